@@ -31,8 +31,13 @@ extern int iccp_mclag_config_dump(char * *buf, int *num, int mclag_id);
 extern int iccp_arp_dump(char * *buf, int *num, int mclag_id);
 extern int iccp_ndisc_dump(char * *buf, int *num, int mclag_id);
 extern int iccp_mac_dump(char * *buf, int *num, int mclag_id);
+struct mclagd_dump_cursor;
+extern int iccp_arp_dump_page(char *buf, int max_num, struct mclagd_dump_cursor *cursor, int mclag_id, int *num, int *more);
+extern int iccp_ndisc_dump_page(char *buf, int max_num, struct mclagd_dump_cursor *cursor, int mclag_id, int *num, int *more);
+extern int iccp_mac_dump_page(char *buf, int max_num, struct mclagd_dump_cursor *cursor, int mclag_id, int *num, int *more);
 extern int iccp_local_if_dump(char * *buf, int *num, int mclag_id);
 extern int iccp_peer_if_dump(char * *buf, int *num, int mclag_id);
 extern int iccp_cmd_dbg_counter_dump(char * *buf, int *data_len, int mclag_id);
 extern int iccp_unique_ip_if_dump(char * *buf, int *num, int mclag_id);
+extern int iccp_cmd_perf_dump(char **buf, int *data_len);
 #endif
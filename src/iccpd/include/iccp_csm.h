@@ -38,6 +38,8 @@
 #include "../include/port.h"
 
 #define CSM_BUFFER_SIZE 65536
+/* Peer receive buffer, room for one full message plus a partial one */
+#define CSM_RX_BUFFER_SIZE (2 * CSM_BUFFER_SIZE)
 
 #ifndef IFNAMSIZ
 #define IFNAMSIZ 16
@@ -77,6 +79,9 @@ struct Msg
     char* buf;
     size_t len;
     TAILQ_ENTRY(Msg) tail;
+    RB_ENTRY(Msg) neigh_rb;     // entry into arp_rb/ndisc_rb, keyed by IP
+    RB_ENTRY(Msg) neigh_if_rb;  // entry into arp_if_rb/ndisc_if_rb, keyed by ifname + IP
+    uint8_t warm_stale;         // neighbor restored from the warm reboot snapshot, not yet re-learned
 };
 
 /* Connection state */
@@ -125,6 +130,12 @@ struct CSM
     /* Msg queue */
     TAILQ_HEAD(msg_list, Msg) msg_list;
 
+    /* Peer receive buffer, unparsed bytes are [rx_head, rx_tail) */
+    char rx_buf[CSM_RX_BUFFER_SIZE];
+    uint32_t rx_head;
+    uint32_t rx_tail;
+    uint32_t rx_retry; /* wakeups the pending partial message has spanned */
+
     /* STP role */
     stp_role_type_et role_type;
 
@@ -147,6 +158,7 @@ struct CSM
     LIST_HEAD(csm_if_list, If_info) if_bind_list;
 };
 int iccp_csm_send(struct CSM*, char*, int);
+int iccp_csm_send_flags(struct CSM*, char*, int, int);
 int iccp_csm_init_msg(struct Msg**, char*, int);
 int iccp_csm_prepare_nak_msg(struct CSM*, char*, size_t);
 int iccp_csm_prepare_iccp_msg(struct CSM*, char*, size_t);
@@ -0,0 +1,100 @@
+/*
+ * iccp_warmboot.h
+ *
+ * Copyright(c) 2016-2019 Nephos/Estinet.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * The full GNU General Public License is included in this distribution in
+ * the file called "COPYING".
+ *
+ *  Maintainer: jianjun, grace Li from nephos
+ *
+ */
+
+#ifndef _ICCP_WARMBOOT_H
+#define _ICCP_WARMBOOT_H
+
+#include <stdint.h>
+
+#include "../include/mlacp_tlv.h"
+
+#define ICCP_WARMBOOT_SNAPSHOT_DIR      "/var/warmboot/iccpd"
+#define ICCP_WARMBOOT_SNAPSHOT_FILE     ICCP_WARMBOOT_SNAPSHOT_DIR "/iccpd_snapshot.bin"
+
+#define ICCP_WARMBOOT_SNAPSHOT_MAGIC    0x53434349   /* "ICCS" */
+#define ICCP_WARMBOOT_SNAPSHOT_VERSION  1
+
+/* Restored entries not re-reported by mclagsyncd, the kernel or the peer
+ * within this many seconds of the session coming up are purged */
+#define ICCP_WARMBOOT_RECONCILE_SEC     60
+
+/* Sections not claimed by a configured mlag-id within this many seconds
+ * of start up are dropped together with the mapping */
+#define ICCP_WARMBOOT_RESTORE_SEC       300
+
+/*
+ * Snapshot layout, all records are fixed size and pointer free so the
+ * file can be mapped read-only and walked in place:
+ *
+ *   iccp_warmboot_hdr
+ *   per CSM: iccp_warmboot_csm_hdr
+ *            mac_count   x iccp_warmboot_mac_rec
+ *            arp_count   x struct ARPMsg
+ *            ndisc_count x struct NDISCMsg
+ */
+struct iccp_warmboot_hdr
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t hdr_len;
+    uint16_t csm_hdr_len;
+    uint16_t mac_rec_len;
+    uint16_t arp_rec_len;
+    uint16_t ndisc_rec_len;
+    uint32_t csm_count;
+    uint32_t reserved;
+    uint64_t total_len;
+    uint64_t save_time;
+};
+
+struct iccp_warmboot_csm_hdr
+{
+    int32_t mlag_id;
+    uint32_t mac_count;
+    uint32_t arp_count;
+    uint32_t ndisc_count;
+};
+
+struct iccp_warmboot_mac_rec
+{
+    uint16_t vid;
+    uint8_t mac_addr[ETHER_ADDR_LEN];
+    uint8_t fdb_type;
+    uint8_t age_flag;
+    uint8_t pending_local_del;
+    uint8_t add_to_syncd;
+    char ifname[MAX_L_PORT_NAME];
+    char origin_ifname[MAX_L_PORT_NAME];
+};
+
+struct CSM;
+
+int iccp_warmboot_snapshot_save(void);
+int iccp_warmboot_snapshot_load(void);
+void iccp_warmboot_snapshot_restore(struct CSM *csm);
+void iccp_warmboot_snapshot_release(void);
+void iccp_warmboot_snapshot_expire(void);
+void iccp_warmboot_reconcile(struct CSM *csm);
+
+#endif
@@ -143,11 +143,39 @@ do{\
         ++MLACP(csm).dbg_counters.iccp_counters[dbg_type][ICCP_DBG_CNTR_DIR_RX][status];\
 }while(0);
 
+/* MAC/ARP/ND info TLVs batched to the peer */
+typedef uint8_t MLACP_SYNC_BATCH_e;
+enum MLACP_SYNC_BATCH_e
+{
+    MLACP_SYNC_BATCH_MAC   = 0,
+    MLACP_SYNC_BATCH_ARP   = 1,
+    MLACP_SYNC_BATCH_NDISC = 2,
+    MLACP_SYNC_BATCH_MAX
+};
+
 typedef struct mlacp_dbg_counter_info
 {
     uint64_t iccp_counters[ICCP_DBG_CNTR_MSG_MAX][ICCP_DBG_CNTR_DIR_MAX][ICCP_DBG_CNTR_STS_MAX];
+
+    /* Peer sync batching */
+    uint64_t sync_batch_msgs[MLACP_SYNC_BATCH_MAX];        //info messages sent
+    uint64_t sync_batch_entries[MLACP_SYNC_BATCH_MAX];     //entries carried by those messages
+    uint32_t sync_batch_max_entries[MLACP_SYNC_BATCH_MAX]; //largest batch sent
+    uint32_t resync_count;      //completed full resyncs with the peer
+    uint32_t resync_last_msec;  //wall time of the last resync, session up to queues drained
+    uint32_t resync_max_msec;
 }mlacp_dbg_counter_info_t;
 
+/* ARP/ND list indexes, the entries are the Msg nodes of arp_list/ndisc_list */
+RB_HEAD(arp_rb_tree, Msg);
+RB_PROTOTYPE(arp_rb_tree, Msg, neigh_rb, ARPMsg_compare);
+RB_HEAD(arp_if_rb_tree, Msg);
+RB_PROTOTYPE(arp_if_rb_tree, Msg, neigh_if_rb, ARPMsg_if_compare);
+RB_HEAD(ndisc_rb_tree, Msg);
+RB_PROTOTYPE(ndisc_rb_tree, Msg, neigh_rb, NDISCMsg_compare);
+RB_HEAD(ndisc_if_rb_tree, Msg);
+RB_PROTOTYPE(ndisc_if_rb_tree, Msg, neigh_if_rb, NDISCMsg_if_compare);
+
 struct mLACP
 {
     int id;
@@ -163,6 +191,14 @@ struct mLACP
     uint16_t system_priority;
     uint8_t system_config_changed;
 
+    /* Peer sync batching state */
+    uint64_t sync_pending_msec[MLACP_SYNC_BATCH_MAX]; //when a partial batch started waiting
+    uint64_t resync_start_msec;
+
+    /* Warm reboot snapshot reconcile state */
+    uint8_t warm_restored;
+    time_t warm_reconcile_time; //purge stale restored MACs after this time
+
     struct Remote_System remote_system;
     const char* error_msg;
     TAILQ_HEAD(mlacp_msg_list, Msg) mlacp_msg_list;
@@ -173,10 +209,15 @@ struct mLACP
     TAILQ_HEAD(mac_msg_list, MACMsg) mac_msg_list;
 
     struct mac_rb_tree mac_rb;
+    struct arp_rb_tree arp_rb;
+    struct arp_if_rb_tree arp_if_rb;
+    struct ndisc_rb_tree ndisc_rb;
+    struct ndisc_if_rb_tree ndisc_if_rb;
 
     LIST_HEAD(lif_list, LocalInterface) lif_list;
     LIST_HEAD(lif_purge_list, LocalInterface) lif_purge_list;
     LIST_HEAD(pif_list, PeerInterface) pif_list;
+    struct pif_name_rb_tree pif_name_rb;    /* pif_list indexed by name */
 
     /* ICCP message tx/rx debug counters */
     mlacp_dbg_counter_info_t  dbg_counters;
@@ -185,6 +226,7 @@ struct mLACP
 void mlacp_init(struct CSM* csm, int all);
 void mlacp_finalize(struct CSM* csm);
 void mlacp_fsm_transit(struct CSM* csm);
+uint64_t mlacp_fsm_sync_deadline_msec(struct CSM* csm);
 void mlacp_enqueue_msg(struct CSM*, struct Msg*);
 struct Msg* mlacp_dequeue_msg(struct CSM*);
 char* mlacp_state(struct CSM* csm);
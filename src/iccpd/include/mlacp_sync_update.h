@@ -44,6 +44,16 @@ int mlacp_fsm_update_warmboot(struct CSM* csm, struct mLACPWarmbootTLV* tlv);
 
 void mlacp_enqueue_arp(struct CSM* csm, struct Msg* msg);
 void mlacp_enqueue_ndisc(struct CSM *csm, struct Msg *msg);
+void mlacp_dequeue_arp(struct CSM* csm, struct Msg* msg);
+void mlacp_dequeue_ndisc(struct CSM *csm, struct Msg *msg);
+struct Msg* mlacp_arp_find(struct CSM* csm, uint32_t ipv4_addr);
+struct Msg* mlacp_arp_first_on_if(struct CSM* csm, const char* ifname);
+struct Msg* mlacp_arp_next_on_if(struct Msg* msg);
+void mlacp_arp_set_ifname(struct CSM* csm, struct Msg* msg, const char* ifname);
+struct Msg *mlacp_ndisc_find(struct CSM *csm, uint32_t *ipv6_addr);
+struct Msg *mlacp_ndisc_first_on_if(struct CSM *csm, const char *ifname);
+struct Msg *mlacp_ndisc_next_on_if(struct Msg *msg);
+void mlacp_ndisc_set_ifname(struct CSM *csm, struct Msg *msg, const char *ifname);
 int mlacp_fsm_update_Agg_conf(struct CSM* csm, mLACPAggConfigTLV* portconf);
 int mlacp_fsm_update_port_channel_info(struct CSM* csm, struct mLACPPortChannelInfoTLV* tlv);
 int mlacp_fsm_update_peerlink_info(struct CSM* csm, struct mLACPPeerLinkInfoTLV* tlv);
@@ -525,6 +525,7 @@ struct MACMsg
     uint8_t age_flag;/*local or peer is age?*/
     uint8_t pending_local_del;
     uint8_t add_to_syncd;
+    uint8_t warm_stale;/*restored from warm reboot snapshot, not yet re-reported*/
 
     TAILQ_ENTRY(MACMsg) tail;     // entry into mac_msg_list
 };
@@ -42,6 +42,8 @@ struct System;
 #define HEARTBEAT_TIMEOUT_SEC       15
 #define TRANSIT_INTERVAL_SEC        1
 #define EPOLL_TIMEOUT_MSEC          100
+/* FSM pass interval while a session handshake or peer sync is in progress */
+#define SCHEDULER_POLL_MSEC         100
 
 int scheduler_prepare_session(struct CSM*);
 int scheduler_check_csm_config(struct CSM*);
@@ -57,5 +59,7 @@ int iccp_get_server_sock_fd();
 int scheduler_server_accept();
 int iccp_receive_signal_handler(struct System* sys);
 void scheduler_csm_socket_cleanup(struct CSM* csm, int location);
+int scheduler_timer_init(struct System* sys);
+int scheduler_timer_handler(struct System* sys);
 
 #endif /* SCHEDULER_H_ */
@@ -160,7 +160,7 @@ do{\
         ++sys->dbg_counters.rx_peer_invalid_msg_counter;
 
 #define SYSTEM_GET_INVALID_PEER_MSG_COUNTER(sys)\
-    ((sys) ? ((sys)->dbg_counters.rx_peer_invalid_msg_counter) ? 0)
+    ((sys) ? ((sys)->dbg_counters.rx_peer_invalid_msg_counter) : 0)
 
 #define SYSTEM_INCR_RX_READ_SOCK_ZERO_COUNTER(sys)\
    if (sys)\
@@ -288,10 +288,80 @@ typedef struct system_dbg_counter_info
     uint32_t mac_entry_alloc_counter;
     uint32_t mac_entry_free_counter;
 
+    /* Scheduler passes and event-to-action latency */
+    uint64_t sched_event_run_counter; //FSM passes triggered by fd events
+    uint64_t sched_timer_run_counter; //FSM passes triggered by the timer only
+    uint64_t sched_latency_total_usec; //sum of event-to-action latency
+    uint32_t sched_latency_last_usec;
+    uint32_t sched_latency_max_usec;
+    uint32_t sched_timer_late_max_usec; //worst timer expiry past its deadline
+
+    /* Batched kernel neighbor programming */
+    uint64_t neigh_batch_msg_counter; //netlink sends carrying batched neighbor requests
+    uint64_t neigh_batch_entry_counter; //neighbor requests sent in batches
+    uint32_t neigh_batch_err_counter; //batched requests nacked or left unacked
+
+    /* Warm reboot snapshot */
+    uint32_t warm_restore_mac_counter; //MACs restored from the snapshot
+    uint32_t warm_restore_neigh_counter; //ARP/ND entries restored from the snapshot
+    uint32_t warm_purge_mac_counter; //restored MACs purged at reconcile
+    uint32_t warm_purge_neigh_counter; //restored ARP/ND entries purged at reconcile
+
     uint64_t syncd_tx_counters[SYNCD_TX_DBG_CNTR_MSG_MAX][SYNCD_DBG_CNTR_STS_MAX];
     uint64_t syncd_rx_counters[SYNCD_RX_DBG_CNTR_MSG_MAX][SYNCD_DBG_CNTR_STS_MAX];
 }system_dbg_counter_info_t;
 
+/* Latency histograms shown by "mclagdctl dump perf". Bucket 0 counts
+ * samples under 2 usec, bucket i samples in [2^i, 2^(i+1)) usec and the
+ * last bucket everything above.
+ */
+#define ICCP_PERF_HIST_BUCKETS 24
+
+typedef struct iccp_perf_hist
+{
+    uint64_t count;
+    uint64_t total_usec;
+    uint32_t max_usec;
+    uint32_t bucket[ICCP_PERF_HIST_BUCKETS];
+}iccp_perf_hist_t;
+
+/* Time spent per scheduler pass and per event source */
+typedef uint8_t ICCP_PERF_SRC_e;
+enum ICCP_PERF_SRC_e
+{
+    ICCP_PERF_SRC_FSM_TRANSIT   = 0,
+    ICCP_PERF_SRC_TIMER         = 1,
+    ICCP_PERF_SRC_SERVER_ACCEPT = 2,
+    ICCP_PERF_SRC_NETLINK_GENL  = 3,
+    ICCP_PERF_SRC_NETLINK_ROUTE = 4,
+    ICCP_PERF_SRC_ARP_PKT       = 5,
+    ICCP_PERF_SRC_NDISC_PKT     = 6,
+    ICCP_PERF_SRC_MCLAGDCTL     = 7,
+    ICCP_PERF_SRC_MCLAGSYNCD    = 8,
+    ICCP_PERF_SRC_SIGNAL        = 9,
+    ICCP_PERF_SRC_PEER_RX       = 10,
+    ICCP_PERF_SRC_MAX
+};
+
+/* Time spent handling each received mLACP TLV: TLV_T_MLACP_CONNECT..
+ * TLV_T_MLACP_DISCONNECT_CAUSE, then TLV_T_MLACP_ORPHAN_PORT..
+ * TLV_T_MLACP_IF_UP_ACK, then anything else
+ */
+#define ICCP_PERF_TLV_LOW_BASE      0x0030
+#define ICCP_PERF_TLV_LOW_COUNT     12
+#define ICCP_PERF_TLV_HIGH_BASE     0x1033
+#define ICCP_PERF_TLV_HIGH_COUNT    9
+#define ICCP_PERF_TLV_OTHER         (ICCP_PERF_TLV_LOW_COUNT + ICCP_PERF_TLV_HIGH_COUNT)
+#define ICCP_PERF_TLV_MAX           (ICCP_PERF_TLV_OTHER + 1)
+
+typedef struct iccp_perf_info
+{
+    uint64_t reset_msec; /* CLOCK_MONOTONIC of the last reset */
+    uint64_t now_msec;   /* filled in when dumped */
+    iccp_perf_hist_t src[ICCP_PERF_SRC_MAX];
+    iccp_perf_hist_t tlv[ICCP_PERF_TLV_MAX];
+}iccp_perf_info_t;
+
 struct System
 {
     int server_fd;/* Peer-Link Socket*/
@@ -306,11 +376,16 @@ struct System
     int family;
     struct nl_sock * route_sock;
     int route_sock_seq;
+    struct nl_sock * neigh_batch_sock;
     struct nl_sock * genric_event_sock;
     struct nl_sock * route_event_sock;
 
     int sig_pipe_r;
     int sig_pipe_w;
+    int timer_fd;
+    uint64_t timer_deadline_usec; /* CLOCK_MONOTONIC, next FSM deadline */
+    uint64_t event_rx_usec;       /* first fd event of the current pass */
+    int timer_expired;
     int warmboot_start;
     int warmboot_exit;
 
@@ -318,6 +393,10 @@ struct System
     LIST_HEAD(csm_list, CSM) csm_list;
     LIST_HEAD(lif_all_list, LocalInterface) lif_list;
     LIST_HEAD(lif_purge_all_list, LocalInterface) lif_purge_list;
+    struct lif_name_rb_tree lif_name_rb;       /* lif_list indexed by name */
+    struct lif_ifindex_rb_tree lif_ifindex_rb; /* lif_list indexed by ifindex */
+    struct lif_po_id_rb_tree lif_po_id_rb;     /* port-channels indexed by po_id */
+    uint32_t lif_shadowed_count;               /* lif_list entries with index_shadowed set */
     LIST_HEAD(unq_ip_all_if_list, Unq_ip_If_info) unq_ip_if_list;
     LIST_HEAD(pending_vlan_mbr_if_list, PendingVlanMbrIf) pending_vlan_mbr_if_list;
 
@@ -326,6 +405,7 @@ struct System
     char* cmd_file_path;
     char* config_file_path;
     char* mclagdctl_file_path;
+    char* warmboot_file_path;
     int pid_file_fd;
     int telnet_port;
     fd_set readfd; /*record socket need to listen*/
@@ -336,6 +416,9 @@ struct System
 
     /* ICCDd/MclagSyncd debug counters */
     system_dbg_counter_info_t dbg_counters;
+
+    /* Handler latency histograms */
+    iccp_perf_info_t perf;
 };
 
 struct CSM* system_create_csm();
@@ -351,5 +434,11 @@ SYNCD_RX_DBG_CNTR_MSG_e system_syncdrx_to_dbg_msg_type(uint32_t msg_type);
 
 char *mac_addr_to_str(uint8_t mac_addr[ETHER_ADDR_LEN]);
 void system_update_netlink_counters(uint16_t netlink_msg_type, struct nlmsghdr *nlh);
+uint64_t system_get_time_msec(void);
+uint64_t system_get_time_usec(void);
+void system_perf_record(iccp_perf_hist_t *hist, uint64_t start_usec);
+void system_perf_record_src(struct System *sys, ICCP_PERF_SRC_e src, uint64_t start_usec);
+void system_perf_record_tlv(struct System *sys, uint16_t tlv_type, uint64_t start_usec);
+void system_perf_reset(struct System *sys);
 
 #endif /* SYSTEM_H_ */
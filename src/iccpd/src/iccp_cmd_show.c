@@ -348,6 +348,186 @@ int iccp_mac_dump(char * *buf, int *num, int mclag_id)
     return EXEC_TYPE_SUCCESS;
 }
 
+static struct CSM *iccp_dump_page_csm(struct System *sys, int mclag_id)
+{
+    struct CSM *csm = NULL;
+
+    LIST_FOREACH(csm, &(sys->csm_list), next)
+    {
+        if (csm->mlag_id == mclag_id)
+            return csm;
+    }
+
+    return NULL;
+}
+
+/* Fill buf with at most max_num ARP entries ordered by IP, starting after
+ * the cursor key, and move the cursor to the last entry returned.
+ */
+int iccp_arp_dump_page(char *buf, int max_num, struct mclagd_dump_cursor *cursor, int mclag_id, int *num, int *more)
+{
+    struct System *sys = NULL;
+    struct CSM *csm = NULL;
+    struct Msg *msg = NULL;
+    struct Msg key_msg;
+    struct ARPMsg key_arp;
+    struct ARPMsg *iccpd_arp = NULL;
+    struct mclagd_arp_msg *mclagd_arp = (struct mclagd_arp_msg *)buf;
+    int arp_num = 0;
+
+    if (!(sys = system_get_instance()))
+        return EXEC_TYPE_NO_EXIST_SYS;
+
+    if (!(csm = iccp_dump_page_csm(sys, mclag_id)))
+        return EXEC_TYPE_NO_EXIST_MCLAGID;
+
+    if (cursor->valid)
+    {
+        memset(&key_arp, 0, sizeof(struct ARPMsg));
+        memcpy(&key_arp.ipv4_addr, cursor->ip_addr, sizeof(key_arp.ipv4_addr));
+        key_msg.buf = (char *)&key_arp;
+        msg = RB_NFIND(arp_rb_tree, &MLACP(csm).arp_rb, &key_msg);
+        if (msg && ((struct ARPMsg *)msg->buf)->ipv4_addr == key_arp.ipv4_addr)
+            msg = RB_NEXT(arp_rb_tree, msg);
+    }
+    else
+    {
+        msg = RB_MIN(arp_rb_tree, &MLACP(csm).arp_rb);
+    }
+
+    for (; msg && arp_num < max_num; msg = RB_NEXT(arp_rb_tree, msg))
+    {
+        iccpd_arp = (struct ARPMsg *)msg->buf;
+
+        memset(mclagd_arp, 0, sizeof(struct mclagd_arp_msg));
+        mclagd_arp->op_type = iccpd_arp->op_type;
+        mclagd_arp->learn_flag = iccpd_arp->learn_flag;
+        memcpy(mclagd_arp->ifname, iccpd_arp->ifname, strnlen(iccpd_arp->ifname, MAX_L_PORT_NAME));
+        memcpy(mclagd_arp->ipv4_addr, show_ip_str(iccpd_arp->ipv4_addr), 16);
+        memcpy(mclagd_arp->mac_addr, iccpd_arp->mac_addr, 6);
+
+        memcpy(cursor->ip_addr, &iccpd_arp->ipv4_addr, sizeof(iccpd_arp->ipv4_addr));
+        cursor->valid = 1;
+        mclagd_arp++;
+        arp_num++;
+    }
+
+    *num = arp_num;
+    *more = (msg != NULL);
+
+    return EXEC_TYPE_SUCCESS;
+}
+
+/* Same as iccp_arp_dump_page for ND entries, ordered by IPv6 address */
+int iccp_ndisc_dump_page(char *buf, int max_num, struct mclagd_dump_cursor *cursor, int mclag_id, int *num, int *more)
+{
+    struct System *sys = NULL;
+    struct CSM *csm = NULL;
+    struct Msg *msg = NULL;
+    struct Msg key_msg;
+    struct NDISCMsg key_ndisc;
+    struct NDISCMsg *iccpd_ndisc = NULL;
+    struct mclagd_ndisc_msg *mclagd_ndisc = (struct mclagd_ndisc_msg *)buf;
+    int ndisc_num = 0;
+
+    if (!(sys = system_get_instance()))
+        return EXEC_TYPE_NO_EXIST_SYS;
+
+    if (!(csm = iccp_dump_page_csm(sys, mclag_id)))
+        return EXEC_TYPE_NO_EXIST_MCLAGID;
+
+    if (cursor->valid)
+    {
+        memset(&key_ndisc, 0, sizeof(struct NDISCMsg));
+        memcpy(key_ndisc.ipv6_addr, cursor->ip_addr, 16);
+        key_msg.buf = (char *)&key_ndisc;
+        msg = RB_NFIND(ndisc_rb_tree, &MLACP(csm).ndisc_rb, &key_msg);
+        if (msg && memcmp(((struct NDISCMsg *)msg->buf)->ipv6_addr, key_ndisc.ipv6_addr, 16) == 0)
+            msg = RB_NEXT(ndisc_rb_tree, msg);
+    }
+    else
+    {
+        msg = RB_MIN(ndisc_rb_tree, &MLACP(csm).ndisc_rb);
+    }
+
+    for (; msg && ndisc_num < max_num; msg = RB_NEXT(ndisc_rb_tree, msg))
+    {
+        iccpd_ndisc = (struct NDISCMsg *)msg->buf;
+
+        memset(mclagd_ndisc, 0, sizeof(struct mclagd_ndisc_msg));
+        mclagd_ndisc->op_type = iccpd_ndisc->op_type;
+        mclagd_ndisc->learn_flag = iccpd_ndisc->learn_flag;
+        memcpy(mclagd_ndisc->ifname, iccpd_ndisc->ifname, strnlen(iccpd_ndisc->ifname, MAX_L_PORT_NAME));
+        memcpy(mclagd_ndisc->ipv6_addr, show_ipv6_str((char *)iccpd_ndisc->ipv6_addr), 46);
+        memcpy(mclagd_ndisc->mac_addr, iccpd_ndisc->mac_addr, 6);
+
+        memcpy(cursor->ip_addr, iccpd_ndisc->ipv6_addr, 16);
+        cursor->valid = 1;
+        mclagd_ndisc++;
+        ndisc_num++;
+    }
+
+    *num = ndisc_num;
+    *more = (msg != NULL);
+
+    return EXEC_TYPE_SUCCESS;
+}
+
+/* Same as iccp_arp_dump_page for MAC entries, in mac_rb_tree order */
+int iccp_mac_dump_page(char *buf, int max_num, struct mclagd_dump_cursor *cursor, int mclag_id, int *num, int *more)
+{
+    struct System *sys = NULL;
+    struct CSM *csm = NULL;
+    struct MACMsg key_mac;
+    struct MACMsg *iccpd_mac = NULL;
+    struct mclagd_mac_msg *mclagd_mac = (struct mclagd_mac_msg *)buf;
+    int mac_num = 0;
+
+    if (!(sys = system_get_instance()))
+        return EXEC_TYPE_NO_EXIST_SYS;
+
+    if (!(csm = iccp_dump_page_csm(sys, mclag_id)))
+        return EXEC_TYPE_NO_EXIST_MCLAGID;
+
+    if (cursor->valid)
+    {
+        memset(&key_mac, 0, sizeof(struct MACMsg));
+        key_mac.vid = cursor->vid;
+        memcpy(key_mac.mac_addr, cursor->mac_addr, ETHER_ADDR_LEN);
+        iccpd_mac = RB_NFIND(mac_rb_tree, &MLACP(csm).mac_rb, &key_mac);
+        if (iccpd_mac && iccpd_mac->vid == key_mac.vid
+            && memcmp(iccpd_mac->mac_addr, key_mac.mac_addr, ETHER_ADDR_LEN) == 0)
+            iccpd_mac = RB_NEXT(mac_rb_tree, iccpd_mac);
+    }
+    else
+    {
+        iccpd_mac = RB_MIN(mac_rb_tree, &MLACP(csm).mac_rb);
+    }
+
+    for (; iccpd_mac && mac_num < max_num; iccpd_mac = RB_NEXT(mac_rb_tree, iccpd_mac))
+    {
+        memset(mclagd_mac, 0, sizeof(struct mclagd_mac_msg));
+        mclagd_mac->op_type = iccpd_mac->op_type;
+        mclagd_mac->fdb_type = iccpd_mac->fdb_type;
+        memcpy(mclagd_mac->mac_addr, iccpd_mac->mac_addr, ETHER_ADDR_LEN);
+        mclagd_mac->vid = iccpd_mac->vid;
+        memcpy(mclagd_mac->ifname, iccpd_mac->ifname, strnlen(iccpd_mac->ifname, MAX_L_PORT_NAME));
+        memcpy(mclagd_mac->origin_ifname, iccpd_mac->origin_ifname, strnlen(iccpd_mac->origin_ifname, MAX_L_PORT_NAME));
+        mclagd_mac->age_flag = iccpd_mac->age_flag;
+
+        memcpy(cursor->mac_addr, iccpd_mac->mac_addr, ETHER_ADDR_LEN);
+        cursor->vid = iccpd_mac->vid;
+        cursor->valid = 1;
+        mclagd_mac++;
+        mac_num++;
+    }
+
+    *num = mac_num;
+    *more = (iccpd_mac != NULL);
+
+    return EXEC_TYPE_SUCCESS;
+}
+
 int iccp_local_if_dump(char * *buf,  int *num, int mclag_id)
 {
     struct System *sys = NULL;
@@ -765,6 +945,30 @@ int iccp_cmd_dbg_counter_dump(char **buf, int *data_len, int mclag_id)
     return EXEC_TYPE_SUCCESS;
 }
 
+int iccp_cmd_perf_dump(char **buf, int *data_len)
+{
+    struct System *sys = NULL;
+    iccp_perf_info_t *perf_ptr;
+    char *perf_buf = NULL;
+    int buf_size = MCLAGD_REPLY_INFO_HDR + sizeof(iccp_perf_info_t);
+
+    if (!(sys = system_get_instance()))
+        return EXEC_TYPE_NO_EXIST_SYS;
+
+    perf_buf = (char *)malloc(buf_size);
+    if (!perf_buf)
+        return EXEC_TYPE_FAILED;
+
+    memset(perf_buf, 0, MCLAGD_REPLY_INFO_HDR);
+    perf_ptr = (iccp_perf_info_t *)(perf_buf + MCLAGD_REPLY_INFO_HDR);
+    memcpy(perf_ptr, &sys->perf, sizeof(iccp_perf_info_t));
+    perf_ptr->now_msec = system_get_time_msec();
+
+    *buf = perf_buf;
+    *data_len = sizeof(iccp_perf_info_t);
+    return EXEC_TYPE_SUCCESS;
+}
+
 int iccp_unique_ip_if_dump(char **buf, int *num, int mclag_id)
 {
     struct System *sys = NULL;
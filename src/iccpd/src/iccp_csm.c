@@ -138,6 +138,9 @@ void iccp_csm_status_reset(struct CSM* csm, int all)
     }
 
     csm->sock_fd = -1;
+    csm->rx_head = 0;
+    csm->rx_tail = 0;
+    csm->rx_retry = 0;
     pthread_mutex_init(&csm->conn_mutex, NULL);
     csm->connTimePrev = 0;
     csm->heartbeat_send_time = 0;
@@ -243,6 +246,14 @@ void iccp_csm_msg_list_finalize(struct CSM* csm)
 
 /* Send message to peer */
 int iccp_csm_send(struct CSM* csm, char* buf, int msg_len)
+{
+    return iccp_csm_send_flags(csm, buf, msg_len, 0);
+}
+
+/* Send message to peer, flags are passed to send(), e.g. MSG_MORE
+ * to let TCP coalesce consecutive messages into full segments
+ */
+int iccp_csm_send_flags(struct CSM* csm, char* buf, int msg_len, int flags)
 {
     LDPHdr* ldp_hdr = (LDPHdr*)buf;
     ICCParameter* param = NULL;
@@ -266,7 +277,7 @@ int iccp_csm_send(struct CSM* csm, char* buf, int msg_len)
         csm->msg_log.end_index = 0;
 
     tlv_type = ntohs(param->type);
-    rc = write(csm->sock_fd, buf, msg_len);
+    rc = send(csm->sock_fd, buf, msg_len, flags);
     if ((rc <= 0) || (rc != msg_len))
     {
         MLACP_SET_ICCP_TX_DBG_COUNTER(
@@ -803,6 +814,7 @@ int iccp_csm_init_msg(struct Msg** msg, char* data, int len)
 
     memcpy(iccp_msg->buf, data, len);
     iccp_msg->len = len;
+    iccp_msg->warm_stale = 0;
     *msg = iccp_msg;
 
     return 0;
@@ -277,24 +277,25 @@ static void do_arp_learn_from_kernel(struct ndmsg *ndm, struct rtattr *tb[], int
     }
 
     /* update lif ARP*/
-    TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+    msg = mlacp_arp_find(csm, arp_msg->ipv4_addr);
+    if (msg)
     {
         arp_info = (struct ARPMsg *)msg->buf;
-        if (arp_info->ipv4_addr != arp_msg->ipv4_addr)
-            continue;
 
         entry_exists = 1;
         if (msgtype == RTM_DELNEIGH)
         {
             /* delete ARP*/
-            TAILQ_REMOVE(&MLACP(csm).arp_list, msg, tail);
-            free(msg->buf);
-            free(msg);
+            mlacp_dequeue_arp(csm, msg);
             msg = NULL;
             ICCPD_LOG_DEBUG(__FUNCTION__, "Delete ARP %s", show_ip_str(arp_msg->ipv4_addr));
         }
         else
         {
+            /* The kernel vouches for local entries only, remote ones wait for the peer */
+            if (arp_info->learn_flag != NEIGH_REMOTE)
+                msg->warm_stale = 0;
+
             /* update ARP*/
             if (arp_info->op_type != arp_msg->op_type
                 || strcmp(arp_info->ifname, arp_msg->ifname) != 0
@@ -302,12 +303,11 @@ static void do_arp_learn_from_kernel(struct ndmsg *ndm, struct rtattr *tb[], int
             {
                 arp_update = 1;
                 arp_info->op_type = arp_msg->op_type;
-                sprintf(arp_info->ifname, "%s", arp_msg->ifname);
+                mlacp_arp_set_ifname(csm, msg, arp_msg->ifname);
                 memcpy(arp_info->mac_addr, arp_msg->mac_addr, ETHER_ADDR_LEN);
                 ICCPD_LOG_DEBUG(__FUNCTION__, "Update ARP for %s", show_ip_str(arp_msg->ipv4_addr));
             }
         }
-        break;
     }
 
     if (msg && !arp_update)
@@ -551,37 +551,36 @@ static void do_ndisc_learn_from_kernel(struct ndmsg *ndm, struct rtattr *tb[], i
     }
 
     /* update lif ND */
-    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+    msg = mlacp_ndisc_find(csm, ndisc_msg->ipv6_addr);
+    if (msg)
     {
         ndisc_info = (struct NDISCMsg *)msg->buf;
 
-        if (memcmp(&ndisc_info->ipv6_addr, &ndisc_msg->ipv6_addr, 16) != 0)
-            continue;
-
         entry_exists = 1;
         if (msgtype == RTM_DELNEIGH)
         {
             /* delete ND */
-            TAILQ_REMOVE(&MLACP(csm).ndisc_list, msg, tail);
-            free(msg->buf);
-            free(msg);
+            mlacp_dequeue_ndisc(csm, msg);
             msg = NULL;
             ICCPD_LOG_DEBUG(__FUNCTION__, "Delete neighbor %s", show_ipv6_str((char *)ndisc_msg->ipv6_addr));
         }
         else
         {
+            /* The kernel vouches for local entries only, remote ones wait for the peer */
+            if (ndisc_info->learn_flag != NEIGH_REMOTE)
+                msg->warm_stale = 0;
+
             /* update ND */
             if (ndisc_info->op_type != ndisc_info->op_type
                 || strcmp(ndisc_info->ifname, ndisc_info->ifname) != 0 || memcmp(ndisc_info->mac_addr, ndisc_info->mac_addr, ETHER_ADDR_LEN) != 0)
             {
                 neigh_update = 1;
                 ndisc_info->op_type = ndisc_msg->op_type;
-                sprintf(ndisc_info->ifname, "%s", ndisc_msg->ifname);
+                mlacp_ndisc_set_ifname(csm, msg, ndisc_msg->ifname);
                 memcpy(ndisc_info->mac_addr, ndisc_msg->mac_addr, ETHER_ADDR_LEN);
                 ICCPD_LOG_DEBUG(__FUNCTION__, "Update neighbor for %s", show_ipv6_str((char *)ndisc_msg->ipv6_addr));
             }
         }
-        break;
     }
 
     if (msg && !neigh_update)
@@ -960,11 +959,12 @@ void do_arp_update_from_reply_packet(unsigned int ifindex, unsigned int addr, ui
     }
 
     /* update lif ARP*/
-    TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+    msg = mlacp_arp_find(csm, arp_msg->ipv4_addr);
+    if (msg)
     {
         arp_info = (struct ARPMsg*)msg->buf;
-        if (arp_info->ipv4_addr != arp_msg->ipv4_addr)
-            continue;
+        if (arp_info->learn_flag != NEIGH_REMOTE)
+            msg->warm_stale = 0;
 
         /* update ARP*/
         if (arp_info->op_type != arp_msg->op_type
@@ -972,12 +972,11 @@ void do_arp_update_from_reply_packet(unsigned int ifindex, unsigned int addr, ui
             || memcmp(arp_info->mac_addr, arp_msg->mac_addr, ETHER_ADDR_LEN) != 0)
         {
             arp_info->op_type = arp_msg->op_type;
-            sprintf(arp_info->ifname, "%s", arp_msg->ifname);
+            mlacp_arp_set_ifname(csm, msg, arp_msg->ifname);
             memcpy(arp_info->mac_addr, arp_msg->mac_addr, ETHER_ADDR_LEN);
             ICCPD_LOG_DEBUG(__FUNCTION__, "Update ARP for %s",
                             show_ip_str(arp_msg->ipv4_addr));
         }
-        break;
     }
 
     /* enquene lif_msg (add)*/
@@ -1182,12 +1181,12 @@ void do_ndisc_update_from_reply_packet(unsigned int ifindex, char *ipv6_addr, ui
     }
 
     /* update lif ND */
-    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+    msg = mlacp_ndisc_find(csm, ndisc_msg->ipv6_addr);
+    if (msg)
     {
         ndisc_info = (struct NDISCMsg *)msg->buf;
-
-        if (memcmp((char *)ndisc_info->ipv6_addr, (char *)ndisc_msg->ipv6_addr, 16) != 0)
-            continue;
+        if (ndisc_info->learn_flag != NEIGH_REMOTE)
+            msg->warm_stale = 0;
 
         /* If MAC addr is NULL, use the old one */
         if (memcmp(mac_addr, null_mac, ETHER_ADDR_LEN) == 0)
@@ -1202,11 +1201,10 @@ void do_ndisc_update_from_reply_packet(unsigned int ifindex, char *ipv6_addr, ui
             || strcmp(ndisc_info->ifname, ndisc_msg->ifname) != 0 || memcmp(ndisc_info->mac_addr, ndisc_msg->mac_addr, ETHER_ADDR_LEN) != 0)
         {
             ndisc_info->op_type = ndisc_msg->op_type;
-            sprintf(ndisc_info->ifname, "%s", ndisc_msg->ifname);
+            mlacp_ndisc_set_ifname(csm, msg, ndisc_msg->ifname);
             memcpy(ndisc_info->mac_addr, ndisc_msg->mac_addr, ETHER_ADDR_LEN);
              ICCPD_LOG_DEBUG(__FUNCTION__, "Update ND for %s", show_ipv6_str((char *)ndisc_msg->ipv6_addr));
         }
-        break;
     }
 
     /* enquene lif_msg (add) */
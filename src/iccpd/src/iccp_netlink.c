@@ -27,6 +27,7 @@
 #include <stdlib.h>
 
 #include <sys/epoll.h>
+#include <errno.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 
@@ -501,18 +502,7 @@ void iccp_set_interface_ipadd_mac(struct LocalInterface *lif, char * mac_addr )
 
     /*send msg*/
     if (sys->sync_fd)
-    {
-        if (write(sys->sync_fd,msg_buf, msg_hdr->len) == -1)
-        {
-            SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                sys, msg_hdr->type, ICCP_DBG_CNTR_STS_ERR);
-        }
-        else
-        {
-            SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                sys, msg_hdr->type, ICCP_DBG_CNTR_STS_OK);
-        }
-    }
+        iccp_send_to_mclagsyncd(msg_hdr->type, msg_buf, msg_hdr->len);
     return;
 }
 
@@ -824,6 +814,205 @@ void recover_if_ipmac_on_standby(struct LocalInterface *lif_po, int dir)
     return;
 }
 
+/* Neighbor requests issued while a batch is open are packed into one
+ * NETLINK_ROUTE send on sys->neigh_batch_sock; the acks are drained once per
+ * window and matched back to the queued entry by sequence number. The socket
+ * is private to the batch layer, so acks it fails to collect never reach the
+ * synchronous rtnl calls on route_sock.
+ */
+#define ICCP_NEIGH_BATCH_MAX_ENTRY          256
+#define ICCP_NEIGH_BATCH_BUF_SIZE           (64 * 1024)
+
+struct iccp_neigh_batch_entry
+{
+    uint32_t seq;
+    int family;
+    uint8_t addr[16];
+    char ifname[MAX_L_PORT_NAME];
+    int add;
+    int dir;
+};
+
+static int g_neigh_batch_depth = 0;
+static int g_neigh_batch_count = 0;
+static size_t g_neigh_batch_len = 0;
+static char g_neigh_batch_buf[ICCP_NEIGH_BATCH_BUF_SIZE];
+static struct iccp_neigh_batch_entry g_neigh_batch_entry[ICCP_NEIGH_BATCH_MAX_ENTRY];
+
+static void iccp_netlink_neighbor_batch_log_err(struct iccp_neigh_batch_entry *entry, int err)
+{
+    ICCPD_LOG_NOTICE(__FUNCTION__, "%s %s entry(ip:%s, intf:%s) failed, dir %d, err = %d",
+                     entry->add ? "add" : "del", (entry->family == AF_INET) ? "ARP" : "ND",
+                     (entry->family == AF_INET) ? show_ip_str(*((int *)entry->addr)) : show_ipv6_str((char *)entry->addr),
+                     entry->ifname, entry->dir, err);
+}
+
+/* Read whatever is queued on the batch socket without blocking and match the
+ * acks against the open window. Returns -1 once the kernel reported ENOBUFS,
+ * i.e. some acks were dropped and will never arrive.
+ */
+static int iccp_netlink_neighbor_batch_drain(struct System *sys, int fd, int *idx, int *acked)
+{
+    char rbuf[8192];
+    struct nlmsghdr *hdr;
+    struct nlmsgerr *nl_err;
+    ssize_t len;
+    int overrun = 0;
+    int i;
+
+    while (1)
+    {
+        len = recv(fd, rbuf, sizeof(rbuf), MSG_DONTWAIT);
+        if (len < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            /* Keep reading past an overrun so the queue is left empty */
+            if (errno == ENOBUFS)
+            {
+                overrun = 1;
+                continue;
+            }
+            return overrun ? -1 : 0;
+        }
+        if (len == 0)
+            return overrun ? -1 : 0;
+
+        for (hdr = (struct nlmsghdr *)rbuf; NLMSG_OK(hdr, len); hdr = NLMSG_NEXT(hdr, len))
+        {
+            if (hdr->nlmsg_type != NLMSG_ERROR)
+                continue;
+
+            /* The kernel acks in request order, so the match only moves forward */
+            for (i = *idx; i < g_neigh_batch_count; i++)
+            {
+                if (g_neigh_batch_entry[i].seq == hdr->nlmsg_seq)
+                    break;
+            }
+            if (i == g_neigh_batch_count)
+                continue;
+
+            *idx = i + 1;
+            ++(*acked);
+
+            nl_err = (struct nlmsgerr *)NLMSG_DATA(hdr);
+            if (nl_err->error != 0)
+            {
+                ++sys->dbg_counters.neigh_batch_err_counter;
+                iccp_netlink_neighbor_batch_log_err(&g_neigh_batch_entry[i], nl_err->error);
+            }
+        }
+    }
+}
+
+/* Send the queued neighbor requests and collect one ack per request.
+ * rtnetlink handles requests in the sender's context, so every ack is
+ * already queued when send() returns and nothing here has to wait.
+ */
+static void iccp_netlink_neighbor_batch_flush(struct System *sys)
+{
+    int fd;
+    int idx = 0;
+    int acked = 0;
+
+    if (g_neigh_batch_count == 0)
+        return;
+
+    fd = nl_socket_get_fd(sys->neigh_batch_sock);
+
+    /* Throw away anything left over from an earlier window */
+    iccp_netlink_neighbor_batch_drain(sys, fd, &idx, &acked);
+    idx = 0;
+    acked = 0;
+
+    if (send(fd, g_neigh_batch_buf, g_neigh_batch_len, 0) < 0)
+    {
+        ICCPD_LOG_WARN(__FUNCTION__, "send %d neighbor requests failed, errno %d",
+                       g_neigh_batch_count, errno);
+        sys->dbg_counters.neigh_batch_err_counter += g_neigh_batch_count;
+        g_neigh_batch_count = 0;
+        g_neigh_batch_len = 0;
+        return;
+    }
+
+    ++sys->dbg_counters.neigh_batch_msg_counter;
+    sys->dbg_counters.neigh_batch_entry_counter += g_neigh_batch_count;
+
+    if (iccp_netlink_neighbor_batch_drain(sys, fd, &idx, &acked) < 0)
+        ICCPD_LOG_WARN(__FUNCTION__, "ack overrun on neighbor batch socket");
+
+    if (acked < g_neigh_batch_count)
+    {
+        ICCPD_LOG_WARN(__FUNCTION__, "only %d of %d neighbor requests acked",
+                       acked, g_neigh_batch_count);
+        sys->dbg_counters.neigh_batch_err_counter += g_neigh_batch_count - acked;
+    }
+
+    g_neigh_batch_count = 0;
+    g_neigh_batch_len = 0;
+}
+
+static int iccp_netlink_neighbor_batch_add(struct System *sys, struct rtnl_neigh *neigh,
+                                           int family, uint8_t *addr, int add, char *portname, int dir)
+{
+    struct iccp_neigh_batch_entry *entry;
+    struct nl_msg *msg = NULL;
+    struct nlmsghdr *hdr;
+    int err;
+
+    if (add)
+        err = rtnl_neigh_build_add_request(neigh, NLM_F_REPLACE | NLM_F_CREATE, &msg);
+    else
+        err = rtnl_neigh_build_delete_request(neigh, 0, &msg);
+
+    if (err < 0)
+        return err;
+
+    hdr = nlmsg_hdr(msg);
+    if (g_neigh_batch_count >= ICCP_NEIGH_BATCH_MAX_ENTRY
+        || g_neigh_batch_len + NLMSG_ALIGN(hdr->nlmsg_len) > ICCP_NEIGH_BATCH_BUF_SIZE)
+        iccp_netlink_neighbor_batch_flush(sys);
+
+    hdr->nlmsg_flags |= NLM_F_REQUEST | NLM_F_ACK;
+    hdr->nlmsg_seq = nl_socket_use_seq(sys->neigh_batch_sock);
+    hdr->nlmsg_pid = nl_socket_get_local_port(sys->neigh_batch_sock);
+
+    memset(g_neigh_batch_buf + g_neigh_batch_len, 0, NLMSG_ALIGN(hdr->nlmsg_len));
+    memcpy(g_neigh_batch_buf + g_neigh_batch_len, hdr, hdr->nlmsg_len);
+    g_neigh_batch_len += NLMSG_ALIGN(hdr->nlmsg_len);
+
+    entry = &g_neigh_batch_entry[g_neigh_batch_count++];
+    memset(entry, 0, sizeof(*entry));
+    entry->seq = hdr->nlmsg_seq;
+    entry->family = family;
+    memcpy(entry->addr, addr, (family == AF_INET) ? 4 : 16);
+    snprintf(entry->ifname, sizeof(entry->ifname), "%s", portname);
+    entry->add = add;
+    entry->dir = dir;
+
+    nlmsg_free(msg);
+    return 0;
+}
+
+/* Batches nest; requests are sent when the outermost batch ends or the
+ * window fills up
+ */
+void iccp_netlink_neighbor_batch_begin(void)
+{
+    ++g_neigh_batch_depth;
+}
+
+void iccp_netlink_neighbor_batch_end(void)
+{
+    struct System *sys = NULL;
+
+    if (g_neigh_batch_depth == 0 || --g_neigh_batch_depth > 0)
+        return;
+
+    if ((sys = system_get_instance()) != NULL)
+        iccp_netlink_neighbor_batch_flush(sys);
+}
+
 int iccp_netlink_neighbor_request(int family, uint8_t *addr, int add, uint8_t *mac, char *portname, int permanent, int dir)
 {
     struct System *sys = NULL;
@@ -883,7 +1072,12 @@ int iccp_netlink_neighbor_request(int family, uint8_t *addr, int add, uint8_t *m
         rtnl_neigh_set_state(neigh, NUD_REACHABLE);
     }
 
-    if (add)
+    if (g_neigh_batch_depth > 0 && sys->neigh_batch_sock)
+    {
+        if ((err = iccp_netlink_neighbor_batch_add(sys, neigh, family, addr, add, portname, dir)) < 0)
+            ICCPD_LOG_DEBUG(__FUNCTION__, "queue neigh error, err = %d", err);
+    }
+    else if (add)
     {
         if ((err = rtnl_neigh_add(sys->route_sock, neigh, NLM_F_REPLACE | NLM_F_CREATE)) < 0)
             ICCPD_LOG_DEBUG(__FUNCTION__, "add neigh error, err = %d", err);
@@ -957,7 +1151,7 @@ void iccp_event_handler_obj_input_newlink(struct nl_object *obj, void *arg)
 
     if (lif && (lif->ifindex == -1) && (lif->type == IF_T_VLAN))
     {
-        lif->ifindex = ifindex;
+        local_if_set_ifindex(lif, ifindex);
         lif->state = (op_state == IF_OPER_UP) ? PORT_STATE_UP : PORT_STATE_DOWN;
 
         if (addr_type == AF_LLC)
@@ -1226,8 +1420,8 @@ int iccp_del_self_ip_from_neigh_table (struct LocalInterface *lif, int addr_fami
     struct System *sys = NULL;
     struct CSM *csm = NULL;
     struct Msg *msg = NULL;
-    struct ARPMsg *arp_msg = NULL, *arp_info = NULL;
-    struct NDISCMsg *ndisc_msg = NULL, *ndisc_info = NULL;
+    struct ARPMsg *arp_msg = NULL;
+    struct NDISCMsg *ndisc_msg = NULL;
     int err = 0;
 
     if (!(sys = system_get_instance()))
@@ -1239,20 +1433,11 @@ int iccp_del_self_ip_from_neigh_table (struct LocalInterface *lif, int addr_fami
 
         LIST_FOREACH(csm, &(sys->csm_list), next)
         {
-            TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
-            {
-                arp_info = (struct ARPMsg *)msg->buf;
-                if (arp_info->ipv4_addr == lif->ipv4_addr) {
-                    ICCPD_LOG_NOTICE(__FUNCTION__, " Delete ARP %s", show_ip_str(lif->ipv4_addr));
-                    break;
-                }
-            }
-
+            msg = mlacp_arp_find(csm, lif->ipv4_addr);
             if (msg)
             {
-                TAILQ_REMOVE(&(MLACP(csm).arp_list), msg, tail);
-                free(msg->buf);
-                free(msg);
+                ICCPD_LOG_NOTICE(__FUNCTION__, " Delete ARP %s", show_ip_str(lif->ipv4_addr));
+                mlacp_dequeue_arp(csm, msg);
                 msg = NULL;
                 break;
             }
@@ -1261,21 +1446,11 @@ int iccp_del_self_ip_from_neigh_table (struct LocalInterface *lif, int addr_fami
 
         LIST_FOREACH(csm, &(sys->csm_list), next)
         {
-            TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
-            {
-                ndisc_info = (struct NDISCMsg *)msg->buf;
-
-                if (memcmp(&ndisc_info->ipv6_addr, &lif->ipv6_addr, 16) == 0) {
-                    ICCPD_LOG_DEBUG(__FUNCTION__, " Delete neighbor %s", show_ipv6_str((char *)lif->ipv6_addr));
-                    break;
-                }
-            }
-
+            msg = mlacp_ndisc_find(csm, lif->ipv6_addr);
             if (msg)
             {
-                TAILQ_REMOVE(&MLACP(csm).ndisc_list, msg, tail);
-                free(msg->buf);
-                free(msg);
+                ICCPD_LOG_DEBUG(__FUNCTION__, " Delete neighbor %s", show_ipv6_str((char *)lif->ipv6_addr));
+                mlacp_dequeue_ndisc(csm, msg);
                 msg = NULL;
                 break;
             }
@@ -1688,6 +1863,26 @@ int iccp_system_init_netlink_socket()
         goto err_route_sock_connect;
     }
 
+    /* Optional: without it neighbor requests stay on route_sock, one by one */
+    sys->neigh_batch_sock = nl_socket_alloc();
+    if (sys->neigh_batch_sock)
+    {
+        val = 1;
+        if (nl_connect(sys->neigh_batch_sock, NETLINK_ROUTE) < 0
+            || nl_socket_set_buffer_size(sys->neigh_batch_sock, NETLINK_SOCKET_BUFFER_SIZE, 0) < 0)
+        {
+            ICCPD_LOG_WARN(__FUNCTION__, "Failed to set up netlink neighbor batch sock, batching disabled.");
+            nl_socket_free(sys->neigh_batch_sock);
+            sys->neigh_batch_sock = NULL;
+        }
+        else
+        {
+            /* Acks only need the header of the request */
+            setsockopt(nl_socket_get_fd(sys->neigh_batch_sock), SOL_NETLINK,
+                       NETLINK_CAP_ACK, &val, sizeof(val));
+        }
+    }
+
     sys->route_event_sock = nl_socket_alloc();
     if (!sys->route_event_sock)
         goto err_route_event_sock_alloc;
@@ -1845,6 +2040,8 @@ void iccp_system_dinit_netlink_socket()
         return;
 
     nl_socket_free(sys->route_event_sock);
+    if (sys->neigh_batch_sock)
+        nl_socket_free(sys->neigh_batch_sock);
     nl_socket_free(sys->route_sock);
     nl_socket_free(sys->genric_event_sock);
     nl_socket_free(sys->genric_sock);
@@ -2084,6 +2281,7 @@ struct iccp_eventfd
 {
     int (*get_fd)(struct System* sys);
     int (*event_handler)(struct System* sys);
+    ICCP_PERF_SRC_e perf_src;
 };
 /* endcond */
 
@@ -2091,22 +2289,27 @@ static const struct iccp_eventfd iccp_eventfds[] = {
     {
         .get_fd = iccp_get_server_sock_fd,
         .event_handler = scheduler_server_accept,
+        .perf_src = ICCP_PERF_SRC_SERVER_ACCEPT,
     },
     {
         .get_fd = iccp_get_netlink_genic_sock_event_fd,
         .event_handler = iccp_netlink_genic_sock_event_handler,
+        .perf_src = ICCP_PERF_SRC_NETLINK_GENL,
     },
     {
         .get_fd = iccp_get_netlink_route_sock_event_fd,
         .event_handler = iccp_netlink_route_sock_event_handler,
+        .perf_src = ICCP_PERF_SRC_NETLINK_ROUTE,
     },
     {
         .get_fd = iccp_get_receive_arp_packet_sock_fd,
         .event_handler = iccp_receive_arp_packet_handler,
+        .perf_src = ICCP_PERF_SRC_ARP_PKT,
      },
     {
      .get_fd = iccp_get_receive_ndisc_packet_sock_fd,
      .event_handler = iccp_receive_ndisc_packet_handler,
+     .perf_src = ICCP_PERF_SRC_NDISC_PKT,
     }
 };
 
@@ -2174,15 +2377,31 @@ int iccp_handle_events(struct System * sys)
     int i;
     int err;
     int max_nfds;
+    uint64_t start_usec;
     struct mLACPHeartbeatTLV dummy_tlv;
 
     max_nfds = ICCP_EVENT_FDS_COUNT + sys->readfd_count;
 
-    nfds = epoll_wait(sys->epoll_fd, events, max_nfds, EPOLL_TIMEOUT_MSEC);
+    /* With the scheduler timer armed, wait for an event or the next deadline */
+    nfds = epoll_wait(sys->epoll_fd, events, max_nfds,
+                      (sys->timer_fd > 0) ? -1 : EPOLL_TIMEOUT_MSEC);
 
     /* Go over list of event fds and handle them sequentially */
     for (i = 0; i < nfds; i++)
     {
+        start_usec = system_get_time_usec();
+
+        if (events[i].data.fd == sys->timer_fd)
+        {
+            scheduler_timer_handler(sys);
+            system_perf_record_src(sys, ICCP_PERF_SRC_TIMER, start_usec);
+            continue;
+        }
+
+        /* Start of the event-to-action latency for this pass */
+        if (sys->event_rx_usec == 0)
+            sys->event_rx_usec = start_usec;
+
         for (n = 0; n < ICCP_EVENT_FDS_COUNT; n++)
         {
             const struct iccp_eventfd *eventfd = &iccp_eventfds[n];
@@ -2191,6 +2410,7 @@ int iccp_handle_events(struct System * sys)
                 err = eventfd->event_handler(sys);
                 if (err)
                     ICCPD_LOG_INFO(__FUNCTION__, "Scheduler fd %d handler error %d !", events[i].data.fd, err );
+                system_perf_record_src(sys, eventfd->perf_src, start_usec);
                 break;
             }
         }
@@ -2206,18 +2426,21 @@ int iccp_handle_events(struct System * sys)
                 mclagd_ctl_interactive_process(client_fd);
                 close(client_fd);
             }
+            system_perf_record_src(sys, ICCP_PERF_SRC_MCLAGDCTL, start_usec);
             continue;
         }
 
         if (events[i].data.fd == sys->sync_fd)
         {
             iccp_mclagsyncd_msg_handler(sys);
+            system_perf_record_src(sys, ICCP_PERF_SRC_MCLAGSYNCD, start_usec);
             continue;
         }
 
         if (events[i].data.fd == sys->sig_pipe_r)
         {
             iccp_receive_signal_handler(sys);
+            system_perf_record_src(sys, ICCP_PERF_SRC_SIGNAL, start_usec);
 
             continue;
         }
@@ -2233,6 +2456,7 @@ int iccp_handle_events(struct System * sys)
                         //consider any msg from peer as heartbeat update, this will be in scenarios of scaled msg sync b/w peers
                         mlacp_fsm_update_heartbeat(csm, &dummy_tlv);
                     }
+                    system_perf_record_src(sys, ICCP_PERF_SRC_PEER_RX, start_usec);
                     break;
                 }
             }
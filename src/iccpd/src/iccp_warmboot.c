@@ -0,0 +1,622 @@
+/*
+ * iccp_warmboot.c
+ *
+ * Copyright(c) 2016-2019 Nephos/Estinet.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * The full GNU General Public License is included in this distribution in
+ * the file called "COPYING".
+ *
+ *  Maintainer: jianjun, grace Li from nephos
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "../include/system.h"
+#include "../include/logger.h"
+#include "../include/iccp_csm.h"
+#include "../include/mlacp_tlv.h"
+#include "../include/mlacp_link_handler.h"
+#include "../include/mlacp_sync_update.h"
+#include "../include/iccp_netlink.h"
+#include "../include/iccp_ifm.h"
+#include "../include/iccp_warmboot.h"
+
+/* Snapshot mapped at start up, kept until every CSM section is restored
+ * or the restore deadline passes */
+static uint8_t *g_warmboot_map = NULL;
+static size_t g_warmboot_map_len = 0;
+static uint32_t g_warmboot_pending = 0;
+static time_t g_warmboot_deadline = 0;
+
+static size_t iccp_warmboot_csm_len(const struct iccp_warmboot_csm_hdr *csm_hdr)
+{
+    return sizeof(struct iccp_warmboot_csm_hdr)
+           + (size_t)csm_hdr->mac_count * sizeof(struct iccp_warmboot_mac_rec)
+           + (size_t)csm_hdr->arp_count * sizeof(struct ARPMsg)
+           + (size_t)csm_hdr->ndisc_count * sizeof(struct NDISCMsg);
+}
+
+static int iccp_warmboot_write(FILE *fp, const void *data, size_t len)
+{
+    if (fwrite(data, len, 1, fp) != 1)
+        return MCLAG_ERROR;
+
+    return 0;
+}
+
+static int iccp_warmboot_write_csm(FILE *fp, struct CSM *csm, uint64_t *total_len)
+{
+    struct iccp_warmboot_csm_hdr csm_hdr;
+    struct iccp_warmboot_mac_rec mac_rec;
+    struct MACMsg *mac_msg = NULL;
+    struct Msg *msg = NULL;
+
+    memset(&csm_hdr, 0, sizeof(csm_hdr));
+    csm_hdr.mlag_id = csm->mlag_id;
+
+    RB_FOREACH(mac_msg, mac_rb_tree, &MLACP(csm).mac_rb)
+        csm_hdr.mac_count++;
+    TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+        csm_hdr.arp_count++;
+    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+        csm_hdr.ndisc_count++;
+
+    if (iccp_warmboot_write(fp, &csm_hdr, sizeof(csm_hdr)) < 0)
+        return MCLAG_ERROR;
+
+    RB_FOREACH(mac_msg, mac_rb_tree, &MLACP(csm).mac_rb)
+    {
+        memset(&mac_rec, 0, sizeof(mac_rec));
+        mac_rec.vid = mac_msg->vid;
+        memcpy(mac_rec.mac_addr, mac_msg->mac_addr, ETHER_ADDR_LEN);
+        mac_rec.fdb_type = mac_msg->fdb_type;
+        mac_rec.age_flag = mac_msg->age_flag;
+        mac_rec.pending_local_del = mac_msg->pending_local_del;
+        mac_rec.add_to_syncd = mac_msg->add_to_syncd;
+        memcpy(mac_rec.ifname, mac_msg->ifname, MAX_L_PORT_NAME);
+        memcpy(mac_rec.origin_ifname, mac_msg->origin_ifname, MAX_L_PORT_NAME);
+
+        if (iccp_warmboot_write(fp, &mac_rec, sizeof(mac_rec)) < 0)
+            return MCLAG_ERROR;
+    }
+
+    TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+    {
+        if (iccp_warmboot_write(fp, msg->buf, sizeof(struct ARPMsg)) < 0)
+            return MCLAG_ERROR;
+    }
+
+    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+    {
+        if (iccp_warmboot_write(fp, msg->buf, sizeof(struct NDISCMsg)) < 0)
+            return MCLAG_ERROR;
+    }
+
+    *total_len += iccp_warmboot_csm_len(&csm_hdr);
+
+    ICCPD_LOG_NOTICE(__FUNCTION__, "Snapshot mlag-id %d: %u MAC, %u ARP, %u ND",
+        csm->mlag_id, csm_hdr.mac_count, csm_hdr.arp_count, csm_hdr.ndisc_count);
+
+    return 0;
+}
+
+/*****************************************
+* Save MAC/ARP/ND state on warm reboot exit
+*
+* ***************************************/
+int iccp_warmboot_snapshot_save(void)
+{
+    struct System *sys = NULL;
+    struct CSM *csm = NULL;
+    struct iccp_warmboot_hdr hdr;
+    char tmp_file[PATH_MAX];
+    char dir[PATH_MAX];
+    char *slash = NULL;
+    FILE *fp = NULL;
+    uint64_t start_usec;
+    int ret = 0;
+
+    if ((sys = system_get_instance()) == NULL || !sys->warmboot_file_path)
+        return MCLAG_ERROR;
+
+    start_usec = system_get_time_usec();
+
+    snprintf(tmp_file, sizeof(tmp_file), "%s.tmp", sys->warmboot_file_path);
+    snprintf(dir, sizeof(dir), "%s", sys->warmboot_file_path);
+    if ((slash = strrchr(dir, '/')) != NULL && slash != dir)
+    {
+        *slash = '\0';
+        if (mkdir(dir, 0755) < 0 && errno != EEXIST)
+        {
+            ICCPD_LOG_ERR(__FUNCTION__, "Create %s fail, errno %d", dir, errno);
+            return MCLAG_ERROR;
+        }
+    }
+
+    fp = fopen(tmp_file, "w");
+    if (!fp)
+    {
+        ICCPD_LOG_ERR(__FUNCTION__, "Open %s fail, errno %d", tmp_file, errno);
+        return MCLAG_ERROR;
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = ICCP_WARMBOOT_SNAPSHOT_MAGIC;
+    hdr.version = ICCP_WARMBOOT_SNAPSHOT_VERSION;
+    hdr.hdr_len = sizeof(struct iccp_warmboot_hdr);
+    hdr.csm_hdr_len = sizeof(struct iccp_warmboot_csm_hdr);
+    hdr.mac_rec_len = sizeof(struct iccp_warmboot_mac_rec);
+    hdr.arp_rec_len = sizeof(struct ARPMsg);
+    hdr.ndisc_rec_len = sizeof(struct NDISCMsg);
+    hdr.total_len = sizeof(struct iccp_warmboot_hdr);
+    hdr.save_time = time(NULL);
+
+    /* Header is rewritten with the final counts once all sections are out */
+    ret = iccp_warmboot_write(fp, &hdr, sizeof(hdr));
+
+    LIST_FOREACH(csm, &(sys->csm_list), next)
+    {
+        if (ret < 0)
+            break;
+
+        ret = iccp_warmboot_write_csm(fp, csm, &hdr.total_len);
+        hdr.csm_count++;
+    }
+
+    if (ret == 0 && fseek(fp, 0, SEEK_SET) == 0)
+        ret = iccp_warmboot_write(fp, &hdr, sizeof(hdr));
+    else
+        ret = MCLAG_ERROR;
+
+    if (ret == 0 && (fflush(fp) != 0 || fsync(fileno(fp)) < 0))
+        ret = MCLAG_ERROR;
+
+    if (fclose(fp) != 0)
+        ret = MCLAG_ERROR;
+
+    if (ret == 0 && rename(tmp_file, sys->warmboot_file_path) < 0)
+        ret = MCLAG_ERROR;
+
+    if (ret < 0)
+    {
+        ICCPD_LOG_ERR(__FUNCTION__, "Write snapshot fail, errno %d", errno);
+        unlink(tmp_file);
+        return MCLAG_ERROR;
+    }
+
+    ICCPD_LOG_NOTICE(__FUNCTION__, "Snapshot saved: %u mlag, %lu bytes in %lu us",
+        hdr.csm_count, hdr.total_len, system_get_time_usec() - start_usec);
+
+    return 0;
+}
+
+static int iccp_warmboot_snapshot_validate(const uint8_t *base, size_t len)
+{
+    const struct iccp_warmboot_hdr *hdr = (const struct iccp_warmboot_hdr *)base;
+    const struct iccp_warmboot_csm_hdr *csm_hdr = NULL;
+    size_t off;
+    uint32_t i;
+
+    if (len < sizeof(struct iccp_warmboot_hdr))
+        return MCLAG_ERROR;
+
+    if (hdr->magic != ICCP_WARMBOOT_SNAPSHOT_MAGIC
+        || hdr->version != ICCP_WARMBOOT_SNAPSHOT_VERSION
+        || hdr->hdr_len != sizeof(struct iccp_warmboot_hdr)
+        || hdr->csm_hdr_len != sizeof(struct iccp_warmboot_csm_hdr)
+        || hdr->mac_rec_len != sizeof(struct iccp_warmboot_mac_rec)
+        || hdr->arp_rec_len != sizeof(struct ARPMsg)
+        || hdr->ndisc_rec_len != sizeof(struct NDISCMsg)
+        || hdr->total_len != len)
+        return MCLAG_ERROR;
+
+    off = hdr->hdr_len;
+    for (i = 0; i < hdr->csm_count; i++)
+    {
+        if (len - off < sizeof(struct iccp_warmboot_csm_hdr))
+            return MCLAG_ERROR;
+
+        csm_hdr = (const struct iccp_warmboot_csm_hdr *)(base + off);
+        if (len - off < iccp_warmboot_csm_len(csm_hdr))
+            return MCLAG_ERROR;
+
+        off += iccp_warmboot_csm_len(csm_hdr);
+    }
+
+    return (off == len) ? 0 : MCLAG_ERROR;
+}
+
+/*****************************************
+* Map the snapshot on warm reboot start
+*
+* ***************************************/
+int iccp_warmboot_snapshot_load(void)
+{
+    struct System *sys = NULL;
+    const char *file = NULL;
+    struct stat st;
+    void *map = NULL;
+    int fd;
+
+    if ((sys = system_get_instance()) == NULL || !sys->warmboot_file_path)
+        return MCLAG_ERROR;
+
+    file = sys->warmboot_file_path;
+    fd = open(file, O_RDONLY);
+    if (fd < 0)
+    {
+        ICCPD_LOG_NOTICE(__FUNCTION__, "No snapshot %s, start without saved state", file);
+        return MCLAG_ERROR;
+    }
+
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(struct iccp_warmboot_hdr))
+    {
+        close(fd);
+        unlink(file);
+        ICCPD_LOG_WARN(__FUNCTION__, "Snapshot %s truncated, ignored", file);
+        return MCLAG_ERROR;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    /* The mapping outlives the name, never replay it on a later boot */
+    unlink(file);
+
+    if (map == MAP_FAILED)
+    {
+        ICCPD_LOG_WARN(__FUNCTION__, "Map snapshot fail, errno %d", errno);
+        return MCLAG_ERROR;
+    }
+
+    if (iccp_warmboot_snapshot_validate(map, st.st_size) < 0)
+    {
+        munmap(map, st.st_size);
+        ICCPD_LOG_WARN(__FUNCTION__, "Snapshot %s invalid or from another version, ignored", file);
+        return MCLAG_ERROR;
+    }
+
+    g_warmboot_map = map;
+    g_warmboot_map_len = st.st_size;
+    g_warmboot_pending = ((struct iccp_warmboot_hdr *)map)->csm_count;
+    g_warmboot_deadline = time(NULL) + ICCP_WARMBOOT_RESTORE_SEC;
+
+    ICCPD_LOG_NOTICE(__FUNCTION__, "Snapshot loaded: %u mlag, %zu bytes",
+        g_warmboot_pending, g_warmboot_map_len);
+
+    if (g_warmboot_pending == 0)
+        iccp_warmboot_snapshot_release();
+
+    return 0;
+}
+
+void iccp_warmboot_snapshot_release(void)
+{
+    if (!g_warmboot_map)
+        return;
+
+    munmap(g_warmboot_map, g_warmboot_map_len);
+    g_warmboot_map = NULL;
+    g_warmboot_map_len = 0;
+    g_warmboot_pending = 0;
+    g_warmboot_deadline = 0;
+
+    return;
+}
+
+/* Drop sections for mlag-ids that never got configured */
+void iccp_warmboot_snapshot_expire(void)
+{
+    if (!g_warmboot_map || time(NULL) < g_warmboot_deadline)
+        return;
+
+    ICCPD_LOG_NOTICE(__FUNCTION__, "Restore deadline passed, %u snapshot section(s) unclaimed",
+        g_warmboot_pending);
+
+    iccp_warmboot_snapshot_release();
+
+    return;
+}
+
+static const struct iccp_warmboot_csm_hdr *iccp_warmboot_snapshot_find(int mlag_id)
+{
+    const struct iccp_warmboot_hdr *hdr = (const struct iccp_warmboot_hdr *)g_warmboot_map;
+    const struct iccp_warmboot_csm_hdr *csm_hdr = NULL;
+    size_t off;
+    uint32_t i;
+
+    off = hdr->hdr_len;
+    for (i = 0; i < hdr->csm_count; i++)
+    {
+        csm_hdr = (const struct iccp_warmboot_csm_hdr *)(g_warmboot_map + off);
+        if (csm_hdr->mlag_id == mlag_id)
+            return csm_hdr;
+
+        off += iccp_warmboot_csm_len(csm_hdr);
+    }
+
+    return NULL;
+}
+
+/*****************************************
+* Rehydrate a CSM once its mlag-id is set
+*
+* Restored MACs and ARP/ND entries are marked stale and are not
+* programmed again, the hardware and the restored kernel tables keep
+* them across warm reboot. mclagsyncd, the kernel and the peer clear
+* the mark as they re-report entries, whatever is left at the
+* reconcile deadline is purged.
+* ***************************************/
+void iccp_warmboot_snapshot_restore(struct CSM *csm)
+{
+    struct System *sys = NULL;
+    const struct iccp_warmboot_csm_hdr *csm_hdr = NULL;
+    const struct iccp_warmboot_mac_rec *mac_rec = NULL;
+    const struct ARPMsg *arp_rec = NULL;
+    const struct NDISCMsg *ndisc_rec = NULL;
+    struct MACMsg mac_buf, *mac_msg = NULL;
+    struct Msg *msg = NULL;
+    uint32_t i, mac_num = 0, neigh_num = 0;
+    uint64_t start_usec;
+
+    if (!csm || !g_warmboot_map || MLACP(csm).warm_restored)
+        return;
+
+    if ((sys = system_get_instance()) == NULL)
+        return;
+
+    if ((csm_hdr = iccp_warmboot_snapshot_find(csm->mlag_id)) == NULL)
+        return;
+
+    start_usec = system_get_time_usec();
+
+    mac_rec = (const struct iccp_warmboot_mac_rec *)(csm_hdr + 1);
+    for (i = 0; i < csm_hdr->mac_count; i++, mac_rec++)
+    {
+        memset(&mac_buf, 0, sizeof(struct MACMsg));
+        mac_buf.vid = mac_rec->vid;
+        memcpy(mac_buf.mac_addr, mac_rec->mac_addr, ETHER_ADDR_LEN);
+
+        if (RB_FIND(mac_rb_tree, &MLACP(csm).mac_rb, &mac_buf))
+            continue;
+
+        mac_buf.op_type = MAC_SYNC_ADD;
+        mac_buf.fdb_type = mac_rec->fdb_type;
+        mac_buf.age_flag = mac_rec->age_flag;
+        mac_buf.pending_local_del = mac_rec->pending_local_del;
+        mac_buf.add_to_syncd = mac_rec->add_to_syncd;
+        mac_buf.warm_stale = 1;
+        memcpy(mac_buf.ifname, mac_rec->ifname, MAX_L_PORT_NAME);
+        memcpy(mac_buf.origin_ifname, mac_rec->origin_ifname, MAX_L_PORT_NAME);
+        mac_buf.ifname[MAX_L_PORT_NAME - 1] = '\0';
+        mac_buf.origin_ifname[MAX_L_PORT_NAME - 1] = '\0';
+
+        if (iccp_csm_init_mac_msg(&mac_msg, (char*)&mac_buf, sizeof(struct MACMsg)) == 0)
+        {
+            RB_INSERT(mac_rb_tree, &MLACP(csm).mac_rb, mac_msg);
+            mac_num++;
+        }
+    }
+
+    arp_rec = (const struct ARPMsg *)mac_rec;
+    for (i = 0; i < csm_hdr->arp_count; i++, arp_rec++)
+    {
+        if (mlacp_arp_find(csm, arp_rec->ipv4_addr))
+            continue;
+
+        if (iccp_csm_init_msg(&msg, (char*)arp_rec, sizeof(struct ARPMsg)) == 0)
+        {
+            msg->warm_stale = 1;
+            mlacp_enqueue_arp(csm, msg);
+            neigh_num++;
+        }
+    }
+
+    ndisc_rec = (const struct NDISCMsg *)arp_rec;
+    for (i = 0; i < csm_hdr->ndisc_count; i++, ndisc_rec++)
+    {
+        if (mlacp_ndisc_find(csm, (uint32_t *)ndisc_rec->ipv6_addr))
+            continue;
+
+        if (iccp_csm_init_msg(&msg, (char*)ndisc_rec, sizeof(struct NDISCMsg)) == 0)
+        {
+            msg->warm_stale = 1;
+            mlacp_enqueue_ndisc(csm, msg);
+            neigh_num++;
+        }
+    }
+
+    MLACP(csm).warm_restored = 1;
+    sys->dbg_counters.warm_restore_mac_counter += mac_num;
+    sys->dbg_counters.warm_restore_neigh_counter += neigh_num;
+
+    ICCPD_LOG_NOTICE(__FUNCTION__, "Restore mlag-id %d: %u MAC, %u ARP/ND in %lu us",
+        csm->mlag_id, mac_num, neigh_num, system_get_time_usec() - start_usec);
+
+    if (--g_warmboot_pending == 0)
+        iccp_warmboot_snapshot_release();
+
+    return;
+}
+
+/* A stale local entry was not re-learned from the kernel, so the peer
+ * is told it is gone; a stale remote entry was installed for the peer,
+ * which did not sync it again, so it comes out of the kernel.
+ */
+static void iccp_warmboot_purge_neigh(struct CSM *csm, int family, void *neigh, uint8_t *addr,
+                                      uint8_t *mac_addr, char *ifname, uint8_t learn_flag)
+{
+    struct Msg *msg_send = NULL;
+    int len = (family == AF_INET) ? sizeof(struct ARPMsg) : sizeof(struct NDISCMsg);
+
+    if (learn_flag == NEIGH_REMOTE)
+    {
+        iccp_netlink_neighbor_request(family, addr, 0, mac_addr, ifname, 0, 12);
+        return;
+    }
+
+    if (MLACP(csm).current_state != MLACP_STATE_EXCHANGE)
+        return;
+
+    if (family == AF_INET)
+    {
+        ((struct ARPMsg *)neigh)->op_type = NEIGH_SYNC_DEL;
+        ((struct ARPMsg *)neigh)->flag = 0;
+    }
+    else
+    {
+        ((struct NDISCMsg *)neigh)->op_type = NEIGH_SYNC_DEL;
+        ((struct NDISCMsg *)neigh)->flag = 0;
+    }
+
+    if (iccp_csm_init_msg(&msg_send, (char *)neigh, len) == 0)
+    {
+        if (family == AF_INET)
+            TAILQ_INSERT_TAIL(&(MLACP(csm).arp_msg_list), msg_send, tail);
+        else
+            TAILQ_INSERT_TAIL(&(MLACP(csm).ndisc_msg_list), msg_send, tail);
+    }
+
+    return;
+}
+
+static uint32_t iccp_warmboot_reconcile_neigh(struct CSM *csm)
+{
+    struct Msg *msg = NULL, *msg_next = NULL;
+    struct ARPMsg arp_buf;
+    struct NDISCMsg ndisc_buf;
+    uint32_t purge_num = 0;
+    int stale = 0;
+
+    TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+        stale |= msg->warm_stale;
+    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+        stale |= msg->warm_stale;
+
+    if (!stale)
+        return 0;
+
+    /* Local entries learned before the mlag-id was configured never got
+     * matched against the kernel, dump it once more so they are */
+    iccp_neigh_get_init();
+
+    /* Kernel deletes for the whole purge go out in one netlink send */
+    iccp_netlink_neighbor_batch_begin();
+
+    for (msg = TAILQ_FIRST(&MLACP(csm).arp_list); msg; msg = msg_next)
+    {
+        msg_next = TAILQ_NEXT(msg, tail);
+        if (!msg->warm_stale)
+            continue;
+
+        memcpy(&arp_buf, msg->buf, sizeof(struct ARPMsg));
+        mlacp_dequeue_arp(csm, msg);
+
+        ICCPD_LOG_DEBUG(__FUNCTION__, "Warm reconcile, del stale ARP %s interface %s",
+            show_ip_str(arp_buf.ipv4_addr), arp_buf.ifname);
+
+        iccp_warmboot_purge_neigh(csm, AF_INET, &arp_buf, (uint8_t *)&arp_buf.ipv4_addr,
+            arp_buf.mac_addr, arp_buf.ifname, arp_buf.learn_flag);
+        purge_num++;
+    }
+
+    for (msg = TAILQ_FIRST(&MLACP(csm).ndisc_list); msg; msg = msg_next)
+    {
+        msg_next = TAILQ_NEXT(msg, tail);
+        if (!msg->warm_stale)
+            continue;
+
+        memcpy(&ndisc_buf, msg->buf, sizeof(struct NDISCMsg));
+        mlacp_dequeue_ndisc(csm, msg);
+
+        ICCPD_LOG_DEBUG(__FUNCTION__, "Warm reconcile, del stale ND %s interface %s",
+            show_ipv6_str((char *)ndisc_buf.ipv6_addr), ndisc_buf.ifname);
+
+        iccp_warmboot_purge_neigh(csm, AF_INET6, &ndisc_buf, (uint8_t *)ndisc_buf.ipv6_addr,
+            ndisc_buf.mac_addr, ndisc_buf.ifname, ndisc_buf.learn_flag);
+        purge_num++;
+    }
+
+    iccp_netlink_neighbor_batch_end();
+
+    return purge_num;
+}
+
+/*****************************************
+* Purge restored MACs and ARP/ND entries nobody re-reported
+*
+* ***************************************/
+void iccp_warmboot_reconcile(struct CSM *csm)
+{
+    struct System *sys = NULL;
+    struct MACMsg *mac_msg = NULL, *mac_temp = NULL;
+    uint32_t purge_num = 0, neigh_num = 0;
+
+    if (!csm || MLACP(csm).warm_reconcile_time == 0)
+        return;
+
+    if (time(NULL) < MLACP(csm).warm_reconcile_time)
+        return;
+
+    if ((sys = system_get_instance()) == NULL)
+        return;
+
+    RB_FOREACH_SAFE(mac_msg, mac_rb_tree, &MLACP(csm).mac_rb, mac_temp)
+    {
+        if (!mac_msg->warm_stale)
+            continue;
+
+        ICCPD_LOG_DEBUG("ICCP_FDB", "Warm reconcile, del stale MAC %s vlan-id %d interface %s",
+            mac_addr_to_str(mac_msg->mac_addr), mac_msg->vid, mac_msg->ifname);
+
+        /*Local entry, tell the peer it is gone*/
+        mac_msg->age_flag = set_mac_local_age_flag(csm, mac_msg, 1, 1);
+        mac_msg->age_flag |= MAC_AGE_PEER;
+
+        del_mac_from_chip(mac_msg);
+
+        MAC_RB_REMOVE(mac_rb_tree, &MLACP(csm).mac_rb, mac_msg);
+        // free only if not in change list to be send to peer node,
+        // else free is taken care after sending the update to peer
+        if (!MAC_IN_MSG_LIST(&(MLACP(csm).mac_msg_list), mac_msg, tail))
+        {
+            free(mac_msg);
+        }
+        purge_num++;
+    }
+
+    neigh_num = iccp_warmboot_reconcile_neigh(csm);
+
+    MLACP(csm).warm_reconcile_time = 0;
+    MLACP(csm).warm_restored = 0;
+    sys->dbg_counters.warm_purge_mac_counter += purge_num;
+    sys->dbg_counters.warm_purge_neigh_counter += neigh_num;
+
+    ICCPD_LOG_NOTICE(__FUNCTION__, "Warm reconcile mlag-id %d done, %u stale MAC, %u stale ARP/ND purged",
+        csm->mlag_id, purge_num, neigh_num);
+
+    return;
+}
@@ -36,6 +36,7 @@
 #include "../../include/system.h"
 
 static int mclagdctl_sock_fd = -1;
+static int mclagdctl_json = 0;
 char *mclagdctl_sock_path = "/var/run/iccpd/mclagdctl.sock";
 
 /*
@@ -44,6 +45,9 @@ char *mclagdctl_sock_path = "/var/run/iccpd/mclagdctl.sock";
    mclagdctl -i dump arp
    mclagdctl -i dump nd
    mclagdctl -i dump mac
+   mclagdctl -i -j dump arp|nd|mac (JSON lines)
+   mclagdctl dump perf
+   mclagdctl clear perf
    mclagdctl -i dump unique_ip
    mclagdctl -i dump portlist local
    mclagdctl -i dump portlist peer
@@ -84,6 +88,8 @@ static struct command_type command_types[] =
         .name = "arp",
         .enca_msg = mclagdctl_enca_dump_arp,
         .parse_msg = mclagdctl_parse_dump_arp,
+        .page_info_type = INFO_TYPE_DUMP_ARP_PAGE,
+        .parse_page = mclagdctl_parse_page_arp,
     },
     {
          .id = ID_CMDTYPE_D_A,
@@ -92,6 +98,8 @@ static struct command_type command_types[] =
          .name = "nd",
          .enca_msg = mclagdctl_enca_dump_ndisc,
          .parse_msg = mclagdctl_parse_dump_ndisc,
+         .page_info_type = INFO_TYPE_DUMP_NDISC_PAGE,
+         .parse_page = mclagdctl_parse_page_ndisc,
      },
     {
         .id = ID_CMDTYPE_D_A,
@@ -100,6 +108,8 @@ static struct command_type command_types[] =
         .name = "mac",
         .enca_msg = mclagdctl_enca_dump_mac,
         .parse_msg = mclagdctl_parse_dump_mac,
+        .page_info_type = INFO_TYPE_DUMP_MAC_PAGE,
+        .parse_page = mclagdctl_parse_page_mac,
     },
     {
         .id = ID_CMDTYPE_D_A,
@@ -143,6 +153,14 @@ static struct command_type command_types[] =
         .enca_msg = mclagdctl_enca_dump_dbg_counters,
         .parse_msg = mclagdctl_parse_dump_dbg_counters,
     },
+    {
+        .id = ID_CMDTYPE_D_PF,
+        .parent_id = ID_CMDTYPE_D,
+        .info_type = INFO_TYPE_DUMP_PERF,
+        .name = "perf",
+        .enca_msg = mclagdctl_enca_dump_perf,
+        .parse_msg = mclagdctl_parse_dump_perf,
+    },
     {
         .id = ID_CMDTYPE_C,
         .name = "config",
@@ -157,6 +175,20 @@ static struct command_type command_types[] =
         .enca_msg = mclagdctl_enca_config_loglevel,
         .parse_msg = mclagdctl_parse_config_loglevel,
     },
+    {
+        .id = ID_CMDTYPE_CL,
+        .name = "clear",
+        .enca_msg = NULL,
+        .parse_msg = NULL,
+    },
+    {
+        .id = ID_CMDTYPE_CL_P,
+        .parent_id = ID_CMDTYPE_CL,
+        .info_type = INFO_TYPE_CLEAR_PERF,
+        .name = "perf",
+        .enca_msg = mclagdctl_enca_clear_perf,
+        .parse_msg = mclagdctl_parse_clear_perf,
+    },
 };
 
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
@@ -369,85 +401,166 @@ int mclagdctl_enca_dump_ndisc(char *msg, int mclag_id, int argc, char **argv)
     return 1;
 }
 
-int mclagdctl_parse_dump_arp(char *msg, int data_len)
+static char mclagdctl_neigh_flag(uint8_t learn_flag)
 {
-    struct mclagd_arp_msg * arp_info = NULL;
-    int len = 0;
-    int count = 0;
+    if (learn_flag == NEIGH_REMOTE)
+        return 'R';
+    else if (learn_flag == NEIGH_LOCAL)
+        return 'L';
+
+    return '-';
+}
+
+/* Print ,"name":"str" (no comma when first), escaped as JSON requires.
+ * Names come from the peer and the kernel, so they are not trusted.
+ */
+static void mclagdctl_json_put_str(const char *name, const char *str, size_t max, int first)
+{
+    size_t i, len = strnlen(str, max);
+    unsigned char c;
+
+    fprintf(stdout, "%s\"%s\":\"", first ? "" : ",", name);
+    for (i = 0; i < len; i++)
+    {
+        c = (unsigned char)str[i];
+        if (c == '"' || c == '\\')
+            fprintf(stdout, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(stdout, "\\u%04x", c);
+        else
+            fputc(c, stdout);
+    }
+    fputc('"', stdout);
+}
 
+static void mclagdctl_print_arp_title(void)
+{
     fprintf(stdout, "%-6s", "No.");
     fprintf(stdout, "%-20s", "IP");
     fprintf(stdout, "%-20s", "MAC");
     fprintf(stdout, "%-20s", "DEV");
     fprintf(stdout, "%s", "Flag");
     fprintf(stdout, "\n");
+}
+
+static void mclagdctl_print_arp(struct mclagd_arp_msg *arp_info, int no)
+{
+    if (mclagdctl_json)
+    {
+        fputc('{', stdout);
+        mclagdctl_json_put_str("ip", arp_info->ipv4_addr, sizeof(arp_info->ipv4_addr), 1);
+        fprintf(stdout, ",\"mac\":\"%s\"", mac_addr_to_str(arp_info->mac_addr));
+        mclagdctl_json_put_str("dev", arp_info->ifname, sizeof(arp_info->ifname), 0);
+        fprintf(stdout, ",\"flag\":\"%c\"}\n", mclagdctl_neigh_flag(arp_info->learn_flag));
+        return;
+    }
+
+    fprintf(stdout, "%-6d", no);
+    fprintf(stdout, "%-20s", arp_info->ipv4_addr);
+    fprintf(stdout, "%s", mac_addr_to_str(arp_info->mac_addr));
+    fprintf(stdout, "   ");
+    fprintf(stdout, "%-20s", arp_info->ifname);
+    fprintf(stdout, "%c", mclagdctl_neigh_flag(arp_info->learn_flag));
+    fprintf(stdout, "\n");
+}
+
+int mclagdctl_parse_dump_arp(char *msg, int data_len)
+{
+    struct mclagd_arp_msg * arp_info = NULL;
+    int len = 0;
+    int count = 0;
+
+    if (!mclagdctl_json)
+        mclagdctl_print_arp_title();
 
     len = sizeof(struct mclagd_arp_msg);
 
     for (; data_len >= len; data_len -= len, count++)
     {
         arp_info = (struct mclagd_arp_msg*)(msg + len * count);
-
-        fprintf(stdout, "%-6d", count + 1);
-        fprintf(stdout, "%-20s", arp_info->ipv4_addr);
-        fprintf(stdout, "%02x:%02x:%02x:%02x:%02x:%02x",
-                arp_info->mac_addr[0], arp_info->mac_addr[1],
-                arp_info->mac_addr[2], arp_info->mac_addr[3],
-                arp_info->mac_addr[4], arp_info->mac_addr[5]);
-        fprintf(stdout, "   ");
-        fprintf(stdout, "%-20s", arp_info->ifname);
-        if (arp_info->learn_flag == NEIGH_REMOTE) {
-            fprintf(stdout, "%s", "R");
-        } else if (arp_info->learn_flag == NEIGH_LOCAL) {
-            fprintf(stdout, "%s", "L");
-        } else {
-            fprintf(stdout, "%s", "-");
-        }
-        fprintf(stdout, "\n");
+        mclagdctl_print_arp(arp_info, count + 1);
     }
 
     return 0;
 }
 
-int mclagdctl_parse_dump_ndisc(char *msg, int data_len)
+int mclagdctl_parse_page_arp(char *msg, int count, int base)
 {
-    struct mclagd_ndisc_msg *ndisc_info = NULL;
-    int len = 0;
-    int count = 0;
+    int i;
+
+    if (base == 0 && !mclagdctl_json)
+        mclagdctl_print_arp_title();
 
+    for (i = 0; i < count; i++)
+        mclagdctl_print_arp((struct mclagd_arp_msg *)msg + i, base + i + 1);
+
+    return 0;
+}
+
+static void mclagdctl_print_ndisc_title(void)
+{
     fprintf(stdout, "%-6s", "No.");
     fprintf(stdout, "%-52s", "IPv6");
     fprintf(stdout, "%-20s", "MAC");
     fprintf(stdout, "%-20s", "DEV");
     fprintf(stdout, "%s", "Flag");
     fprintf(stdout, "\n");
+}
+
+static void mclagdctl_print_ndisc(struct mclagd_ndisc_msg *ndisc_info, int no)
+{
+    if (mclagdctl_json)
+    {
+        fputc('{', stdout);
+        mclagdctl_json_put_str("ip", ndisc_info->ipv6_addr, sizeof(ndisc_info->ipv6_addr), 1);
+        fprintf(stdout, ",\"mac\":\"%s\"", mac_addr_to_str(ndisc_info->mac_addr));
+        mclagdctl_json_put_str("dev", ndisc_info->ifname, sizeof(ndisc_info->ifname), 0);
+        fprintf(stdout, ",\"flag\":\"%c\"}\n", mclagdctl_neigh_flag(ndisc_info->learn_flag));
+        return;
+    }
+
+    fprintf(stdout, "%-6d", no);
+    fprintf(stdout, "%-52s", ndisc_info->ipv6_addr);
+    fprintf(stdout, "%s", mac_addr_to_str(ndisc_info->mac_addr));
+    fprintf(stdout, "   ");
+    fprintf(stdout, "%-20s", ndisc_info->ifname);
+    fprintf(stdout, "%c", mclagdctl_neigh_flag(ndisc_info->learn_flag));
+    fprintf(stdout, "\n");
+}
+
+int mclagdctl_parse_dump_ndisc(char *msg, int data_len)
+{
+    struct mclagd_ndisc_msg *ndisc_info = NULL;
+    int len = 0;
+    int count = 0;
+
+    if (!mclagdctl_json)
+        mclagdctl_print_ndisc_title();
 
     len = sizeof(struct mclagd_ndisc_msg);
 
     for (; data_len >= len; data_len -= len, count++)
     {
         ndisc_info = (struct mclagd_ndisc_msg *)(msg + len * count);
-
-        fprintf(stdout, "%-6d", count + 1);
-        fprintf(stdout, "%-52s", ndisc_info->ipv6_addr);
-        fprintf(stdout, "%02x:%02x:%02x:%02x:%02x:%02x",
-                ndisc_info->mac_addr[0], ndisc_info->mac_addr[1],
-                ndisc_info->mac_addr[2], ndisc_info->mac_addr[3], ndisc_info->mac_addr[4], ndisc_info->mac_addr[5]);
-        fprintf(stdout, "   ");
-        fprintf(stdout, "%-20s", ndisc_info->ifname);
-        if (ndisc_info->learn_flag == NEIGH_REMOTE) {
-            fprintf(stdout, "%s", "R");
-        } else if (ndisc_info->learn_flag == NEIGH_LOCAL) {
-            fprintf(stdout, "%s", "L");
-        } else {
-            fprintf(stdout, "%s", "-");
-        }
-        fprintf(stdout, "\n");
+        mclagdctl_print_ndisc(ndisc_info, count + 1);
     }
 
     return 0;
 }
 
+int mclagdctl_parse_page_ndisc(char *msg, int count, int base)
+{
+    int i;
+
+    if (base == 0 && !mclagdctl_json)
+        mclagdctl_print_ndisc_title();
+
+    for (i = 0; i < count; i++)
+        mclagdctl_print_ndisc((struct mclagd_ndisc_msg *)msg + i, base + i + 1);
+
+    return 0;
+}
+
 int mclagdctl_enca_dump_mac(char *msg, int mclag_id, int argc, char **argv)
 {
     struct mclagdctl_req_hdr req;
@@ -466,12 +579,8 @@ int mclagdctl_enca_dump_mac(char *msg, int mclag_id, int argc, char **argv)
     return 1;
 }
 
-int mclagdctl_parse_dump_mac(char *msg, int data_len)
+static void mclagdctl_print_mac_title(void)
 {
-    struct mclagd_mac_msg * mac_info = NULL;
-    int len = 0;
-    int count = 0;
-
     fprintf(stdout, "%-60s\n", "TYPE: S-STATIC, D-DYNAMIC; AGE: L-Local age, P-Peer age");
 
     fprintf(stdout, "%-6s", "No.");
@@ -482,36 +591,77 @@ int mclagdctl_parse_dump_mac(char *msg, int data_len)
     fprintf(stdout, "%-20s", "ORIGIN-DEV");
     fprintf(stdout, "%-5s", "AGE");
     fprintf(stdout, "\n");
+}
+
+static void mclagdctl_print_mac(struct mclagd_mac_msg *mac_info, int no)
+{
+    const char *age;
+
+    if ((mac_info->age_flag & MAC_AGE_LOCAL_CTL) && (mac_info->age_flag & MAC_AGE_PEER_CTL))
+        age = "LP";
+    else if (mac_info->age_flag & MAC_AGE_LOCAL_CTL)
+        age = "L";
+    else if (mac_info->age_flag & MAC_AGE_PEER_CTL)
+        age = "P";
+    else
+        age = mclagdctl_json ? "" : " ";
+
+    if (mclagdctl_json)
+    {
+        fprintf(stdout, "{\"type\":\"%s\",\"mac\":\"%s\",\"vid\":%d",
+                (mac_info->fdb_type == MAC_TYPE_STATIC_CTL) ? "S" : "D",
+                mac_addr_to_str(mac_info->mac_addr), mac_info->vid);
+        mclagdctl_json_put_str("dev", mac_info->ifname, sizeof(mac_info->ifname), 0);
+        mclagdctl_json_put_str("origin_dev", mac_info->origin_ifname, sizeof(mac_info->origin_ifname), 0);
+        fprintf(stdout, ",\"age\":\"%s\"}\n", age);
+        return;
+    }
+
+    fprintf(stdout, "%-6d", no);
+
+    if (mac_info->fdb_type == MAC_TYPE_STATIC_CTL)
+        fprintf(stdout, "%-5s", "S");
+    else
+        fprintf(stdout, "%-5s", "D");
+
+    fprintf(stdout, "%-20s", mac_addr_to_str(mac_info->mac_addr));
+
+    fprintf(stdout, "%-5d", mac_info->vid);
+    fprintf(stdout, "%-20s", mac_info->ifname);
+    fprintf(stdout, "%-20s", mac_info->origin_ifname);
+    fprintf(stdout, "%-5s", age);
+    fprintf(stdout, "\n");
+}
+
+int mclagdctl_parse_dump_mac(char *msg, int data_len)
+{
+    struct mclagd_mac_msg * mac_info = NULL;
+    int len = 0;
+    int count = 0;
+
+    if (!mclagdctl_json)
+        mclagdctl_print_mac_title();
 
     len = sizeof(struct mclagd_mac_msg);
 
     for (; data_len >= len; data_len -= len, count++)
     {
         mac_info = (struct mclagd_mac_msg*)(msg + len * count);
+        mclagdctl_print_mac(mac_info, count + 1);
+    }
 
-        fprintf(stdout, "%-6d", count + 1);
-
-        if (mac_info->fdb_type == MAC_TYPE_STATIC_CTL)
-            fprintf(stdout, "%-5s", "S");
-        else
-            fprintf(stdout, "%-5s", "D");
+    return 0;
+}
 
-        fprintf(stdout, "%-20s", mac_addr_to_str(mac_info->mac_addr));
+int mclagdctl_parse_page_mac(char *msg, int count, int base)
+{
+    int i;
 
-        fprintf(stdout, "%-5d", mac_info->vid);
-        fprintf(stdout, "%-20s", mac_info->ifname);
-        fprintf(stdout, "%-20s", mac_info->origin_ifname);
+    if (base == 0 && !mclagdctl_json)
+        mclagdctl_print_mac_title();
 
-        if ((mac_info->age_flag & MAC_AGE_LOCAL_CTL) && (mac_info->age_flag & MAC_AGE_PEER_CTL))
-            fprintf(stdout, "%-5s", "LP");
-        else if (mac_info->age_flag & MAC_AGE_LOCAL_CTL)
-            fprintf(stdout, "%-5s", "L");
-        else if (mac_info->age_flag & MAC_AGE_PEER_CTL)
-            fprintf(stdout, "%-5s", "P");
-        else
-            fprintf(stdout, "%-5s", " ");
-        fprintf(stdout, "\n");
-    }
+    for (i = 0; i < count; i++)
+        mclagdctl_print_mac((struct mclagd_mac_msg *)msg + i, base + i + 1);
 
     return 0;
 }
@@ -653,6 +803,146 @@ int mclagdctl_parse_dump_peer_portlist(char *msg, int data_len)
     return 0;
 }
 
+int mclagdctl_enca_dump_perf(char *msg, int mclag_id, int argc, char **argv)
+{
+    struct mclagdctl_req_hdr req;
+
+    memset(&req, 0, sizeof(struct mclagdctl_req_hdr));
+    req.info_type = INFO_TYPE_DUMP_PERF;
+    req.mclag_id = mclag_id;
+    memcpy((struct mclagdctl_req_hdr *)msg, &req, sizeof(struct mclagdctl_req_hdr));
+
+    return 1;
+}
+
+static char *mclagdctl_perf_src2str(ICCP_PERF_SRC_e src)
+{
+    switch (src)
+    {
+        case ICCP_PERF_SRC_FSM_TRANSIT:
+            return "FsmTransit";
+        case ICCP_PERF_SRC_TIMER:
+            return "Timer";
+        case ICCP_PERF_SRC_SERVER_ACCEPT:
+            return "PeerAccept";
+        case ICCP_PERF_SRC_NETLINK_GENL:
+            return "NetlinkGenl";
+        case ICCP_PERF_SRC_NETLINK_ROUTE:
+            return "NetlinkRoute";
+        case ICCP_PERF_SRC_ARP_PKT:
+            return "ArpPkt";
+        case ICCP_PERF_SRC_NDISC_PKT:
+            return "NdiscPkt";
+        case ICCP_PERF_SRC_MCLAGDCTL:
+            return "Mclagdctl";
+        case ICCP_PERF_SRC_MCLAGSYNCD:
+            return "MclagSyncd";
+        case ICCP_PERF_SRC_SIGNAL:
+            return "Signal";
+        case ICCP_PERF_SRC_PEER_RX:
+            return "PeerRx";
+        default:
+            return "Unknown";
+    }
+}
+
+static char *mclagdctl_perf_tlv2str(int idx)
+{
+    static char *tlv_str[ICCP_PERF_TLV_MAX] =
+    {
+        "Connect", "Disconnect", "SysConfig", "PortConfig", "PortPriority",
+        "PortState", "AggrConfig", "AggrState", "SyncReq", "SyncData",
+        "Heartbeat", "DisconnectCause", "OrphanPort", "PortChannelInfo",
+        "PeerLinkInfo", "ArpInfo", "StpInfo", "MacInfo", "WarmbootFlag",
+        "NdiscInfo", "IfUpAck", "Other"
+    };
+
+    if (idx < 0 || idx >= ICCP_PERF_TLV_MAX)
+        return "Unknown";
+
+    return tlv_str[idx];
+}
+
+/* Upper bound in usec of the bucket holding the given percentile */
+static uint64_t mclagdctl_perf_percentile(iccp_perf_hist_t *hist, int percent)
+{
+    uint64_t target = (hist->count * percent + 99) / 100;
+    uint64_t sum = 0;
+    int i;
+
+    for (i = 0; i < ICCP_PERF_HIST_BUCKETS - 1; ++i)
+    {
+        sum += hist->bucket[i];
+        if (sum >= target)
+            return (uint64_t)2 << i;
+    }
+
+    return hist->max_usec;
+}
+
+static void mclagdctl_print_perf_hist(char *name, iccp_perf_hist_t *hist)
+{
+    if (hist->count == 0)
+        return;
+
+    fprintf(stdout, "%-18s%-12lu%-12lu%-12lu%-12lu%-12u\n",
+        name, hist->count, hist->total_usec / hist->count,
+        mclagdctl_perf_percentile(hist, 50),
+        mclagdctl_perf_percentile(hist, 99),
+        hist->max_usec);
+}
+
+int mclagdctl_parse_dump_perf(char *msg, int data_len)
+{
+    iccp_perf_info_t *perf_p;
+    int i;
+
+    if (data_len != sizeof(iccp_perf_info_t))
+    {
+        fprintf(stderr, "Invalid perf info length %d, expected %zu\n",
+            data_len, sizeof(iccp_perf_info_t));
+        return MCLAG_ERROR;
+    }
+
+    perf_p = (iccp_perf_info_t *)msg;
+    fprintf(stdout, "%-20s%lu\n\n", "Since reset (ms):",
+        perf_p->now_msec - perf_p->reset_msec);
+
+    /* P50/P99 are histogram bucket upper bounds */
+    fprintf(stdout, "%-18s%-12s%-12s%-12s%-12s%-12s\n",
+        "Event source", "COUNT", "AVG_US", "P50_US", "P99_US", "MAX_US");
+    fprintf(stdout, "%-18s%-12s%-12s%-12s%-12s%-12s\n",
+        "------------", "-----", "------", "------", "------", "------");
+    for (i = 0; i < ICCP_PERF_SRC_MAX; ++i)
+        mclagdctl_print_perf_hist(mclagdctl_perf_src2str(i), &perf_p->src[i]);
+
+    fprintf(stdout, "\n%-18s%-12s%-12s%-12s%-12s%-12s\n",
+        "Peer TLV", "COUNT", "AVG_US", "P50_US", "P99_US", "MAX_US");
+    fprintf(stdout, "%-18s%-12s%-12s%-12s%-12s%-12s\n",
+        "--------", "-----", "------", "------", "------", "------");
+    for (i = 0; i < ICCP_PERF_TLV_MAX; ++i)
+        mclagdctl_print_perf_hist(mclagdctl_perf_tlv2str(i), &perf_p->tlv[i]);
+
+    return 0;
+}
+
+int mclagdctl_enca_clear_perf(char *msg, int mclag_id, int argc, char **argv)
+{
+    struct mclagdctl_req_hdr req;
+
+    memset(&req, 0, sizeof(struct mclagdctl_req_hdr));
+    req.info_type = INFO_TYPE_CLEAR_PERF;
+    req.mclag_id = mclag_id;
+    memcpy((struct mclagdctl_req_hdr *)msg, &req, sizeof(struct mclagdctl_req_hdr));
+
+    return 1;
+}
+
+int mclagdctl_parse_clear_perf(char *msg, int data_len)
+{
+    return 0;
+}
+
 int mclagdctl_enca_dump_unique_ip(char *msg, int mclag_id, int argc, char **argv)
 {
     struct mclagdctl_req_hdr req;
@@ -825,6 +1115,21 @@ static char *mclagdctl_dbg_counter_syncdrx2str(SYNCD_RX_DBG_CNTR_MSG_e syncdrx_i
     }
 }
 
+static char *mclagdctl_dbg_counter_batch2str(MLACP_SYNC_BATCH_e batch_id)
+{
+    switch(batch_id)
+    {
+        case MLACP_SYNC_BATCH_MAC:
+            return "MacInfo";
+        case MLACP_SYNC_BATCH_ARP:
+            return "ArpInfo";
+        case MLACP_SYNC_BATCH_NDISC:
+            return "NdiscInfo";
+        default:
+            return "Unknown";
+    }
+}
+
 int mclagdctl_parse_dump_dbg_counters(char *msg, int data_len)
 {
     mclagd_dbg_counter_info_t *dbg_counter_p;
@@ -864,6 +1169,37 @@ int mclagdctl_parse_dump_dbg_counters(char *msg, int data_len)
     fprintf(stdout, "\n");
     fprintf(stdout, "%-20s%u\n\n", "Warmboot:", sys_counter_p->warmboot_counter);
 
+    /* Scheduler passes and event-to-action latency */
+    fprintf(stdout, "%-20s%lu\n", "Sched event run:",
+        sys_counter_p->sched_event_run_counter);
+    fprintf(stdout, "%-20s%lu\n", "Sched timer run:",
+        sys_counter_p->sched_timer_run_counter);
+    fprintf(stdout, "%-20s%u/%lu/%u\n", "Sched lat us(l/a/m):",
+        sys_counter_p->sched_latency_last_usec,
+        sys_counter_p->sched_event_run_counter ?
+            sys_counter_p->sched_latency_total_usec / sys_counter_p->sched_event_run_counter : 0,
+        sys_counter_p->sched_latency_max_usec);
+    fprintf(stdout, "%-20s%u\n\n", "Sched timer late us:",
+        sys_counter_p->sched_timer_late_max_usec);
+
+    /* Batched kernel neighbor programming */
+    fprintf(stdout, "%-20s%lu\n", "Neigh batch send:",
+        sys_counter_p->neigh_batch_msg_counter);
+    fprintf(stdout, "%-20s%lu\n", "Neigh batch entry:",
+        sys_counter_p->neigh_batch_entry_counter);
+    fprintf(stdout, "%-20s%u\n\n", "Neigh batch error:",
+        sys_counter_p->neigh_batch_err_counter);
+
+    /* Warm reboot snapshot */
+    fprintf(stdout, "%-20s%u\n", "Warm restore MAC:",
+        sys_counter_p->warm_restore_mac_counter);
+    fprintf(stdout, "%-20s%u\n", "Warm restore neigh:",
+        sys_counter_p->warm_restore_neigh_counter);
+    fprintf(stdout, "%-20s%u\n", "Warm purge MAC:",
+        sys_counter_p->warm_purge_mac_counter);
+    fprintf(stdout, "%-20s%u\n\n", "Warm purge neigh:",
+        sys_counter_p->warm_purge_neigh_counter);
+
     /* ICCP daemon to Mclagsyncd messages */
     fprintf(stdout, "%-20s%-20s%-20s\n", "ICCP to MclagSyncd", "TX_OK", "TX_ERROR");
     fprintf(stdout, "%-20s%-20s%-20s\n", "------------------", "-----", "--------");
@@ -906,6 +1242,25 @@ int mclagdctl_parse_dump_dbg_counters(char *msg, int data_len)
                 iccp_counter_p->iccp_counters[j][1][1]);
         }
         fprintf(stdout, "\n");
+
+        /* Entries per MAC/ARP/ND info message sent to the peer */
+        fprintf(stdout, "%-20s%-20s%-20s%-20s%-20s\n",
+            "Peer sync batch", "TX_MSG", "TX_ENTRY", "AVG_ENTRY", "MAX_ENTRY");
+        fprintf(stdout, "%-20s%-20s%-20s%-20s%-20s\n",
+            "---------------", "------", "--------", "---------", "---------");
+        for (j = 0; j < MLACP_SYNC_BATCH_MAX; ++j)
+        {
+            fprintf(stdout, "%-20s%-20lu%-20lu%-20lu%-20u\n",
+                mclagdctl_dbg_counter_batch2str(j),
+                iccp_counter_p->sync_batch_msgs[j],
+                iccp_counter_p->sync_batch_entries[j],
+                iccp_counter_p->sync_batch_msgs[j] ?
+                    iccp_counter_p->sync_batch_entries[j] / iccp_counter_p->sync_batch_msgs[j] : 0,
+                iccp_counter_p->sync_batch_max_entries[j]);
+        }
+        fprintf(stdout, "%-20s%u\n", "Resync count:", iccp_counter_p->resync_count);
+        fprintf(stdout, "%-20s%u/%u\n\n", "Resync last/max ms:",
+            iccp_counter_p->resync_last_msec, iccp_counter_p->resync_max_msec);
     }
     /* Netlink counters */
     fprintf(stdout, "\nNetlink Counters\n");
@@ -1058,6 +1413,124 @@ static void mclagdctl_print_cmd(struct command_type *cmd_type)
     fprintf(stdout, "%s", cmd_type->name);
 }
 
+/* Fetch a table one page per connection, so iccpd serves other events
+ * between pages, and print each page as it arrives. Returns MCLAG_ERROR,
+ * with nothing printed, when iccpd does not serve this page version.
+ */
+static int mclagdctl_dump_pages(struct command_type *cmd_type, int mclag_id)
+{
+    static char rcv_buf[MCLAGD_DUMP_PAGE_BUF_SIZE];
+    struct mclagdctl_req_hdr req;
+    struct mclagd_dump_cursor cursor;
+    struct mclagd_reply_hdr *reply = (struct mclagd_reply_hdr *)rcv_buf;
+    struct mclagd_dump_page *page = (struct mclagd_dump_page *)(rcv_buf + sizeof(struct mclagd_reply_hdr));
+    int version = MCLAGD_DUMP_PAGE_VERSION;
+    int first = 1;
+    int total = 0;
+    int len = 0;
+    int ret = EXIT_SUCCESS;
+
+    if (mclag_id <= 0)
+    {
+        fprintf(stderr, "Need to specify mclag-id through the parameter i !\n");
+        return EXIT_FAILURE;
+    }
+
+    memset(&cursor, 0, sizeof(struct mclagd_dump_cursor));
+
+    do
+    {
+        if (mclagdctl_sock_connect() < 0)
+        {
+            fprintf(stderr, "Failed to connect to mclagd\n");
+            return EXIT_FAILURE;
+        }
+
+        memset(&req, 0, sizeof(struct mclagdctl_req_hdr));
+        req.info_type = cmd_type->page_info_type;
+        req.mclag_id = mclag_id;
+        memcpy(req.para1, &cursor, sizeof(struct mclagd_dump_cursor));
+        memcpy(req.para2, &version, sizeof(int));
+
+        if (mclagdctl_sock_write(mclagdctl_sock_fd, (unsigned char *)&req, sizeof(struct mclagdctl_req_hdr)) <= 0)
+        {
+            fprintf(stderr, "Failed to send command to mclagd\n");
+            ret = EXIT_FAILURE;
+            break;
+        }
+
+        if (mclagdctl_sock_read(mclagdctl_sock_fd, (unsigned char *)&len, sizeof(int)) <= 0)
+        {
+            /* An older iccpd closes on a request type it does not know */
+            if (first)
+            {
+                ret = MCLAG_ERROR;
+                break;
+            }
+            fprintf(stderr, "Failed to read data length from mclagd\n");
+            ret = EXIT_FAILURE;
+            break;
+        }
+
+        if (len < (int)sizeof(struct mclagd_reply_hdr)
+            || len > (int)(MCLAGD_DUMP_PAGE_BUF_SIZE - sizeof(int)))
+        {
+            fprintf(stderr, "pkt len = %d, error\n", len);
+            ret = EXIT_FAILURE;
+            break;
+        }
+
+        if (mclagdctl_sock_read(mclagdctl_sock_fd, (unsigned char *)rcv_buf, len) <= 0)
+        {
+            fprintf(stderr, "Failed to read data from mclagd\n");
+            ret = EXIT_FAILURE;
+            break;
+        }
+
+        mclagdctl_sock_close();
+
+        if (first && (reply->data_len < (int)sizeof(struct mclagd_dump_page)
+                      || page->version != MCLAGD_DUMP_PAGE_VERSION))
+            return MCLAG_ERROR;
+
+        if (reply->info_type != cmd_type->page_info_type)
+        {
+            fprintf(stderr, "Reply info type from mclagd error\n");
+            return EXIT_FAILURE;
+        }
+
+        if (reply->exec_result == EXEC_TYPE_NO_EXIST_SYS)
+        {
+            fprintf(stderr, "No exist sys in iccpd!\n");
+            return EXIT_FAILURE;
+        }
+
+        if (reply->exec_result == EXEC_TYPE_NO_EXIST_MCLAGID)
+        {
+            fprintf(stderr, "Mclag-id %d hasn't been configured in iccpd!\n", mclag_id);
+            return EXIT_FAILURE;
+        }
+
+        if (reply->exec_result != EXEC_TYPE_SUCCESS
+            || reply->data_len < (int)sizeof(struct mclagd_dump_page))
+        {
+            fprintf(stderr, "exec error in iccpd!\n");
+            return EXIT_FAILURE;
+        }
+
+        cmd_type->parse_page((char *)(page + 1), page->count, total);
+        fflush(stdout);
+
+        first = 0;
+        total += page->count;
+        memcpy(&cursor, &page->next, sizeof(struct mclagd_dump_cursor));
+    } while (page->more && page->count > 0);
+
+    mclagdctl_sock_close();
+
+    return ret;
+}
+
 static void mclagdctl_print_help(const char *argv0)
 {
     int i, j;
@@ -1066,7 +1539,8 @@ static void mclagdctl_print_help(const char *argv0)
     fprintf(stdout, "%s [options] command [command args]\n"
             "    -h --help                Show this help\n"
             "    -i --mclag-id            Specify one mclag id\n"
-            "    -l --level               Specify log level     critical,err,warn,notice,info,debug\n",
+            "    -l --level               Specify log level     critical,err,warn,notice,info,debug\n"
+            "    -j --json                Print arp/nd/mac dumps as JSON lines\n",
             argv0);
     fprintf(stdout, "Commands:\n");
 
@@ -1095,6 +1569,7 @@ int main(int argc, char **argv)
         { "help",      no_argument,             NULL,        'h' },
         { "mclag id",  required_argument,       NULL,        'i' },
         { "log level", required_argument,       NULL,        'l' },
+        { "json",      no_argument,             NULL,        'j' },
         { NULL,        0,                       NULL,        0   }
     };
     int opt;
@@ -1107,7 +1582,7 @@ int main(int argc, char **argv)
     char *data;
     struct mclagd_reply_hdr *reply;
 
-    while ((opt = getopt_long(argc, argv, "hi:l:", long_options, NULL)) >= 0)
+    while ((opt = getopt_long(argc, argv, "hi:l:j", long_options, NULL)) >= 0)
     {
         switch (opt)
         {
@@ -1119,6 +1594,10 @@ int main(int argc, char **argv)
             para_int = atoi(optarg);
             break;
 
+        case 'j':
+            mclagdctl_json = 1;
+            break;
+
         case 'l':
             switch (tolower(optarg[0]))
             {
@@ -1182,6 +1661,14 @@ int main(int argc, char **argv)
         return EXIT_FAILURE;
     }
 
+    if (cmd_type->parse_page)
+    {
+        ret = mclagdctl_dump_pages(cmd_type, para_int);
+        if (ret != MCLAG_ERROR)
+            return ret;
+        /* Older iccpd, fall back to the whole-table request */
+    }
+
     if (mclagdctl_sock_fd <= 0)
     {
         ret = mclagdctl_sock_connect();
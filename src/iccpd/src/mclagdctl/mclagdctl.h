@@ -36,6 +36,7 @@
 
 typedef int (*call_enca_msg_fun)(char *msg, int mclag_id,  int argc, char **argv);
 typedef int (*call_parse_msg_fun)(char *msg, int data_len);
+typedef int (*call_parse_page_fun)(char *msg, int count, int base);
 
 enum MAC_TYPE_CTL
 {
@@ -63,6 +64,9 @@ enum id_command_type
     ID_CMDTYPE_C,
     ID_CMDTYPE_C_L,
     ID_CMDTYPE_C_D,
+    ID_CMDTYPE_D_PF,
+    ID_CMDTYPE_CL,
+    ID_CMDTYPE_CL_P,
 };
 
 enum mclagdctl_notify_peer_type
@@ -78,6 +82,11 @@ enum mclagdctl_notify_peer_type
     INFO_TYPE_DUMP_DBG_COUNTERS,
     INFO_TYPE_CONFIG_LOGLEVEL,
     INFO_TYPE_CONFIG_DOWN,
+    INFO_TYPE_DUMP_ARP_PAGE,
+    INFO_TYPE_DUMP_NDISC_PAGE,
+    INFO_TYPE_DUMP_MAC_PAGE,
+    INFO_TYPE_DUMP_PERF,
+    INFO_TYPE_CLEAR_PERF,
     INFO_TYPE_FINISH,
 };
 
@@ -126,6 +135,9 @@ struct command_type
     char *params[MCLAGDCTL_COMMAND_PARAM_MAX_CNT];
     call_enca_msg_fun enca_msg;
     call_parse_msg_fun parse_msg;
+    /* Set for tables that are fetched one page at a time */
+    enum mclagdctl_notify_peer_type page_info_type;
+    call_parse_page_fun parse_page;
 };
 
 struct mclagd_state
@@ -211,6 +223,35 @@ struct mclagd_peer_if
     unsigned char po_active;
 };
 
+/* Paged table dumps. The request carries the cursor in para1 and the
+ * page version in para2; each reply holds a struct mclagd_dump_page
+ * followed by up to MCLAGD_DUMP_PAGE_ENTRIES entries, resuming after the
+ * cursor key. iccpd refuses a version it does not speak, and mclagdctl
+ * falls back to the whole-table request when the first page is refused
+ * or gets no reply (iccpd older than the page requests).
+ */
+#define MCLAGD_DUMP_PAGE_VERSION 1
+#define MCLAGD_DUMP_PAGE_ENTRIES 512
+
+struct mclagd_dump_cursor
+{
+    uint8_t valid;
+    uint8_t mac_addr[MCLAGDCTL_ETHER_ADDR_LEN];
+    uint16_t vid;
+    uint8_t ip_addr[16];
+};
+
+struct mclagd_dump_page
+{
+    int version;
+    int count;
+    int more;
+    struct mclagd_dump_cursor next;
+};
+
+#define MCLAGD_DUMP_PAGE_BUF_SIZE (MCLAGD_REPLY_INFO_HDR + sizeof(struct mclagd_dump_page) \
+                                   + MCLAGD_DUMP_PAGE_ENTRIES * sizeof(struct mclagd_ndisc_msg))
+
 typedef struct mclagd_dbg_counter_info
 {
     system_dbg_counter_info_t system_dbg;
@@ -234,6 +275,9 @@ extern int mclagdctl_parse_dump_arp(char *msg, int data_len);
 extern int mclagdctl_parse_dump_ndisc(char *msg, int data_len);
 extern int mclagdctl_enca_dump_mac(char *msg, int mclag_id, int argc, char **argv);
 extern int mclagdctl_parse_dump_mac(char *msg, int data_len);
+extern int mclagdctl_parse_page_arp(char *msg, int count, int base);
+extern int mclagdctl_parse_page_ndisc(char *msg, int count, int base);
+extern int mclagdctl_parse_page_mac(char *msg, int count, int base);
 extern int mclagdctl_enca_dump_local_portlist(char *msg, int mclag_id,  int argc, char **argv);
 extern int mclagdctl_parse_dump_local_portlist(char *msg, int data_len);
 extern int mclagdctl_enca_dump_peer_portlist(char *msg, int mclag_id,  int argc, char **argv);
@@ -245,3 +289,7 @@ extern int mclagdctl_enca_dump_dbg_counters(char *msg, int mclag_id, int argc, c
 extern int mclagdctl_parse_dump_dbg_counters(char *msg, int data_len);
 extern int mclagdctl_enca_dump_unique_ip(char *msg, int mclag_id, int argc, char **argv);
 extern int mclagdctl_parse_dump_unique_ip(char *msg, int data_len);
+extern int mclagdctl_enca_dump_perf(char *msg, int mclag_id, int argc, char **argv);
+extern int mclagdctl_parse_dump_perf(char *msg, int data_len);
+extern int mclagdctl_enca_clear_perf(char *msg, int mclag_id, int argc, char **argv);
+extern int mclagdctl_parse_clear_perf(char *msg, int data_len);
@@ -42,6 +42,7 @@
 #include "../include/mlacp_sync_update.h"
 #include "../include/system.h"
 #include "../include/scheduler.h"
+#include "../include/iccp_warmboot.h"
 
 #include <signal.h>
 
@@ -61,6 +62,15 @@
         TAILQ_INIT(&(list)); \
     }
 
+/* Entries are freed with arp_list/ndisc_list, only reset the index roots */
+#define MLACP_NEIGH_INDEX_REINIT(csm) \
+    { \
+        RB_INIT(arp_rb_tree, &MLACP(csm).arp_rb); \
+        RB_INIT(arp_if_rb_tree, &MLACP(csm).arp_if_rb); \
+        RB_INIT(ndisc_rb_tree, &MLACP(csm).ndisc_rb); \
+        RB_INIT(ndisc_if_rb_tree, &MLACP(csm).ndisc_if_rb); \
+    }
+
 #define MLACP_MAC_MSG_QUEUE_REINIT(list) \
     { \
         struct MACMsg* mac_msg = NULL; \
@@ -134,6 +144,59 @@ static int MACMsg_compare(const struct MACMsg *mac1, const struct MACMsg *mac2)
 
 RB_GENERATE(mac_rb_tree, MACMsg, mac_entry_rb, MACMsg_compare);
 
+static int ARPMsg_compare(const struct Msg *msg1, const struct Msg *msg2)
+{
+    const struct ARPMsg *arp1 = (const struct ARPMsg *)msg1->buf;
+    const struct ARPMsg *arp2 = (const struct ARPMsg *)msg2->buf;
+
+    if (arp1->ipv4_addr < arp2->ipv4_addr)
+        return -1;
+
+    if (arp1->ipv4_addr > arp2->ipv4_addr)
+        return 1;
+
+    return 0;
+}
+
+static int ARPMsg_if_compare(const struct Msg *msg1, const struct Msg *msg2)
+{
+    const struct ARPMsg *arp1 = (const struct ARPMsg *)msg1->buf;
+    const struct ARPMsg *arp2 = (const struct ARPMsg *)msg2->buf;
+    int ret;
+
+    ret = strncmp(arp1->ifname, arp2->ifname, MAX_L_PORT_NAME);
+    if (ret != 0)
+        return ret;
+
+    return ARPMsg_compare(msg1, msg2);
+}
+
+static int NDISCMsg_compare(const struct Msg *msg1, const struct Msg *msg2)
+{
+    const struct NDISCMsg *ndisc1 = (const struct NDISCMsg *)msg1->buf;
+    const struct NDISCMsg *ndisc2 = (const struct NDISCMsg *)msg2->buf;
+
+    return memcmp(ndisc1->ipv6_addr, ndisc2->ipv6_addr, 16);
+}
+
+static int NDISCMsg_if_compare(const struct Msg *msg1, const struct Msg *msg2)
+{
+    const struct NDISCMsg *ndisc1 = (const struct NDISCMsg *)msg1->buf;
+    const struct NDISCMsg *ndisc2 = (const struct NDISCMsg *)msg2->buf;
+    int ret;
+
+    ret = strncmp(ndisc1->ifname, ndisc2->ifname, MAX_L_PORT_NAME);
+    if (ret != 0)
+        return ret;
+
+    return NDISCMsg_compare(msg1, msg2);
+}
+
+RB_GENERATE(arp_rb_tree, Msg, neigh_rb, ARPMsg_compare);
+RB_GENERATE(arp_if_rb_tree, Msg, neigh_if_rb, ARPMsg_if_compare);
+RB_GENERATE(ndisc_rb_tree, Msg, neigh_rb, NDISCMsg_compare);
+RB_GENERATE(ndisc_if_rb_tree, Msg, neigh_if_rb, NDISCMsg_if_compare);
+
 #define WARM_REBOOT_TIMEOUT 90
 #define PEER_REBOOT_TIMEOUT 300
 
@@ -148,8 +211,8 @@ static void mlacp_resync_ndisc(struct CSM *csm);
 static void mlacp_sync_send_sysConf(struct CSM* csm);
 static void mlacp_sync_send_aggConf(struct CSM* csm);
 static void mlacp_sync_send_aggState(struct CSM* csm);
-static void mlacp_sync_send_syncArpInfo(struct CSM* csm);
-static void mlacp_sync_send_syncNdiscInfo(struct CSM *csm);
+static void mlacp_sync_send_syncArpInfo(struct CSM* csm, int flush);
+static void mlacp_sync_send_syncNdiscInfo(struct CSM *csm, int flush);
 static void mlacp_sync_send_heartbeat(struct CSM* csm);
 static void mlacp_sync_send_syncDoneData(struct CSM* csm);
 /* Sync Reciever APIs*/
@@ -255,14 +318,95 @@ static void mlacp_sync_send_aggState(struct CSM* csm)
 
     return;
 }
-#define MAX_MAC_ENTRY_NUM 30
-#define MAX_NEIGH_ENTRY_NUM 40
-static void mlacp_sync_send_syncMacInfo(struct CSM* csm)
+/* MAC/ARP/ND info TLVs are filled up to the CSM buffer, which also
+ * keeps the LDP msg_len within 16 bits
+ */
+#define MLACP_SYNC_BATCH_ENTRY_NUM(tlv_type, entry_type) \
+    ((int)((CSM_BUFFER_SIZE - sizeof(ICCHdr) - sizeof(tlv_type)) / sizeof(entry_type)))
+#define MAX_MAC_ENTRY_NUM   MLACP_SYNC_BATCH_ENTRY_NUM(struct mLACPMACInfoTLV, struct mLACPMACData)
+#define MAX_ARP_ENTRY_NUM   MLACP_SYNC_BATCH_ENTRY_NUM(struct mLACPARPInfoTLV, struct ARPMsg)
+#define MAX_NDISC_ENTRY_NUM MLACP_SYNC_BATCH_ENTRY_NUM(struct mLACPNDISCInfoTLV, struct NDISCMsg)
+
+/* A partial batch is held at most this long waiting for more entries */
+#define MLACP_SYNC_FLUSH_MSEC 50
+
+/* Count queued entries, stop counting once a full batch is seen */
+#define MLACP_SYNC_QUEUE_LEN(head, type, field, max, len) \
+    { \
+        struct type* elm = NULL; \
+        (len) = 0; \
+        TAILQ_FOREACH(elm, (head), field) { \
+            if (++(len) >= (max)) \
+                break; \
+        } \
+    }
+
+/* Time/size flush policy: send when a full batch is queued, when the
+ * oldest queued entry waited MLACP_SYNC_FLUSH_MSEC, or when forced
+ */
+static int mlacp_sync_batch_ready(struct CSM* csm, MLACP_SYNC_BATCH_e batch,
+                                  int pending, int max_entry, int flush)
+{
+    uint64_t now;
+
+    if (pending == 0)
+    {
+        MLACP(csm).sync_pending_msec[batch] = 0;
+        return 0;
+    }
+
+    if (flush || pending >= max_entry)
+        return 1;
+
+    now = system_get_time_msec();
+    if (MLACP(csm).sync_pending_msec[batch] == 0)
+        MLACP(csm).sync_pending_msec[batch] = now;
+
+    return ((now - MLACP(csm).sync_pending_msec[batch]) >= MLACP_SYNC_FLUSH_MSEC);
+}
+
+/* Earliest time a partially filled sync batch is due, 0 if none waits */
+uint64_t mlacp_fsm_sync_deadline_msec(struct CSM* csm)
+{
+    uint64_t deadline = 0;
+    int batch;
+
+    for (batch = 0; batch < MLACP_SYNC_BATCH_MAX; ++batch)
+    {
+        if (MLACP(csm).sync_pending_msec[batch] == 0)
+            continue;
+        if (deadline == 0 || MLACP(csm).sync_pending_msec[batch] < deadline)
+            deadline = MLACP(csm).sync_pending_msec[batch];
+    }
+
+    return deadline ? deadline + MLACP_SYNC_FLUSH_MSEC : 0;
+}
+
+static void mlacp_sync_send_batch(struct CSM* csm, MLACP_SYNC_BATCH_e batch,
+                                  int msg_len, int count, int more)
+{
+    mlacp_dbg_counter_info_t *cntr = &MLACP(csm).dbg_counters;
+
+    iccp_csm_send_flags(csm, g_csm_buf, msg_len, more ? MSG_MORE : 0);
+
+    ++cntr->sync_batch_msgs[batch];
+    cntr->sync_batch_entries[batch] += count;
+    if (count > cntr->sync_batch_max_entries[batch])
+        cntr->sync_batch_max_entries[batch] = count;
+    MLACP(csm).sync_pending_msec[batch] = 0;
+}
+
+static void mlacp_sync_send_syncMacInfo(struct CSM* csm, int flush)
 {
     int msg_len = 0;
     struct MACMsg* mac_msg = NULL;
     struct MACMsg mac_find;
     int count = 0;
+    int pending = 0;
+
+    MLACP_SYNC_QUEUE_LEN(&(MLACP(csm).mac_msg_list), MACMsg, tail, MAX_MAC_ENTRY_NUM, pending);
+    if (!mlacp_sync_batch_ready(csm, MLACP_SYNC_BATCH_MAC, pending, MAX_MAC_ENTRY_NUM, flush))
+        return;
 
     memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
     memset(&mac_find, 0, sizeof(struct MACMsg));
@@ -291,7 +435,8 @@ static void mlacp_sync_send_syncMacInfo(struct CSM* csm)
 
         if (count >= MAX_MAC_ENTRY_NUM)
         {
-            iccp_csm_send(csm, g_csm_buf, msg_len);
+            mlacp_sync_send_batch(csm, MLACP_SYNC_BATCH_MAC, msg_len, count,
+                                  !TAILQ_EMPTY(&(MLACP(csm).mac_msg_list)));
             count = 0;
             memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
         }
@@ -299,16 +444,21 @@ static void mlacp_sync_send_syncMacInfo(struct CSM* csm)
     }
 
     if (count)
-        iccp_csm_send(csm, g_csm_buf, msg_len);
+        mlacp_sync_send_batch(csm, MLACP_SYNC_BATCH_MAC, msg_len, count, 0);
 
     return;
 }
 
-static void mlacp_sync_send_syncArpInfo(struct CSM* csm)
+static void mlacp_sync_send_syncArpInfo(struct CSM* csm, int flush)
 {
     int msg_len = 0;
     struct Msg* msg = NULL;
     int count = 0;
+    int pending = 0;
+
+    MLACP_SYNC_QUEUE_LEN(&(MLACP(csm).arp_msg_list), Msg, tail, MAX_ARP_ENTRY_NUM, pending);
+    if (!mlacp_sync_batch_ready(csm, MLACP_SYNC_BATCH_ARP, pending, MAX_ARP_ENTRY_NUM, flush))
+        return;
 
     memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
 
@@ -321,9 +471,10 @@ static void mlacp_sync_send_syncArpInfo(struct CSM* csm)
         count++;
         free(msg->buf);
         free(msg);
-        if (count >= MAX_NEIGH_ENTRY_NUM)
+        if (count >= MAX_ARP_ENTRY_NUM)
         {
-            iccp_csm_send(csm, g_csm_buf, msg_len);
+            mlacp_sync_send_batch(csm, MLACP_SYNC_BATCH_ARP, msg_len, count,
+                                  !TAILQ_EMPTY(&(MLACP(csm).arp_msg_list)));
             count = 0;
             memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
         }
@@ -331,16 +482,21 @@ static void mlacp_sync_send_syncArpInfo(struct CSM* csm)
     }
 
     if (count)
-        iccp_csm_send(csm, g_csm_buf, msg_len);
+        mlacp_sync_send_batch(csm, MLACP_SYNC_BATCH_ARP, msg_len, count, 0);
 
     return;
 }
 
-static void mlacp_sync_send_syncNdiscInfo(struct CSM *csm)
+static void mlacp_sync_send_syncNdiscInfo(struct CSM *csm, int flush)
 {
     int msg_len = 0;
     struct Msg *msg = NULL;
     int count = 0;
+    int pending = 0;
+
+    MLACP_SYNC_QUEUE_LEN(&(MLACP(csm).ndisc_msg_list), Msg, tail, MAX_NDISC_ENTRY_NUM, pending);
+    if (!mlacp_sync_batch_ready(csm, MLACP_SYNC_BATCH_NDISC, pending, MAX_NDISC_ENTRY_NUM, flush))
+        return;
 
     memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
 
@@ -353,9 +509,10 @@ static void mlacp_sync_send_syncNdiscInfo(struct CSM *csm)
         count++;
         free(msg->buf);
         free(msg);
-        if (count >= MAX_NEIGH_ENTRY_NUM)
+        if (count >= MAX_NDISC_ENTRY_NUM)
         {
-            iccp_csm_send(csm, g_csm_buf, msg_len);
+            mlacp_sync_send_batch(csm, MLACP_SYNC_BATCH_NDISC, msg_len, count,
+                                  !TAILQ_EMPTY(&(MLACP(csm).ndisc_msg_list)));
             count = 0;
             memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
         }
@@ -363,11 +520,36 @@ static void mlacp_sync_send_syncNdiscInfo(struct CSM *csm)
     }
 
     if (count)
-        iccp_csm_send(csm, g_csm_buf, msg_len);
+        mlacp_sync_send_batch(csm, MLACP_SYNC_BATCH_NDISC, msg_len, count, 0);
 
     return;
 }
 
+/* Full resync with the peer is done once all sync queues are drained */
+static void mlacp_sync_check_resync_done(struct CSM* csm)
+{
+    mlacp_dbg_counter_info_t *cntr = &MLACP(csm).dbg_counters;
+    uint64_t elapsed;
+
+    if (MLACP(csm).resync_start_msec == 0)
+        return;
+
+    if (!TAILQ_EMPTY(&(MLACP(csm).mac_msg_list))
+        || !TAILQ_EMPTY(&(MLACP(csm).arp_msg_list))
+        || !TAILQ_EMPTY(&(MLACP(csm).ndisc_msg_list)))
+        return;
+
+    elapsed = system_get_time_msec() - MLACP(csm).resync_start_msec;
+    MLACP(csm).resync_start_msec = 0;
+
+    ++cntr->resync_count;
+    cntr->resync_last_msec = (uint32_t)elapsed;
+    if (cntr->resync_last_msec > cntr->resync_max_msec)
+        cntr->resync_max_msec = cntr->resync_last_msec;
+
+    ICCPD_LOG_NOTICE(__FUNCTION__, "Resync with peer done in %u ms", cntr->resync_last_msec);
+}
+
 static void mlacp_sync_send_syncPortChannelInfo(struct CSM* csm)
 {
     struct System* sys = NULL;
@@ -868,6 +1050,7 @@ void mlacp_init(struct CSM* csm, int all)
     mlacp_mac_msg_queue_reinit(csm);
 
     PIF_QUEUE_REINIT(MLACP(csm).pif_list);
+    RB_INIT(pif_name_rb_tree, &MLACP(csm).pif_name_rb);
     LIF_PURGE_QUEUE_REINIT(MLACP(csm).lif_purge_list);
 
     if (all != 0)
@@ -875,8 +1058,11 @@ void mlacp_init(struct CSM* csm, int all)
         /* if no clean all, keep the arp info & local interface info for next connection*/
         MLACP_MSG_QUEUE_REINIT(MLACP(csm).arp_list);
         MLACP_MSG_QUEUE_REINIT(MLACP(csm).ndisc_list);
+        MLACP_NEIGH_INDEX_REINIT(csm);
         RB_INIT(mac_rb_tree, &MLACP(csm).mac_rb );
         LIF_QUEUE_REINIT(MLACP(csm).lif_list);
+        MLACP(csm).warm_restored = 0;
+        MLACP(csm).warm_reconcile_time = 0;
 
         MLACP(csm).node_id = MLACP_SYSCONF_NODEID_MSB_MASK;
         MLACP(csm).node_id |= (((inet_addr(csm->sender_ip) >> 24) << 4) & MLACP_SYSCONF_NODEID_NODEID_MASK);
@@ -902,6 +1088,7 @@ void mlacp_finalize(struct CSM* csm)
     mlacp_mac_msg_queue_reinit(csm);
     MLACP_MSG_QUEUE_REINIT(MLACP(csm).arp_list);
     MLACP_MSG_QUEUE_REINIT(MLACP(csm).ndisc_list);
+    MLACP_NEIGH_INDEX_REINIT(csm);
 
     RB_INIT(mac_rb_tree, &MLACP(csm).mac_rb );
 
@@ -910,6 +1097,7 @@ void mlacp_finalize(struct CSM* csm)
     LIF_PURGE_QUEUE_REINIT(MLACP(csm).lif_purge_list);
     /* remove & destroy pif queue */
     PIF_QUEUE_REINIT(MLACP(csm).pif_list);
+    RB_INIT(pif_name_rb_tree, &MLACP(csm).pif_name_rb);
 
     return;
 }
@@ -1010,6 +1198,7 @@ void mlacp_fsm_transit(struct CSM* csm)
         {
             MLACP(csm).wait_for_sync_data = 0;
             MLACP(csm).current_state = MLACP_STATE_STAGE1;
+            MLACP(csm).resync_start_msec = system_get_time_msec();
             mlacp_resync_arp(csm);
             mlacp_resync_ndisc(csm);
         }
@@ -1296,12 +1485,14 @@ static void mlacp_sync_recv_nak_handler(struct CSM* csm,  struct Msg* msg)
 static void mlacp_sync_receiver_handler(struct CSM* csm, struct Msg* msg)
 {
     ICCParameter *icc_param;
+    uint64_t start_usec;
 
     /* No receive message...*/
     if (!csm || !msg)
         return;
 
     icc_param = (ICCParameter*)&(msg->buf[sizeof(ICCHdr)]);
+    start_usec = system_get_time_usec();
 
     /*fprintf(stderr, " Recv Type [%d]\n", icc_param->type);*/
     switch (icc_param->type)
@@ -1381,6 +1572,8 @@ static void mlacp_sync_receiver_handler(struct CSM* csm, struct Msg* msg)
             break;
     }
 
+    system_perf_record_tlv(system_get_instance(), icc_param->type, start_usec);
+
     /*ICCPD_LOG_DEBUG("mlacp_fsm", "  [Sync Recv] %s... DONE", get_tlv_type_string(icc_param->type));*/
 
     return;
@@ -1417,11 +1610,11 @@ static void mlacp_sync_sender_handler(struct CSM* csm)
             break;
 
         case MLACP_SYNC_ARP_INFO:
-            mlacp_sync_send_syncArpInfo(csm);
+            mlacp_sync_send_syncArpInfo(csm, 1);
             break;
 
         case MLACP_SYNC_NDISC_INFO:
-            mlacp_sync_send_syncNdiscInfo(csm);
+            mlacp_sync_send_syncNdiscInfo(csm, 1);
             break;
 
         case MLACP_SYNC_DONE:
@@ -1647,13 +1840,18 @@ static void mlacp_exchange_handler(struct CSM* csm, struct Msg* msg)
     }
 
     /* Send MAC info if any*/
-    mlacp_sync_send_syncMacInfo(csm);
+    mlacp_sync_send_syncMacInfo(csm, 0);
 
     /* Send ARP info if any*/
-    mlacp_sync_send_syncArpInfo(csm);
+    mlacp_sync_send_syncArpInfo(csm, 0);
 
     /* Send Ndisc info if any */
-    mlacp_sync_send_syncNdiscInfo(csm);
+    mlacp_sync_send_syncNdiscInfo(csm, 0);
+
+    mlacp_sync_check_resync_done(csm);
+
+    /*Drop restored MACs that were not re-reported after warm reboot*/
+    iccp_warmboot_reconcile(csm);
 
     /*If peer is warm reboot*/
     if (csm->peer_warm_reboot_time != 0)
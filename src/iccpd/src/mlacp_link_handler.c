@@ -44,9 +44,11 @@
 #include "../include/iccp_cmd.h"
 #include "../include/mlacp_link_handler.h"
 #include "../include/mlacp_sync_prepare.h"
+#include "../include/mlacp_sync_update.h"
 #include "../include/iccp_netlink.h"
 #include "../include/scheduler.h"
 #include "../include/iccp_ifm.h"
+#include "../include/iccp_warmboot.h"
 
 /*****************************************
 * Enum
@@ -68,6 +70,14 @@ char g_ipv6_str[INET6_ADDRSTRLEN];
 char g_iccp_mlagsyncd_recv_buf[ICCP_MLAGSYNCD_RECV_MSG_BUFFER_SIZE] = { 0 };
 char g_iccp_mlagsyncd_send_buf[ICCP_MLAGSYNCD_SEND_MSG_BUFFER_SIZE] = { 0 };
 
+/* FDB writes to mclagsyncd are coalesced here while an FDB batch is open */
+static char g_iccp_fdb_batch_buf[ICCP_MLAGSYNCD_SEND_MSG_BUFFER_SIZE] = { 0 };
+static int g_iccp_fdb_batch_open = 0;
+static int g_iccp_fdb_batch_count = 0;
+
+#define ICCP_FDB_BATCH_MAX_ENTRY \
+    ((ICCP_MLAGSYNCD_SEND_MSG_BUFFER_SIZE - sizeof(struct IccpSyncdHDr)) / sizeof(struct mclag_fdb_info))
+
 
 extern void mlacp_sync_mac(struct CSM* csm);
 
@@ -130,7 +140,6 @@ static int arp_set_handler(struct CSM* csm,
     struct Msg* msg = NULL;
     struct ARPMsg* arp_msg = NULL;
     char mac_str[18] = "";
-    int err = 0;
 
     if (!csm || !lif)
         return 0;
@@ -145,7 +154,9 @@ add_arp:
     if (MLACP(csm).current_state != MLACP_STATE_EXCHANGE)
         return 0;
 
-    TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+    iccp_netlink_neighbor_batch_begin();
+    /* find the ARP for lif_list*/
+    for (msg = mlacp_arp_first_on_if(csm, lif->name); msg; msg = mlacp_arp_next_on_if(msg))
     {
         mac_str[0] = '\0';
         arp_msg = (struct ARPMsg*)msg->buf;
@@ -154,36 +165,33 @@ add_arp:
         if (arp_msg->op_type == NEIGH_SYNC_DEL)
             continue;
 
-        /* find the ARP for lif_list*/
-        if (strcmp(lif->name, arp_msg->ifname) != 0)
-            continue;
-
         sprintf(mac_str, "%02x:%02x:%02x:%02x:%02x:%02x", arp_msg->mac_addr[0], arp_msg->mac_addr[1], arp_msg->mac_addr[2],
                 arp_msg->mac_addr[3], arp_msg->mac_addr[4], arp_msg->mac_addr[5]);
 
-        err = iccp_netlink_neighbor_request(AF_INET, (uint8_t *)&arp_msg->ipv4_addr, 1, arp_msg->mac_addr, arp_msg->ifname, 0, 4);
-        ICCPD_LOG_NOTICE(__FUNCTION__, "Add dynamic ARP to kernel [%s], status %d", show_ip_str(arp_msg->ipv4_addr), err);
+        /* Batched, the kernel result is logged when the batch is flushed */
+        iccp_netlink_neighbor_request(AF_INET, (uint8_t *)&arp_msg->ipv4_addr, 1, arp_msg->mac_addr, arp_msg->ifname, 0, 4);
+        ICCPD_LOG_NOTICE(__FUNCTION__, "Add dynamic ARP to kernel [%s]", show_ip_str(arp_msg->ipv4_addr));
     }
+    iccp_netlink_neighbor_batch_end();
     goto done;
 
 del_arp:
     /* Process Del */
-    TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+    iccp_netlink_neighbor_batch_begin();
+    /* find the ARP for lif_list*/
+    for (msg = mlacp_arp_first_on_if(csm, lif->name); msg; msg = mlacp_arp_next_on_if(msg))
     {
         arp_msg = (struct ARPMsg*)msg->buf;
 
-        /* find the ARP for lif_list*/
-        if (strcmp(lif->name, arp_msg->ifname) != 0)
-            continue;
-
         /* don't process del*/
         if (arp_msg->op_type == NEIGH_SYNC_DEL)
             continue;
 
-        err = iccp_netlink_neighbor_request(AF_INET, (uint8_t *)&arp_msg->ipv4_addr, 0, arp_msg->mac_addr, arp_msg->ifname, 0, 5);
+        iccp_netlink_neighbor_request(AF_INET, (uint8_t *)&arp_msg->ipv4_addr, 0, arp_msg->mac_addr, arp_msg->ifname, 0, 5);
         /* link broken, del all dynamic arp on the lif */
-        ICCPD_LOG_NOTICE(__FUNCTION__, "Del dynamic ARP [%s], status %d", show_ip_str(arp_msg->ipv4_addr), err);
+        ICCPD_LOG_NOTICE(__FUNCTION__, "Del dynamic ARP [%s]", show_ip_str(arp_msg->ipv4_addr));
     }
+    iccp_netlink_neighbor_batch_end();
 
 done:
     return 0;
@@ -194,7 +202,6 @@ static int ndisc_set_handler(struct CSM *csm, struct LocalInterface *lif, int ad
     struct Msg *msg = NULL;
     struct NDISCMsg *ndisc_msg = NULL;
     char mac_str[18] = "";
-    int err = 0;
 
     if (!csm || !lif)
         return 0;
@@ -209,7 +216,9 @@ add_ndisc:
     if (MLACP(csm).current_state != MLACP_STATE_EXCHANGE)
         return 0;
 
-    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+    iccp_netlink_neighbor_batch_begin();
+    /* find the ND for lif_list */
+    for (msg = mlacp_ndisc_first_on_if(csm, lif->name); msg; msg = mlacp_ndisc_next_on_if(msg))
     {
         mac_str[0] = '\0';
         ndisc_msg = (struct NDISCMsg *)msg->buf;
@@ -218,37 +227,34 @@ add_ndisc:
         if (ndisc_msg->op_type == NEIGH_SYNC_DEL)
             continue;
 
-        /* find the ND for lif_list */
-        if (strcmp(lif->name, ndisc_msg->ifname) != 0)
-            continue;
-
         sprintf(mac_str, "%02x:%02x:%02x:%02x:%02x:%02x", ndisc_msg->mac_addr[0], ndisc_msg->mac_addr[1], ndisc_msg->mac_addr[2],
                 ndisc_msg->mac_addr[3], ndisc_msg->mac_addr[4], ndisc_msg->mac_addr[5]);
 
-        err = iccp_netlink_neighbor_request(AF_INET6, (uint8_t *)ndisc_msg->ipv6_addr, 1, ndisc_msg->mac_addr, ndisc_msg->ifname, 0, 6);
-        ICCPD_LOG_NOTICE(__FUNCTION__, "Add dynamic ND to kernel [%s], status %d", show_ipv6_str((char *)ndisc_msg->ipv6_addr), err);
+        /* Batched, the kernel result is logged when the batch is flushed */
+        iccp_netlink_neighbor_request(AF_INET6, (uint8_t *)ndisc_msg->ipv6_addr, 1, ndisc_msg->mac_addr, ndisc_msg->ifname, 0, 6);
+        ICCPD_LOG_NOTICE(__FUNCTION__, "Add dynamic ND to kernel [%s]", show_ipv6_str((char *)ndisc_msg->ipv6_addr));
     }
+    iccp_netlink_neighbor_batch_end();
     goto done;
 
 del_ndisc:
     /* Process Del */
-    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+    iccp_netlink_neighbor_batch_begin();
+    /* find the ND for lif_list */
+    for (msg = mlacp_ndisc_first_on_if(csm, lif->name); msg; msg = mlacp_ndisc_next_on_if(msg))
     {
         ndisc_msg = (struct NDISCMsg *)msg->buf;
 
-        /* find the ND for lif_list */
-        if (strcmp(lif->name, ndisc_msg->ifname) != 0)
-            continue;
-
         /* don't process del */
         if (ndisc_msg->op_type == NEIGH_SYNC_DEL)
             continue;
 
-        err = iccp_netlink_neighbor_request(AF_INET6, (uint8_t *)ndisc_msg->ipv6_addr, 1, ndisc_msg->mac_addr, ndisc_msg->ifname, 0, 7);
+        iccp_netlink_neighbor_request(AF_INET6, (uint8_t *)ndisc_msg->ipv6_addr, 1, ndisc_msg->mac_addr, ndisc_msg->ifname, 0, 7);
 
         /* link broken, del all dynamic ndisc on the lif */
-        ICCPD_LOG_NOTICE(__FUNCTION__, "Del dynamic ND [%s], status %d", show_ipv6_str((char *)ndisc_msg->ipv6_addr), err);
+        ICCPD_LOG_NOTICE(__FUNCTION__, "Del dynamic ND [%s]", show_ipv6_str((char *)ndisc_msg->ipv6_addr));
     }
+    iccp_netlink_neighbor_batch_end();
 
 done:
     return 0;
@@ -361,6 +367,51 @@ static int peer_po_is_alive(struct CSM *csm, int po_ifindex)
     return pif_active;
 }
 
+/* Send the FDB entries coalesced so far as one SET_FDB message */
+static void iccp_fdb_batch_send(void)
+{
+    struct IccpSyncdHDr * msg_hdr;
+    struct System *sys;
+    ssize_t rc;
+
+    if (g_iccp_fdb_batch_count == 0)
+        return;
+
+    msg_hdr = (struct IccpSyncdHDr *)g_iccp_fdb_batch_buf;
+    msg_hdr->ver = ICCPD_TO_MCLAGSYNCD_HDR_VERSION;
+    msg_hdr->type = MCLAG_MSG_TYPE_SET_FDB;
+    msg_hdr->len = sizeof(struct IccpSyncdHDr) + g_iccp_fdb_batch_count * sizeof(struct mclag_fdb_info);
+    g_iccp_fdb_batch_count = 0;
+
+    if ((sys = system_get_instance()) == NULL)
+        return;
+
+    if (sys->sync_fd > 0 )
+    {
+        rc = iccp_send_to_mclagsyncd(msg_hdr->type, g_iccp_fdb_batch_buf, msg_hdr->len);
+        if (rc <= 0)
+        {
+            ICCPD_LOG_WARN(__FUNCTION__, "Send to Mclagsyncd failed rc: %d",rc);
+        }
+    }
+    else
+    {
+        SYSTEM_SET_SYNCD_TX_DBG_COUNTER(sys, msg_hdr->type, ICCP_DBG_CNTR_STS_ERR);
+        ICCPD_LOG_ERR(__FUNCTION__, "Invalid sync_fd Failed to write, fd %d", sys->sync_fd);
+    }
+}
+
+static void iccp_fdb_batch_begin(void)
+{
+    g_iccp_fdb_batch_open = 1;
+}
+
+static void iccp_fdb_batch_flush(void)
+{
+    iccp_fdb_batch_send();
+    g_iccp_fdb_batch_open = 0;
+}
+
 // return -1 if failed
 ssize_t iccp_send_to_mclagsyncd(uint8_t msg_type, char *send_buff, uint16_t msg_len)
 {
@@ -377,6 +428,10 @@ ssize_t iccp_send_to_mclagsyncd(uint8_t msg_type, char *send_buff, uint16_t msg_
         return MCLAG_ERROR;
     }
 
+    /* Keep mclagsyncd seeing messages in order behind pending FDB writes */
+    if (msg_type != MCLAG_MSG_TYPE_SET_FDB)
+        iccp_fdb_batch_send();
+
     if (sys->sync_fd)
     {
         while (msg_len > 0)
@@ -507,19 +562,12 @@ void set_peerlink_mlag_port_learn(struct LocalInterface *lif, int enable)
     /*send msg*/
     if (sys->sync_fd)
     {
-        rc = write(sys->sync_fd,msg_buf, msg_hdr->len);
+        rc = iccp_send_to_mclagsyncd(msg_hdr->type, msg_buf, msg_hdr->len);
         if ((rc <= 0) || (rc != msg_hdr->len))
         {
-            SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                sys, msg_hdr->type, ICCP_DBG_CNTR_STS_ERR);
             ICCPD_LOG_ERR(__FUNCTION__, "Failed to write for %s, rc %d",
                 lif->name, rc);
         }
-        else
-        {
-            SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                sys, msg_hdr->type, ICCP_DBG_CNTR_STS_OK);
-        }
     }
     return;
 }
@@ -808,7 +856,7 @@ int mlacp_link_del_iccp_info(
     msg_hdr->len += (sizeof(mclag_sub_option_hdr_t) + sub_msg->op_len);
 
     if (sys->sync_fd)
-        rc = send(sys->sync_fd,msg_buf, msg_hdr->len, MSG_DONTWAIT);
+        rc = iccp_send_to_mclagsyncd(msg_hdr->type, msg_buf, msg_hdr->len);
 
     if ((rc <= 0) || (rc != msg_hdr->len))
     {
@@ -1168,18 +1216,11 @@ void update_peerlink_isolate_from_all_csm_lif(
     /*send msg*/
     if (sys->sync_fd)
     {
-        rc = write(sys->sync_fd,msg_buf, msg_hdr->len);
+        rc = iccp_send_to_mclagsyncd(msg_hdr->type, msg_buf, msg_hdr->len);
         if ((rc <= 0) || (rc != msg_hdr->len))
         {
-            SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                sys, msg_hdr->type, ICCP_DBG_CNTR_STS_ERR);
             ICCPD_LOG_ERR(__FUNCTION__, "Failed to write, rc %d", rc);
         }
-        else
-        {
-            SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                sys, msg_hdr->type, ICCP_DBG_CNTR_STS_OK);
-        }
     }
 
     return;
@@ -1460,7 +1501,7 @@ int is_local_vlan_on(struct VLAN_ID* vlan_id_list)
 void syn_arp_info_to_peer(struct CSM *csm, struct LocalInterface *local_if)
 {
     struct Msg *msg = NULL;
-    struct ARPMsg *arp_msg = NULL, *arp_info = NULL;
+    struct ARPMsg *arp_msg = NULL;
     struct Msg *msg_send = NULL;
 
     if (!csm || !local_if)
@@ -1468,13 +1509,8 @@ void syn_arp_info_to_peer(struct CSM *csm, struct LocalInterface *local_if)
 
     if (!TAILQ_EMPTY(&(MLACP(csm).arp_list)))
     {
-        TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+        for (msg = mlacp_arp_first_on_if(csm, local_if->name); msg; msg = mlacp_arp_next_on_if(msg))
         {
-            arp_info = (struct ARPMsg*)msg->buf;
-
-            if (strcmp(arp_info->ifname, local_if->name) != 0)
-                continue;
-
             arp_msg = (struct ARPMsg*)msg->buf;
             arp_msg->op_type = NEIGH_SYNC_ADD;
             arp_msg->flag = 0;
@@ -1497,7 +1533,7 @@ void syn_arp_info_to_peer(struct CSM *csm, struct LocalInterface *local_if)
 void syn_ndisc_info_to_peer(struct CSM *csm, struct LocalInterface *local_if)
 {
     struct Msg *msg = NULL;
-    struct NDISCMsg *ndisc_msg = NULL, *ndisc_info = NULL;
+    struct NDISCMsg *ndisc_msg = NULL;
     struct Msg *msg_send = NULL;
 
     if (!csm || !local_if)
@@ -1505,13 +1541,8 @@ void syn_ndisc_info_to_peer(struct CSM *csm, struct LocalInterface *local_if)
 
     if (!TAILQ_EMPTY(&(MLACP(csm).ndisc_list)))
     {
-        TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+        for (msg = mlacp_ndisc_first_on_if(csm, local_if->name); msg; msg = mlacp_ndisc_next_on_if(msg))
         {
-            ndisc_info = (struct NDISCMsg *)msg->buf;
-
-            if (strcmp(ndisc_info->ifname, local_if->name) != 0)
-                continue;
-
             ndisc_msg = (struct NDISCMsg *)msg->buf;
             ndisc_msg->op_type = NEIGH_SYNC_ADD;
             ndisc_msg->flag = 0;
@@ -1621,6 +1652,29 @@ void iccp_send_fdb_entry_to_syncd( struct MACMsg* mac_msg, uint8_t mac_type, uin
         return;
     }
 
+    /* Inside an FDB batch, append the entry and send once the message is full */
+    if (g_iccp_fdb_batch_open)
+    {
+        mac_info = (struct mclag_fdb_info *)&g_iccp_fdb_batch_buf[sizeof(struct IccpSyncdHDr)];
+        mac_info += g_iccp_fdb_batch_count++;
+        memset(mac_info, 0, sizeof(struct mclag_fdb_info));
+        mac_info->vid = mac_msg->vid;
+        memcpy(mac_info->port_name, mac_msg->ifname, MAX_L_PORT_NAME);
+        memcpy(mac_info->mac, mac_msg->mac_addr, ETHER_ADDR_LEN);
+        mac_info->type = mac_type;
+        mac_info->op_type = oper;
+
+        ICCPD_LOG_DEBUG("ICCP_FDB", "Send fdb to syncd: batch mac msg vid : %d ; ifname %s ; mac %s fdb type %d ; op type %s",
+            mac_info->vid, mac_info->port_name, mac_addr_to_str(mac_info->mac), mac_info->type,
+            oper == MAC_SYNC_ADD ? "add" : "del");
+
+        if (g_iccp_fdb_batch_count >= ICCP_FDB_BATCH_MAX_ENTRY)
+            iccp_fdb_batch_send();
+
+        mac_msg->add_to_syncd = (oper == MAC_SYNC_DEL) ? 0 : 1;
+        return;
+    }
+
     memset(msg_buf, 0, ICCP_MLAGSYNCD_SEND_MSG_BUFFER_SIZE);
 
     msg_hdr = (struct IccpSyncdHDr *)msg_buf;
@@ -2251,6 +2305,10 @@ void mlacp_peer_conn_handler(struct CSM* csm)
     sys->csm_trans_time = time(NULL);
     mlacp_conn_handler_fdb(csm);
 
+    /*Give mclagsyncd and peer time to re-report restored MACs*/
+    if (MLACP(csm).warm_restored && MLACP(csm).warm_reconcile_time == 0)
+        MLACP(csm).warm_reconcile_time = time(NULL) + ICCP_WARMBOOT_RECONCILE_SEC;
+
     LIST_FOREACH(lif, &(MLACP(csm).lif_list), mlacp_next)
     {
         if (lif->type == IF_T_PORT_CHANNEL)
@@ -2650,28 +2708,81 @@ int iccp_get_receive_fdb_sock_fd(struct System *sys)
     return sys->sync_fd;
 }
 
-/*When received MAC add and del packets from mclagsyncd, update mac information*/
-void do_mac_update_from_syncd(uint8_t mac_addr[ETHER_ADDR_LEN], uint16_t vid, char *ifname, uint8_t fdb_type, uint8_t op_type)
+/* Interface lookups for FDB entries from mclagsyncd; a batch redoes them
+ * only when the port name changes between consecutive entries
+ */
+struct syncd_fdb_if_info
+{
+    char ifname[MAX_L_PORT_NAME];
+    struct CSM *csm;                /* first CSM, only one CSM in the system currently */
+    struct LocalInterface *lif_po;  /* MCLAG port-channel the MAC is learnt on */
+    struct LocalInterface *mac_lif; /* local interface the MAC is learnt on */
+    struct PeerInterface *pif;      /* peer interface of the same name */
+    uint8_t from_mclag_intf;        /*0: orphan port, 1: MCLAG port*/
+};
+
+static void syncd_fdb_if_info_resolve(struct System *sys, struct syncd_fdb_if_info *if_info, const char *ifname)
 {
-    struct System *sys = NULL;
     struct CSM *csm = NULL;
-    struct Msg *msg = NULL;
+    struct LocalInterface *lif_po = NULL;
+
+    memset(if_info, 0, sizeof(struct syncd_fdb_if_info));
+    snprintf(if_info->ifname, MAX_L_PORT_NAME, "%s", ifname);
+
+    /* Find MLACP itf, may be mclag enabled port-channel*/
+    LIST_FOREACH(csm, &(sys->csm_list), next)
+    {
+        if (csm && !if_info->csm)
+        {
+            /*Record the first CSM, only one CSM in the system currently*/
+            if_info->csm = csm;
+        }
+
+        /*If MAC is from peer-link, break; peer-link is not in MLACP(csm).lif_list*/
+        if (strcmp(if_info->ifname, csm->peer_itf_name) == 0)
+            break;
+
+        LIST_FOREACH(lif_po, &(MLACP(csm).lif_list), mlacp_next)
+        {
+            if (lif_po->type != IF_T_PORT_CHANNEL)
+                continue;
+
+            if (strcmp(lif_po->name, if_info->ifname) == 0)
+            {
+                if_info->from_mclag_intf = 1;
+                if_info->lif_po = lif_po;
+                break;
+            }
+        }
+
+        if (if_info->from_mclag_intf == 1)
+            break;
+    }
+
+    if (!if_info->csm)
+        return;
+
+    /*If support multiple CSM, the MAC list of orphan port must be moved to sys->mac_rb*/
+    if_info->pif = peer_if_find_by_name(if_info->csm, if_info->ifname);
+    if_info->mac_lif = local_if_find_by_name(if_info->ifname);
+}
+
+/*When received MAC add and del packets from mclagsyncd, update mac information*/
+static void do_mac_update_from_syncd(struct syncd_fdb_if_info *if_info, uint8_t mac_addr[ETHER_ADDR_LEN],
+                                     uint16_t vid, uint8_t fdb_type, uint8_t op_type)
+{
+    struct CSM *csm = if_info->csm;
     struct MACMsg *mac_msg = NULL, *mac_info = NULL, *new_mac_msg = NULL;
+    struct MACMsg mac_msg_buf;
     struct MACMsg mac_find;
     uint8_t mac_exist = 0;
-    char buf[MAX_BUFSIZE];
     size_t msg_len = 0;
-    uint8_t from_mclag_intf = 0;/*0: orphan port, 1: MCLAG port*/
-    struct CSM *first_csm = NULL;
+    char *ifname = if_info->ifname;
+    uint8_t from_mclag_intf = if_info->from_mclag_intf;
+    struct PeerInterface *pif = if_info->pif;
     uint8_t null_mac[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 
-    struct LocalInterface *lif_po = NULL, *mac_lif = NULL;
-
-    if (!(sys = system_get_instance()))
-    {
-        ICCPD_LOG_ERR(__FUNCTION__, "Invalid system instance");
-        return;
-    }
+    struct LocalInterface *lif_po = if_info->lif_po, *mac_lif = NULL;
 
     if (memcmp(mac_addr, null_mac, ETHER_ADDR_LEN) == 0)
     {
@@ -2680,9 +2791,9 @@ void do_mac_update_from_syncd(uint8_t mac_addr[ETHER_ADDR_LEN], uint16_t vid, ch
     }
 
     /* create MAC msg*/
-    memset(buf, 0, MAX_BUFSIZE);
+    memset(&mac_msg_buf, 0, sizeof(struct MACMsg));
     msg_len = sizeof(struct MACMsg);
-    mac_msg = (struct MACMsg*)buf;
+    mac_msg = &mac_msg_buf;
     mac_msg->op_type = op_type;
     mac_msg->fdb_type = fdb_type;
     memcpy(mac_msg->mac_addr, mac_addr, ETHER_ADDR_LEN);
@@ -2704,44 +2815,9 @@ void do_mac_update_from_syncd(uint8_t mac_addr[ETHER_ADDR_LEN], uint16_t vid, ch
     fprintf(stderr, "==============================\n");
     #endif
 
-    /* Find MLACP itf, may be mclag enabled port-channel*/
-    LIST_FOREACH(csm, &(sys->csm_list), next)
-    {
-        if (csm && !first_csm)
-        {
-            /*Record the first CSM, only one CSM in the system currently*/
-            first_csm = csm;
-        }
-
-        /*If MAC is from peer-link, break; peer-link is not in MLACP(csm).lif_list*/
-        if (strcmp(ifname, csm->peer_itf_name) == 0)
-            break;
-
-        LIST_FOREACH(lif_po, &(MLACP(csm).lif_list), mlacp_next)
-        {
-            if (lif_po->type != IF_T_PORT_CHANNEL)
-                continue;
-
-            if (strcmp(lif_po->name, ifname) == 0)
-            {
-                from_mclag_intf = 1;
-                break;
-            }
-        }
-
-        if (from_mclag_intf == 1)
-            break;
-    }
-
-    if (!first_csm)
+    if (!csm)
         return;
 
-    /*If support multiple CSM, the MAC list of orphan port must be moved to sys->mac_rb*/
-    csm = first_csm;
-
-    struct PeerInterface* pif = NULL;
-    pif = peer_if_find_by_name(csm, ifname);
-
     memset(&mac_find, 0, sizeof(struct MACMsg));
     mac_find.vid = vid;
     memcpy(mac_find.mac_addr,mac_addr, ETHER_ADDR_LEN);
@@ -2759,7 +2835,7 @@ void do_mac_update_from_syncd(uint8_t mac_addr[ETHER_ADDR_LEN], uint16_t vid, ch
     if (op_type == MAC_SYNC_ADD)
     {
         /* Find local itf*/
-        if (!(mac_lif = local_if_find_by_name(ifname)))
+        if (!(mac_lif = if_info->mac_lif))
         {
             ICCPD_LOG_ERR(__FUNCTION__, " interface %s not present failed "
                 "to add MAC %s vlan %d", ifname, mac_addr_to_str(mac_addr), vid);
@@ -2780,6 +2856,8 @@ void do_mac_update_from_syncd(uint8_t mac_addr[ETHER_ADDR_LEN], uint16_t vid, ch
         /*same MAC exist*/
         if (mac_exist)
         {
+            mac_info->warm_stale = 0;
+
             /*If the current mac port is peer-link, it will handle by port up event*/
             /*if(strcmp(csm->peer_itf_name, mac_info->ifname) == 0)
                {
@@ -3055,6 +3133,41 @@ void do_mac_update_from_syncd(uint8_t mac_addr[ETHER_ADDR_LEN], uint16_t vid, ch
     return;
 }
 
+
+/* Apply a vector of FDB entries received from mclagsyncd. Interface
+ * lookups are shared by consecutive entries on the same port, and the
+ * FDB writes they trigger go back to mclagsyncd coalesced.
+ */
+void do_mac_batch_update_from_syncd(struct mclag_fdb_info *fdb_info, int count)
+{
+    struct System *sys = NULL;
+    struct syncd_fdb_if_info if_info;
+    int resolved = 0;
+    int i = 0;
+
+    if (!(sys = system_get_instance()))
+    {
+        ICCPD_LOG_ERR(__FUNCTION__, "Invalid system instance");
+        return;
+    }
+
+    iccp_fdb_batch_begin();
+
+    for (i = 0; i < count; i++)
+    {
+        if (!resolved || strncmp(if_info.ifname, fdb_info[i].port_name, MAX_L_PORT_NAME) != 0)
+        {
+            syncd_fdb_if_info_resolve(sys, &if_info, fdb_info[i].port_name);
+            resolved = 1;
+        }
+
+        do_mac_update_from_syncd(&if_info, fdb_info[i].mac, fdb_info[i].vid,
+                                 fdb_info[i].type, fdb_info[i].op_type);
+    }
+
+    iccp_fdb_batch_flush();
+}
+
 int iccp_mclagsyncd_mclag_domain_cfg_handler(struct System *sys, char *msg_buf)
 {
     struct IccpSyncdHDr * msg_hdr;
@@ -3329,7 +3442,6 @@ int iccp_mclagsyncd_vlan_mbr_update_handler(struct System *sys, char *msg_buf)
 int iccp_receive_fdb_handler_from_syncd(struct System *sys, char *msg_buf)
 {
     int count = 0;
-    int i = 0;
     struct IccpSyncdHDr * msg_hdr;
     struct mclag_fdb_info * mac_info;
 
@@ -3338,12 +3450,9 @@ int iccp_receive_fdb_handler_from_syncd(struct System *sys, char *msg_buf)
     count = (msg_hdr->len- sizeof(struct IccpSyncdHDr))/sizeof(struct mclag_fdb_info);
     ICCPD_LOG_DEBUG(__FUNCTION__, "recv msg fdb count %d   ",count );
 
-    for (i =0; i<count;i++)
-    {
-        mac_info = (struct mclag_fdb_info *)&msg_buf[sizeof(struct IccpSyncdHDr )+ i * sizeof(struct mclag_fdb_info)];
+    mac_info = (struct mclag_fdb_info *)&msg_buf[sizeof(struct IccpSyncdHDr)];
+    do_mac_batch_update_from_syncd(mac_info, count);
 
-        do_mac_update_from_syncd(mac_info->mac, mac_info->vid, mac_info->port_name, mac_info->type, mac_info->op_type);
-    }
     return 0;
 }
 
@@ -3668,6 +3777,21 @@ char * mclagd_ctl_cmd_str(int req_type)
         case INFO_TYPE_CONFIG_LOGLEVEL:
             return "config loglevel";
 
+        case INFO_TYPE_DUMP_ARP_PAGE:
+            return "dump arp page";
+
+        case INFO_TYPE_DUMP_NDISC_PAGE:
+            return "dump nd page";
+
+        case INFO_TYPE_DUMP_MAC_PAGE:
+            return "dump mac page";
+
+        case INFO_TYPE_DUMP_PERF:
+            return "dump perf";
+
+        case INFO_TYPE_CLEAR_PERF:
+            return "clear perf";
+
         default:
             break;
     }
@@ -3963,6 +4087,70 @@ void mclagd_ctl_handle_dump_mac(int client_fd, int mclag_id)
     return;
 }
 
+/* Serve one page of a table dump. The reply is built in a pre-sized
+ * buffer and the handler returns to the event loop after each page, so a
+ * large table no longer stalls iccpd for the whole dump.
+ */
+void mclagd_ctl_handle_dump_page(int client_fd, struct mclagdctl_req_hdr *req)
+{
+    static char buf[MCLAGD_DUMP_PAGE_BUF_SIZE];
+    struct mclagd_reply_hdr *hd = (struct mclagd_reply_hdr *)(buf + sizeof(int));
+    struct mclagd_dump_page *page = (struct mclagd_dump_page *)(buf + MCLAGD_REPLY_INFO_HDR);
+    char *data = (char *)(page + 1);
+    int entry_size = 0;
+    int num = 0;
+    int more = 0;
+    int ret = EXEC_TYPE_FAILED;
+    int len_tmp = 0;
+    int version = 0;
+
+    memset(page, 0, sizeof(struct mclagd_dump_page));
+    memcpy(&page->next, req->para1, sizeof(struct mclagd_dump_cursor));
+    memcpy(&version, req->para2, sizeof(int));
+    page->version = MCLAGD_DUMP_PAGE_VERSION;
+
+    switch (version == MCLAGD_DUMP_PAGE_VERSION ? req->info_type : INFO_TYPE_NONE)
+    {
+        case INFO_TYPE_DUMP_ARP_PAGE:
+            entry_size = sizeof(struct mclagd_arp_msg);
+            ret = iccp_arp_dump_page(data, MCLAGD_DUMP_PAGE_ENTRIES, &page->next, req->mclag_id, &num, &more);
+            break;
+
+        case INFO_TYPE_DUMP_NDISC_PAGE:
+            entry_size = sizeof(struct mclagd_ndisc_msg);
+            ret = iccp_ndisc_dump_page(data, MCLAGD_DUMP_PAGE_ENTRIES, &page->next, req->mclag_id, &num, &more);
+            break;
+
+        case INFO_TYPE_DUMP_MAC_PAGE:
+            entry_size = sizeof(struct mclagd_mac_msg);
+            ret = iccp_mac_dump_page(data, MCLAGD_DUMP_PAGE_ENTRIES, &page->next, req->mclag_id, &num, &more);
+            break;
+
+        default:
+            break;
+    }
+
+    hd->exec_result = ret;
+    hd->info_type = req->info_type;
+    if (ret == EXEC_TYPE_SUCCESS)
+    {
+        page->count = num;
+        page->more = more;
+        hd->data_len = sizeof(struct mclagd_dump_page) + num * entry_size;
+    }
+    else
+    {
+        /* The version still goes back, so the client can fall back */
+        hd->data_len = sizeof(struct mclagd_dump_page);
+    }
+
+    len_tmp = hd->data_len + sizeof(struct mclagd_reply_hdr);
+    memcpy(buf, &len_tmp, sizeof(int));
+    mclagd_ctl_sock_write(client_fd, buf, MCLAGD_REPLY_INFO_HDR + hd->data_len);
+
+    return;
+}
+
 void mclagd_ctl_handle_dump_local_portlist(int client_fd, int mclag_id)
 {
     char * Pbuf = NULL;
@@ -4139,6 +4327,71 @@ void mclagd_ctl_handle_config_loglevel(int client_fd, int log_level)
     return;
 }
 
+void mclagd_ctl_handle_dump_perf(int client_fd, int mclag_id)
+{
+    char * Pbuf = NULL;
+    char buf[512] = {0};
+    int data_len = 0;
+    int ret = 0;
+    struct mclagd_reply_hdr *hd = NULL;
+    int len_tmp = 0;
+
+    ret = iccp_cmd_perf_dump(&Pbuf, &data_len);
+    if (ret != EXEC_TYPE_SUCCESS)
+    {
+        len_tmp = sizeof(struct mclagd_reply_hdr);
+        memcpy(buf, &len_tmp, sizeof(int));
+        hd = (struct mclagd_reply_hdr *)(buf + sizeof(int));
+        hd->exec_result = ret;
+        hd->info_type = INFO_TYPE_DUMP_PERF;
+        hd->data_len = 0;
+        mclagd_ctl_sock_write(client_fd, buf, MCLAGD_REPLY_INFO_HDR);
+
+        if (Pbuf)
+            free(Pbuf);
+        return;
+    }
+
+    hd = (struct mclagd_reply_hdr *)(Pbuf + sizeof(int));
+    hd->exec_result = EXEC_TYPE_SUCCESS;
+    hd->info_type = INFO_TYPE_DUMP_PERF;
+    hd->data_len = data_len;
+    len_tmp = (hd->data_len + sizeof(struct mclagd_reply_hdr));
+    memcpy(Pbuf, &len_tmp, sizeof(int));
+    mclagd_ctl_sock_write(client_fd, Pbuf, MCLAGD_REPLY_INFO_HDR + hd->data_len);
+
+    if (Pbuf)
+       free(Pbuf);
+}
+
+void mclagd_ctl_handle_clear_perf(int client_fd, int mclag_id)
+{
+    char buf[sizeof(struct mclagd_reply_hdr)+sizeof(int)];
+    struct mclagd_reply_hdr *hd = NULL;
+    struct System *sys = NULL;
+    int len_tmp = 0;
+
+    len_tmp = sizeof(struct mclagd_reply_hdr);
+    memcpy(buf, &len_tmp, sizeof(int));
+    hd = (struct mclagd_reply_hdr *)(buf + sizeof(int));
+    hd->info_type = INFO_TYPE_CLEAR_PERF;
+    hd->data_len = 0;
+
+    if ((sys = system_get_instance()) != NULL)
+    {
+        system_perf_reset(sys);
+        hd->exec_result = EXEC_TYPE_SUCCESS;
+    }
+    else
+    {
+        hd->exec_result = EXEC_TYPE_NO_EXIST_SYS;
+    }
+
+    mclagd_ctl_sock_write(client_fd, buf, MCLAGD_REPLY_INFO_HDR);
+
+    return;
+}
+
 int mclagd_ctl_interactive_process(int client_fd)
 {
     char buf[512] = { 0 };
@@ -4196,6 +4449,20 @@ int mclagd_ctl_interactive_process(int client_fd)
             mclagd_ctl_handle_config_loglevel(client_fd, req->mclag_id);
             break;
 
+        case INFO_TYPE_DUMP_ARP_PAGE:
+        case INFO_TYPE_DUMP_NDISC_PAGE:
+        case INFO_TYPE_DUMP_MAC_PAGE:
+            mclagd_ctl_handle_dump_page(client_fd, req);
+            break;
+
+        case INFO_TYPE_DUMP_PERF:
+            mclagd_ctl_handle_dump_perf(client_fd, req->mclag_id);
+            break;
+
+        case INFO_TYPE_CLEAR_PERF:
+            mclagd_ctl_handle_clear_perf(client_fd, req->mclag_id);
+            break;
+
         default:
             return MCLAG_ERROR;
     }
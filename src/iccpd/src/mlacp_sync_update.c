@@ -31,6 +31,7 @@
 #include "../include/mlacp_tlv.h"
 #include "../include/iccp_csm.h"
 #include "../include/mlacp_link_handler.h"
+#include "../include/mlacp_sync_update.h"
 #include "../include/iccp_netlink.h"
 #include "../include/iccp_consistency_check.h"
 #include "../include/port.h"
@@ -132,7 +133,7 @@ int mlacp_fsm_update_Agg_conf(struct CSM* csm, mLACPAggConfigTLV* portconf)
     }
 
     pif->po_id = ntohs(portconf->agg_id);
-    memcpy(pif->name, portconf->agg_name, portconf->agg_name_len);
+    peer_if_set_name(csm, pif, portconf->agg_name, portconf->agg_name_len);
     memcpy(pif->mac_addr, portconf->mac_addr, ETHER_ADDR_LEN);
 
     po_active = (pif->state == PORT_STATE_UP);
@@ -262,6 +263,7 @@ int mlacp_fsm_update_mac_entry_from_peer( struct CSM* csm, struct mLACPMACData *
         if (MacData->type == MAC_SYNC_ADD)
         {
             mac_msg->age_flag &= ~MAC_AGE_PEER;
+            mac_msg->warm_stale = 0;
 
             if (from_mclag_intf && mac_msg->pending_local_del)
             {
@@ -575,6 +577,7 @@ int mlacp_fsm_update_mac_info_from_peer(struct CSM* csm, struct mLACPMACInfoTLV*
 void mlacp_enqueue_arp(struct CSM* csm, struct Msg* msg)
 {
     struct ARPMsg *arp_msg = NULL;
+    struct Msg *old_msg = NULL;
 
     if (!csm)
     {
@@ -588,12 +591,116 @@ void mlacp_enqueue_arp(struct CSM* csm, struct Msg* msg)
     arp_msg = (struct ARPMsg*)msg->buf;
     if (arp_msg->op_type != NEIGH_SYNC_DEL)
     {
+        /* Keep list and index in step, a stale entry for the same IP is replaced */
+        old_msg = RB_FIND(arp_rb_tree, &MLACP(csm).arp_rb, msg);
+        if (old_msg)
+            mlacp_dequeue_arp(csm, old_msg);
+
         TAILQ_INSERT_TAIL(&(MLACP(csm).arp_list), msg, tail);
+        RB_INSERT(arp_rb_tree, &MLACP(csm).arp_rb, msg);
+        RB_INSERT(arp_if_rb_tree, &MLACP(csm).arp_if_rb, msg);
     }
 
     return;
 }
 
+/*****************************************
+ * Tool : Remove and free ARP Info from ARP list
+ *
+ ****************************************/
+void mlacp_dequeue_arp(struct CSM* csm, struct Msg* msg)
+{
+    if (!csm || !msg)
+        return;
+
+    RB_REMOVE(arp_if_rb_tree, &MLACP(csm).arp_if_rb, msg);
+    RB_REMOVE(arp_rb_tree, &MLACP(csm).arp_rb, msg);
+    TAILQ_REMOVE(&(MLACP(csm).arp_list), msg, tail);
+    free(msg->buf);
+    free(msg);
+
+    return;
+}
+
+/*****************************************
+ * Tool : Find ARP Info by IPv4 address (net order)
+ *
+ ****************************************/
+struct Msg* mlacp_arp_find(struct CSM* csm, uint32_t ipv4_addr)
+{
+    struct Msg key;
+    struct ARPMsg arp_key;
+
+    if (!csm)
+        return NULL;
+
+    arp_key.ipv4_addr = ipv4_addr;
+    key.buf = (char *)&arp_key;
+
+    return RB_FIND(arp_rb_tree, &MLACP(csm).arp_rb, &key);
+}
+
+/*****************************************
+ * Tool : Walk ARP Info learned on one interface
+ *
+ ****************************************/
+struct Msg* mlacp_arp_first_on_if(struct CSM* csm, const char* ifname)
+{
+    struct Msg key;
+    struct ARPMsg arp_key;
+    struct Msg* msg = NULL;
+
+    if (!csm || !ifname)
+        return NULL;
+
+    memset(&arp_key, 0, sizeof(arp_key));
+    snprintf(arp_key.ifname, sizeof(arp_key.ifname), "%s", ifname);
+    key.buf = (char *)&arp_key;
+
+    msg = RB_NFIND(arp_if_rb_tree, &MLACP(csm).arp_if_rb, &key);
+    if (msg && strncmp(((struct ARPMsg*)msg->buf)->ifname, arp_key.ifname, MAX_L_PORT_NAME) != 0)
+        return NULL;
+
+    return msg;
+}
+
+struct Msg* mlacp_arp_next_on_if(struct Msg* msg)
+{
+    struct Msg* next = NULL;
+
+    if (!msg)
+        return NULL;
+
+    next = RB_NEXT(arp_if_rb_tree, msg);
+    if (next && strncmp(((struct ARPMsg*)next->buf)->ifname,
+                        ((struct ARPMsg*)msg->buf)->ifname, MAX_L_PORT_NAME) != 0)
+        return NULL;
+
+    return next;
+}
+
+/*****************************************
+ * Tool : Move ARP Info to another interface
+ *
+ ****************************************/
+void mlacp_arp_set_ifname(struct CSM* csm, struct Msg* msg, const char* ifname)
+{
+    struct ARPMsg *arp_msg = NULL;
+
+    if (!csm || !msg || !ifname)
+        return;
+
+    arp_msg = (struct ARPMsg*)msg->buf;
+    if (strncmp(arp_msg->ifname, ifname, MAX_L_PORT_NAME) == 0)
+        return;
+
+    RB_REMOVE(arp_if_rb_tree, &MLACP(csm).arp_if_rb, msg);
+    snprintf(arp_msg->ifname, sizeof(arp_msg->ifname), "%s", ifname);
+    RB_INSERT(arp_if_rb_tree, &MLACP(csm).arp_if_rb, msg);
+
+    return;
+}
+
 /*****************************************
  * Tool : Add Ndisc Info into ndisc list
  *
@@ -601,6 +708,7 @@ void mlacp_enqueue_arp(struct CSM* csm, struct Msg* msg)
 void mlacp_enqueue_ndisc(struct CSM *csm, struct Msg *msg)
 {
     struct NDISCMsg *ndisc_msg = NULL;
+    struct Msg *old_msg = NULL;
 
     if (!csm)
     {
@@ -614,12 +722,116 @@ void mlacp_enqueue_ndisc(struct CSM *csm, struct Msg *msg)
     ndisc_msg = (struct NDISCMsg *)msg->buf;
     if (ndisc_msg->op_type != NEIGH_SYNC_DEL)
     {
+        /* Keep list and index in step, a stale entry for the same IP is replaced */
+        old_msg = RB_FIND(ndisc_rb_tree, &MLACP(csm).ndisc_rb, msg);
+        if (old_msg)
+            mlacp_dequeue_ndisc(csm, old_msg);
+
         TAILQ_INSERT_TAIL(&(MLACP(csm).ndisc_list), msg, tail);
+        RB_INSERT(ndisc_rb_tree, &MLACP(csm).ndisc_rb, msg);
+        RB_INSERT(ndisc_if_rb_tree, &MLACP(csm).ndisc_if_rb, msg);
     }
 
     return;
 }
 
+/*****************************************
+ * Tool : Remove and free Ndisc Info from ndisc list
+ *
+ ****************************************/
+void mlacp_dequeue_ndisc(struct CSM *csm, struct Msg *msg)
+{
+    if (!csm || !msg)
+        return;
+
+    RB_REMOVE(ndisc_if_rb_tree, &MLACP(csm).ndisc_if_rb, msg);
+    RB_REMOVE(ndisc_rb_tree, &MLACP(csm).ndisc_rb, msg);
+    TAILQ_REMOVE(&(MLACP(csm).ndisc_list), msg, tail);
+    free(msg->buf);
+    free(msg);
+
+    return;
+}
+
+/*****************************************
+ * Tool : Find Ndisc Info by IPv6 address
+ *
+ ****************************************/
+struct Msg *mlacp_ndisc_find(struct CSM *csm, uint32_t *ipv6_addr)
+{
+    struct Msg key;
+    struct NDISCMsg ndisc_key;
+
+    if (!csm || !ipv6_addr)
+        return NULL;
+
+    memcpy(ndisc_key.ipv6_addr, ipv6_addr, 16);
+    key.buf = (char *)&ndisc_key;
+
+    return RB_FIND(ndisc_rb_tree, &MLACP(csm).ndisc_rb, &key);
+}
+
+/*****************************************
+ * Tool : Walk Ndisc Info learned on one interface
+ *
+ ****************************************/
+struct Msg *mlacp_ndisc_first_on_if(struct CSM *csm, const char *ifname)
+{
+    struct Msg key;
+    struct NDISCMsg ndisc_key;
+    struct Msg *msg = NULL;
+
+    if (!csm || !ifname)
+        return NULL;
+
+    memset(&ndisc_key, 0, sizeof(ndisc_key));
+    snprintf(ndisc_key.ifname, sizeof(ndisc_key.ifname), "%s", ifname);
+    key.buf = (char *)&ndisc_key;
+
+    msg = RB_NFIND(ndisc_if_rb_tree, &MLACP(csm).ndisc_if_rb, &key);
+    if (msg && strncmp(((struct NDISCMsg *)msg->buf)->ifname, ndisc_key.ifname, MAX_L_PORT_NAME) != 0)
+        return NULL;
+
+    return msg;
+}
+
+struct Msg *mlacp_ndisc_next_on_if(struct Msg *msg)
+{
+    struct Msg *next = NULL;
+
+    if (!msg)
+        return NULL;
+
+    next = RB_NEXT(ndisc_if_rb_tree, msg);
+    if (next && strncmp(((struct NDISCMsg *)next->buf)->ifname,
+                        ((struct NDISCMsg *)msg->buf)->ifname, MAX_L_PORT_NAME) != 0)
+        return NULL;
+
+    return next;
+}
+
+/*****************************************
+ * Tool : Move Ndisc Info to another interface
+ *
+ ****************************************/
+void mlacp_ndisc_set_ifname(struct CSM *csm, struct Msg *msg, const char *ifname)
+{
+    struct NDISCMsg *ndisc_msg = NULL;
+
+    if (!csm || !msg || !ifname)
+        return;
+
+    ndisc_msg = (struct NDISCMsg *)msg->buf;
+    if (strncmp(ndisc_msg->ifname, ifname, MAX_L_PORT_NAME) == 0)
+        return;
+
+    RB_REMOVE(ndisc_if_rb_tree, &MLACP(csm).ndisc_if_rb, msg);
+    snprintf(ndisc_msg->ifname, sizeof(ndisc_msg->ifname), "%s", ifname);
+    RB_INSERT(ndisc_if_rb_tree, &MLACP(csm).ndisc_if_rb, msg);
+
+    return;
+}
+
 /*****************************************
 * ARP-Info Update
 * ***************************************/
@@ -841,24 +1053,20 @@ int mlacp_fsm_update_arp_entry(struct CSM* csm, struct ARPMsg *arp_entry)
     }
 
     /* update ARP list*/
-    TAILQ_FOREACH(msg, &(MLACP(csm).arp_list), tail)
+    msg = mlacp_arp_find(csm, arp_entry->ipv4_addr);
+    if (msg)
     {
         arp_msg = (struct ARPMsg*)msg->buf;
-        if (arp_msg->ipv4_addr == arp_entry->ipv4_addr)
-        {
-            /*arp_msg->op_type = tlv->type;*/
-            sprintf(arp_msg->ifname, "%s", arp_entry->ifname);
-            memcpy(arp_msg->mac_addr, arp_entry->mac_addr, ETHER_ADDR_LEN);
-            break;
-        }
+        msg->warm_stale = 0;
+        /*arp_msg->op_type = tlv->type;*/
+        mlacp_arp_set_ifname(csm, msg, arp_entry->ifname);
+        memcpy(arp_msg->mac_addr, arp_entry->mac_addr, ETHER_ADDR_LEN);
     }
 
     /* delete/add ARP list*/
     if (msg && arp_entry->op_type == NEIGH_SYNC_DEL)
     {
-        TAILQ_REMOVE(&(MLACP(csm).arp_list), msg, tail);
-        free(msg->buf);
-        free(msg);
+        mlacp_dequeue_arp(csm, msg);
         /*ICCPD_LOG_INFO(__FUNCTION__, "Del arp queue successfully");*/
     }
     else if (!msg && arp_entry->op_type == NEIGH_SYNC_ADD)
@@ -912,10 +1120,13 @@ int mlacp_fsm_update_arp_info(struct CSM* csm, struct mLACPARPInfoTLV* tlv)
     count = ntohs(tlv->num_of_entry);
     ICCPD_LOG_DEBUG(__FUNCTION__, "Received ARP Info count  %d ", count );
 
+    /* Program the whole TLV into the kernel with one netlink send */
+    iccp_netlink_neighbor_batch_begin();
     for (i = 0; i < count; i++)
     {
         mlacp_fsm_update_arp_entry(csm, &(tlv->ArpEntry[i]));
     }
+    iccp_netlink_neighbor_batch_end();
 }
 
 /*****************************************
@@ -1163,24 +1374,20 @@ int mlacp_fsm_update_ndisc_entry(struct CSM *csm, struct NDISCMsg *ndisc_entry)
     }
 
     /* update NDISC list */
-    TAILQ_FOREACH(msg, &(MLACP(csm).ndisc_list), tail)
+    msg = mlacp_ndisc_find(csm, ndisc_entry->ipv6_addr);
+    if (msg)
     {
         ndisc_msg = (struct NDISCMsg *)msg->buf;
-        if (memcmp((char *)ndisc_msg->ipv6_addr, (char *)ndisc_entry->ipv6_addr, 16) == 0)
-        {
-            /* ndisc_msg->op_type = tlv->type; */
-            sprintf(ndisc_msg->ifname, "%s", ndisc_entry->ifname);
-            memcpy(ndisc_msg->mac_addr, ndisc_entry->mac_addr, ETHER_ADDR_LEN);
-            break;
-        }
+        msg->warm_stale = 0;
+        /* ndisc_msg->op_type = tlv->type; */
+        mlacp_ndisc_set_ifname(csm, msg, ndisc_entry->ifname);
+        memcpy(ndisc_msg->mac_addr, ndisc_entry->mac_addr, ETHER_ADDR_LEN);
     }
 
     /* delete/add NDISC list */
     if (msg && ndisc_entry->op_type == NEIGH_SYNC_DEL)
     {
-        TAILQ_REMOVE(&(MLACP(csm).ndisc_list), msg, tail);
-        free(msg->buf);
-        free(msg);
+        mlacp_dequeue_ndisc(csm, msg);
         /* ICCPD_LOG_INFO(__FUNCTION__, "Del ndisc queue successfully"); */
     }
     else if (!msg && ndisc_entry->op_type == NEIGH_SYNC_ADD)
@@ -1234,10 +1441,13 @@ int mlacp_fsm_update_ndisc_info(struct CSM *csm, struct mLACPNDISCInfoTLV *tlv)
     count = ntohs(tlv->num_of_entry);
     ICCPD_LOG_INFO(__FUNCTION__, "Received NDISC Info count  %d ", count);
 
+    /* Program the whole TLV into the kernel with one netlink send */
+    iccp_netlink_neighbor_batch_begin();
     for (i = 0; i < count; i++)
     {
         mlacp_fsm_update_ndisc_entry(csm, &(tlv->NdiscEntry[i]));
     }
+    iccp_netlink_neighbor_batch_end();
 }
 
 /*****************************************
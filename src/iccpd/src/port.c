@@ -46,6 +46,154 @@ static int vlan_node_compare(const struct VLAN_ID *p_vlan_node1, const struct VL
 }
 RB_GENERATE(vlan_rb_tree, VLAN_ID, vlan_entry, vlan_node_compare);
 
+static int lif_name_compare(const struct LocalInterface *lif1, const struct LocalInterface *lif2)
+{
+    return strncmp(lif1->name, lif2->name, MAX_L_PORT_NAME);
+}
+RB_GENERATE(lif_name_rb_tree, LocalInterface, name_rb, lif_name_compare);
+
+static int lif_ifindex_compare(const struct LocalInterface *lif1, const struct LocalInterface *lif2)
+{
+    if (lif1->ifindex < lif2->ifindex)
+        return -1;
+
+    if (lif1->ifindex > lif2->ifindex)
+        return 1;
+
+    return 0;
+}
+RB_GENERATE(lif_ifindex_rb_tree, LocalInterface, ifindex_rb, lif_ifindex_compare);
+
+static int lif_po_id_compare(const struct LocalInterface *lif1, const struct LocalInterface *lif2)
+{
+    if (lif1->po_id < lif2->po_id)
+        return -1;
+
+    if (lif1->po_id > lif2->po_id)
+        return 1;
+
+    return 0;
+}
+RB_GENERATE(lif_po_id_rb_tree, LocalInterface, po_id_rb, lif_po_id_compare);
+
+static int pif_name_compare(const struct PeerInterface *pif1, const struct PeerInterface *pif2)
+{
+    return strncmp(pif1->name, pif2->name, MAX_L_PORT_NAME);
+}
+RB_GENERATE(pif_name_rb_tree, PeerInterface, name_rb, pif_name_compare);
+
+static void local_if_shadow_set(struct System* sys, struct LocalInterface* lif, uint8_t key)
+{
+    if (lif->index_shadowed == 0)
+        ++sys->lif_shadowed_count;
+
+    lif->index_shadowed |= key;
+}
+
+static void local_if_shadow_clear(struct System* sys, struct LocalInterface* lif, uint8_t key)
+{
+    if (!(lif->index_shadowed & key))
+        return;
+
+    lif->index_shadowed &= ~key;
+    if (lif->index_shadowed == 0)
+        --sys->lif_shadowed_count;
+}
+
+/* Newest interface other than lif that lost the key slot to a duplicate */
+static struct LocalInterface* local_if_shadow_find(struct System* sys, struct LocalInterface* lif, uint8_t key)
+{
+    struct LocalInterface* other = NULL;
+
+    if (sys->lif_shadowed_count == 0)
+        return NULL;
+
+    LIST_FOREACH(other, &(sys->lif_list), system_next)
+    {
+        if (other == lif || !(other->index_shadowed & key))
+            continue;
+
+        if ((key == LIF_SHADOW_NAME && lif_name_compare(other, lif) == 0)
+            || (key == LIF_SHADOW_IFINDEX && lif_ifindex_compare(other, lif) == 0)
+            || (key == LIF_SHADOW_PO_ID && lif_po_id_compare(other, lif) == 0))
+            return other;
+    }
+
+    return NULL;
+}
+
+/* Index a local interface; like the head-inserted lif_list walk this
+ * replaced, a newer interface wins over an older one with the same key.
+ * The older one is marked shadowed and takes the slot back when the
+ * newer one goes away.
+ */
+static void local_if_index_add(struct System* sys, struct LocalInterface* lif)
+{
+    struct LocalInterface* old = NULL;
+
+    if ((old = RB_INSERT(lif_name_rb_tree, &sys->lif_name_rb, lif)) != NULL)
+    {
+        RB_REMOVE(lif_name_rb_tree, &sys->lif_name_rb, old);
+        RB_INSERT(lif_name_rb_tree, &sys->lif_name_rb, lif);
+        local_if_shadow_set(sys, old, LIF_SHADOW_NAME);
+    }
+
+    if (lif->ifindex > 0
+        && (old = RB_INSERT(lif_ifindex_rb_tree, &sys->lif_ifindex_rb, lif)) != NULL)
+    {
+        RB_REMOVE(lif_ifindex_rb_tree, &sys->lif_ifindex_rb, old);
+        RB_INSERT(lif_ifindex_rb_tree, &sys->lif_ifindex_rb, lif);
+        local_if_shadow_set(sys, old, LIF_SHADOW_IFINDEX);
+    }
+
+    if (lif->type == IF_T_PORT_CHANNEL && lif->po_id >= 0
+        && (old = RB_INSERT(lif_po_id_rb_tree, &sys->lif_po_id_rb, lif)) != NULL)
+    {
+        RB_REMOVE(lif_po_id_rb_tree, &sys->lif_po_id_rb, old);
+        RB_INSERT(lif_po_id_rb_tree, &sys->lif_po_id_rb, lif);
+        local_if_shadow_set(sys, old, LIF_SHADOW_PO_ID);
+    }
+}
+
+static void local_if_index_del(struct System* sys, struct LocalInterface* lif)
+{
+    struct LocalInterface* other = NULL;
+
+    if (RB_FIND(lif_name_rb_tree, &sys->lif_name_rb, lif) == lif)
+    {
+        RB_REMOVE(lif_name_rb_tree, &sys->lif_name_rb, lif);
+        if ((other = local_if_shadow_find(sys, lif, LIF_SHADOW_NAME)) != NULL)
+        {
+            RB_INSERT(lif_name_rb_tree, &sys->lif_name_rb, other);
+            local_if_shadow_clear(sys, other, LIF_SHADOW_NAME);
+        }
+    }
+
+    if (lif->ifindex > 0 && RB_FIND(lif_ifindex_rb_tree, &sys->lif_ifindex_rb, lif) == lif)
+    {
+        RB_REMOVE(lif_ifindex_rb_tree, &sys->lif_ifindex_rb, lif);
+        if ((other = local_if_shadow_find(sys, lif, LIF_SHADOW_IFINDEX)) != NULL)
+        {
+            RB_INSERT(lif_ifindex_rb_tree, &sys->lif_ifindex_rb, other);
+            local_if_shadow_clear(sys, other, LIF_SHADOW_IFINDEX);
+        }
+    }
+
+    if (lif->type == IF_T_PORT_CHANNEL && lif->po_id >= 0
+        && RB_FIND(lif_po_id_rb_tree, &sys->lif_po_id_rb, lif) == lif)
+    {
+        RB_REMOVE(lif_po_id_rb_tree, &sys->lif_po_id_rb, lif);
+        if ((other = local_if_shadow_find(sys, lif, LIF_SHADOW_PO_ID)) != NULL)
+        {
+            RB_INSERT(lif_po_id_rb_tree, &sys->lif_po_id_rb, other);
+            local_if_shadow_clear(sys, other, LIF_SHADOW_PO_ID);
+        }
+    }
+
+    /* Whatever lif itself had lost stays with the current holder */
+    local_if_shadow_clear(sys, lif, LIF_SHADOW_NAME | LIF_SHADOW_IFINDEX | LIF_SHADOW_PO_ID);
+}
+
 void local_if_init(struct LocalInterface* local_if)
 {
     if (local_if == NULL)
@@ -165,6 +313,7 @@ struct LocalInterface* local_if_create(int ifindex, char* ifname, int type, uint
                    local_if->mac_addr[3], local_if->mac_addr[4], local_if->mac_addr[5], local_if->state ? "down" : "up");
 
     LIST_INSERT_HEAD(&(sys->lif_list), local_if, system_next);
+    local_if_index_add(sys, local_if);
 
     //if there is pending vlan membership for this interface move to system lif
     move_pending_vlan_mbr_to_lif(sys, local_if);
@@ -194,7 +343,7 @@ struct LocalInterface* local_if_create(int ifindex, char* ifname, int type, uint
 struct LocalInterface* local_if_find_by_name(const char* ifname)
 {
     struct System* sys = NULL;
-    struct LocalInterface* local_if = NULL;
+    struct LocalInterface local_if_key;
 
     if (!ifname)
         return NULL;
@@ -202,47 +351,60 @@ struct LocalInterface* local_if_find_by_name(const char* ifname)
     if (!(sys = system_get_instance()))
         return NULL;
 
-    LIST_FOREACH(local_if, &(sys->lif_list), system_next)
-    {
-        if (strcmp(local_if->name, ifname) == 0)
-            return local_if;
-    }
+    snprintf(local_if_key.name, MAX_L_PORT_NAME, "%s", ifname);
 
-    return NULL;
+    return RB_FIND(lif_name_rb_tree, &sys->lif_name_rb, &local_if_key);
 }
 
 struct LocalInterface* local_if_find_by_ifindex(int ifindex)
 {
     struct System* sys = NULL;
     struct LocalInterface* local_if = NULL;
+    struct LocalInterface local_if_key;
 
     if ((sys = system_get_instance()) == NULL)
         return NULL;
 
-    LIST_FOREACH(local_if, &(sys->lif_list), system_next)
+    /* Unresolved ifindex (e.g. Vlan created from config) is not indexed */
+    if (ifindex <= 0)
     {
-        if (local_if->ifindex == ifindex)
-            return local_if;
+        LIST_FOREACH(local_if, &(sys->lif_list), system_next)
+        {
+            if (local_if->ifindex == ifindex)
+                return local_if;
+        }
+
+        return NULL;
     }
 
-    return NULL;
+    local_if_key.ifindex = ifindex;
+
+    return RB_FIND(lif_ifindex_rb_tree, &sys->lif_ifindex_rb, &local_if_key);
 }
 
 struct LocalInterface* local_if_find_by_po_id(int po_id)
 {
     struct System* sys = NULL;
-    struct LocalInterface* local_if = NULL;
+    struct LocalInterface local_if_key;
 
     if ((sys = system_get_instance()) == NULL)
         return NULL;
 
-    LIST_FOREACH(local_if, &(sys->lif_list), system_next)
-    {
-        if (local_if->type == IF_T_PORT_CHANNEL && local_if->po_id == po_id)
-            return local_if;
-    }
+    local_if_key.po_id = po_id;
 
-    return NULL;
+    return RB_FIND(lif_po_id_rb_tree, &sys->lif_po_id_rb, &local_if_key);
+}
+
+void local_if_set_ifindex(struct LocalInterface* lif, int ifindex)
+{
+    struct System* sys = NULL;
+
+    if ((sys = system_get_instance()) == NULL)
+        return;
+
+    local_if_index_del(sys, lif);
+    lif->ifindex = ifindex;
+    local_if_index_add(sys, lif);
 }
 
  void local_if_vlan_remove(struct LocalInterface *lif_vlan)
@@ -365,6 +527,7 @@ void local_if_destroy(char *ifname)
 to_sys_purge:
     /* sys purge */
     LIST_REMOVE(lif, system_next);
+    local_if_index_del(sys, lif);
     if (lif->csm)
         LIST_REMOVE(lif, mlacp_next);
     LIST_INSERT_HEAD(&(sys->lif_purge_list), lif, system_purge_next);
@@ -373,6 +536,7 @@ to_sys_purge:
 to_mlacp_purge:
     /* sys & mlacp purge */
     LIST_REMOVE(lif, system_next);
+    local_if_index_del(sys, lif);
     LIST_REMOVE(lif, mlacp_next);
     LIST_INSERT_HEAD(&(sys->lif_purge_list), lif, system_purge_next);
     LIST_INSERT_HEAD(&(MLACP(csm).lif_purge_list), lif, mlacp_purge_next);
@@ -507,13 +671,13 @@ struct PeerInterface* peer_if_create(struct CSM* csm,
     {
         peer_if->ifindex = peer_if_number;
         peer_if->type = IF_T_PORT;
-        peer_if->csm = csm;
     }
     else if (type == IF_T_PORT_CHANNEL)
     {
         peer_if->ifindex = peer_if_number;
         peer_if->type = IF_T_PORT_CHANNEL;
     }
+    peer_if->csm = csm;
 
     LIST_INSERT_HEAD(&(MLACP(csm).pif_list), peer_if, mlacp_next);
 
@@ -523,7 +687,7 @@ struct PeerInterface* peer_if_create(struct CSM* csm,
 struct PeerInterface* peer_if_find_by_name(struct CSM* csm, char* name)
 {
     struct System* sys = NULL;
-    struct PeerInterface* peer_if = NULL;
+    struct PeerInterface peer_if_key;
 
     if ((sys = system_get_instance()) == NULL)
         return NULL;
@@ -531,13 +695,32 @@ struct PeerInterface* peer_if_find_by_name(struct CSM* csm, char* name)
     if (csm == NULL)
         return NULL;
 
-    LIST_FOREACH(peer_if, &(csm->app_csm.mlacp.pif_list), mlacp_next)
+    snprintf(peer_if_key.name, MAX_L_PORT_NAME, "%s", name);
+
+    return RB_FIND(pif_name_rb_tree, &MLACP(csm).pif_name_rb, &peer_if_key);
+}
+
+/* Name a peer interface and (re)index it; names arrive after creation */
+void peer_if_set_name(struct CSM* csm, struct PeerInterface* pif, const char* name, size_t len)
+{
+    struct PeerInterface* old = NULL;
+
+    if (csm == NULL || pif == NULL)
+        return;
+
+    if (RB_FIND(pif_name_rb_tree, &MLACP(csm).pif_name_rb, pif) == pif)
+        RB_REMOVE(pif_name_rb_tree, &MLACP(csm).pif_name_rb, pif);
+
+    if (len > MAX_L_PORT_NAME)
+        len = MAX_L_PORT_NAME;
+    memset(pif->name, 0, MAX_L_PORT_NAME);
+    memcpy(pif->name, name, len);
+
+    if ((old = RB_INSERT(pif_name_rb_tree, &MLACP(csm).pif_name_rb, pif)) != NULL)
     {
-        if (strcmp(peer_if->name, name) == 0)
-            return peer_if;
+        RB_REMOVE(pif_name_rb_tree, &MLACP(csm).pif_name_rb, old);
+        RB_INSERT(pif_name_rb_tree, &MLACP(csm).pif_name_rb, pif);
     }
-
-    return NULL;
 }
 
 void peer_if_del_all_vlan(struct PeerInterface* pif)
@@ -561,6 +744,8 @@ void peer_if_destroy(struct PeerInterface* pif)
 
     /* destroy if*/
     LIST_REMOVE(pif, mlacp_next);
+    if (pif->csm && RB_FIND(pif_name_rb_tree, &MLACP(pif->csm).pif_name_rb, pif) == pif)
+        RB_REMOVE(pif_name_rb_tree, &MLACP(pif->csm).pif_name_rb, pif);
     peer_if_del_all_vlan(pif);
 
     free(pif);
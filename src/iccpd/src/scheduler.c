@@ -32,6 +32,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/epoll.h>
+#include <sys/timerfd.h>
 
 #include "../include/logger.h"
 #include "../include/system.h"
@@ -41,6 +42,8 @@
 #include "../include/iccp_cmd.h"
 #include "../include/mlacp_link_handler.h"
 #include "../include/iccp_netlink.h"
+#include "../include/mlacp_fsm.h"
+#include "../include/iccp_warmboot.h"
 
 /******************************************************
 *
@@ -51,8 +54,10 @@
 //this needs to be fine tuned
 #define PEER_SOCK_SND_BUF_LEN  (6 * 1024 * 1024)
 #define PEER_SOCK_RCV_BUF_LEN  (6 * 1024 * 1024)
-#define RECV_RETRY_INTERVAL_USEC    100000
-#define RECV_RETRY_MAX              10
+/* Bytes read from one peer socket per wakeup before yielding to the other
+ * fds; epoll is level-triggered so the rest is picked up on the next loop.
+ */
+#define PEER_SOCK_RX_BUDGET    (4 * CSM_RX_BUFFER_SIZE)
 
 extern int mlacp_prepare_for_warm_reboot(struct CSM* csm, char* buf, size_t max_buf_size);
 
@@ -116,6 +121,8 @@ static int scheduler_transit_fsm()
         mlacp_fsm_transit(csm);
     }
 
+    iccp_warmboot_snapshot_expire();
+
     //lif->changed flag is marked for state change for lif, for active node when
     //it is in STAGE2 where it receiving cfg sync from peer if there is any po
     //state change that change is not sent and this clear clears the marking and
@@ -126,131 +133,243 @@ static int scheduler_transit_fsm()
     return 1;
 }
 
-/* Receive packets call back function */
-int scheduler_csm_read_callback(struct CSM* csm)
+/* Next turn of the wall clock second; FSM timers compare time(NULL) */
+static uint64_t scheduler_next_second_usec(uint64_t now)
 {
-    struct Msg* msg = NULL;
-    /*peer message*/
-    char *peer_msg = g_csm_buf;
-    LDPHdr* ldp_hdr = (LDPHdr*)peer_msg;
-    char* data = &peer_msg[sizeof(LDPHdr)];
-    size_t data_len = 0;
-    size_t pos = 0;
-    int recv_len = 0, len = 0, retval;
-    int num_retry = 0;
-    int total_retry_time = 0;
-    int total_data_len = 0;
+    struct timespec ts;
 
-    if (csm->sock_fd <= 0)
-        return MCLAG_ERROR;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return now + (1000000 - (ts.tv_nsec / 1000));
+}
 
-    memset(peer_msg, 0, CSM_BUFFER_SIZE);
+/* Arm the scheduler timer for the earliest pending FSM deadline */
+static void scheduler_timer_arm(struct System* sys)
+{
+    struct CSM* csm = NULL;
+    struct itimerspec its;
+    uint64_t now = 0;
+    uint64_t deadline = 0;
+    uint64_t sync_deadline = 0;
 
-    recv_len = 0;
-    errno = 0;
+    if (sys->timer_fd <= 0)
+        return;
+
+    now = system_get_time_usec();
+    deadline = scheduler_next_second_usec(now);
 
-    while (recv_len != sizeof(LDPHdr))
+    LIST_FOREACH(csm, &(sys->csm_list), next)
     {
-        len = recv(csm->sock_fd, peer_msg + recv_len, sizeof(LDPHdr) - recv_len, 0);
-        if (len == -1)
+        /* ICCP messages are consumed one per pass */
+        if (!TAILQ_EMPTY(&(csm->msg_list)))
         {
-            perror("recv(). Error");
-            ICCPD_LOG_WARN("ICCP_FSM", "Peer disconnect for header read error[%s] len = -1 till now received len  = %d ", strerror(errno), recv_len);
-            SYSTEM_INCR_HDR_READ_SOCK_ERR_COUNTER(system_get_instance());
-            goto recv_err;
+            deadline = now;
+            break;
         }
-        else if (len == 0)
+
+        /* Session handshake and peer sync stages advance one step per pass */
+        if (csm->sock_fd > 0
+            && (csm->current_state != ICCP_OPERATIONAL
+                || MLACP(csm).current_state != MLACP_STATE_EXCHANGE)
+            && now + (SCHEDULER_POLL_MSEC * 1000) < deadline)
         {
-            ICCPD_LOG_WARN("ICCP_FSM", "Peer disconnect for header read error[%s] len = 0, till now received len = %d ",strerror(errno), recv_len);
-            SYSTEM_INCR_HDR_READ_SOCK_ZERO_LEN_COUNTER(system_get_instance());
-            goto recv_err;
+            deadline = now + (SCHEDULER_POLL_MSEC * 1000);
         }
-        recv_len += len;
-        /*usleep(100);*/
+
+        sync_deadline = mlacp_fsm_sync_deadline_msec(csm) * 1000;
+        if (sync_deadline && sync_deadline < deadline)
+            deadline = sync_deadline;
     }
 
-    if (ntohs(ldp_hdr->msg_len) >= MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS)
+    /* Absolute expiry, a deadline already passed fires at once */
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = deadline / 1000000;
+    its.it_value.tv_nsec = (deadline % 1000000) * 1000;
+    if (timerfd_settime(sys->timer_fd, TFD_TIMER_ABSTIME, &its, NULL) != 0)
     {
-        data_len = ntohs(ldp_hdr->msg_len) - MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS;
+        ICCPD_LOG_WARN(__FUNCTION__, "Scheduler timer set error %d", errno);
+        return;
     }
-    else
+    sys->timer_deadline_usec = deadline;
+}
+
+/* Record what woke the last FSM pass and how long the event waited */
+static void scheduler_latency_probe(struct System* sys)
+{
+    system_dbg_counter_info_t *cntr = &sys->dbg_counters;
+    uint64_t latency = 0;
+
+    if (sys->event_rx_usec)
     {
-        ICCPD_LOG_ERR("ICCP_FSM", "Peer disconnect for invalid data error; length[%d] msg_type[0x%x] ", ntohs(ldp_hdr->msg_len),  ntohs(ldp_hdr->msg_type));
-        SYSTEM_INCR_INVALID_PEER_MSG_COUNTER(system_get_instance());
-        goto recv_err;
+        latency = system_get_time_usec() - sys->event_rx_usec;
+        ++cntr->sched_event_run_counter;
+        cntr->sched_latency_total_usec += latency;
+        cntr->sched_latency_last_usec = latency;
+        if (latency > cntr->sched_latency_max_usec)
+            cntr->sched_latency_max_usec = latency;
     }
-    total_data_len = data_len;
-    pos = 0;
+    else if (sys->timer_expired)
+    {
+        ++cntr->sched_timer_run_counter;
+    }
+
+    sys->event_rx_usec = 0;
+    sys->timer_expired = 0;
+}
+
+/* Shortest message of this type the enqueue path can read without running
+ * past its end; every ICCP message carries the ICC header.
+ */
+static uint32_t scheduler_csm_min_msg_len(uint16_t msg_type)
+{
+    switch (msg_type)
+    {
+        case MSG_T_NOTIFICATION:
+            return sizeof(ICCHdr) + sizeof(NAKTLV);
+
+        case MSG_T_RG_APP_DATA:
+            return sizeof(ICCHdr) + sizeof(ICCParameter);
+
+        default:
+            return sizeof(ICCHdr);
+    }
+}
+
+/* Frame every complete LDP message in the peer receive buffer and enqueue
+ * it; a trailing partial message stays buffered for the next read.
+ */
+static int scheduler_csm_parse_rx_buf(struct CSM* csm)
+{
+    struct Msg* msg = NULL;
+    LDPHdr* ldp_hdr = NULL;
+    uint32_t msg_len = 0;
+    uint16_t msg_type = 0;
+    int num_msg = 0;
+
+    while (csm->rx_tail - csm->rx_head >= sizeof(LDPHdr))
+    {
+        ldp_hdr = (LDPHdr*)&csm->rx_buf[csm->rx_head];
+        msg_len = ntohs(ldp_hdr->msg_len);
+        if (msg_len < MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS
+            || msg_len + MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS > CSM_BUFFER_SIZE)
+        {
+            ICCPD_LOG_ERR("ICCP_FSM", "Peer disconnect for invalid data error; length[%d] msg_type[0x%x] ",
+                          msg_len, ntohs(ldp_hdr->msg_type));
+            SYSTEM_INCR_INVALID_PEER_MSG_COUNTER(system_get_instance());
+            return MCLAG_ERROR;
+        }
+        msg_len += MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS;
+
+        if (csm->rx_tail - csm->rx_head < msg_len)
+            break;
+
+        if (csm->rx_retry > 0)
+        {
+            SYSTEM_SET_RETRY_COUNTER(system_get_instance(), csm->rx_retry);
+            csm->rx_retry = 0;
+        }
+
+        /* Drop a message too short for its type, the framing is intact */
+        msg_type = ntohs(*(uint16_t*)ldp_hdr) & 0x7fff;
+        if (msg_len < scheduler_csm_min_msg_len(msg_type))
+        {
+            ICCPD_LOG_WARN("ICCP_FSM", "Drop short peer message; length[%u] msg_type[0x%x]",
+                           msg_len, msg_type);
+            SYSTEM_INCR_INVALID_PEER_MSG_COUNTER(system_get_instance());
+            ++csm->i_msg_in_count;
+        }
+        else if (iccp_csm_init_msg(&msg, (char*)ldp_hdr, msg_len) == 0)
+        {
+            iccp_csm_enqueue_msg(csm, msg);
+            ++csm->icc_msg_in_count;
+        }
+        else
+            ++csm->i_msg_in_count;
+
+        csm->rx_head += msg_len;
+        ++num_msg;
+    }
+
+    if (csm->rx_head == csm->rx_tail)
+    {
+        csm->rx_head = 0;
+        csm->rx_tail = 0;
+    }
+
+    return num_msg;
+}
 
-    while (data_len > 0)
+/* Receive packets call back function
+ * Drain the peer socket without blocking and enqueue every complete
+ * message; returns the number of messages enqueued.
+ */
+int scheduler_csm_read_callback(struct CSM* csm)
+{
+    ssize_t len = 0;
+    size_t budget = PEER_SOCK_RX_BUDGET;
+    int num_msg = 0;
+    int ret = 0;
+
+    if (csm->sock_fd <= 0)
+        return MCLAG_ERROR;
+
+    while (budget > 0)
     {
-        /* When consecutive CCP session flaps happen, recv() call got stuck.
-         * Change recv() to non-blocking with retry mechanism. If max
-         * retry reaches, attempt one more retry after waiting for one KA
-         * interval before bringing down the session.
-         */
-        recv_len = recv(csm->sock_fd, &data[pos], data_len, MSG_DONTWAIT);
-        if (recv_len == -1)
+        /* Buffer tail reached, slide the partial message to the front */
+        if (csm->rx_tail == CSM_RX_BUFFER_SIZE && csm->rx_head > 0)
         {
+            memmove(csm->rx_buf, &csm->rx_buf[csm->rx_head], csm->rx_tail - csm->rx_head);
+            csm->rx_tail -= csm->rx_head;
+            csm->rx_head = 0;
+        }
+
+        len = recv(csm->sock_fd, &csm->rx_buf[csm->rx_tail],
+                   CSM_RX_BUFFER_SIZE - csm->rx_tail, MSG_DONTWAIT);
+        if (len == -1)
+        {
+            if (errno == EINTR)
+                continue;
             if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+                break;
+
+            ICCPD_LOG_WARN("ICCP_FSM", "Peer disconnect for read error[%s], pending len %u",
+                           strerror(errno), csm->rx_tail - csm->rx_head);
+            if (csm->rx_tail == csm->rx_head)
             {
-                ICCPD_LOG_NOTICE(
-                    "ICCP_FSM", "Non-blocking recv total/pending len %d/%d, errno %d, num_retry %d",
-                    total_data_len, data_len, errno, num_retry);
-                ++num_retry;
-                if (num_retry > RECV_RETRY_MAX)
-                {
-                    ICCPD_LOG_ERR(
-                        "ICCP_FSM", "Non-blocking recv() retry failed, total/pending len %d/%d",
-                        total_data_len, data_len);
-                    SYSTEM_INCR_RX_RETRY_FAIL_COUNTER(system_get_instance());
-                    goto recv_err;
-                }
-                else
-                {
-                    if (num_retry == RECV_RETRY_MAX)
-                        usleep((csm->session_timeout * 1000000) - total_retry_time);
-                    else
-                    {
-                        total_retry_time += (num_retry * RECV_RETRY_INTERVAL_USEC);
-                        usleep(num_retry * RECV_RETRY_INTERVAL_USEC);
-                    }
-                    recv_len = 0;
-                }
+                SYSTEM_INCR_HDR_READ_SOCK_ERR_COUNTER(system_get_instance());
             }
             else
             {
-                perror("continue recv() Error");
-                ICCPD_LOG_WARN("ICCP_FSM", "Peer data read error; recv_len:%d data_len:%d, errno %d",
-                               recv_len, data_len, errno);
                 SYSTEM_INCR_TLV_READ_SOCK_ERR_COUNTER(system_get_instance());
-                goto recv_err;
             }
+            goto recv_err;
         }
-        else if (recv_len == 0)
+        else if (len == 0)
         {
-            ICCPD_LOG_WARN("ICCP_FSM", "Peer disconnect for data read error; recv_len:%d data_len:%d ", recv_len, data_len);
-            SYSTEM_INCR_TLV_READ_SOCK_ZERO_LEN_COUNTER(system_get_instance());
+            ICCPD_LOG_WARN("ICCP_FSM", "Peer disconnect for read len = 0, pending len %u",
+                           csm->rx_tail - csm->rx_head);
+            if (csm->rx_tail == csm->rx_head)
+            {
+                SYSTEM_INCR_HDR_READ_SOCK_ZERO_LEN_COUNTER(system_get_instance());
+            }
+            else
+            {
+                SYSTEM_INCR_TLV_READ_SOCK_ZERO_LEN_COUNTER(system_get_instance());
+            }
             goto recv_err;
         }
-        data_len -= recv_len;
-        pos += recv_len;
-        /*usleep(100);*/
-    }
-    if (num_retry > 0)
-    {
-        SYSTEM_SET_RETRY_COUNTER(system_get_instance(), num_retry);
-    }
-    retval = iccp_csm_init_msg(&msg, peer_msg, ntohs(ldp_hdr->msg_len) + MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS);
-    if (retval == 0)
-    {
-        iccp_csm_enqueue_msg(csm, msg);
-        ++csm->icc_msg_in_count;
+
+        csm->rx_tail += len;
+        budget = ((size_t)len < budget) ? budget - len : 0;
+
+        if ((ret = scheduler_csm_parse_rx_buf(csm)) < 0)
+            goto recv_err;
+        num_msg += ret;
     }
-    else
-        ++csm->i_msg_in_count;
 
-    return 1;
+    if (csm->rx_tail > csm->rx_head)
+        ++csm->rx_retry;
+
+    return num_msg;
 
  recv_err:
     scheduler_session_disconnect_handler(csm);
@@ -381,6 +500,11 @@ void scheduler_init()
         return;
 
     iccp_get_start_type(sys);
+    /*Map saved state before config creates the CSMs that restore from it*/
+    if (sys->warmboot_start == WARM_REBOOT)
+        iccp_warmboot_snapshot_load();
+    else
+        unlink(sys->warmboot_file_path);
     /*Get kernel interface and port */
     iccp_sys_local_if_list_get_init();
     iccp_sys_local_if_list_get_addr();
@@ -406,6 +530,11 @@ void scheduler_init()
         ICCPD_LOG_WARN(__FUNCTION__, "Mclagd ctl info socket connect fail");
     }
 
+    if (scheduler_timer_init(sys) < 0)
+    {
+        ICCPD_LOG_WARN(__FUNCTION__, "Scheduler timer init fail, polling every %d ms", EPOLL_TIMEOUT_MSEC);
+    }
+
     return;
 }
 
@@ -462,6 +591,7 @@ int iccp_receive_signal_handler(struct System* sys)
 void scheduler_loop()
 {
     struct System* sys = NULL;
+    uint64_t start_usec;
 
     if ((sys = system_get_instance()) == NULL)
         return;
@@ -473,14 +603,19 @@ void scheduler_loop()
             iccp_connect_syncd();
         }
 
-        /*handle socket slelect event ,If no message received, it will block 0.1s*/
+        /*handle socket slelect event, block until an fd event or the next FSM deadline*/
         iccp_handle_events(sys);
         /*csm, app state machine transit */
+        start_usec = system_get_time_usec();
         scheduler_transit_fsm();
+        system_perf_record_src(sys, ICCP_PERF_SRC_FSM_TRANSIT, start_usec);
+        scheduler_latency_probe(sys);
+        scheduler_timer_arm(sys);
 
         if (sys->warmboot_exit == WARM_REBOOT)
         {
             ICCPD_LOG_DEBUG(__FUNCTION__, "Warm reboot exit ......");
+            iccp_warmboot_snapshot_save();
             return;
         }
     }
@@ -858,6 +993,56 @@ void scheduler_session_disconnect_handler(struct CSM* csm)
     return;
 }
 
+/* Scheduler timer, the main loop blocks in epoll until an fd event or
+ * the timer armed for the next FSM deadline fires
+ */
+int scheduler_timer_init(struct System* sys)
+{
+    struct epoll_event event;
+
+    sys->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (sys->timer_fd < 0)
+    {
+        ICCPD_LOG_WARN(__FUNCTION__, "Failed to create scheduler timer, errno %d", errno);
+        return MCLAG_ERROR;
+    }
+
+    event.data.fd = sys->timer_fd;
+    event.events = EPOLLIN;
+    if (epoll_ctl(sys->epoll_fd, EPOLL_CTL_ADD, sys->timer_fd, &event) != 0)
+    {
+        ICCPD_LOG_WARN(__FUNCTION__, "Scheduler timer epoll add error %d", errno);
+        close(sys->timer_fd);
+        sys->timer_fd = -1;
+        return MCLAG_ERROR;
+    }
+    FD_SET(sys->timer_fd, &(sys->readfd));
+    sys->readfd_count++;
+
+    scheduler_timer_arm(sys);
+
+    return 0;
+}
+
+int scheduler_timer_handler(struct System* sys)
+{
+    uint64_t expirations = 0;
+    uint64_t now = 0;
+
+    if (read(sys->timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+        return MCLAG_ERROR;
+
+    now = system_get_time_usec();
+    if (now > sys->timer_deadline_usec
+        && (now - sys->timer_deadline_usec) > sys->dbg_counters.sched_timer_late_max_usec)
+    {
+        sys->dbg_counters.sched_timer_late_max_usec = now - sys->timer_deadline_usec;
+    }
+    sys->timer_expired = 1;
+
+    return 0;
+}
+
 void scheduler_csm_socket_cleanup(struct CSM* csm, int location)
 {
     struct System* sys;
@@ -892,5 +1077,8 @@ void scheduler_csm_socket_cleanup(struct CSM* csm, int location)
                          csm->sock_fd, location);
     }
     csm->sock_fd = -1;
+    csm->rx_head = 0;
+    csm->rx_tail = 0;
+    csm->rx_retry = 0;
 }
 
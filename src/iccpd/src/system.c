@@ -22,6 +22,7 @@
  */
 
 #include <stdio.h>
+#include <time.h>
 #include <netlink/msg.h>
 
 #include "../include/iccp_csm.h"
@@ -30,6 +31,7 @@
 #include "../include/scheduler.h"
 #include "../include/mlacp_link_handler.h"
 #include "../include/iccp_ifm.h"
+#include "../include/iccp_warmboot.h"
 
 #define ETHER_ADDR_LEN 6
 char mac_print_str[ETHER_ADDR_STR_LEN];
@@ -66,12 +68,17 @@ void system_init(struct System* sys)
     sys->arp_receive_fd = -1;
     sys->ndisc_receive_fd = -1;
     sys->epoll_fd = -1;
+    sys->timer_fd = -1;
+    sys->perf.reset_msec = system_get_time_msec();
     sys->family = -1;
     sys->warmboot_start = 0;
     sys->warmboot_exit = 0;
     LIST_INIT(&(sys->csm_list));
     LIST_INIT(&(sys->lif_list));
     LIST_INIT(&(sys->lif_purge_list));
+    RB_INIT(lif_name_rb_tree, &sys->lif_name_rb);
+    RB_INIT(lif_ifindex_rb_tree, &sys->lif_ifindex_rb);
+    RB_INIT(lif_po_id_rb_tree, &sys->lif_po_id_rb);
     LIST_INIT(&(sys->unq_ip_if_list));
     LIST_INIT(&(sys->pending_vlan_mbr_if_list));
 
@@ -79,6 +86,7 @@ void system_init(struct System* sys)
     sys->cmd_file_path = strdup("/var/run/iccpd/iccpd.vty");
     sys->config_file_path = strdup("/etc/iccpd/iccpd.conf");
     sys->mclagdctl_file_path = strdup("/var/run/iccpd/mclagdctl.sock");
+    sys->warmboot_file_path = strdup(ICCP_WARMBOOT_SNAPSHOT_FILE);
     sys->pid_file_fd = 0;
     sys->telnet_port = 2015;
     FD_ZERO(&(sys->readfd));
@@ -122,6 +130,9 @@ void system_finalize()
         LIST_REMOVE(local_if, system_next);
         local_if_finalize(local_if);
     }
+    RB_INIT(lif_name_rb_tree, &sys->lif_name_rb);
+    RB_INIT(lif_ifindex_rb_tree, &sys->lif_ifindex_rb);
+    RB_INIT(lif_po_id_rb_tree, &sys->lif_po_id_rb);
 
     while (!LIST_EMPTY(&(sys->lif_purge_list)))
     {
@@ -148,6 +159,8 @@ void system_finalize()
         free(sys->cmd_file_path);
     if (sys->config_file_path != NULL )
         free(sys->config_file_path);
+    if (sys->warmboot_file_path != NULL )
+        free(sys->warmboot_file_path);
     if (sys->pid_file_fd > 0)
         close(sys->pid_file_fd);
     if (sys->server_fd > 0)
@@ -164,6 +177,8 @@ void system_finalize()
         close(sys->sig_pipe_r);
     if (sys->sig_pipe_w > 0)
         close(sys->sig_pipe_w);
+    if (sys->timer_fd > 0)
+        close(sys->timer_fd);
 
     if (sys->epoll_fd)
         close(sys->epoll_fd);
@@ -397,3 +412,67 @@ void system_update_netlink_counters(
             break;
     }
 }
+
+/* Monotonic time in milliseconds, for measuring intervals */
+uint64_t system_get_time_msec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+/* Monotonic time in microseconds, for latency and timer deadlines */
+uint64_t system_get_time_usec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+/* Add the time elapsed since start_usec to a latency histogram */
+void system_perf_record(iccp_perf_hist_t *hist, uint64_t start_usec)
+{
+    uint64_t delta = system_get_time_usec() - start_usec;
+    uint32_t usec = (delta > UINT32_MAX) ? UINT32_MAX : (uint32_t)delta;
+    int i = 0;
+
+    while ((usec >> (i + 1)) && i < ICCP_PERF_HIST_BUCKETS - 1)
+        i++;
+
+    ++hist->bucket[i];
+    ++hist->count;
+    hist->total_usec += usec;
+    if (usec > hist->max_usec)
+        hist->max_usec = usec;
+}
+
+void system_perf_record_src(struct System *sys, ICCP_PERF_SRC_e src, uint64_t start_usec)
+{
+    if (sys && src < ICCP_PERF_SRC_MAX)
+        system_perf_record(&sys->perf.src[src], start_usec);
+}
+
+void system_perf_record_tlv(struct System *sys, uint16_t tlv_type, uint64_t start_usec)
+{
+    int idx = ICCP_PERF_TLV_OTHER;
+
+    if (!sys)
+        return;
+
+    if (tlv_type >= ICCP_PERF_TLV_LOW_BASE
+        && tlv_type < ICCP_PERF_TLV_LOW_BASE + ICCP_PERF_TLV_LOW_COUNT)
+        idx = tlv_type - ICCP_PERF_TLV_LOW_BASE;
+    else if (tlv_type >= ICCP_PERF_TLV_HIGH_BASE
+             && tlv_type < ICCP_PERF_TLV_HIGH_BASE + ICCP_PERF_TLV_HIGH_COUNT)
+        idx = ICCP_PERF_TLV_LOW_COUNT + tlv_type - ICCP_PERF_TLV_HIGH_BASE;
+
+    system_perf_record(&sys->perf.tlv[idx], start_usec);
+}
+
+void system_perf_reset(struct System *sys)
+{
+    memset(&sys->perf, 0, sizeof(sys->perf));
+    sys->perf.reset_msec = system_get_time_msec();
+}
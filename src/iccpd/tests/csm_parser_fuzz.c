@@ -0,0 +1,378 @@
+/*
+ * csm_parser_fuzz.c
+ *
+ * Feeds peer byte streams through scheduler_csm_read_callback() over a
+ * socket pair, cut at random points, and checks the incremental framer:
+ * - valid messages come out whole, in order and byte for byte, however
+ *   the stream is split, including maximum size messages;
+ * - garbage, bad lengths and truncated messages never read outside the
+ *   message, and a bad length disconnects the session with the receive
+ *   buffer reset.
+ * Every run is reproducible from its seed, and captured streams can be
+ * replayed with random splits:
+ *
+ *   csm_parser_fuzz [iterations [seed]]    (default 200, seed 1)
+ *   csm_parser_fuzz -r file ...
+ *
+ * Build with -fsanitize=address,undefined for fuzzing runs.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+#include "../include/system.h"
+#include "../include/logger.h"
+#include "../include/iccp_csm.h"
+#include "../include/msg_format.h"
+#include "../include/mlacp_fsm.h"
+#include "../include/scheduler.h"
+
+/* Largest message the framer accepts, header included */
+#define FUZZ_MSG_MAX        (CSM_BUFFER_SIZE - MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS)
+#define FUZZ_STREAM_MAX     (4 * CSM_RX_BUFFER_SIZE)
+#define FUZZ_MSGS_MAX       64
+
+static int test_fail = 0;
+
+#define TEST_CHECK(cond, fmt, args ...) do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d seed %u: " fmt "\n", __FILE__, __LINE__, fuzz_seed, ## args); \
+            ++test_fail; \
+        } \
+} while (0)
+
+static unsigned int fuzz_seed;
+static uint64_t fuzz_state;
+
+static uint32_t fuzz_rand(void)
+{
+    /* xorshift64*, so a seed replays the same run on any libc */
+    fuzz_state ^= fuzz_state >> 12;
+    fuzz_state ^= fuzz_state << 25;
+    fuzz_state ^= fuzz_state >> 27;
+    return (uint32_t)((fuzz_state * 2685821657736338717ULL) >> 32);
+}
+
+static uint32_t fuzz_range(uint32_t lo, uint32_t hi)
+{
+    return lo + fuzz_rand() % (hi - lo + 1);
+}
+
+static void fuzz_fill(char *buf, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        buf[i] = (char)fuzz_rand();
+}
+
+/* Stream offsets are unaligned */
+static void fuzz_put16(char *buf, uint16_t val)
+{
+    val = htons(val);
+    memcpy(buf, &val, sizeof(val));
+}
+
+static void fuzz_msg_free(struct Msg *msg)
+{
+    free(msg->buf);
+    free(msg);
+}
+
+/* Free whatever the enqueue routing spread over the CSM queues */
+static int fuzz_drain(struct CSM *csm)
+{
+    struct Msg *msg = NULL;
+    int count = 0;
+
+    while ((msg = iccp_csm_dequeue_msg(csm)) != NULL)
+    {
+        fuzz_msg_free(msg);
+        ++count;
+    }
+    while ((msg = app_csm_dequeue_msg(csm)) != NULL)
+    {
+        fuzz_msg_free(msg);
+        ++count;
+    }
+    while ((msg = mlacp_dequeue_msg(csm)) != NULL)
+    {
+        fuzz_msg_free(msg);
+        ++count;
+    }
+
+    return count;
+}
+
+static int fuzz_connect(struct CSM *csm, int *peer_fd)
+{
+    int fds[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+        return -1;
+
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    csm->sock_fd = fds[0];
+    *peer_fd = fds[1];
+    return 0;
+}
+
+/* Write the stream in random cuts, reading after each one as a wakeup
+ * would. Returns the last callback result, or MCLAG_ERROR once the
+ * session has been dropped.
+ */
+static int fuzz_feed(struct CSM *csm, int peer_fd, const char *stream, size_t len)
+{
+    size_t pos = 0, cut;
+    ssize_t sent;
+    int ret = 0;
+
+    while (pos < len)
+    {
+        /* Mostly small cuts so headers and bodies split everywhere */
+        cut = (fuzz_rand() & 3) ? fuzz_range(1, 64) : fuzz_range(1, CSM_BUFFER_SIZE);
+        if (cut > len - pos)
+            cut = len - pos;
+
+        sent = send(peer_fd, stream + pos, cut, 0);
+        if (sent <= 0)
+            return MCLAG_ERROR;
+        pos += sent;
+
+        ret = scheduler_csm_read_callback(csm);
+        if (ret < 0)
+            break;
+    }
+
+    return ret;
+}
+
+/* Valid messages of random length must survive any split unchanged */
+static void fuzz_split(struct CSM *csm, char *stream)
+{
+    struct Msg *msg = NULL;
+    char *hdr = NULL;
+    size_t offs[FUZZ_MSGS_MAX], lens[FUZZ_MSGS_MAX];
+    size_t len = 0, msg_len;
+    int count, i, peer_fd;
+
+    count = fuzz_range(1, FUZZ_MSGS_MAX);
+    for (i = 0; i < count; i++)
+    {
+        switch (fuzz_rand() % 8)
+        {
+            case 0:
+                msg_len = FUZZ_MSG_MAX;
+                break;
+
+            case 1:
+                msg_len = sizeof(ICCHdr);
+                break;
+
+            default:
+                msg_len = fuzz_range(sizeof(ICCHdr), 2048);
+                break;
+        }
+        if (len + msg_len > FUZZ_STREAM_MAX)
+            break;
+
+        hdr = &stream[len];
+        fuzz_fill(hdr, msg_len);
+        /* Capability messages stay on the ICCP queue, so order is kept */
+        fuzz_put16(hdr, MSG_T_CAPABILITY);
+        fuzz_put16(hdr + 2, msg_len - MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS);
+        offs[i] = len;
+        lens[i] = msg_len;
+        len += msg_len;
+    }
+    count = i;
+
+    if (fuzz_connect(csm, &peer_fd) < 0)
+    {
+        TEST_CHECK(0, "socketpair");
+        return;
+    }
+
+    TEST_CHECK(fuzz_feed(csm, peer_fd, stream, len) >= 0, "valid stream dropped");
+
+    for (i = 0; i < count; i++)
+    {
+        if ((msg = iccp_csm_dequeue_msg(csm)) == NULL)
+        {
+            TEST_CHECK(0, "%d of %d messages framed", i, count);
+            break;
+        }
+
+        /* Enqueue converts the type field in place, compare the rest */
+        TEST_CHECK(msg->len == lens[i] && memcmp(msg->buf + 2, stream + offs[i] + 2, lens[i] - 2) == 0,
+                   "message %d of %d corrupt, len %zu expected %zu", i, count, msg->len, lens[i]);
+        fuzz_msg_free(msg);
+    }
+    TEST_CHECK(fuzz_drain(csm) == 0, "extra messages framed");
+    TEST_CHECK(csm->rx_head == 0 && csm->rx_tail == 0, "bytes left in receive buffer");
+
+    scheduler_session_disconnect_handler(csm);
+    close(peer_fd);
+}
+
+/* Random headers and payloads; the framer may take or reject them but
+ * must stay inside the buffer and reset it on a drop
+ */
+static void fuzz_garbage(struct CSM *csm, char *stream)
+{
+    static const uint16_t types[] = { MSG_T_CAPABILITY, MSG_T_RG_CONNECT, MSG_T_RG_DISCONNECT,
+                                      MSG_T_NOTIFICATION, MSG_T_RG_APP_DATA };
+    struct System *sys = system_get_instance();
+    char *hdr = NULL;
+    size_t len = 0, msg_len;
+    uint32_t invalid;
+    int peer_fd, ret;
+
+    while (len + sizeof(LDPHdr) < FUZZ_STREAM_MAX && (fuzz_rand() % 16))
+    {
+        hdr = &stream[len];
+        msg_len = fuzz_range(sizeof(LDPHdr), 512);
+        if (len + msg_len > FUZZ_STREAM_MAX)
+            break;
+
+        fuzz_fill(hdr, msg_len);
+        switch (fuzz_rand() % 4)
+        {
+            case 0:
+                /* Raw garbage header */
+                break;
+
+            case 1:
+                /* Well framed but possibly shorter than its type needs */
+                fuzz_put16(hdr, types[fuzz_rand() % (sizeof(types) / sizeof(types[0]))]);
+                fuzz_put16(hdr + 2, msg_len - MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS);
+                break;
+
+            default:
+                /* Well framed, message type chosen so app data routing is hit */
+                fuzz_put16(hdr, types[fuzz_rand() % (sizeof(types) / sizeof(types[0]))]);
+                fuzz_put16(hdr + 2, msg_len - MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS);
+                if (msg_len >= sizeof(ICCHdr) + sizeof(ICCParameter))
+                    fuzz_put16(&stream[len + sizeof(ICCHdr)], fuzz_range(0, TLV_T_MLACP_LIST_END));
+                break;
+        }
+        len += msg_len;
+    }
+
+    if (fuzz_connect(csm, &peer_fd) < 0)
+    {
+        TEST_CHECK(0, "socketpair");
+        return;
+    }
+
+    invalid = SYSTEM_GET_INVALID_PEER_MSG_COUNTER(sys);
+    ret = fuzz_feed(csm, peer_fd, stream, len);
+    if (ret < 0)
+    {
+        TEST_CHECK(csm->sock_fd == -1 && csm->rx_head == 0 && csm->rx_tail == 0,
+                   "receive state not reset on drop");
+        TEST_CHECK(SYSTEM_GET_INVALID_PEER_MSG_COUNTER(sys) > invalid,
+                   "invalid message counter not bumped on drop");
+    }
+    else
+    {
+        TEST_CHECK(csm->rx_tail - csm->rx_head < CSM_BUFFER_SIZE, "partial message overruns the buffer");
+        scheduler_session_disconnect_handler(csm);
+    }
+
+    fuzz_drain(csm);
+    close(peer_fd);
+}
+
+/* Replay a captured peer stream with a few different splits */
+static void fuzz_replay(struct CSM *csm, char *stream, const char *path)
+{
+    FILE *fp = NULL;
+    size_t len;
+    int run, peer_fd, ret, count;
+
+    if (!(fp = fopen(path, "rb")))
+    {
+        TEST_CHECK(0, "cannot open %s", path);
+        return;
+    }
+    len = fread(stream, 1, FUZZ_STREAM_MAX, fp);
+    fclose(fp);
+
+    for (run = 0; run < 8; run++)
+    {
+        if (fuzz_connect(csm, &peer_fd) < 0)
+        {
+            TEST_CHECK(0, "socketpair");
+            return;
+        }
+
+        ret = fuzz_feed(csm, peer_fd, stream, len);
+        count = fuzz_drain(csm);
+        if (ret >= 0)
+            scheduler_session_disconnect_handler(csm);
+        close(peer_fd);
+
+        printf("%s: %zu bytes, %d messages%s\n", path, len, count, ret < 0 ? ", dropped" : "");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    struct CSM *csm = NULL;
+    char *stream = NULL;
+    int iterations = 200;
+    int i;
+
+    fuzz_seed = 1;
+    if (argc > 1 && strcmp(argv[1], "-r") != 0)
+    {
+        iterations = atoi(argv[1]);
+        if (argc > 2)
+            fuzz_seed = strtoul(argv[2], NULL, 0);
+    }
+    if (iterations <= 0 || (argc == 2 && strcmp(argv[1], "-r") == 0))
+    {
+        fprintf(stderr, "usage: %s [iterations [seed]] | -r file ...\n", argv[0]);
+        return 1;
+    }
+    fuzz_state = fuzz_seed | ((uint64_t)1 << 63);
+
+    logger_set_configuration(CRITICAL_LOG_LEVEL);
+
+    if (!system_get_instance() || !(csm = system_create_csm())
+        || !(stream = malloc(FUZZ_STREAM_MAX)))
+    {
+        printf("FAIL: setup\n");
+        return 1;
+    }
+
+    if (argc > 2 && strcmp(argv[1], "-r") == 0)
+    {
+        for (i = 2; i < argc; i++)
+            fuzz_replay(csm, stream, argv[i]);
+    }
+    else
+    {
+        printf("seed %u, %d iterations\n", fuzz_seed, iterations);
+        for (i = 0; i < iterations && !test_fail; i++)
+        {
+            fuzz_split(csm, stream);
+            fuzz_garbage(csm, stream);
+        }
+    }
+
+    free(stream);
+
+    printf("%s\n", test_fail ? "FAIL" : "PASS");
+    return test_fail ? 1 : 0;
+}
@@ -0,0 +1,178 @@
+/*
+ * neigh_batch_bench.c
+ *
+ * Measures how many neighbors per second iccp_netlink_neighbor_request()
+ * programs into the kernel, once request by request on route_sock and once
+ * through the batch layer. The entries go onto one end of a veth pair
+ * inside a private network namespace, so the host tables are left alone.
+ *
+ * Needs CAP_NET_ADMIN and iproute2; exits 77 (automake "skipped") otherwise.
+ *
+ *   neigh_batch_bench [count]
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/sched.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+
+#include "../include/system.h"
+#include "../include/port.h"
+#include "../include/iccp_netlink.h"
+
+#define BENCH_IFNAME        "nbb0"
+#define BENCH_PEER_IFNAME   "nbb1"
+#define BENCH_SKIP          77
+
+static uint8_t bench_mac[ETHER_ADDR_LEN] = { 0x02, 0x00, 0x5e, 0x00, 0x53, 0x01 };
+
+static uint64_t bench_now_usec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int bench_neigh_count(void)
+{
+    FILE *fp;
+    char line[256];
+    int count = 0;
+
+    fp = popen("ip -4 neigh show dev " BENCH_IFNAME, "r");
+    if (!fp)
+        return -1;
+
+    while (fgets(line, sizeof(line), fp))
+        ++count;
+
+    pclose(fp);
+    return count;
+}
+
+/* Returns the number of requests that failed synchronously */
+static int bench_run(int count, int add, int batched)
+{
+    uint32_t addr;
+    int fail = 0;
+    int i;
+
+    if (batched)
+        iccp_netlink_neighbor_batch_begin();
+
+    for (i = 0; i < count; i++)
+    {
+        /* 10.0.0.1 onwards; the kernel does not insist on a matching subnet */
+        addr = htonl(0x0a000001 + i);
+        if (iccp_netlink_neighbor_request(AF_INET, (uint8_t *)&addr, add, bench_mac,
+                                          BENCH_IFNAME, 1, 0) < 0)
+            ++fail;
+    }
+
+    if (batched)
+        iccp_netlink_neighbor_batch_end();
+
+    return fail;
+}
+
+static int bench_pass(struct System *sys, int count, int batched)
+{
+    const char *mode = batched ? "batched" : "unbatched";
+    uint32_t err_before = sys->dbg_counters.neigh_batch_err_counter;
+    uint64_t start, add_usec, del_usec;
+    int add_fail, del_fail, programmed, left;
+
+    start = bench_now_usec();
+    add_fail = bench_run(count, 1, batched);
+    add_usec = bench_now_usec() - start;
+    programmed = bench_neigh_count();
+
+    start = bench_now_usec();
+    del_fail = bench_run(count, 0, batched);
+    del_usec = bench_now_usec() - start;
+    left = bench_neigh_count();
+
+    printf("%-9s add %6d in %8.1f ms  %9.0f neigh/s\n", mode, count,
+           add_usec / 1000.0, count * 1000000.0 / (add_usec ? add_usec : 1));
+    printf("%-9s del %6d in %8.1f ms  %9.0f neigh/s\n", mode, count,
+           del_usec / 1000.0, count * 1000000.0 / (del_usec ? del_usec : 1));
+
+    if (add_fail || del_fail || programmed != count || left != 0
+        || sys->dbg_counters.neigh_batch_err_counter != err_before)
+    {
+        printf("%-9s FAIL: add_fail %d del_fail %d programmed %d left %d batch_err %u\n",
+               mode, add_fail, del_fail, programmed, left,
+               sys->dbg_counters.neigh_batch_err_counter - err_before);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct System *sys = NULL;
+    int count = 10000;
+    int rc = 0;
+
+    if (argc > 1)
+        count = atoi(argv[1]);
+    if (count <= 0 || count > 0xffffff)
+    {
+        fprintf(stderr, "usage: %s [count]\n", argv[0]);
+        return 1;
+    }
+
+    /* iccp_netlink.h clashes with _GNU_SOURCE, hence the raw syscall */
+    if (syscall(SYS_unshare, CLONE_NEWNET) < 0)
+    {
+        printf("SKIP: no private network namespace (needs CAP_NET_ADMIN)\n");
+        return BENCH_SKIP;
+    }
+
+    if (system("ip link add " BENCH_IFNAME " type veth peer name " BENCH_PEER_IFNAME
+               " && ip link set " BENCH_IFNAME " up && ip link set " BENCH_PEER_IFNAME " up") != 0)
+    {
+        printf("SKIP: cannot create veth pair\n");
+        return BENCH_SKIP;
+    }
+
+    if (!(sys = system_get_instance()) || !sys->route_sock)
+    {
+        printf("FAIL: netlink sockets not initialized\n");
+        return 1;
+    }
+
+    if (!local_if_create(if_nametoindex(BENCH_IFNAME), BENCH_IFNAME, IF_T_PORT, PORT_STATE_UP))
+    {
+        printf("FAIL: cannot create local interface " BENCH_IFNAME "\n");
+        return 1;
+    }
+
+    if (!sys->neigh_batch_sock)
+        printf("WARN: no batch socket, the batched pass falls back to route_sock\n");
+
+    if (bench_pass(sys, count, 0) < 0)
+        rc = 1;
+    if (bench_pass(sys, count, 1) < 0)
+        rc = 1;
+    /* Synchronous requests on route_sock must still line up after batching */
+    if (bench_pass(sys, count, 0) < 0)
+        rc = 1;
+
+    printf("batch sends %llu, batched entries %llu\n",
+           (unsigned long long)sys->dbg_counters.neigh_batch_msg_counter,
+           (unsigned long long)sys->dbg_counters.neigh_batch_entry_counter);
+
+    return rc;
+}
@@ -0,0 +1,301 @@
+/*
+ * neigh_index_test.c
+ *
+ * Checks the ARP and ND indexes against a plain array model under a random
+ * replay of adds, re-adds of a known IP, interface moves and deletes: every
+ * IP is found by mlacp_arp_find()/mlacp_ndisc_find() exactly while the model
+ * holds it, with the latest MAC and interface, each per-interface walk
+ * returns exactly that interface's entries, and the list and both indexes
+ * stay the same size and end up empty.
+ *
+ *   neigh_index_test [steps [seed]]    (default 20000 steps, seed 1)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "../include/system.h"
+#include "../include/logger.h"
+#include "../include/iccp_csm.h"
+#include "../include/mlacp_tlv.h"
+#include "../include/mlacp_sync_update.h"
+
+#define TEST_IP_COUNT       512
+#define TEST_IF_COUNT       8
+#define TEST_VERIFY_EVERY   1000
+
+struct test_neigh
+{
+    int present;
+    int if_idx;
+    uint8_t gen;
+};
+
+static struct test_neigh test_arp[TEST_IP_COUNT];
+static struct test_neigh test_nd[TEST_IP_COUNT];
+static uint32_t test_seed = 1;
+static int test_fail = 0;
+
+#define TEST_CHECK(cond, fmt, args ...) do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d: " fmt "\n", __FILE__, __LINE__, ## args); \
+            ++test_fail; \
+        } \
+} while (0)
+
+static uint32_t test_rand(void)
+{
+    test_seed ^= test_seed << 13;
+    test_seed ^= test_seed >> 17;
+    test_seed ^= test_seed << 5;
+    return test_seed;
+}
+
+static void test_ifname(char *buf, size_t len, int if_idx)
+{
+    snprintf(buf, len, "Vlan%d", 100 + if_idx);
+}
+
+static uint32_t test_ipv4(int i)
+{
+    return htonl(0x0a000001 + i);
+}
+
+static void test_ipv6(uint32_t *addr, int i)
+{
+    memset(addr, 0, 16);
+    addr[0] = htonl(0x20010db8);
+    addr[3] = htonl(1 + i);
+}
+
+static void test_arp_add(struct CSM *csm, int i, int if_idx)
+{
+    struct ARPMsg arp_buf;
+    struct Msg *msg = NULL;
+
+    memset(&arp_buf, 0, sizeof(arp_buf));
+    arp_buf.op_type = NEIGH_SYNC_ADD;
+    arp_buf.ipv4_addr = test_ipv4(i);
+    arp_buf.mac_addr[0] = 0x02;
+    arp_buf.mac_addr[5] = ++test_arp[i].gen;
+    test_ifname(arp_buf.ifname, sizeof(arp_buf.ifname), if_idx);
+
+    if (iccp_csm_init_msg(&msg, (char *)&arp_buf, sizeof(arp_buf)) != 0)
+    {
+        TEST_CHECK(0, "ARP msg alloc");
+        return;
+    }
+    mlacp_enqueue_arp(csm, msg);
+    test_arp[i].present = 1;
+    test_arp[i].if_idx = if_idx;
+}
+
+static void test_nd_add(struct CSM *csm, int i, int if_idx)
+{
+    struct NDISCMsg ndisc_buf;
+    struct Msg *msg = NULL;
+
+    memset(&ndisc_buf, 0, sizeof(ndisc_buf));
+    ndisc_buf.op_type = NEIGH_SYNC_ADD;
+    test_ipv6(ndisc_buf.ipv6_addr, i);
+    ndisc_buf.mac_addr[0] = 0x02;
+    ndisc_buf.mac_addr[5] = ++test_nd[i].gen;
+    test_ifname(ndisc_buf.ifname, sizeof(ndisc_buf.ifname), if_idx);
+
+    if (iccp_csm_init_msg(&msg, (char *)&ndisc_buf, sizeof(ndisc_buf)) != 0)
+    {
+        TEST_CHECK(0, "ND msg alloc");
+        return;
+    }
+    mlacp_enqueue_ndisc(csm, msg);
+    test_nd[i].present = 1;
+    test_nd[i].if_idx = if_idx;
+}
+
+static struct Msg *test_nd_find(struct CSM *csm, int i)
+{
+    uint32_t addr[4];
+
+    test_ipv6(addr, i);
+    return mlacp_ndisc_find(csm, addr);
+}
+
+/* One random operation on a random IP of each family */
+static void test_step(struct CSM *csm)
+{
+    char ifname[MAX_L_PORT_NAME];
+    struct Msg *msg = NULL;
+    int i, op, if_idx;
+
+    i = test_rand() % TEST_IP_COUNT;
+    op = test_rand() % 4;
+    if_idx = test_rand() % TEST_IF_COUNT;
+    msg = mlacp_arp_find(csm, test_ipv4(i));
+    TEST_CHECK(!msg == !test_arp[i].present, "ARP %d found %d, expected %d", i, !!msg, test_arp[i].present);
+
+    if (op < 2)
+    {
+        test_arp_add(csm, i, if_idx);
+    }
+    else if (op == 2 && msg)
+    {
+        test_ifname(ifname, sizeof(ifname), if_idx);
+        mlacp_arp_set_ifname(csm, msg, ifname);
+        test_arp[i].if_idx = if_idx;
+    }
+    else if (msg)
+    {
+        mlacp_dequeue_arp(csm, msg);
+        test_arp[i].present = 0;
+        TEST_CHECK(!mlacp_arp_find(csm, test_ipv4(i)), "ARP %d found after delete", i);
+    }
+
+    i = test_rand() % TEST_IP_COUNT;
+    op = test_rand() % 4;
+    if_idx = test_rand() % TEST_IF_COUNT;
+    msg = test_nd_find(csm, i);
+    TEST_CHECK(!msg == !test_nd[i].present, "ND %d found %d, expected %d", i, !!msg, test_nd[i].present);
+
+    if (op < 2)
+    {
+        test_nd_add(csm, i, if_idx);
+    }
+    else if (op == 2 && msg)
+    {
+        test_ifname(ifname, sizeof(ifname), if_idx);
+        mlacp_ndisc_set_ifname(csm, msg, ifname);
+        test_nd[i].if_idx = if_idx;
+    }
+    else if (msg)
+    {
+        mlacp_dequeue_ndisc(csm, msg);
+        test_nd[i].present = 0;
+        TEST_CHECK(!test_nd_find(csm, i), "ND %d found after delete", i);
+    }
+}
+
+static void test_verify(struct CSM *csm)
+{
+    char ifname[MAX_L_PORT_NAME];
+    struct ARPMsg *arp_msg = NULL;
+    struct NDISCMsg *ndisc_msg = NULL;
+    struct Msg *msg = NULL;
+    int arp_per_if[TEST_IF_COUNT] = { 0 }, nd_per_if[TEST_IF_COUNT] = { 0 };
+    int arp_count = 0, nd_count = 0, walked, list, rb, i;
+
+    for (i = 0; i < TEST_IP_COUNT; i++)
+    {
+        msg = mlacp_arp_find(csm, test_ipv4(i));
+        TEST_CHECK(!msg == !test_arp[i].present, "ARP %d found %d, expected %d", i, !!msg, test_arp[i].present);
+        if (msg && test_arp[i].present)
+        {
+            arp_msg = (struct ARPMsg *)msg->buf;
+            test_ifname(ifname, sizeof(ifname), test_arp[i].if_idx);
+            TEST_CHECK(arp_msg->mac_addr[5] == test_arp[i].gen && strcmp(arp_msg->ifname, ifname) == 0,
+                       "ARP %d is %s gen %u, expected %s gen %u", i, arp_msg->ifname,
+                       arp_msg->mac_addr[5], ifname, test_arp[i].gen);
+            ++arp_per_if[test_arp[i].if_idx];
+            ++arp_count;
+        }
+
+        msg = test_nd_find(csm, i);
+        TEST_CHECK(!msg == !test_nd[i].present, "ND %d found %d, expected %d", i, !!msg, test_nd[i].present);
+        if (msg && test_nd[i].present)
+        {
+            ndisc_msg = (struct NDISCMsg *)msg->buf;
+            test_ifname(ifname, sizeof(ifname), test_nd[i].if_idx);
+            TEST_CHECK(ndisc_msg->mac_addr[5] == test_nd[i].gen && strcmp(ndisc_msg->ifname, ifname) == 0,
+                       "ND %d is %s gen %u, expected %s gen %u", i, ndisc_msg->ifname,
+                       ndisc_msg->mac_addr[5], ifname, test_nd[i].gen);
+            ++nd_per_if[test_nd[i].if_idx];
+            ++nd_count;
+        }
+    }
+
+    for (i = 0; i < TEST_IF_COUNT; i++)
+    {
+        test_ifname(ifname, sizeof(ifname), i);
+
+        walked = 0;
+        for (msg = mlacp_arp_first_on_if(csm, ifname); msg; msg = mlacp_arp_next_on_if(msg))
+        {
+            TEST_CHECK(strcmp(((struct ARPMsg *)msg->buf)->ifname, ifname) == 0, "ARP walk of %s left it", ifname);
+            ++walked;
+        }
+        TEST_CHECK(walked == arp_per_if[i], "ARP walk of %s gave %d, expected %d", ifname, walked, arp_per_if[i]);
+
+        walked = 0;
+        for (msg = mlacp_ndisc_first_on_if(csm, ifname); msg; msg = mlacp_ndisc_next_on_if(msg))
+        {
+            TEST_CHECK(strcmp(((struct NDISCMsg *)msg->buf)->ifname, ifname) == 0, "ND walk of %s left it", ifname);
+            ++walked;
+        }
+        TEST_CHECK(walked == nd_per_if[i], "ND walk of %s gave %d, expected %d", ifname, walked, nd_per_if[i]);
+    }
+
+    list = rb = 0;
+    TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+        ++list;
+    RB_FOREACH(msg, arp_rb_tree, &MLACP(csm).arp_rb)
+        ++rb;
+    TEST_CHECK(list == arp_count && rb == arp_count, "ARP list %d index %d, expected %d", list, rb, arp_count);
+
+    list = rb = 0;
+    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+        ++list;
+    RB_FOREACH(msg, ndisc_rb_tree, &MLACP(csm).ndisc_rb)
+        ++rb;
+    TEST_CHECK(list == nd_count && rb == nd_count, "ND list %d index %d, expected %d", list, rb, nd_count);
+}
+
+int main(int argc, char *argv[])
+{
+    struct CSM *csm = NULL;
+    struct Msg *msg = NULL;
+    int steps = 20000;
+    int i;
+
+    if (argc > 1)
+        steps = atoi(argv[1]);
+    if (argc > 2)
+        test_seed = strtoul(argv[2], NULL, 0);
+    if (steps <= 0 || test_seed == 0)
+    {
+        fprintf(stderr, "usage: %s [steps [seed]]    (seed non-zero)\n", argv[0]);
+        return 1;
+    }
+
+    logger_set_configuration(CRITICAL_LOG_LEVEL);
+
+    if (!system_get_instance() || !(csm = system_create_csm()))
+    {
+        printf("FAIL: setup\n");
+        return 1;
+    }
+
+    for (i = 1; i <= steps; i++)
+    {
+        test_step(csm);
+        if (i % TEST_VERIFY_EVERY == 0)
+            test_verify(csm);
+    }
+    test_verify(csm);
+
+    while ((msg = TAILQ_FIRST(&MLACP(csm).arp_list)) != NULL)
+        mlacp_dequeue_arp(csm, msg);
+    while ((msg = TAILQ_FIRST(&MLACP(csm).ndisc_list)) != NULL)
+        mlacp_dequeue_ndisc(csm, msg);
+
+    TEST_CHECK(RB_EMPTY(arp_rb_tree, &MLACP(csm).arp_rb) && RB_EMPTY(arp_if_rb_tree, &MLACP(csm).arp_if_rb)
+               && RB_EMPTY(ndisc_rb_tree, &MLACP(csm).ndisc_rb) && RB_EMPTY(ndisc_if_rb_tree, &MLACP(csm).ndisc_if_rb),
+               "indexes not empty");
+
+    printf("%s\n", test_fail ? "FAIL" : "PASS");
+    return test_fail ? 1 : 0;
+}
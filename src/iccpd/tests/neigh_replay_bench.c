@@ -0,0 +1,258 @@
+/*
+ * neigh_replay_bench.c
+ *
+ * Replays a neighbor add/delete churn through the ARP and ND tables the
+ * way peer sync drives them: every IP is added, re-added with a new MAC,
+ * looked up, walked per interface and deleted in shuffled order. Times are
+ * printed next to the arp_list/ndisc_list walk the indexes replaced; the
+ * walk is timed on a sample, it is quadratic over the whole set.
+ *
+ *   neigh_replay_bench [count]     (default 100000)
+ *
+ * Neighbors are spread over 64 Vlan interfaces.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "../include/system.h"
+#include "../include/logger.h"
+#include "../include/iccp_csm.h"
+#include "../include/mlacp_tlv.h"
+#include "../include/mlacp_sync_update.h"
+
+#define BENCH_IF_COUNT      64
+#define BENCH_WALK_SAMPLE   100
+
+static uint32_t *bench_order;
+
+static void bench_report(const char *what, uint64_t start_usec, uint32_t count)
+{
+    uint64_t usec = system_get_time_usec() - start_usec;
+
+    printf("%-14s %8u in %9.2f ms  %8.0f ns/op\n", what, count, usec / 1000.0,
+           count ? usec * 1000.0 / count : 0.0);
+}
+
+static void bench_ifname(char *buf, size_t len, uint32_t i)
+{
+    snprintf(buf, len, "Vlan%u", 1 + i % BENCH_IF_COUNT);
+}
+
+static void bench_ipv6(uint32_t *addr, uint32_t i)
+{
+    memset(addr, 0, 16);
+    addr[0] = htonl(0x20010db8);
+    addr[3] = htonl(1 + i);
+}
+
+/* Add or re-add every IP, in the replay order */
+static void bench_add(struct CSM *csm, uint32_t count, uint8_t gen)
+{
+    struct ARPMsg arp_buf;
+    struct NDISCMsg ndisc_buf;
+    struct Msg *msg = NULL;
+    uint32_t i, n;
+
+    for (n = 0; n < count; n++)
+    {
+        i = bench_order[n];
+
+        memset(&arp_buf, 0, sizeof(arp_buf));
+        arp_buf.op_type = NEIGH_SYNC_ADD;
+        arp_buf.ipv4_addr = htonl(0x0a000001 + i);
+        arp_buf.mac_addr[0] = 0x02;
+        arp_buf.mac_addr[5] = gen;
+        bench_ifname(arp_buf.ifname, sizeof(arp_buf.ifname), i);
+        if (iccp_csm_init_msg(&msg, (char *)&arp_buf, sizeof(arp_buf)) == 0)
+            mlacp_enqueue_arp(csm, msg);
+
+        memset(&ndisc_buf, 0, sizeof(ndisc_buf));
+        ndisc_buf.op_type = NEIGH_SYNC_ADD;
+        bench_ipv6(ndisc_buf.ipv6_addr, i);
+        ndisc_buf.mac_addr[0] = 0x02;
+        ndisc_buf.mac_addr[5] = gen;
+        bench_ifname(ndisc_buf.ifname, sizeof(ndisc_buf.ifname), i);
+        if (iccp_csm_init_msg(&msg, (char *)&ndisc_buf, sizeof(ndisc_buf)) == 0)
+            mlacp_enqueue_ndisc(csm, msg);
+    }
+}
+
+static uint32_t bench_find(struct CSM *csm, uint32_t count)
+{
+    uint32_t addr[4];
+    uint32_t i, n, found = 0;
+
+    for (n = 0; n < count; n++)
+    {
+        i = bench_order[n];
+        bench_ipv6(addr, i);
+        found += (mlacp_arp_find(csm, htonl(0x0a000001 + i)) != NULL);
+        found += (mlacp_ndisc_find(csm, addr) != NULL);
+    }
+
+    return found;
+}
+
+/* The lookup mlacp_fsm_update_arp_entry() did before the indexes */
+static uint32_t bench_list_find(struct CSM *csm, uint32_t count)
+{
+    struct Msg *msg = NULL;
+    uint32_t addr[4];
+    uint32_t i, n, found = 0;
+
+    for (n = 0; n < count; n++)
+    {
+        i = bench_order[n];
+        bench_ipv6(addr, i);
+        TAILQ_FOREACH(msg, &(MLACP(csm).arp_list), tail)
+        {
+            if (((struct ARPMsg *)msg->buf)->ipv4_addr == htonl(0x0a000001 + i))
+            {
+                ++found;
+                break;
+            }
+        }
+        TAILQ_FOREACH(msg, &(MLACP(csm).ndisc_list), tail)
+        {
+            if (memcmp(((struct NDISCMsg *)msg->buf)->ipv6_addr, addr, 16) == 0)
+            {
+                ++found;
+                break;
+            }
+        }
+    }
+
+    return found;
+}
+
+static uint32_t bench_walk(struct CSM *csm)
+{
+    char ifname[MAX_L_PORT_NAME];
+    struct Msg *msg = NULL;
+    uint32_t i, walked = 0;
+
+    for (i = 0; i < BENCH_IF_COUNT; i++)
+    {
+        bench_ifname(ifname, sizeof(ifname), i);
+        for (msg = mlacp_arp_first_on_if(csm, ifname); msg; msg = mlacp_arp_next_on_if(msg))
+            ++walked;
+        for (msg = mlacp_ndisc_first_on_if(csm, ifname); msg; msg = mlacp_ndisc_next_on_if(msg))
+            ++walked;
+    }
+
+    return walked;
+}
+
+static uint32_t bench_delete(struct CSM *csm, uint32_t count)
+{
+    struct Msg *msg = NULL;
+    uint32_t addr[4];
+    uint32_t i, n, deleted = 0;
+
+    for (n = 0; n < count; n++)
+    {
+        i = bench_order[n];
+        if ((msg = mlacp_arp_find(csm, htonl(0x0a000001 + i))) != NULL)
+        {
+            mlacp_dequeue_arp(csm, msg);
+            ++deleted;
+        }
+        bench_ipv6(addr, i);
+        if ((msg = mlacp_ndisc_find(csm, addr)) != NULL)
+        {
+            mlacp_dequeue_ndisc(csm, msg);
+            ++deleted;
+        }
+    }
+
+    return deleted;
+}
+
+static void bench_shuffle(uint32_t count)
+{
+    uint32_t i, j, tmp;
+
+    for (i = count - 1; i > 0; i--)
+    {
+        j = (uint32_t)rand() % (i + 1);
+        tmp = bench_order[i];
+        bench_order[i] = bench_order[j];
+        bench_order[j] = tmp;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    struct CSM *csm = NULL;
+    uint32_t count = 100000;
+    uint32_t sample, found, walked, deleted, i;
+    uint64_t start;
+    int rc = 0;
+
+    if (argc > 1)
+        count = strtoul(argv[1], NULL, 0);
+    if (count == 0 || count > 0xffffff)
+    {
+        fprintf(stderr, "usage: %s [count]\n", argv[0]);
+        return 1;
+    }
+
+    logger_set_configuration(CRITICAL_LOG_LEVEL);
+
+    if (!system_get_instance() || !(csm = system_create_csm())
+        || !(bench_order = malloc(count * sizeof(*bench_order))))
+    {
+        printf("FAIL: setup\n");
+        return 1;
+    }
+
+    srand(1);
+    for (i = 0; i < count; i++)
+        bench_order[i] = i;
+    bench_shuffle(count);
+
+    start = system_get_time_usec();
+    bench_add(csm, count, 1);
+    bench_report("add", start, 2 * count);
+
+    bench_shuffle(count);
+    start = system_get_time_usec();
+    bench_add(csm, count, 2);
+    bench_report("re-add", start, 2 * count);
+
+    bench_shuffle(count);
+    start = system_get_time_usec();
+    found = bench_find(csm, count);
+    bench_report("find", start, 2 * count);
+
+    sample = count < BENCH_WALK_SAMPLE ? count : BENCH_WALK_SAMPLE;
+    start = system_get_time_usec();
+    found += bench_list_find(csm, sample);
+    bench_report("list walk", start, 2 * sample);
+
+    start = system_get_time_usec();
+    walked = bench_walk(csm);
+    bench_report("walk per if", start, walked);
+
+    bench_shuffle(count);
+    start = system_get_time_usec();
+    deleted = bench_delete(csm, count);
+    bench_report("delete", start, deleted);
+
+    if (found != 2 * (count + sample) || walked != 2 * count || deleted != 2 * count
+        || !TAILQ_EMPTY(&MLACP(csm).arp_list) || !TAILQ_EMPTY(&MLACP(csm).ndisc_list))
+    {
+        printf("FAIL: found %u walked %u deleted %u of %u\n", found, walked, deleted, 2 * count);
+        rc = 1;
+    }
+
+    free(bench_order);
+    return rc;
+}
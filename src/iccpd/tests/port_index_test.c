@@ -0,0 +1,206 @@
+/*
+ * port_index_test.c
+ *
+ * Checks the local interface indexes by name, ifindex and po_id: every
+ * created interface is found under each of its keys, and when a duplicate
+ * key is destroyed the interface it displaced is found again. Creation,
+ * lookup and teardown times for the whole set are printed next to the
+ * lif_list walk the indexes replaced, so a large count doubles as the
+ * interface scale benchmark:
+ *
+ *   port_index_test [if_count]     (default 2000, e.g. 10000)
+ *
+ * One interface in ten is a port-channel, the rest are Ethernet ports.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/system.h"
+#include "../include/logger.h"
+#include "../include/port.h"
+
+#define TEST_IFINDEX_BASE   1000
+
+static int test_fail = 0;
+
+#define TEST_CHECK(cond, fmt, args ...) do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d: " fmt "\n", __FILE__, __LINE__, ## args); \
+            ++test_fail; \
+        } \
+} while (0)
+
+static void test_ifname(char *buf, size_t len, int i)
+{
+    if (i % 10 == 0)
+        snprintf(buf, len, "PortChannel%d", i / 10);
+    else
+        snprintf(buf, len, "Ethernet%d", i);
+}
+
+static void test_report(const char *what, uint64_t start_usec, int count)
+{
+    uint64_t usec = system_get_time_usec() - start_usec;
+
+    printf("%-12s %6d in %9.2f ms  %10.0f/s\n", what, count, usec / 1000.0,
+           count * 1000000.0 / (usec ? usec : 1));
+}
+
+/* The lookup local_if_find_by_name() did before the indexes */
+static struct LocalInterface *test_list_find(struct System *sys, const char *ifname)
+{
+    struct LocalInterface *lif = NULL;
+
+    LIST_FOREACH(lif, &(sys->lif_list), system_next)
+    {
+        if (strcmp(lif->name, ifname) == 0)
+            return lif;
+    }
+
+    return NULL;
+}
+
+static void test_scale(struct System *sys, int count)
+{
+    struct LocalInterface *lif = NULL;
+    char ifname[MAX_L_PORT_NAME];
+    uint64_t start;
+    int i, found;
+
+    start = system_get_time_usec();
+    for (i = 0; i < count; i++)
+    {
+        test_ifname(ifname, sizeof(ifname), i);
+        local_if_create(TEST_IFINDEX_BASE + i, ifname,
+                        (i % 10 == 0) ? IF_T_PORT_CHANNEL : IF_T_PORT, PORT_STATE_UP);
+    }
+    test_report("create", start, count);
+
+    found = 0;
+    start = system_get_time_usec();
+    for (i = 0; i < count; i++)
+    {
+        test_ifname(ifname, sizeof(ifname), i);
+        lif = local_if_find_by_name(ifname);
+        found += (lif && lif->ifindex == TEST_IFINDEX_BASE + i);
+    }
+    test_report("by name", start, count);
+    TEST_CHECK(found == count, "%d of %d found by name", found, count);
+
+    found = 0;
+    start = system_get_time_usec();
+    for (i = 0; i < count; i++)
+    {
+        lif = local_if_find_by_ifindex(TEST_IFINDEX_BASE + i);
+        found += (lif && lif->ifindex == TEST_IFINDEX_BASE + i);
+    }
+    test_report("by ifindex", start, count);
+    TEST_CHECK(found == count, "%d of %d found by ifindex", found, count);
+
+    found = 0;
+    start = system_get_time_usec();
+    for (i = 0; i < count; i += 10)
+    {
+        lif = local_if_find_by_po_id(i / 10);
+        found += (lif && lif->ifindex == TEST_IFINDEX_BASE + i);
+    }
+    test_report("by po_id", start, (count + 9) / 10);
+    TEST_CHECK(found == (count + 9) / 10, "%d of %d found by po_id", found, (count + 9) / 10);
+
+    found = 0;
+    start = system_get_time_usec();
+    for (i = 0; i < count; i++)
+    {
+        test_ifname(ifname, sizeof(ifname), i);
+        found += (test_list_find(sys, ifname) != NULL);
+    }
+    test_report("list walk", start, count);
+    TEST_CHECK(found == count, "%d of %d found by list walk", found, count);
+
+    start = system_get_time_usec();
+    for (i = 0; i < count; i++)
+    {
+        test_ifname(ifname, sizeof(ifname), i);
+        local_if_destroy(ifname);
+    }
+    local_if_purge_clear();
+    test_report("destroy", start, count);
+
+    TEST_CHECK(LIST_EMPTY(&(sys->lif_list)), "lif_list not empty");
+    TEST_CHECK(RB_EMPTY(lif_name_rb_tree, &sys->lif_name_rb)
+               && RB_EMPTY(lif_ifindex_rb_tree, &sys->lif_ifindex_rb)
+               && RB_EMPTY(lif_po_id_rb_tree, &sys->lif_po_id_rb), "indexes not empty");
+}
+
+static void test_duplicate(struct System *sys)
+{
+    struct LocalInterface *port = NULL, *vlan = NULL, *vlan_old = NULL, *vlan_new = NULL;
+
+    /* A config-created Vlan resolves to an ifindex another interface holds */
+    port = local_if_create(500, "Ethernet500", IF_T_PORT, PORT_STATE_UP);
+    vlan = local_if_create(0, "Vlan500", IF_T_VLAN, PORT_STATE_UP);
+    TEST_CHECK(port && vlan, "create");
+    if (!port || !vlan)
+        return;
+
+    local_if_set_ifindex(vlan, 500);
+    TEST_CHECK(local_if_find_by_ifindex(500) == vlan, "newer interface does not win ifindex 500");
+    TEST_CHECK(sys->lif_shadowed_count == 1, "shadowed count %u", sys->lif_shadowed_count);
+
+    local_if_destroy("Vlan500");
+    TEST_CHECK(local_if_find_by_ifindex(500) == port, "ifindex 500 not handed back");
+    TEST_CHECK(sys->lif_shadowed_count == 0, "shadowed count %u", sys->lif_shadowed_count);
+
+    /* Same name twice while the ifindex is unresolved */
+    vlan_old = local_if_create(0, "Vlan600", IF_T_VLAN, PORT_STATE_UP);
+    vlan_new = local_if_create(0, "Vlan600", IF_T_VLAN, PORT_STATE_UP);
+    TEST_CHECK(local_if_find_by_name("Vlan600") == vlan_new, "newer interface does not win Vlan600");
+
+    local_if_destroy("Vlan600");
+    TEST_CHECK(local_if_find_by_name("Vlan600") == vlan_old, "Vlan600 not handed back");
+
+    local_if_set_ifindex(vlan_old, 600);
+    TEST_CHECK(local_if_find_by_ifindex(600) == vlan_old, "ifindex 600 not indexed");
+
+    local_if_destroy("Vlan600");
+    local_if_destroy("Ethernet500");
+    local_if_purge_clear();
+
+    TEST_CHECK(!local_if_find_by_name("Vlan600") && !local_if_find_by_ifindex(500)
+               && !local_if_find_by_ifindex(600), "stale index entries");
+    TEST_CHECK(sys->lif_shadowed_count == 0, "shadowed count %u", sys->lif_shadowed_count);
+}
+
+int main(int argc, char *argv[])
+{
+    struct System *sys = NULL;
+    int count = 2000;
+
+    if (argc > 1)
+        count = atoi(argv[1]);
+    if (count <= 0 || count > 1000000)
+    {
+        fprintf(stderr, "usage: %s [if_count]\n", argv[0]);
+        return 1;
+    }
+
+    logger_set_configuration(CRITICAL_LOG_LEVEL);
+
+    if (!(sys = system_get_instance()))
+    {
+        printf("FAIL: setup\n");
+        return 1;
+    }
+
+    test_scale(sys, count);
+    test_duplicate(sys);
+
+    printf("%s\n", test_fail ? "FAIL" : "PASS");
+    return test_fail ? 1 : 0;
+}
@@ -0,0 +1,326 @@
+/*
+ * warmboot_test.c
+ *
+ * Saves a snapshot of two mLAGs, restores it the way a warm start does and
+ * reconciles it with part of the state re-reported. Checks the restored
+ * counts, that the mapping survives the first mLAG's reconcile for the
+ * second one, and that only stale MACs and ARP/ND entries are purged.
+ * Save, load, restore and reconcile times are printed, so a large count
+ * doubles as the warm reboot benchmark:
+ *
+ *   warmboot_test [mac_count]      (default 2000, e.g. 200000)
+ *
+ * ARP entries are a tenth and ND entries a twentieth of the MAC count.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "../include/system.h"
+#include "../include/logger.h"
+#include "../include/iccp_csm.h"
+#include "../include/mlacp_tlv.h"
+#include "../include/mlacp_sync_update.h"
+#include "../include/iccp_warmboot.h"
+
+#define TEST_MLAG_A     1
+#define TEST_MLAG_B     2
+
+static int test_fail = 0;
+
+#define TEST_CHECK(cond, fmt, args ...) do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d: " fmt "\n", __FILE__, __LINE__, ## args); \
+            ++test_fail; \
+        } \
+} while (0)
+
+static void test_fill(struct CSM *csm, uint32_t mac_count)
+{
+    struct MACMsg mac_buf, *mac_msg = NULL;
+    struct ARPMsg arp_buf;
+    struct NDISCMsg ndisc_buf;
+    struct Msg *msg = NULL;
+    uint32_t i;
+
+    for (i = 0; i < mac_count; i++)
+    {
+        memset(&mac_buf, 0, sizeof(mac_buf));
+        mac_buf.op_type = MAC_SYNC_ADD;
+        mac_buf.vid = 1 + i % 4000;
+        mac_buf.mac_addr[0] = 0x02;
+        mac_buf.mac_addr[2] = (uint8_t)(i >> 24);
+        mac_buf.mac_addr[3] = (uint8_t)(i >> 16);
+        mac_buf.mac_addr[4] = (uint8_t)(i >> 8);
+        mac_buf.mac_addr[5] = (uint8_t)i;
+        snprintf(mac_buf.ifname, sizeof(mac_buf.ifname), "PortChannel%u", i % 64);
+        snprintf(mac_buf.origin_ifname, sizeof(mac_buf.origin_ifname), "%s", mac_buf.ifname);
+
+        if (iccp_csm_init_mac_msg(&mac_msg, (char *)&mac_buf, sizeof(mac_buf)) == 0)
+            RB_INSERT(mac_rb_tree, &MLACP(csm).mac_rb, mac_msg);
+    }
+
+    for (i = 0; i < mac_count / 10; i++)
+    {
+        memset(&arp_buf, 0, sizeof(arp_buf));
+        arp_buf.op_type = NEIGH_SYNC_LIF;
+        arp_buf.learn_flag = (i & 1) ? NEIGH_REMOTE : NEIGH_LOCAL;
+        arp_buf.ipv4_addr = htonl(0x0a000001 + i);
+        arp_buf.mac_addr[0] = 0x02;
+        arp_buf.mac_addr[5] = (uint8_t)i;
+        snprintf(arp_buf.ifname, sizeof(arp_buf.ifname), "Vlan%u", 1 + i % 16);
+
+        if (iccp_csm_init_msg(&msg, (char *)&arp_buf, sizeof(arp_buf)) == 0)
+            mlacp_enqueue_arp(csm, msg);
+    }
+
+    for (i = 0; i < mac_count / 20; i++)
+    {
+        memset(&ndisc_buf, 0, sizeof(ndisc_buf));
+        ndisc_buf.op_type = NEIGH_SYNC_LIF;
+        ndisc_buf.learn_flag = (i & 1) ? NEIGH_REMOTE : NEIGH_LOCAL;
+        ndisc_buf.ipv6_addr[0] = htonl(0x20010db8);
+        ndisc_buf.ipv6_addr[3] = htonl(1 + i);
+        ndisc_buf.mac_addr[0] = 0x02;
+        ndisc_buf.mac_addr[5] = (uint8_t)i;
+        snprintf(ndisc_buf.ifname, sizeof(ndisc_buf.ifname), "Vlan%u", 1 + i % 16);
+
+        if (iccp_csm_init_msg(&msg, (char *)&ndisc_buf, sizeof(ndisc_buf)) == 0)
+            mlacp_enqueue_ndisc(csm, msg);
+    }
+}
+
+/* What a restart leaves behind: empty tables */
+static void test_flush(struct CSM *csm)
+{
+    struct MACMsg *mac_msg = NULL, *mac_temp = NULL;
+    struct Msg *msg = NULL;
+
+    RB_FOREACH_SAFE(mac_msg, mac_rb_tree, &MLACP(csm).mac_rb, mac_temp)
+    {
+        MAC_RB_REMOVE(mac_rb_tree, &MLACP(csm).mac_rb, mac_msg);
+        free(mac_msg);
+    }
+
+    while ((msg = TAILQ_FIRST(&MLACP(csm).arp_list)) != NULL)
+        mlacp_dequeue_arp(csm, msg);
+    while ((msg = TAILQ_FIRST(&MLACP(csm).ndisc_list)) != NULL)
+        mlacp_dequeue_ndisc(csm, msg);
+
+    MLACP(csm).warm_restored = 0;
+}
+
+static void test_count(struct CSM *csm, uint32_t *mac, uint32_t *neigh, uint32_t *stale)
+{
+    struct MACMsg *mac_msg = NULL;
+    struct Msg *msg = NULL;
+
+    *mac = *neigh = *stale = 0;
+
+    RB_FOREACH(mac_msg, mac_rb_tree, &MLACP(csm).mac_rb)
+    {
+        ++(*mac);
+        *stale += mac_msg->warm_stale;
+    }
+    TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+    {
+        ++(*neigh);
+        *stale += msg->warm_stale;
+    }
+    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+    {
+        ++(*neigh);
+        *stale += msg->warm_stale;
+    }
+}
+
+/* Stand in for mclagsyncd and the peer re-reporting every other entry */
+static uint32_t test_rereport(struct CSM *csm)
+{
+    struct MACMsg *mac_msg = NULL;
+    struct Msg *msg = NULL;
+    uint32_t i = 0, kept = 0;
+
+    RB_FOREACH(mac_msg, mac_rb_tree, &MLACP(csm).mac_rb)
+    {
+        if (i++ & 1)
+            continue;
+        mac_msg->warm_stale = 0;
+        ++kept;
+    }
+    TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+    {
+        if (i++ & 1)
+            continue;
+        msg->warm_stale = 0;
+        ++kept;
+    }
+    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+    {
+        if (i++ & 1)
+            continue;
+        msg->warm_stale = 0;
+        ++kept;
+    }
+
+    return kept;
+}
+
+static uint32_t test_stale_local_neigh(struct CSM *csm)
+{
+    struct Msg *msg = NULL;
+    uint32_t count = 0;
+
+    TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+        count += (msg->warm_stale && ((struct ARPMsg *)msg->buf)->learn_flag != NEIGH_REMOTE);
+    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+        count += (msg->warm_stale && ((struct NDISCMsg *)msg->buf)->learn_flag != NEIGH_REMOTE);
+
+    return count;
+}
+
+static uint32_t test_msg_list_len(struct CSM *csm)
+{
+    struct Msg *msg = NULL;
+    uint32_t count = 0;
+
+    TAILQ_FOREACH(msg, &MLACP(csm).arp_msg_list, tail)
+        ++count;
+    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_msg_list, tail)
+        ++count;
+
+    return count;
+}
+
+static void test_report(const char *what, uint64_t start_usec, uint32_t entries)
+{
+    uint64_t usec = system_get_time_usec() - start_usec;
+
+    printf("%-10s %8u entries in %9.1f ms\n", what, entries, usec / 1000.0);
+}
+
+/* Returns the number of entries that should have been purged */
+static uint32_t test_reconcile(struct CSM *csm, uint32_t total)
+{
+    uint32_t mac, neigh, stale, kept, stale_local, queued;
+    uint64_t start;
+
+    kept = test_rereport(csm);
+    stale_local = test_stale_local_neigh(csm);
+    queued = test_msg_list_len(csm);
+
+    /* Session up long enough, peer in sync */
+    MLACP(csm).current_state = MLACP_STATE_EXCHANGE;
+    MLACP(csm).warm_reconcile_time = 1;
+
+    start = system_get_time_usec();
+    iccp_warmboot_reconcile(csm);
+    test_report("reconcile", start, total - kept);
+
+    test_count(csm, &mac, &neigh, &stale);
+    TEST_CHECK(mac + neigh == kept, "mlag %d kept %u, expected %u", csm->mlag_id, mac + neigh, kept);
+    TEST_CHECK(stale == 0, "mlag %d %u stale entries left", csm->mlag_id, stale);
+    TEST_CHECK(test_msg_list_len(csm) - queued == stale_local,
+               "mlag %d %u deletes queued to peer, expected %u",
+               csm->mlag_id, test_msg_list_len(csm) - queued, stale_local);
+    TEST_CHECK(MLACP(csm).warm_reconcile_time == 0 && !MLACP(csm).warm_restored,
+               "mlag %d reconcile state not cleared", csm->mlag_id);
+
+    return total - kept;
+}
+
+int main(int argc, char *argv[])
+{
+    struct System *sys = NULL;
+    struct CSM *csm_a = NULL, *csm_b = NULL;
+    char dir[] = "/tmp/iccpd_warmboot_XXXXXX";
+    char path[sizeof(dir) + 32];
+    uint32_t mac_count = 2000;
+    uint32_t total, mac, neigh, stale, purged;
+    uint64_t start;
+
+    if (argc > 1)
+        mac_count = strtoul(argv[1], NULL, 0);
+    if (mac_count < 20 || mac_count > 0xffffff)
+    {
+        fprintf(stderr, "usage: %s [mac_count]\n", argv[0]);
+        return 1;
+    }
+    total = mac_count + mac_count / 10 + mac_count / 20;
+
+    logger_set_configuration(CRITICAL_LOG_LEVEL);
+
+    if (!mkdtemp(dir) || !(sys = system_get_instance()))
+    {
+        printf("FAIL: setup\n");
+        return 1;
+    }
+
+    snprintf(path, sizeof(path), "%s/iccpd_snapshot.bin", dir);
+    free(sys->warmboot_file_path);
+    sys->warmboot_file_path = strdup(path);
+
+    csm_a = system_create_csm();
+    csm_b = system_create_csm();
+    csm_a->mlag_id = TEST_MLAG_A;
+    csm_b->mlag_id = TEST_MLAG_B;
+    test_fill(csm_a, mac_count);
+    test_fill(csm_b, mac_count);
+
+    start = system_get_time_usec();
+    TEST_CHECK(iccp_warmboot_snapshot_save() == 0, "save");
+    test_report("save", start, 2 * total);
+
+    test_flush(csm_a);
+    test_flush(csm_b);
+
+    start = system_get_time_usec();
+    TEST_CHECK(iccp_warmboot_snapshot_load() == 0, "load");
+    test_report("load", start, 2 * total);
+    TEST_CHECK(access(path, F_OK) < 0, "snapshot not unlinked after load");
+
+    /* mlag A comes up and reconciles before mlag B is configured */
+    start = system_get_time_usec();
+    iccp_warmboot_snapshot_restore(csm_a);
+    test_report("restore", start, total);
+
+    test_count(csm_a, &mac, &neigh, &stale);
+    TEST_CHECK(mac == mac_count, "mlag A restored %u MAC, expected %u", mac, mac_count);
+    TEST_CHECK(mac + neigh == total && stale == total,
+               "mlag A restored %u entries, %u stale, expected %u", mac + neigh, stale, total);
+
+    purged = test_reconcile(csm_a, total);
+
+    iccp_warmboot_snapshot_restore(csm_b);
+    test_count(csm_b, &mac, &neigh, &stale);
+    TEST_CHECK(mac + neigh == total && stale == total,
+               "mlag B restored %u entries, %u stale after mlag A reconcile, expected %u",
+               mac + neigh, stale, total);
+
+    purged += test_reconcile(csm_b, total);
+
+    TEST_CHECK(sys->dbg_counters.warm_restore_mac_counter == 2 * mac_count,
+               "restore MAC counter %u", sys->dbg_counters.warm_restore_mac_counter);
+    TEST_CHECK(sys->dbg_counters.warm_purge_mac_counter + sys->dbg_counters.warm_purge_neigh_counter
+               == purged,
+               "purge counters %u + %u", sys->dbg_counters.warm_purge_mac_counter,
+               sys->dbg_counters.warm_purge_neigh_counter);
+
+    /* A corrupt snapshot is ignored and removed */
+    TEST_CHECK(iccp_warmboot_snapshot_save() == 0, "second save");
+    TEST_CHECK(truncate(path, sizeof(struct iccp_warmboot_hdr) + 1) == 0, "truncate");
+    TEST_CHECK(iccp_warmboot_snapshot_load() < 0, "truncated snapshot accepted");
+    TEST_CHECK(access(path, F_OK) < 0, "bad snapshot not unlinked");
+
+    rmdir(dir);
+
+    printf("%s\n", test_fail ? "FAIL" : "PASS");
+    return test_fail ? 1 : 0;
+}
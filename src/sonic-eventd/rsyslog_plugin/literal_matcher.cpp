@@ -0,0 +1,99 @@
+#include <queue>
+#include "literal_matcher.h"
+
+/***
+ *
+ * Adds a literal to the set, duplicates share one id
+ *
+ * @param pattern literal that must appear verbatim in the message
+ * @return id of the pattern, used as index into hits from search
+ *
+ */
+
+size_t LiteralMatcher::addPattern(const string& pattern) {
+    auto it = m_patternIds.find(pattern);
+    if(it != m_patternIds.end()) {
+        return it->second;
+    }
+    size_t id = m_patterns.size();
+    m_patterns.push_back(pattern);
+    m_patternIds[pattern] = id;
+    m_compiled = false;
+    return id;
+}
+
+void LiteralMatcher::compile() {
+    m_transitions.assign(ALPHABET_SIZE, -1);
+    m_outputs.assign(1, vector<size_t>());
+
+    // build trie of all patterns
+    for(size_t id = 0; id < m_patterns.size(); id++) {
+        int state = 0;
+        for(unsigned char c : m_patterns[id]) {
+            int& next = m_transitions[state * ALPHABET_SIZE + c];
+            if(next == -1) {
+                next = (int)m_outputs.size();
+                m_transitions.resize(m_transitions.size() + ALPHABET_SIZE, -1);
+                m_outputs.push_back(vector<size_t>());
+            }
+            state = m_transitions[state * ALPHABET_SIZE + c];
+        }
+        m_outputs[state].push_back(id);
+    }
+
+    // breadth first over the trie, turning fail links into direct transitions
+    vector<int> fail(m_outputs.size(), 0);
+    queue<int> pending;
+    for(int c = 0; c < ALPHABET_SIZE; c++) {
+        int& next = m_transitions[c];
+        if(next == -1) {
+            next = 0;
+        } else {
+            pending.push(next);
+        }
+    }
+    while(!pending.empty()) {
+        int state = pending.front();
+        pending.pop();
+        const vector<size_t>& suffixOutputs = m_outputs[fail[state]];
+        m_outputs[state].insert(m_outputs[state].end(), suffixOutputs.begin(), suffixOutputs.end());
+        for(int c = 0; c < ALPHABET_SIZE; c++) {
+            int& next = m_transitions[state * ALPHABET_SIZE + c];
+            int fallback = m_transitions[fail[state] * ALPHABET_SIZE + c];
+            if(next == -1) {
+                next = fallback;
+            } else {
+                fail[next] = fallback;
+                pending.push(next);
+            }
+        }
+    }
+    m_compiled = true;
+}
+
+/***
+ *
+ * Scans text once and flags every pattern found in it
+ *
+ * @param text message to scan
+ * @param hits resized to patternCount(), hits[id] is true if pattern id occurs in text
+ *
+ */
+
+void LiteralMatcher::search(string_view text, vector<bool>& hits) const {
+    hits.assign(m_patterns.size(), false);
+    if(!m_compiled || m_patterns.empty()) {
+        return;
+    }
+    int state = 0;
+    for(unsigned char c : text) {
+        state = m_transitions[state * ALPHABET_SIZE + c];
+        for(size_t id : m_outputs[state]) {
+            hits[id] = true;
+        }
+    }
+}
+
+LiteralMatcher::LiteralMatcher() {
+    m_compiled = false;
+}
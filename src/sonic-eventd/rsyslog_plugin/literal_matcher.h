@@ -0,0 +1,35 @@
+#ifndef LITERAL_MATCHER_H
+#define LITERAL_MATCHER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+/***
+ *
+ * LiteralMatcher finds which of a fixed set of literal strings occur in a message in a single pass.
+ * Patterns are compiled into an Aho-Corasick automaton with a full transition table.
+ *
+ */
+
+class LiteralMatcher {
+public:
+    size_t addPattern(const string& pattern);
+    void compile();
+    void search(string_view text, vector<bool>& hits) const;
+    size_t patternCount() const { return m_patterns.size(); }
+    bool isCompiled() const { return m_compiled; }
+    LiteralMatcher();
+private:
+    static const int ALPHABET_SIZE = 256;
+    vector<string> m_patterns;
+    unordered_map<string, size_t> m_patternIds;
+    vector<int> m_transitions; // ALPHABET_SIZE entries per state
+    vector<vector<size_t>> m_outputs; // patterns ending at each state, suffix matches included
+    bool m_compiled;
+};
+
+#endif
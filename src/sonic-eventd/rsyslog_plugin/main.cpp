@@ -12,6 +12,7 @@ void showUsage() {
     cout << "Usage for rsyslog_plugin: \n" << "options\n"
         << "\t-r,required,type=string\t\tPath to regex file\n"
         << "\t-m,required,type=string\t\tYANG module name of source generating syslog message\n"
+        << "\t-b,optional,type=string\t\tReplay a captured syslog file without publishing and report lines per second\n"
         << "\t-h                     \t\tHelp"
         << endl;
 }
@@ -19,9 +20,10 @@ void showUsage() {
 int main(int argc, char** argv) {
     string regexPath;
     string moduleName;
+    string corpusPath;
     int optionVal;
 
-    while((optionVal = getopt(argc, argv, "r:m:h")) != -1) {
+    while((optionVal = getopt(argc, argv, "r:m:b:h")) != -1) {
         switch(optionVal) {
             case 'r':
                 regexPath = optarg;
@@ -29,6 +31,9 @@ int main(int argc, char** argv) {
             case 'm':
                 moduleName = optarg;
                 break;
+            case 'b':
+                corpusPath = optarg;
+                break;
             case 'h':
             case '?':
             default:
@@ -37,6 +42,11 @@ int main(int argc, char** argv) {
         }
     }
 
+    if(!regexPath.empty() && !corpusPath.empty()) { // benchmark mode, no events published
+        unique_ptr<RsyslogPlugin> plugin(new RsyslogPlugin(moduleName, regexPath));
+        return plugin->replay(corpusPath);
+    }
+
     if(regexPath.empty() || moduleName.empty()) { // Missing required rc path
         cerr << "Error: Missing regexPath and moduleName." << endl;
         return MISSING_ARGS_ERROR_CODE;
@@ -5,14 +5,26 @@
 #include <ctime>
 #include <unordered_map>
 #include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <swss/schema.h>
 #include "rsyslog_plugin.h"
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 
+#define READ_CHUNK_SIZE (64 * 1024)
+#define EVENT_QUEUE_SIZE 4096
+#define PUBLISH_BATCH_SIZE 256
+#define STATS_WRITE_INTERVAL_MS 1000
+#define STATS_KEY_PREFIX "rsyslog_plugin:"
+
 std::atomic<bool> RsyslogPlugin::g_running;
 
-bool RsyslogPlugin::onMessage(string msg, lua_State* luaState) {
+bool RsyslogPlugin::onMessage(const string& msg, lua_State* luaState) {
     string tag;
     event_params_t paramDict;
     if(!m_parser->parseMessage(msg, tag, paramDict, luaState)) {
@@ -65,7 +77,6 @@ bool RsyslogPlugin::createRegexList() {
     }
 
     string regexString;
-    string timestampRegex = "^([a-zA-Z]{3})?\\s*([0-9]{1,2})?\\s*([0-9]{2}:[0-9]{2}:[0-9]{2}.[0-9]{0,6})?\\s*";
     regex expression;
     vector<RegexStruct> regexList;
 
@@ -74,7 +85,7 @@ bool RsyslogPlugin::createRegexList() {
         vector<EventParam> eventParams;
         try {
             string eventRegex = jsonList[i]["regex"];
-            regexString = timestampRegex + eventRegex;
+            regexString = TIMESTAMP_REGEX + eventRegex;
             string tag = jsonList[i]["tag"];
             vector<string> params = jsonList[i]["params"];
             vector<string> timestampParams = { "month", "day", "time" };
@@ -85,6 +96,13 @@ bool RsyslogPlugin::createRegexList() {
             rs.params = eventParams;
             rs.tag = tag;
             rs.regexExpression = expression;
+            // backreferences would be renumbered by the timestamp groups, keep those on the full regex
+            rs.hasBody = !regex_search(eventRegex, regex("\\\\[1-9]"));
+            if(rs.hasBody) {
+                rs.bodyExpression = regex(eventRegex);
+            }
+            rs.anchors = SyslogParser::extractAnchors(eventRegex);
+            rs.luaBatch = jsonList[i].value("lua_batch", false);
             regexList.push_back(rs);
         } catch (nlohmann::detail::type_error& deException) {
             SWSS_LOG_ERROR("Missing required key, throws exception: %s\n", deException.what());
@@ -101,23 +119,261 @@ bool RsyslogPlugin::createRegexList() {
     }
 
     m_parser->m_regexList = regexList;
+    m_parser->buildPrefilter();
+    if(!m_parser->compileLua(m_luaState)) {
+        SWSS_LOG_ERROR("Some lua code in %s does not compile, it is run uncompiled\n", m_regexPath.c_str());
+    }
 
     regexFile.close();
     return true;
 }
 
+/**
+ * Reads whatever the input has available, up to size bytes
+ *
+ * An input stream given to run() is read through the stream, stdin is read with read() so a live
+ * pipe returns as soon as data arrives instead of waiting for a full chunk.
+ *
+*/
+
+ssize_t RsyslogPlugin::readChunk(char* buffer, size_t size) {
+    if(m_input != NULL) {
+        m_input->read(buffer, size);
+        return m_input->gcount();
+    }
+    ssize_t readLen;
+    do {
+        readLen = read(STDIN_FILENO, buffer, size);
+    } while(readLen < 0 && errno == EINTR && RsyslogPlugin::g_running);
+    return readLen;
+}
+
+bool RsyslogPlugin::enqueueMessage(string_view msg) {
+    PendingEvent event;
+    if(!m_parser->parseMessage(msg, event.tag, event.params, m_luaState)) {
+        SWSS_LOG_DEBUG("%.*s was not able to be parsed into a structured event\n", (int)msg.size(), msg.data());
+        return false;
+    }
+
+    unique_lock<mutex> lock(m_queueMutex);
+    if(m_eventQueue.size() >= EVENT_QUEUE_SIZE) {
+        m_publishStats.queueFullWaits++;
+        m_queueNotFull.wait(lock, [this]() { return m_eventQueue.size() < EVENT_QUEUE_SIZE; });
+    }
+    m_eventQueue.push_back(move(event));
+    m_publishStats.enqueued++;
+    m_publishStats.queueMaxDepth = max<uint64_t>(m_publishStats.queueMaxDepth, m_eventQueue.size());
+    lock.unlock();
+    m_queueNotEmpty.notify_one();
+    return true;
+}
+
+/**
+ * Connects to COUNTERS_DB for the publish stats, the plugin runs without them if the DB is not reachable
+ *
+*/
+
+void RsyslogPlugin::initStats() {
+    string regexFile = m_regexPath.substr(m_regexPath.find_last_of('/') + 1);
+    m_statsKey = STATS_KEY_PREFIX + m_moduleName + ":" + regexFile.substr(0, regexFile.find('.'));
+    try {
+        m_countersDb = make_shared<DBConnector>("COUNTERS_DB", 0, false);
+        m_statsTable = unique_ptr<Table>(new Table(m_countersDb.get(), COUNTERS_EVENTS_TABLE));
+    } catch (exception& e) {
+        SWSS_LOG_ERROR("rsyslog_plugin %s cannot write stats to COUNTERS_DB: %s\n", m_statsKey.c_str(), e.what());
+        m_statsTable.reset();
+        m_countersDb.reset();
+    }
+}
+
+void RsyslogPlugin::writeStats() {
+    if(!m_statsTable) {
+        return;
+    }
+    PublishStats stats = getPublishStats();
+    if(stats.enqueued == m_writtenStats.enqueued && stats.published == m_writtenStats.published &&
+        stats.publishFailed == m_writtenStats.publishFailed && stats.queueFullWaits == m_writtenStats.queueFullWaits) {
+        return;
+    }
+    vector<FieldValueTuple> fv;
+    fv.emplace_back("enqueued", to_string(stats.enqueued));
+    fv.emplace_back("published", to_string(stats.published));
+    fv.emplace_back("publish_failed", to_string(stats.publishFailed));
+    fv.emplace_back("batches", to_string(stats.batches));
+    fv.emplace_back("queue_full_waits", to_string(stats.queueFullWaits));
+    fv.emplace_back("queue_max_depth", to_string(stats.queueMaxDepth));
+    try {
+        m_statsTable->set(m_statsKey, fv);
+        m_writtenStats = stats;
+    } catch (exception& e) {
+        SWSS_LOG_ERROR("rsyslog_plugin %s failed to write stats: %s\n", m_statsKey.c_str(), e.what());
+    }
+}
+
+/**
+ * Publisher thread, takes up to PUBLISH_BATCH_SIZE events per wakeup and publishes them outside the lock
+ * Writes the stats at most every STATS_WRITE_INTERVAL_MS, and once the queue goes idle.
+ * Returns once stopped and the queue is drained.
+ *
+*/
+
+void RsyslogPlugin::publishEvents() {
+    vector<PendingEvent> batch;
+    uint64_t published = 0;
+    uint64_t publishFailed = 0;
+    auto statsWritten = chrono::steady_clock::now();
+
+    batch.reserve(PUBLISH_BATCH_SIZE);
+    while(true) {
+        {
+            unique_lock<mutex> lock(m_queueMutex);
+            m_publishStats.published += published;
+            m_publishStats.publishFailed += publishFailed;
+            published = 0;
+            publishFailed = 0;
+            if(!m_queueNotEmpty.wait_for(lock, chrono::milliseconds(STATS_WRITE_INTERVAL_MS),
+                    [this]() { return !m_eventQueue.empty() || m_publisherStop; })) {
+                lock.unlock();
+                writeStats(); // idle, skipped if nothing changed
+                statsWritten = chrono::steady_clock::now();
+                continue;
+            }
+            if(m_eventQueue.empty()) {
+                break;
+            }
+            size_t count = min<size_t>(m_eventQueue.size(), PUBLISH_BATCH_SIZE);
+            move(m_eventQueue.begin(), m_eventQueue.begin() + count, back_inserter(batch));
+            m_eventQueue.erase(m_eventQueue.begin(), m_eventQueue.begin() + count);
+            m_publishStats.batches++;
+        }
+        m_queueNotFull.notify_one();
+
+        for(auto& event : batch) {
+            if(event_publish(m_eventHandle, event.tag, &event.params) != 0) {
+                SWSS_LOG_ERROR("rsyslog_plugin was not able to publish event for %s.\n", event.tag.c_str());
+                publishFailed++;
+            } else {
+                published++;
+            }
+        }
+        batch.clear();
+
+        if(chrono::steady_clock::now() - statsWritten >= chrono::milliseconds(STATS_WRITE_INTERVAL_MS)) {
+            {
+                lock_guard<mutex> lock(m_queueMutex);
+                m_publishStats.published += published;
+                m_publishStats.publishFailed += publishFailed;
+            }
+            published = 0;
+            publishFailed = 0;
+            writeStats();
+            statsWritten = chrono::steady_clock::now();
+        }
+    }
+}
+
+PublishStats RsyslogPlugin::getPublishStats() {
+    lock_guard<mutex> lock(m_queueMutex);
+    return m_publishStats;
+}
+
 void RsyslogPlugin::run() {
+    m_input = NULL;
+    runInput();
+}
+
+void RsyslogPlugin::run(istream& input) {
+    m_input = &input;
+    runInput();
+    m_input = NULL;
+}
+
+void RsyslogPlugin::runInput() {
     signal(SIGTERM, RsyslogPlugin::signalHandler);
-    lua_State* luaState = luaL_newstate();
-    luaL_openlibs(luaState);
+
+    m_publisherStop = false;
+    thread publisher(&RsyslogPlugin::publishEvents, this);
+
+    vector<char> buffer(READ_CHUNK_SIZE);
+    size_t pending = 0; // incomplete line carried over at the start of buffer
+    while(RsyslogPlugin::g_running) {
+        if(pending == buffer.size()) { // line longer than the buffer
+            buffer.resize(buffer.size() * 2);
+        }
+        ssize_t readLen = readChunk(buffer.data() + pending, buffer.size() - pending);
+        if(readLen <= 0) {
+            break;
+        }
+        const char* start = buffer.data();
+        const char* end = buffer.data() + pending + readLen;
+        const char* newline;
+        while(RsyslogPlugin::g_running && (newline = (const char*)memchr(start, '\n', end - start)) != NULL) {
+            if(newline != start) {
+                enqueueMessage(string_view(start, newline - start));
+            }
+            start = newline + 1;
+        }
+        pending = end - start;
+        memmove(buffer.data(), start, pending);
+    }
+    if(RsyslogPlugin::g_running && pending > 0) { // last line without newline
+        enqueueMessage(string_view(buffer.data(), pending));
+    }
+
+    {
+        lock_guard<mutex> lock(m_queueMutex);
+        m_publisherStop = true;
+    }
+    m_queueNotEmpty.notify_one();
+    publisher.join();
+    writeStats();
+
+    PublishStats stats = getPublishStats();
+    SWSS_LOG_NOTICE("Rsyslog plugin published %lu of %lu events in %lu batches, %lu failed, queue full %lu times, max depth %lu",
+        stats.published, stats.enqueued, stats.batches, stats.publishFailed, stats.queueFullWaits, stats.queueMaxDepth);
+}
+
+/**
+ * Replays a captured syslog corpus through the parser without publishing, to measure throughput
+ *
+ * @param corpusPath file with one syslog line per line
+ * @return 0 on success, 1 for invalid regex file, 3 if the corpus cannot be read
+ *
+*/
+
+int RsyslogPlugin::replay(string corpusPath) {
+    if(!createRegexList()) {
+        return 1;
+    }
+    ifstream corpusFile(corpusPath);
+    if(!corpusFile) {
+        SWSS_LOG_ERROR("No such path exists: %s for replay corpus\n", corpusPath.c_str());
+        return 3;
+    }
+    vector<string> lines;
     string line;
-    while(RsyslogPlugin::g_running && getline(cin, line)) {
-        if(line.empty()) {
-            continue;
+    while(getline(corpusFile, line)) {
+        if(!line.empty()) {
+            lines.push_back(line);
+        }
+    }
+    corpusFile.close();
+
+    long unsigned int matched = 0;
+    auto start = chrono::steady_clock::now();
+    for(const string& message : lines) {
+        string tag;
+        event_params_t paramDict;
+        if(m_parser->parseMessage(message, tag, paramDict, m_luaState)) {
+            matched++;
         }
-        onMessage(line, luaState);
     }
-    lua_close(luaState);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    double linesPerSec = elapsed.count() > 0 ? lines.size() / elapsed.count() : 0;
+    cout << "lines: " << lines.size() << " matched: " << matched
+        << " seconds: " << elapsed.count() << " lines/sec: " << (long unsigned int)linesPerSec << endl;
+    return 0;
 }
 
 int RsyslogPlugin::onInit() {
@@ -128,6 +384,7 @@ int RsyslogPlugin::onInit() {
     } else if(m_eventHandle == NULL) {
         return 2; // event init publish error code
     }
+    initStats();
     return 0;
 }
 
@@ -135,5 +392,13 @@ RsyslogPlugin::RsyslogPlugin(string moduleName, string regexPath) {
     m_parser = unique_ptr<SyslogParser>(new SyslogParser());
     m_moduleName = moduleName;
     m_regexPath = regexPath;
+    m_input = NULL;
+    m_publisherStop = false;
+    m_luaState = luaL_newstate();
+    luaL_openlibs(m_luaState);
     RsyslogPlugin::g_running = true;
 }
+
+RsyslogPlugin::~RsyslogPlugin() {
+    lua_close(m_luaState);
+}
@@ -8,29 +8,59 @@ extern "C"
     #include <lua5.1/lauxlib.h>
 }
 #include <string>
+#include <string_view>
 #include <memory>
 #include <csignal>
 #include <atomic>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <istream>
 #include <swss/logger.h>
 #include <swss/events.h>
+#include <swss/dbconnector.h>
+#include <swss/table.h>
 #include "syslog_parser.h"
 
 using namespace std;
 using namespace swss;
 
+struct PendingEvent {
+    string tag;
+    event_params_t params;
+};
+
+struct PublishStats {
+    uint64_t enqueued = 0;
+    uint64_t published = 0;
+    uint64_t publishFailed = 0;
+    uint64_t batches = 0;
+    uint64_t queueFullWaits = 0; // reader blocked on a full queue
+    uint64_t queueMaxDepth = 0;
+};
+
 /**
  * Rsyslog Plugin will utilize an instance of a syslog parser to read syslog messages from rsyslog.d and will continuously read from stdin
  * A plugin instance is created for each container/host.
  *
+ * run() reads stdin in large chunks and parses lines in place, parsed events go through a bounded
+ * queue to a publisher thread that drains them in batches. A full queue blocks the reader, pushing
+ * back on rsyslog, and is counted in PublishStats. The stats are written to COUNTERS_DB under
+ * COUNTERS_EVENTS|rsyslog_plugin:<module>:<regex file name>, at most once per second while running.
+ *
  */
 
 class RsyslogPlugin {
 public:
     static atomic<bool> g_running;
     int onInit();
-    bool onMessage(string msg, lua_State* luaState);
+    bool onMessage(const string& msg, lua_State* luaState);
     void run();
+    void run(istream& input);
+    PublishStats getPublishStats();
+    int replay(string corpusPath);
     RsyslogPlugin(string moduleName, string regexPath);
+    ~RsyslogPlugin();
     static void signalHandler(int signum) {
         if (signum == SIGTERM) {
             SWSS_LOG_INFO("Rsyslog plugin received SIGTERM, shutting down");
@@ -39,10 +69,28 @@ public:
     }
 private:
     unique_ptr<SyslogParser> m_parser;
+    lua_State* m_luaState;
     event_handle_t m_eventHandle;
     string m_regexPath;
     string m_moduleName;
+    istream* m_input; // NULL reads STDIN_FILENO
+    mutex m_queueMutex;
+    condition_variable m_queueNotEmpty;
+    condition_variable m_queueNotFull;
+    deque<PendingEvent> m_eventQueue;
+    bool m_publisherStop;
+    PublishStats m_publishStats;
+    shared_ptr<DBConnector> m_countersDb;
+    unique_ptr<Table> m_statsTable;
+    string m_statsKey;
+    PublishStats m_writtenStats;
     bool createRegexList();
+    void initStats();
+    void writeStats();
+    ssize_t readChunk(char* buffer, size_t size);
+    bool enqueueMessage(string_view msg);
+    void publishEvents();
+    void runInput();
 };
 
 #endif
@@ -1,8 +1,327 @@
 #include <iostream>
 #include <ctime>
+#include <cctype>
 #include <swss/logger.h>
 #include "syslog_parser.h"
 
+#define MIN_ANCHOR_LENGTH 3
+
+/**
+ * Collects the literal runs a regex requires at top level, outside groups and classes
+ *
+ * @param expression is the event regex without the timestamp prefix
+ * @return literals every match must contain, empty if none can be proven (e.g. top level alternation)
+ *
+*/
+
+vector<string> SyslogParser::extractAnchors(const string& expression) {
+    vector<string> anchors;
+    string run;
+    int depth = 0;
+    bool lastWasLiteral = false;
+
+    auto flush = [&]() {
+        if(run.size() >= MIN_ANCHOR_LENGTH) {
+            anchors.push_back(run);
+        }
+        run.clear();
+    };
+
+    for(size_t i = 0; i < expression.size(); i++) {
+        char c = expression[i];
+        bool literal = false;
+        char literalChar = c;
+
+        if(c == '\\') {
+            if(i + 1 >= expression.size()) {
+                return vector<string>();
+            }
+            char escaped = expression[++i];
+            if(isalnum((unsigned char)escaped)) {
+                if(string("dDsSwWbB").find(escaped) == string::npos) {
+                    return vector<string>(); // backreference or code escape, give up
+                }
+                flush();
+            } else {
+                literal = true;
+                literalChar = escaped;
+            }
+        } else if(c == '[') {
+            flush();
+            for(i++; i < expression.size() && expression[i] != ']'; i++) {
+                if(expression[i] == '\\') {
+                    i++;
+                }
+            }
+        } else if(c == '(') {
+            depth++;
+            flush();
+        } else if(c == ')') {
+            depth--;
+            flush();
+        } else if(c == '|') {
+            if(depth == 0) {
+                return vector<string>();
+            }
+            flush();
+        } else if(c == '*' || c == '?' || c == '{') {
+            if(lastWasLiteral && !run.empty()) {
+                run.pop_back(); // preceding char is optional
+            }
+            flush();
+            if(c == '{') {
+                i = expression.find('}', i);
+                if(i == string::npos) {
+                    return vector<string>();
+                }
+            }
+        } else if(c == '+') {
+            flush(); // preceding char stays required but repeats
+        } else if(c == '.' || c == '^' || c == '$') {
+            flush();
+        } else {
+            literal = true;
+        }
+
+        if(literal && depth == 0) {
+            run += literalChar;
+            lastWasLiteral = true;
+        } else {
+            if(literal) {
+                flush();
+            }
+            lastWasLiteral = false;
+        }
+    }
+    flush();
+    return anchors;
+}
+
+/**
+ * Compiles the anchors of every rule in m_regexList into one literal matcher
+ *
+*/
+
+void SyslogParser::buildPrefilter() {
+    m_anchorMatcher = LiteralMatcher();
+    m_ruleAnchors.assign(m_regexList.size(), vector<size_t>());
+    for(long unsigned int i = 0; i < m_regexList.size(); i++) {
+        for(const string& anchor : m_regexList[i].anchors) {
+            m_ruleAnchors[i].push_back(m_anchorMatcher.addPattern(anchor));
+        }
+    }
+    m_anchorMatcher.compile();
+    SWSS_LOG_INFO("Built prefilter with %zu anchors for %zu rules", m_anchorMatcher.patternCount(), m_regexList.size());
+}
+
+/**
+ * Matches one rule, filling values with month, day, time and then the rule's own captures
+ *
+ * The timestamp prefix is matched at most once per message and shared by all rules with a body
+ * expression. If the body does not match right after the greedy prefix, the full regex is tried
+ * so results stay identical to matching the combined expression.
+ *
+*/
+
+bool SyslogParser::matchRule(const RegexStruct& rule, string_view message, cmatch& timestampResults, bool& timestampParsed, vector<string>& values) {
+    const char* messageStart = message.data();
+    const char* messageEnd = message.data() + message.size();
+
+    values.clear();
+    if(rule.hasBody) {
+        if(!timestampParsed) {
+            regex_search(messageStart, messageEnd, timestampResults, m_timestampExpression, regex_constants::match_continuous);
+            timestampParsed = true;
+        }
+        if(!timestampResults.empty()) {
+            cmatch bodyResults;
+            const char* bodyStart = timestampResults[0].second;
+            auto flags = regex_constants::match_continuous;
+            if(bodyStart != messageStart) {
+                flags |= regex_constants::match_prev_avail;
+            }
+            if(regex_search(bodyStart, messageEnd, bodyResults, rule.bodyExpression, flags)) {
+                if(rule.params.size() != bodyResults.size() + 2) {
+                    return false;
+                }
+                for(int j = 1; j <= 3; j++) {
+                    values.push_back(timestampResults[j].str());
+                }
+                for(long unsigned int j = 1; j < bodyResults.size(); j++) {
+                    values.push_back(bodyResults[j].str());
+                }
+                return true;
+            }
+        }
+    }
+
+    cmatch matchResults;
+    if(!regex_search(messageStart, messageEnd, matchResults, rule.regexExpression) || rule.params.size() != matchResults.size() - 1 || matchResults.size() < 4) {
+        return false;
+    }
+    for(long unsigned int j = 1; j < matchResults.size(); j++) {
+        values.push_back(matchResults[j].str());
+    }
+    return true;
+}
+
+/**
+ * Compiles the lua code of every param into a function referenced from the registry of luaState
+ *
+ * Code is wrapped as a function taking arg and returning ret. Code that cannot be wrapped, e.g. one
+ * ending in its own return, is compiled as is and keeps using the arg and ret globals. For rules with
+ * luaBatch set, all params are also compiled into one function returning every result.
+ *
+ * @param luaState state the functions live in, parseMessage recompiles when called with another one
+ * @return false if some lua code does not compile, those params fall back to luaL_dostring
+ *
+*/
+
+bool SyslogParser::compileLua(lua_State* luaState) {
+    bool success = true;
+
+    m_luaState = luaState;
+    // mark the state, a new state reusing the same address must not see stale references
+    lua_pushlightuserdata(luaState, this);
+    lua_pushboolean(luaState, 1);
+    lua_rawset(luaState, LUA_REGISTRYINDEX);
+
+    for(auto& rule : m_regexList) {
+        int envIndex = 0;
+        int batchCount = 0;
+        bool batchable = rule.luaBatch;
+        string batchCode = "return function(...)\nlocal __args = {...}\nlocal __ret = {}\n";
+        string batchReturn;
+
+        rule.luaBatchRef = LUA_NOREF;
+        for(long unsigned int j = 3; j < rule.params.size(); j++) {
+            EventParam& param = rule.params[j];
+            param.luaRef = LUA_NOREF;
+            param.luaGlobals = false;
+            if(param.luaCode.empty()) {
+                continue;
+            }
+            if(envIndex == 0) { // rule environment, unknown names resolve to globals
+                lua_newtable(luaState);
+                lua_newtable(luaState);
+                lua_pushvalue(luaState, LUA_GLOBALSINDEX);
+                lua_setfield(luaState, -2, "__index");
+                lua_setmetatable(luaState, -2);
+                envIndex = lua_gettop(luaState);
+            }
+
+            string wrappedCode = "local arg = ...\n" + param.luaCode + "\nreturn ret";
+            if(luaL_loadstring(luaState, wrappedCode.c_str()) == 0) {
+                lua_pushvalue(luaState, envIndex);
+                lua_setfenv(luaState, -2);
+            } else {
+                lua_pop(luaState, 1);
+                batchable = false;
+                if(luaL_loadstring(luaState, param.luaCode.c_str()) != 0) {
+                    SWSS_LOG_ERROR("Invalid lua code for %s in %s: %s\n", param.paramName.c_str(), rule.tag.c_str(), lua_tostring(luaState, -1));
+                    lua_pop(luaState, 1);
+                    success = false;
+                    continue;
+                }
+                param.luaGlobals = true;
+            }
+            param.luaRef = luaL_ref(luaState, LUA_REGISTRYINDEX);
+
+            string slot = "__ret[" + to_string(++batchCount) + "]";
+            batchCode += "do local arg = __args[" + to_string(batchCount) + "]\n" + param.luaCode + "\n" + slot + " = ret end\n";
+            batchReturn += (batchReturn.empty() ? "" : ", ") + slot;
+        }
+
+        if(batchable && batchCount > 0) {
+            batchCode += "return " + batchReturn + "\nend";
+            if(luaL_loadstring(luaState, batchCode.c_str()) == 0) {
+                lua_pushvalue(luaState, envIndex);
+                lua_setfenv(luaState, -2);
+                if(lua_pcall(luaState, 0, 1, 0) == 0 && lua_isfunction(luaState, -1)) {
+                    rule.luaBatchRef = luaL_ref(luaState, LUA_REGISTRYINDEX);
+                } else {
+                    lua_pop(luaState, 1);
+                }
+            } else {
+                lua_pop(luaState, 1);
+            }
+            if(rule.luaBatchRef == LUA_NOREF) {
+                SWSS_LOG_INFO("Lua batch not possible for %s, params evaluated one by one", rule.tag.c_str());
+            }
+        }
+        if(envIndex != 0) {
+            lua_pop(luaState, 1);
+        }
+    }
+    return success;
+}
+
+bool SyslogParser::isLuaCompiled(lua_State* luaState) {
+    if(luaState != m_luaState) {
+        return false;
+    }
+    lua_pushlightuserdata(luaState, this);
+    lua_rawget(luaState, LUA_REGISTRYINDEX);
+    bool marked = !lua_isnil(luaState, -1);
+    lua_pop(luaState, 1);
+    return marked;
+}
+
+bool SyslogParser::callLua(lua_State* luaState, const EventParam& param, const string& value, string& result) {
+    lua_rawgeti(luaState, LUA_REGISTRYINDEX, param.luaRef);
+    if(param.luaGlobals) {
+        lua_pushlstring(luaState, value.data(), value.size());
+        lua_setglobal(luaState, "arg");
+        if(lua_pcall(luaState, 0, 0, 0) != 0) {
+            lua_pop(luaState, 1);
+            return false;
+        }
+        lua_getglobal(luaState, "ret");
+    } else {
+        lua_pushlstring(luaState, value.data(), value.size());
+        if(lua_pcall(luaState, 1, 1, 0) != 0) {
+            lua_pop(luaState, 1);
+            return false;
+        }
+    }
+    const char* luaResult = lua_tostring(luaState, -1);
+    if(luaResult != NULL) {
+        result = luaResult;
+    }
+    lua_pop(luaState, 1);
+    return luaResult != NULL;
+}
+
+bool SyslogParser::callLuaBatch(lua_State* luaState, const RegexStruct& rule, const vector<string>& values, event_params_t& paramMap) {
+    int count = 0;
+
+    lua_rawgeti(luaState, LUA_REGISTRYINDEX, rule.luaBatchRef);
+    for(long unsigned int j = 3; j < rule.params.size(); j++) {
+        if(!rule.params[j].luaCode.empty()) {
+            lua_pushlstring(luaState, values[j].data(), values[j].size());
+            count++;
+        }
+    }
+    if(lua_pcall(luaState, count, count, 0) != 0) {
+        SWSS_LOG_ERROR("Lua batch for %s failed: %s\n", rule.tag.c_str(), lua_tostring(luaState, -1));
+        lua_pop(luaState, 1);
+        return false;
+    }
+    int index = -count;
+    for(long unsigned int j = 3; j < rule.params.size(); j++) {
+        if(rule.params[j].luaCode.empty()) {
+            continue;
+        }
+        const char* luaResult = lua_tostring(luaState, index++);
+        if(luaResult == NULL) {
+            SWSS_LOG_ERROR("Invalid lua code, unable to do operation.\n");
+        }
+        paramMap[rule.params[j].paramName] = luaResult != NULL ? luaResult : values[j];
+    }
+    lua_pop(luaState, count);
+    return true;
+}
+
 /**
  * Parses syslog message and returns structured event
  *
@@ -11,15 +330,34 @@
  *
 */
 
-bool SyslogParser::parseMessage(string message, string& eventTag, event_params_t& paramMap, lua_State* luaState) {
+bool SyslogParser::parseMessage(string_view message, string& eventTag, event_params_t& paramMap, lua_State* luaState) {
+    bool prefiltered = m_anchorMatcher.isCompiled() && m_ruleAnchors.size() == m_regexList.size();
+    if(prefiltered) {
+        m_anchorMatcher.search(message, m_anchorHits);
+    }
+
+    cmatch timestampResults;
+    bool timestampParsed = false;
+    vector<string> values;
     for(long unsigned int i = 0; i < m_regexList.size(); i++) {
-        smatch matchResults;
-        if(!regex_search(message, matchResults, m_regexList[i].regexExpression) || m_regexList[i].params.size() != matchResults.size() - 1 || matchResults.size() < 4) {
+        if(prefiltered) {
+            bool candidate = true;
+            for(size_t anchorId : m_ruleAnchors[i]) {
+                if(!m_anchorHits[anchorId]) {
+                    candidate = false;
+                    break;
+                }
+            }
+            if(!candidate) {
+                continue;
+            }
+        }
+        if(!matchRule(m_regexList[i], message, timestampResults, timestampParsed, values)) {
             continue;
         }
         string formattedTimestamp;
-        if(!matchResults[1].str().empty() && !matchResults[2].str().empty() && !matchResults[3].str().empty()) { // found timestamp components
-            formattedTimestamp = m_timestampFormatter->changeTimestampFormat({ matchResults[1].str(), matchResults[2].str(), matchResults[3].str() });
+        if(!values[0].empty() && !values[1].empty() && !values[2].empty()) { // found timestamp components
+            formattedTimestamp = m_timestampFormatter->changeTimestampFormat({ values[0], values[1], values[2] });
 	}
         if(!formattedTimestamp.empty()) {
             paramMap["timestamp"] = formattedTimestamp;
@@ -29,11 +367,25 @@ bool SyslogParser::parseMessage(string message, string& eventTag, event_params_t
 
         // found matching regex
         eventTag = m_regexList[i].tag;
+        if(luaState != NULL && !isLuaCompiled(luaState)) {
+            compileLua(luaState);
+        }
+        if(m_regexList[i].luaBatchRef != LUA_NOREF && luaState == m_luaState) {
+            for(long unsigned int j = 3; j < m_regexList[i].params.size(); j++) {
+                if(m_regexList[i].params[j].luaCode.empty()) {
+                    paramMap[m_regexList[i].params[j].paramName] = values[j];
+                }
+            }
+            if(callLuaBatch(luaState, m_regexList[i], values, paramMap)) {
+                return true;
+            }
+        }
 	// check params for lua code
         for(long unsigned int j = 3; j < m_regexList[i].params.size(); j++) {
-	    string resultValue = matchResults[j + 1].str();
-	    string paramName = m_regexList[i].params[j].paramName;
-	    const char* luaCode = m_regexList[i].params[j].luaCode.c_str();
+	    string resultValue = values[j];
+	    const EventParam& param = m_regexList[i].params[j];
+	    string paramName = param.paramName;
+	    const char* luaCode = param.luaCode.c_str();
 
             if(luaCode == NULL || *luaCode == 0) {
                 SWSS_LOG_INFO("Invalid lua code, empty or missing");
@@ -41,6 +393,18 @@ bool SyslogParser::parseMessage(string message, string& eventTag, event_params_t
 		continue;
 	    }
 
+            // precompiled function
+            if(param.luaRef != LUA_NOREF && luaState == m_luaState) {
+                string luaResult;
+                if(callLua(luaState, param, resultValue, luaResult)) {
+                    paramMap[paramName] = luaResult;
+                } else {
+                    SWSS_LOG_ERROR("Invalid lua code, unable to do operation.\n");
+                    paramMap[paramName] = resultValue;
+                }
+                continue;
+            }
+
 	    // execute lua code
             lua_pushstring(luaState, resultValue.c_str());
             lua_setglobal(luaState, "arg");
@@ -62,4 +426,5 @@ bool SyslogParser::parseMessage(string message, string& eventTag, event_params_t
 
 SyslogParser::SyslogParser() {
     m_timestampFormatter = unique_ptr<TimestampFormatter>(new TimestampFormatter());
+    m_timestampExpression = regex(TIMESTAMP_REGEX);
 }
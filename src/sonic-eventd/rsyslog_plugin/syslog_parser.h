@@ -10,10 +10,12 @@ extern "C"
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <regex>
 #include <nlohmann/json.hpp>
 #include <swss/events.h>
 #include "timestamp_formatter.h"
+#include "literal_matcher.h"
 
 using namespace std;
 using json = nlohmann::json;
@@ -21,26 +23,54 @@ using json = nlohmann::json;
 struct EventParam {
     string paramName;
     string luaCode;
+    int luaRef = LUA_NOREF; // compiled luaCode in the parser's lua state
+    bool luaGlobals = false; // compiled as is, takes arg and returns ret through globals
 };
 
 struct RegexStruct {
     regex regexExpression;
     vector<EventParam> params;
     string tag;
+    bool hasBody = false; // bodyExpression set, timestamp prefix matched separately
+    regex bodyExpression;
+    vector<string> anchors; // literals every match must contain
+    bool luaBatch = false; // evaluate all lua params of the rule in one call
+    int luaBatchRef = LUA_NOREF;
 };
 
+const string TIMESTAMP_REGEX = "^([a-zA-Z]{3})?\\s*([0-9]{1,2})?\\s*([0-9]{2}:[0-9]{2}:[0-9]{2}.[0-9]{0,6})?\\s*";
+
 /**
  * Syslog Parser is responsible for parsing log messages fed by rsyslog.d and returns
  * matched result to rsyslog_plugin to use with events publish API
  *
+ * Once buildPrefilter is called, a rule is only tried if all its anchors occur in the message,
+ * so lines matching no rule cost a single literal scan instead of one regex per rule.
+ *
+ * Lua params are compiled once per lua state by compileLua into functions kept in the registry.
+ * Each rule gets its own environment, so globals a rule's code sets persist across its messages.
+ *
  */
 
 class SyslogParser {
 public:
     unique_ptr<TimestampFormatter> m_timestampFormatter;
     vector<RegexStruct> m_regexList;
-    bool parseMessage(string message, string& tag, event_params_t& paramDict, lua_State* luaState);
+    bool parseMessage(string_view message, string& tag, event_params_t& paramDict, lua_State* luaState);
+    void buildPrefilter();
+    bool compileLua(lua_State* luaState);
+    static vector<string> extractAnchors(const string& expression);
     SyslogParser();
+private:
+    regex m_timestampExpression;
+    LiteralMatcher m_anchorMatcher;
+    vector<vector<size_t>> m_ruleAnchors;
+    vector<bool> m_anchorHits;
+    lua_State* m_luaState = NULL;
+    bool matchRule(const RegexStruct& rule, string_view message, cmatch& timestampResults, bool& timestampParsed, vector<string>& values);
+    bool isLuaCompiled(lua_State* luaState);
+    bool callLua(lua_State* luaState, const EventParam& param, const string& value, string& result);
+    bool callLuaBatch(lua_State* luaState, const RegexStruct& rule, const vector<string>& values, event_params_t& paramMap);
 };
 
 #endif
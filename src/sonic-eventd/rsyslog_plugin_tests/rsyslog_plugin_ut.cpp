@@ -209,6 +209,111 @@ TEST(syslog_parser, lua_code_valid_2) {
     lua_close(luaState);
 }
 
+TEST(syslog_parser, lua_code_precompiled) {
+    vector<RegexStruct> regexList;
+    string regexString = "^([a-zA-Z]{3})?\\s*([0-9]{1,2})?\\s*([0-9]{2}:[0-9]{2}:[0-9]{2}.[0-9]{0,6})?\\s*.* (sent|received) (?:to|from) .* ([0-9]{2,3}.[0-9]{2,3}.[0-9]{2,3}.[0-9]{2,3}) active ([1-9]{1,3})/([1-9]{1,3}) .*";
+    vector<string> params = { "month", "day", "time", "is-sent", "ip", "major-code", "minor-code" };
+    // per rule state persists across messages, code with its own return runs through globals
+    vector<string> luaCodes = { "", "", "", "ret=tostring(arg==\"sent\")", "", "count=(count or 0)+1 ret=tostring(count)", "" };
+
+    for(bool luaBatch : { false, true }) {
+        RegexStruct rs = RegexStruct();
+        rs.tag = "test_tag";
+        rs.regexExpression = regex(regexString);
+        // a trailing return keeps the rule out of batching
+        luaCodes[6] = luaBatch ? "ret=arg..\"!\"" : "ret=arg..\"!\" return";
+        rs.params = createEventParams(params, luaCodes);
+        rs.luaBatch = luaBatch;
+        regexList.assign(1, rs);
+
+        unique_ptr<SyslogParser> parser(new SyslogParser());
+        parser->m_regexList = regexList;
+        lua_State* luaState = luaL_newstate();
+        luaL_openlibs(luaState);
+        EXPECT_TRUE(parser->compileLua(luaState));
+
+        for(int i = 1; i <= 2; i++) {
+            string tag;
+            event_params_t paramDict;
+            event_params_t expectedDict;
+            expectedDict["is-sent"] = "true";
+            expectedDict["ip"] = "100.95.147.229";
+            expectedDict["major-code"] = to_string(i);
+            expectedDict["minor-code"] = "2!";
+
+            bool success = parser->parseMessage("NOTIFICATION: sent to neighbor 100.95.147.229 active 2/2 (peer in wrong AS) 2 bytes", tag, paramDict, luaState);
+            EXPECT_EQ(true, success);
+            EXPECT_EQ("test_tag", tag);
+            EXPECT_EQ(expectedDict, paramDict);
+        }
+        lua_close(luaState);
+    }
+}
+
+TEST(syslog_parser, extract_anchors) {
+    vector<string> expectedAnchors = { " %ADJCHANGE: neighbor " };
+    EXPECT_EQ(expectedAnchors, SyslogParser::extractAnchors(".* %ADJCHANGE: neighbor (.*) (Up|Down) .*"));
+
+    expectedAnchors = { "abc", "efgh", "ij." };
+    EXPECT_EQ(expectedAnchors, SyslogParser::extractAnchors("abcd?efgh\\s+ij\\.(k)[lmn]"));
+
+    // top level alternation or backreference, nothing can be required
+    EXPECT_TRUE(SyslogParser::extractAnchors("abcdef|ghijkl").empty());
+    EXPECT_TRUE(SyslogParser::extractAnchors("(abc) \\1 defgh").empty());
+}
+
+TEST(syslog_parser, prefilter_matching) {
+    vector<string> bodies = { ".* %ADJCHANGE: neighbor (.*) (Up|Down) .*", "NOTIFICATION: (sent|received) .*" };
+    vector<vector<string>> params = { { "month", "day", "time", "neighbor_ip", "state" }, { "month", "day", "time", "is-sent" } };
+    vector<string> tags = { "bgp-state", "bgp-notification" };
+    vector<RegexStruct> regexList;
+    for(long unsigned int i = 0; i < bodies.size(); i++) {
+        RegexStruct rs = RegexStruct();
+        rs.tag = tags[i];
+        rs.regexExpression = regex(TIMESTAMP_REGEX + bodies[i]);
+        rs.bodyExpression = regex(bodies[i]);
+        rs.hasBody = true;
+        rs.anchors = SyslogParser::extractAnchors(bodies[i]);
+        rs.params = createEventParams(params[i], vector<string>(params[i].size(), ""));
+        regexList.push_back(rs);
+    }
+
+    unique_ptr<SyslogParser> parser(new SyslogParser());
+    parser->m_regexList = regexList;
+    parser->buildPrefilter();
+    parser->m_timestampFormatter->m_storedTimestamp = "010100:00:00.000000";
+    parser->m_timestampFormatter->m_storedYear = g_stored_year;
+    lua_State* luaState = luaL_newstate();
+    luaL_openlibs(luaState);
+
+    string tag;
+    event_params_t paramDict;
+    event_params_t expectedDict;
+    expectedDict["neighbor_ip"] = "100.126.188.90";
+    expectedDict["state"] = "Down";
+    expectedDict["timestamp"] = g_stored_year + "-08-17T02:39:21.286611Z";
+    bool success = parser->parseMessage("Aug 17 02:39:21.286611 SN6-0101-0114-02T0 INFO bgp#bgpd[62]: %ADJCHANGE: neighbor 100.126.188.90 Down Neighbor deleted", tag, paramDict, luaState);
+    EXPECT_EQ(true, success);
+    EXPECT_EQ("bgp-state", tag);
+    EXPECT_EQ(expectedDict, paramDict);
+
+    // greedy timestamp prefix eats "NOT", the full regex must still match
+    tag.clear();
+    paramDict.clear();
+    expectedDict.clear();
+    expectedDict["is-sent"] = "sent";
+    success = parser->parseMessage("NOTIFICATION: sent to neighbor 100.95.147.229", tag, paramDict, luaState);
+    EXPECT_EQ(true, success);
+    EXPECT_EQ("bgp-notification", tag);
+    EXPECT_EQ(expectedDict, paramDict);
+
+    paramDict.clear();
+    success = parser->parseMessage("Aug 17 04:46:51.290979 SN6-0101-0114-02T0 INFO bgp#bgpd[62]: %NOEVENT: no event", tag, paramDict, luaState);
+    EXPECT_EQ(false, success);
+
+    lua_close(luaState);
+}
+
 TEST(rsyslog_plugin, onInit_emptyJSON) {
     unique_ptr<RsyslogPlugin> plugin(new RsyslogPlugin("test_mod_name", "./rsyslog_plugin_tests/test_regex_1.rc.json"));
     EXPECT_NE(0, plugin->onInit());
@@ -258,10 +363,22 @@ TEST(rsyslog_plugin, run) {
     unique_ptr<RsyslogPlugin> plugin(new RsyslogPlugin("test_mod_name", "./rsyslog_plugin_tests/test_regex_5.rc.json"));
     EXPECT_EQ(0, plugin->onInit());
     istringstream ss("");
-    streambuf* cinbuf = cin.rdbuf();
-    cin.rdbuf(ss.rdbuf());
-    plugin->run();
-    cin.rdbuf(cinbuf);
+    plugin->run(ss);
+}
+
+TEST(rsyslog_plugin, run_pipeline) {
+    unique_ptr<RsyslogPlugin> plugin(new RsyslogPlugin("test_mod_name", "./rsyslog_plugin_tests/test_regex_2.rc.json"));
+    EXPECT_EQ(0, plugin->onInit());
+    string adjChange = "Aug 17 02:39:21.286611 SN6-0101-0114-02T0 INFO bgp#bgpd[62]: %ADJCHANGE: neighbor 100.126.188.90 Down Neighbor deleted";
+    // empty lines are skipped, a line longer than a read chunk is carried over, the last line has no newline
+    string logs = adjChange + "\n\n" + adjChange + "\n" + string(100000, 'x') + "\n" + adjChange;
+    istringstream ss(logs);
+    plugin->run(ss);
+
+    PublishStats stats = plugin->getPublishStats();
+    EXPECT_EQ(3UL, stats.enqueued);
+    EXPECT_EQ(stats.enqueued, stats.published + stats.publishFailed);
+    EXPECT_LE(stats.batches, stats.enqueued);
 }
 
 TEST(rsyslog_plugin, run_SIGTERM) {
@@ -1,5 +1,7 @@
 #include <thread>
 #include <memory>
+#include <algorithm>
+#include <cstring>
 #include <swss/dbconnector.h>
 #include "eventd.h"
 #include "zmq.h"
@@ -27,16 +29,16 @@
 using namespace std;
 using namespace swss;
 
-#define MB(N) ((N) * 1024 * 1024)
 #define EVT_SIZE_AVG 150
 
-#define MAX_CACHE_SIZE (MB(100) / (EVT_SIZE_AVG))
+#define MAX_CACHE_SIZE (CACHE_BYTES_MAX / (EVT_SIZE_AVG))
+
+/* Part of cache budget held back for last event per runtime id */
+#define CACHE_LAST_RESERVE(budget) ((budget) / 16)
 
 /* Count of elements returned in each read */
 #define READ_SET_SIZE 100
 
-#define VEC_SIZE(p) ((int)p.size())
-
 /* Sock read timeout in milliseconds, to enable look for control signals */
 #define CAPTURE_SOCK_TIMEOUT 800
 
@@ -68,27 +70,103 @@ eventd_proxy::init()
 	return m_init_result;
 }
 
+int
+eventd_proxy::forward(void *from, void *to, bool &dropped)
+{
+    int more = 0;
+
+    dropped = false;
+    do {
+        zmq_msg_t msg, copy;
+
+        zmq_msg_init(&msg);
+        if (zmq_msg_recv(&msg, from, ZMQ_DONTWAIT) < 0) {
+            zmq_msg_close(&msg);
+            return zmq_errno();
+        }
+        more = zmq_msg_more(&msg);
+
+        /* Capture is PUB, hence never blocks */
+        zmq_msg_init(&copy);
+        zmq_msg_copy(&copy, &msg);
+        if (zmq_msg_send(&copy, m_capture, more ? ZMQ_SNDMORE : 0) < 0) {
+            zmq_msg_close(&copy);
+        }
+
+        /*
+         * Never wait on subscribers, as that would stall all publishers.
+         * Once a part is not taken, rest of the parts are read & discarded.
+         * XPUB refuses a part only with ZMQ_XPUB_NODROP set; without it zmq
+         * takes every part and drops for a slow subscriber on its own.
+         */
+        if (dropped || (zmq_msg_send(&msg, to,
+                        ZMQ_DONTWAIT | (more ? ZMQ_SNDMORE : 0)) < 0)) {
+            dropped = true;
+            zmq_msg_close(&msg);
+        }
+    } while (more);
+
+    return 0;
+}
+
+void
+eventd_proxy::report_stats()
+{
+    bool changed = false;
+    counters_t cntrs[PROXY_COUNTERS_TOTAL];
+
+    for (int i=0; i < PROXY_COUNTERS_TOTAL; ++i) {
+        cntrs[i] = m_counters[i];
+        if (cntrs[i] != m_reported[i]) {
+            m_reported[i] = cntrs[i];
+            changed = true;
+        }
+    }
+    if (changed && (m_stats != NULL)) {
+        m_stats->set_proxy_stats(cntrs);
+    }
+}
+
 void
 eventd_proxy::run()
 {
 	int rc = 0;
+    int hwm = get_config_data(string(PROXY_HWM_KEY), 0);
+    int nodrop = get_config_data(string(PROXY_NODROP_KEY), 0);
+    zmq_pollitem_t items[2];
+    auto last_report = chrono::steady_clock::now();
     SWSS_LOG_INFO("Running xpub/xsub proxy");
 
     m_frontend = zmq_socket(m_ctx, ZMQ_XSUB);
     RET_ON_ERR(m_frontend != NULL, "failing to get ZMQ_XSUB socket");
 
-    rc = zmq_bind(m_frontend, get_config(string(XSUB_END_KEY)).c_str());
-    RET_ON_ERR(rc == 0, "Failing to bind XSUB to %s", get_config(string(XSUB_END_KEY)).c_str());
-
     m_backend = zmq_socket(m_ctx, ZMQ_XPUB);
     RET_ON_ERR(m_backend != NULL, "failing to get ZMQ_XPUB socket");
 
-    rc = zmq_bind(m_backend, get_config(string(XPUB_END_KEY)).c_str());
-    RET_ON_ERR(rc == 0, "Failing to bind XPUB to %s", get_config(string(XPUB_END_KEY)).c_str());
-
     m_capture = zmq_socket(m_ctx, ZMQ_PUB);
     RET_ON_ERR(m_capture != NULL, "failing to get ZMQ_PUB socket for capture");
 
+    /* zmq applies hwm only to binds made after it is set */
+    if (hwm > 0) {
+        /* Applies to each publisher & subscriber connection */
+        RET_ON_ERR(zmq_setsockopt(m_frontend, ZMQ_RCVHWM, &hwm, sizeof(hwm)) == 0,
+                "Failed to set XSUB hwm=%d", hwm);
+        RET_ON_ERR(zmq_setsockopt(m_backend, ZMQ_SNDHWM, &hwm, sizeof(hwm)) == 0,
+                "Failed to set XPUB hwm=%d", hwm);
+        RET_ON_ERR(zmq_setsockopt(m_capture, ZMQ_SNDHWM, &hwm, sizeof(hwm)) == 0,
+                "Failed to set capture hwm=%d", hwm);
+    }
+    if (nodrop != 0) {
+        RET_ON_ERR(zmq_setsockopt(m_backend, ZMQ_XPUB_NODROP, &nodrop, sizeof(nodrop)) == 0,
+                "Failed to set XPUB nodrop");
+    }
+
+    rc = zmq_bind(m_frontend, get_config(string(XSUB_END_KEY)).c_str());
+    RET_ON_ERR(rc == 0, "Failing to bind XSUB to %s", get_config(string(XSUB_END_KEY)).c_str());
+
+    rc = zmq_bind(m_backend, get_config(string(XPUB_END_KEY)).c_str());
+    RET_ON_ERR(rc == 0, "Failing to bind XPUB to %s", get_config(string(XPUB_END_KEY)).c_str());
+
     rc = zmq_bind(m_capture, get_config(string(CAPTURE_END_KEY)).c_str());
     RET_ON_ERR(rc == 0, "Failing to bind capture PUB to %s", get_config(string(CAPTURE_END_KEY)).c_str());
 
@@ -96,10 +174,71 @@ eventd_proxy::run()
     m_init_result = 0;
     m_init_done = true;
 
+    items[0] = { m_frontend, 0, ZMQ_POLLIN, 0 };
+    items[1] = { m_backend, 0, ZMQ_POLLIN, 0 };
+
     /* runs forever until zmq context is terminated */
-    zmq_proxy(m_frontend, m_backend, m_capture);
+    while (true) {
+        bool dropped;
+
+        rc = zmq_poll(items, ARRAY_SIZE(items), PROXY_STATS_INTERVAL_MS);
+        if (rc < 0) {
+            if (zmq_errno() == ETERM) {
+                /* zmq context terminated */
+                break;
+            }
+            RET_ON_ERR(zmq_errno() == EINTR, "Proxy poll failed with %d", zmq_errno());
+            continue;
+        }
+
+        if (items[0].revents & ZMQ_POLLIN) {
+            /* Events from publishers */
+            int cnt = 0;
+
+            for (; cnt < PROXY_BATCH_SIZE; ++cnt) {
+                rc = forward(m_frontend, m_backend, dropped);
+                if (rc != 0) {
+                    break;
+                }
+                ++m_counters[dropped ? INDEX_PROXY_DROPPED : INDEX_PROXY_FORWARDED];
+            }
+            RET_ON_ERR((rc == 0) || (rc == EAGAIN) || (rc == ETERM),
+                    "Proxy read from XSUB failed %d", rc);
+            if (cnt == PROXY_BATCH_SIZE) {
+                int events = 0;
+                size_t sz = sizeof(events);
+
+                if ((zmq_getsockopt(m_frontend, ZMQ_EVENTS, &events, &sz) == 0) &&
+                        (events & ZMQ_POLLIN)) {
+                    /* Publishers are outpacing the proxy */
+                    ++m_counters[INDEX_PROXY_BLOCKED];
+                }
+            }
+        }
+
+        if (items[1].revents & ZMQ_POLLIN) {
+            /* Subscription requests from subscribers */
+            for (int cnt = 0; cnt < PROXY_BATCH_SIZE; ++cnt) {
+                rc = forward(m_backend, m_frontend, dropped);
+                if (rc != 0) {
+                    break;
+                }
+            }
+            RET_ON_ERR((rc == 0) || (rc == EAGAIN) || (rc == ETERM),
+                    "Proxy read from XPUB failed %d", rc);
+        }
+
+        auto now = chrono::steady_clock::now();
+        if (chrono::duration_cast<chrono::milliseconds>(now - last_report).count() >=
+                PROXY_STATS_INTERVAL_MS) {
+            report_stats();
+            last_report = now;
+        }
+    }
 
 out:
+    report_stats();
+
     /* Signal failure if we got here before successful init */
     if (!m_init_done) {
         m_init_result = 1;
@@ -123,7 +262,57 @@ out:
 }
 
 
+void
+latency_histogram::reset()
+{
+    for (int i=0; i < BUCKETS; ++i) {
+        m_buckets[i] = 0;
+    }
+    m_count = 0;
+    m_max = 0;
+}
+
+void
+latency_histogram::record(int64_t ms)
+{
+    int i = 0;
+
+    /* Publisher & eventd clocks are the same, but guard against jumps */
+    if (ms < 0) {
+        ms = 0;
+    }
+    for (int64_t v = ms; (v != 0) && (i < (BUCKETS - 1)); v >>= 1) {
+        ++i;
+    }
+    ++m_buckets[i];
+    ++m_count;
+    if (ms > m_max) {
+        m_max = ms;
+    }
+}
+
+int64_t
+latency_histogram::percentile(int pct) const
+{
+    uint64_t seen = 0;
+    uint64_t want = (m_count * pct + 99) / 100;
+
+    if (m_count == 0) {
+        return 0;
+    }
+    for (int i=0; i < BUCKETS; ++i) {
+        seen += m_buckets[i];
+        if ((seen != 0) && (seen >= want)) {
+            return min((int64_t)((1LL << i) - 1), m_max);
+        }
+    }
+    return m_max;
+}
+
+
 stats_collector::stats_collector() :
+    m_flush_interval_ms(STATS_FLUSH_INTERVAL_MS), m_latency_updated(false),
+    m_proxy_updated(false),
     m_shutdown(false), m_pause_heartbeat(false), m_heartbeats_published(0),
     m_heartbeats_interval_cnt(0)
 {
@@ -131,6 +320,9 @@ stats_collector::stats_collector() :
     for (int i=0; i < COUNTERS_EVENTS_TOTAL; ++i) {
         m_lst_counters[i] = 0;
     }
+    for (int i=0; i < PROXY_COUNTERS_TOTAL; ++i) {
+        m_proxy_counters[i] = 0;
+    }
     m_updated = false;
 }
 
@@ -183,8 +375,10 @@ stats_collector::start()
         }
         RET_ON_ERR(m_counters_db != NULL, "Failed to get COUNTERS_DB");
 
+        /* Buffered table; All counters are sent in one round trip on flush */
+        m_pipeline = make_shared<swss::RedisPipeline>(m_counters_db.get());
         m_stats_table = make_shared<swss::Table>(
-                m_counters_db.get(), COUNTERS_EVENTS_TABLE);
+                m_pipeline.get(), COUNTERS_EVENTS_TABLE, true);
         RET_ON_ERR(m_stats_table != NULL, "Failed to get events table");
 
         m_thr_writer = thread(&stats_collector::run_writer, this);
@@ -195,33 +389,164 @@ out:
     return rc;
 }
 
+bool
+stats_collector::read_source_counters(const string &source, source_counters_t &cntrs)
+{
+    lock_guard<mutex> lck(m_source_mtx);
+    source_stats_t::const_iterator itc = m_source_stats.find(source);
+
+    if (itc == m_source_stats.end()) {
+        return false;
+    }
+    cntrs = itc->second;
+    return true;
+}
+
+int64_t
+stats_collector::read_latency(int pct)
+{
+    lock_guard<mutex> lck(m_source_mtx);
+    return m_latency.percentile(pct);
+}
+
 void
-stats_collector::run_writer()
+stats_collector::set_proxy_stats(const counters_t *cntrs)
 {
-    while (true) {
-        if (m_updated.exchange(false)) {
-            /* Update if there had been any update */
+    {
+        lock_guard<mutex> lck(m_source_mtx);
 
-            for (int i = 0; i < COUNTERS_EVENTS_TOTAL; ++i) {
-                vector<FieldValueTuple> fv;
+        for (int i=0; i < PROXY_COUNTERS_TOTAL; ++i) {
+            m_proxy_counters[i] = cntrs[i];
+        }
+        m_proxy_updated = true;
+    }
+    set_updated();
+}
 
-                fv.emplace_back(EVENTS_STATS_FIELD_NAME, to_string(m_lst_counters[i]));
+void
+stats_collector::update_source_stats(const event_receive_op_t &op)
+{
+    string source = op.key.substr(0, op.key.find(':'));
+    counters_t bytes = op.key.size();
+    int64_t now = chrono::duration_cast<chrono::milliseconds>(
+            chrono::system_clock::now().time_since_epoch()).count();
+
+    for (event_params_t::const_iterator itc = op.params.begin();
+            itc != op.params.end(); ++itc) {
+        bytes += itc->first.size() + itc->second.size();
+    }
+
+    {
+        lock_guard<mutex> lck(m_source_mtx);
+        source_counters_t &cntrs = m_source_stats[source];
 
-                m_stats_table->set(counter_keys[i], fv);
+        cntrs.published += 1 + op.missed_cnt;
+        cntrs.missed += op.missed_cnt;
+        cntrs.bytes += bytes;
+        cntrs.updated = true;
+
+        if (op.publish_epoch_ms > 0) {
+            m_latency.record(now - op.publish_epoch_ms);
+            m_latency_updated = true;
+        }
+    }
+    set_updated();
+}
+
+void
+stats_collector::write_stats()
+{
+    source_stats_t updated;
+    vector<FieldValueTuple> latency_fv, proxy_fv;
+
+    for (int i = 0; i < COUNTERS_EVENTS_TOTAL; ++i) {
+        vector<FieldValueTuple> fv;
+
+        fv.emplace_back(EVENTS_STATS_FIELD_NAME, to_string(m_lst_counters[i]));
+
+        m_stats_table->set(counter_keys[i], fv);
+    }
+
+    {
+        /* Copy out only what changed, to keep the lock short */
+        lock_guard<mutex> lck(m_source_mtx);
+
+        for (source_stats_t::iterator it = m_source_stats.begin();
+                it != m_source_stats.end(); ++it) {
+            if (it->second.updated) {
+                updated[it->first] = it->second;
+                it->second.updated = false;
             }
         }
-        if (m_shutdown) {
+        if (m_latency_updated) {
+            latency_fv.emplace_back("p50", to_string(m_latency.percentile(50)));
+            latency_fv.emplace_back("p90", to_string(m_latency.percentile(90)));
+            latency_fv.emplace_back("p99", to_string(m_latency.percentile(99)));
+            latency_fv.emplace_back("max", to_string(m_latency.max()));
+            m_latency_updated = false;
+        }
+        if (m_proxy_updated) {
+            proxy_fv.emplace_back("forwarded",
+                    to_string(m_proxy_counters[INDEX_PROXY_FORWARDED]));
+            proxy_fv.emplace_back("blocked",
+                    to_string(m_proxy_counters[INDEX_PROXY_BLOCKED]));
+            proxy_fv.emplace_back("dropped",
+                    to_string(m_proxy_counters[INDEX_PROXY_DROPPED]));
+            m_proxy_updated = false;
+        }
+    }
+
+    for (source_stats_t::const_iterator itc = updated.begin();
+            itc != updated.end(); ++itc) {
+        vector<FieldValueTuple> fv;
+
+        fv.emplace_back(EVENTS_STATS_FIELD_PUBLISHED, to_string(itc->second.published));
+        fv.emplace_back(EVENTS_STATS_FIELD_MISSED, to_string(itc->second.missed));
+        fv.emplace_back(EVENTS_STATS_FIELD_BYTES, to_string(itc->second.bytes));
+
+        m_stats_table->set(string(EVENTS_STATS_SOURCE_PREFIX) + itc->first, fv);
+    }
+    if (!latency_fv.empty()) {
+        m_stats_table->set(EVENTS_STATS_LATENCY_KEY, latency_fv);
+    }
+    if (!proxy_fv.empty()) {
+        m_stats_table->set(EVENTS_STATS_PROXY_KEY, proxy_fv);
+    }
+
+    /* Send all in one go */
+    m_stats_table->flush();
+}
+
+void
+stats_collector::run_writer()
+{
+    unique_lock<mutex> lck(m_writer_mtx);
+
+    while (true) {
+        /* Sleep until there is something to write; No periodic wakeup */
+        m_writer_cv.wait(lck, [this]() { return m_updated || m_shutdown; });
+
+        bool shutdown = m_shutdown;
+
+        lck.unlock();
+        if (m_updated.exchange(false)) {
+            write_stats();
+        }
+        if (shutdown) {
+            /*
+             * m_updated is cleared before write, hence any counter updated
+             * before shutdown was set is in the write above.
+             */
             break;
         }
-        this_thread::sleep_for(chrono::milliseconds(10));
-        /*
-         * After sleep always do an update if needed before checking
-         * shutdown flag, as any counters collected during sleep
-         * needs to be updated.
-         */
+
+        /* Updates arriving in this gap are coalesced into the next write */
+        this_thread::sleep_for(chrono::milliseconds(m_flush_interval_ms));
+        lck.lock();
     }
 
     m_stats_table.reset();
+    m_pipeline.reset();
     m_counters_db.reset();
 }
 
@@ -276,6 +601,7 @@ stats_collector::run_collector()
         if ((rc == 0) && (op.key != hb_key)) {
             /* TODO: Discount EVENT_STR_CTRL_DEINIT messages too */
             increment_published(1+op.missed_cnt);
+            update_source_stats(op);
 
             /* reset counter on receive to restart. */
             hb_cntr = 0;
@@ -312,6 +638,125 @@ out:
     m_shutdown = true;
 }
 
+event_cache::event_cache(size_t budget, size_t max_cnt) :
+    m_budget(budget), m_max_cnt(max_cnt),
+    m_reserve(CACHE_LAST_RESERVE(budget)),
+    m_head(0), m_tail(budget), m_read_pos(0)
+{
+    if (budget != 0) {
+        m_arena.reset(new char[budget]);
+        m_fifo.reserve(min(max_cnt, budget / EVT_SIZE_AVG));
+        m_last.reserve(MAX_PUBLISHERS_COUNT);
+    }
+}
+
+bool
+event_cache::push(const event_serialized_t &evt)
+{
+    size_t sz = evt.size();
+
+    if ((m_fifo.size() >= m_max_cnt) || ((m_head + sz + m_reserve) > m_tail)) {
+        return false;
+    }
+    memcpy(m_arena.get() + m_head, evt.data(), sz);
+    m_fifo.push_back({m_head, sz});
+    m_head += sz;
+    return true;
+}
+
+bool
+event_cache::set_last(const runtime_id_t &rid, const event_serialized_t &evt)
+{
+    size_t sz = evt.size();
+    auto it = m_last.find(rid);
+
+    if ((it != m_last.end()) && (sz <= it->second.len)) {
+        /* Fits in the slot of previous one. */
+        memcpy(m_arena.get() + it->second.off, evt.data(), sz);
+        it->second.len = sz;
+        return true;
+    }
+    if (sz > (m_tail - m_head)) {
+        compact_last();
+        if (sz > (m_tail - m_head)) {
+            return false;
+        }
+    }
+    m_tail -= sz;
+    memcpy(m_arena.get() + m_tail, evt.data(), sz);
+    if (it != m_last.end()) {
+        it->second = {m_tail, sz};
+    } else {
+        m_last[rid] = {m_tail, sz};
+    }
+    return true;
+}
+
+/*
+ * Slide live last event records to the end of arena, dropping space
+ * held by replaced ones. Records are moved in descending order of offset,
+ * hence a move never overwrites a record yet to be moved.
+ */
+void
+event_cache::compact_last()
+{
+    vector<record_t *> recs;
+    size_t pos = m_budget;
+
+    recs.reserve(m_last.size());
+    for (auto &e: m_last) {
+        recs.push_back(&e.second);
+    }
+    sort(recs.begin(), recs.end(),
+            [](const record_t *a, const record_t *b) { return a->off > b->off; });
+
+    for (record_t *rec: recs) {
+        pos -= rec->len;
+        if (pos != rec->off) {
+            memmove(m_arena.get() + pos, m_arena.get() + rec->off, rec->len);
+            rec->off = pos;
+        }
+    }
+    m_tail = pos;
+}
+
+void
+event_cache::read(int cnt, event_serialized_lst_t &lst)
+{
+    if ((fifo_size() == 0) && !m_last.empty()) {
+        /* Ordered list is drained; Hand out last events next. */
+        m_fifo.clear();
+        m_read_pos = 0;
+        for (const auto &e: m_last) {
+            m_fifo.push_back(e.second);
+        }
+        unordered_map<runtime_id_t, record_t>().swap(m_last);
+    }
+    for (; (cnt > 0) && (fifo_size() != 0); --cnt) {
+        lst.push_back(string(fifo_at(0)));
+        ++m_read_pos;
+    }
+    if (fifo_size() == 0) {
+        m_fifo.clear();
+        m_read_pos = 0;
+    }
+}
+
+void
+event_cache::swap(event_cache &other)
+{
+    std::swap(m_arena, other.m_arena);
+    std::swap(m_budget, other.m_budget);
+    std::swap(m_max_cnt, other.m_max_cnt);
+    std::swap(m_reserve, other.m_reserve);
+    std::swap(m_head, other.m_head);
+    std::swap(m_tail, other.m_tail);
+    m_fifo.swap(other.m_fifo);
+    std::swap(m_read_pos, other.m_read_pos);
+    m_last.swap(other.m_last);
+}
+
+
 capture_service::~capture_service()
 {
     stop_capture();
@@ -362,7 +807,7 @@ capture_service::init_capture_cache(const event_serialized_lst_t &lst)
     /* Cache given events as initial stock.
      * Save runtime ID with last seen seq to avoid duplicates, while reading
      * from capture socket.
-     * No check for max cache size here, as most likely not needed.
+     * Events beyond cache budget are dropped, as most likely not needed.
      */
     for (event_serialized_lst_t::const_iterator itc = lst.begin(); itc != lst.end(); ++itc) {
         internal_event_t event;
@@ -373,7 +818,11 @@ capture_service::init_capture_cache(const event_serialized_lst_t &lst)
 
             if (validate_event(event, rid, seq)) {
                 m_pre_exist_id[rid] = seq;
-                m_events.push_back(*itc);
+                if (!m_cache.push(*itc)) {
+                    SWSS_LOG_ERROR("Init cache exceeds cache budget=%d events:size=%d",
+                            (int)m_cache.budget(), (int)m_cache.fifo_size());
+                    break;
+                }
             }
         }
     }
@@ -442,7 +891,7 @@ capture_service::do_capture()
      * Hence until as many events as in initial stock or until the cached id map
      * is empty, do this check.
      */
-    init_cnt = (int)m_events.size();
+    init_cnt = (int)m_cache.fifo_size();
 
     /* Read until STOP_CAPTURE */
     while(m_ctrl == START_CAPTURE) {
@@ -474,7 +923,7 @@ capture_service::do_capture()
              * When duplicate or new one seen, remove the entry from pre-exist map
              * Stay in this state, until the pre-exist cache is empty or as many
              * messages as in cache are seen, as in worst case even if you see
-             * duplicate of each, it will end with first m_events.size()
+             * duplicate of each, it will end with first m_cache.fifo_size()
              */
             {
                 bool add = true;
@@ -491,8 +940,9 @@ capture_service::do_capture()
                         m_pre_exist_id.erase(it);
                     }
                 }
-                if (add) {
-                    m_events.push_back(evt_str);
+                if (add && !m_cache.push(evt_str)) {
+                    cap_state = CAP_STATE_LAST;
+                    goto save_last;
                 }
             }
             if(m_pre_exist_id.empty() || (init_cnt <= 0)) {
@@ -504,31 +954,22 @@ capture_service::do_capture()
 
         case CAP_STATE_ACTIVE:
             /* Save until max allowed */
-            try
-            {
-                m_events.push_back(evt_str);
-                if (VEC_SIZE(m_events) >= m_cache_max) {
-                    cap_state = CAP_STATE_LAST;
-                    /* Clear the map, created to ensure memory space available */
-                    m_last_events.clear();
-                    m_last_events_init = true;
-                }
+            if (m_cache.push(evt_str)) {
                 break;
             }
-            catch (bad_alloc& e)
-            {
-                stringstream ss;
-                ss << e.what();
-                SWSS_LOG_ERROR("Cache save event failed with %s events:size=%d",
-                        ss.str().c_str(), VEC_SIZE(m_events));
-                cap_state = CAP_STATE_LAST;
-                // fall through to save this event in last set.
-            }
+            SWSS_LOG_INFO("Cache full with events:size=%d bytes=%d",
+                    (int)m_cache.fifo_size(), (int)m_cache.used_bytes());
+            cap_state = CAP_STATE_LAST;
+            // fall through to save this event in last set.
 
         case CAP_STATE_LAST:
+        save_last:
             total_overflow++;
-            m_last_events[rid] = evt_str;
-            if (total_overflow > m_last_events.size()) {
+            if (!m_cache.set_last(rid, evt_str)) {
+                SWSS_LOG_ERROR("Cache failed to save last event of rid=%s size=%d",
+                        rid.c_str(), (int)evt_str.size());
+            }
+            if (total_overflow > m_cache.last_size()) {
                 m_total_missed_cache++;
                 m_stats_instance->increment_missed_cache(1);
             }
@@ -570,17 +1011,6 @@ capture_service::set_control(capture_control_t ctrl, event_serialized_lst_t *lst
             break;
 
         case START_CAPTURE:
-
-            /*
-             * Reserve a MAX_PUBLISHERS_COUNT entries for last events, as we use it only
-             * upon m_events/vector overflow, which might block adding new entries in map
-             * if overall mem consumption is too high. Clearing the map just before use
-             * is likely to help.
-             */
-            for (int i=0; i<MAX_PUBLISHERS_COUNT; ++i) {
-                m_last_events[to_string(i)] = "";
-            }
-
             if ((lst != NULL) && (!lst->empty())) {
                 init_capture_cache(*lst);
             }
@@ -612,14 +1042,27 @@ int
 capture_service::read_cache(event_serialized_lst_t &lst_fifo,
         last_events_t &lst_last, counters_t &overflow_cnt)
 {
-    lst_fifo.swap(m_events);
-    if (m_last_events_init) {
-        lst_last.swap(m_last_events);
-    } else {
-        last_events_t().swap(lst_last);
+    event_cache cache;
+
+    read_cache(cache, overflow_cnt);
+
+    event_serialized_lst_t().swap(lst_fifo);
+    last_events_t().swap(lst_last);
+    lst_fifo.reserve(cache.fifo_size());
+    for (size_t i = 0; i < cache.fifo_size(); ++i) {
+        lst_fifo.push_back(string(cache.fifo_at(i)));
     }
-    last_events_t().swap(m_last_events);
-    event_serialized_lst_t().swap(m_events);
+    cache.for_each_last([&lst_last](const runtime_id_t &rid, string_view evt) {
+            lst_last[rid] = string(evt);
+        });
+    return 0;
+}
+
+int
+capture_service::read_cache(event_cache &cache, counters_t &overflow_cnt)
+{
+    event_cache().swap(cache);
+    cache.swap(m_cache);
     overflow_cnt = m_total_missed_cache;
     return 0;
 }
@@ -663,18 +1106,25 @@ run_eventd_service()
     unique_ptr<capture_service> capture;
     bool skip_caching = false;
 
-    event_serialized_lst_t capture_fifo_events;
-    last_events_t capture_last_events;
+    event_cache capture_cached;
 
     SWSS_LOG_INFO("Eventd service starting\n");
 
     void *zctx = zmq_ctx_new();
     RET_ON_ERR(zctx != NULL, "Failed to get zmq ctx");
 
+    /* Has to be set before any socket is created */
+    RET_ON_ERR(zmq_ctx_set(zctx, ZMQ_IO_THREADS,
+                get_config_data(string(PROXY_IO_THREADS_KEY), 1)) == 0,
+            "Failed to set proxy io threads");
+
     cache_max = get_config_data(string(CACHE_MAX_CNT), (int)MAX_CACHE_SIZE);
     RET_ON_ERR(cache_max > 0, "Failed to get CACHE_MAX_CNT");
 
-    proxy = new eventd_proxy(zctx);
+    stats_instance.set_flush_interval(get_config_data(
+                string(STATS_FLUSH_INTERVAL_KEY), STATS_FLUSH_INTERVAL_MS));
+
+    proxy = new eventd_proxy(zctx, &stats_instance);
     RET_ON_ERR(proxy != NULL, "Failed to create proxy");
 
     RET_ON_ERR(proxy->init() == 0, "Failed to init proxy");
@@ -716,8 +1166,7 @@ run_eventd_service()
                 if (capture != NULL) {
                     capture.reset();
                 }
-                event_serialized_lst_t().swap(capture_fifo_events);
-                last_events_t().swap(capture_last_events);
+                event_cache().swap(capture_cached);
 
                 capture = make_unique<capture_service>(zctx, cache_max, &stats_instance);
                 if (capture != NULL) {
@@ -748,8 +1197,7 @@ run_eventd_service()
                 resp = capture->set_control(STOP_CAPTURE);
                 if (resp == 0) {
                     counters_t overflow;
-                    resp = capture->read_cache(capture_fifo_events, capture_last_events,
-                            overflow);
+                    resp = capture->read_cache(capture_cached, overflow);
                 }
                 capture.reset();
 
@@ -771,29 +1219,10 @@ run_eventd_service()
                 }
                 resp = 0;
 
-                if (capture_fifo_events.empty()) {
-                    for (last_events_t::iterator it = capture_last_events.begin();
-                            it != capture_last_events.end(); ++it) {
-                        capture_fifo_events.push_back(it->second);
-                    }
-                    last_events_t().swap(capture_last_events);
-                }
-
-                {
-                    int sz = VEC_SIZE(capture_fifo_events) < READ_SET_SIZE ?
-                        VEC_SIZE(capture_fifo_events) : READ_SET_SIZE;
-
-                    if (sz != 0) {
-                        auto it = std::next(capture_fifo_events.begin(), sz);
-                        move(capture_fifo_events.begin(), capture_fifo_events.end(),
-                                back_inserter(resp_data));
-
-                        if (sz == VEC_SIZE(capture_fifo_events)) {
-                            event_serialized_lst_t().swap(capture_fifo_events);
-                        } else {
-                            capture_fifo_events.erase(capture_fifo_events.begin(), it);
-                        }
-                    }
+                capture_cached.read(READ_SET_SIZE, resp_data);
+                if (capture_cached.fifo_size() == 0 && capture_cached.last_size() == 0) {
+                    /* All read; Release the arena */
+                    event_cache().swap(capture_cached);
                 }
                 break;
 
@@ -2,6 +2,11 @@
  * Header file for eventd daemon
  */
 #include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
 #include <swss/table.h>
 #include <swss/events_service.h>
 #include <swss/events.h>
@@ -21,12 +26,70 @@ typedef enum {
 } stats_counter_index_t;
 
 #define EVENTS_STATS_FIELD_NAME "value"
+
+/* Per publisher source counters are saved with key prefix + source */
+#define EVENTS_STATS_SOURCE_PREFIX "source:"
+#define EVENTS_STATS_FIELD_PUBLISHED "published"
+#define EVENTS_STATS_FIELD_MISSED "missed_internal"
+#define EVENTS_STATS_FIELD_BYTES "bytes"
+
+/* Publish to receive latency, in milliseconds */
+#define EVENTS_STATS_LATENCY_KEY "latency"
+
+/* Proxy counters */
+#define EVENTS_STATS_PROXY_KEY "proxy"
+
+/*
+ * Least gap between two writes of stats to DB in milliseconds.
+ * Overridden by stats_flush_interval_ms in init config.
+ */
+#define STATS_FLUSH_INTERVAL_MS 10
+#define STATS_FLUSH_INTERVAL_KEY "stats_flush_interval_ms"
 #define STATS_HEARTBEAT_MIN 300
 #define CAPTURE_SERVICE_POLLING_DURATION 10
 #define CAPTURE_SERVICE_POLLING_INCREMENT 10
 #define CAPTURE_SERVICE_POLLING_MAX_DURATION 100
 #define CAPTURE_SERVICE_POLLING_RETRIES 100
 
+/*
+ * Proxy tunables, read from init config.
+ *  io_threads: Count of zmq I/O threads on the eventd context. Publisher
+ *          connections are spread across these; forwarding is still done
+ *          by the single proxy thread.
+ *  hwm: High water mark per connection; 0 keeps zmq default.
+ *  nodrop: Report subscriber overflow as drops, instead of zmq silently
+ *          dropping for the slow subscriber only.
+ */
+#define PROXY_IO_THREADS_KEY "proxy_io_threads"
+#define PROXY_HWM_KEY "proxy_hwm"
+#define PROXY_NODROP_KEY "proxy_nodrop"
+
+/* Max messages forwarded in one go, before serving the other direction */
+#define PROXY_BATCH_SIZE 256
+
+/* Interval to hand proxy counters to stats collector in milliseconds */
+#define PROXY_STATS_INTERVAL_MS 1000
+
+/* Hard limit on memory held by capture cache */
+#define CACHE_BYTES_MAX (100 * 1024 * 1024)
+
+typedef enum {
+    /* Events forwarded from publishers to subscribers */
+    INDEX_PROXY_FORWARDED,
+
+    /* Times a full batch was forwarded & more were still queued */
+    INDEX_PROXY_BLOCKED,
+
+    /*
+     * Events that could not be handed to subscribers. Counted only with
+     * proxy_nodrop set; otherwise zmq drops for a slow subscriber silently.
+     */
+    INDEX_PROXY_DROPPED,
+    PROXY_COUNTERS_TOTAL
+} proxy_counter_index_t;
+
+class stats_collector;
+
 /*
  *  Started by eventd_service.
  *  Creates XPUB & XSUB end points.
@@ -34,12 +97,23 @@ typedef enum {
  *  Create a PUB socket end point for capture and bind.
  *  Call run_proxy method with sockets in a dedicated thread.
  *  Thread runs forever until the zmq context is terminated.
+ *
+ *  Messages are steered by the thread, instead of zmq_proxy, so as to
+ *  count forwarded, blocked & dropped. Every message, in either direction,
+ *  is copied to capture end point, same as zmq_proxy.
  */
 class eventd_proxy
 {
     public:
-        eventd_proxy(void *ctx) : m_ctx(ctx), m_frontend(NULL), m_backend(NULL),
-            m_capture(NULL), m_init_done(false), m_init_result(0) {};
+        eventd_proxy(void *ctx, stats_collector *stats = NULL) : m_ctx(ctx),
+            m_frontend(NULL), m_backend(NULL), m_capture(NULL), m_stats(stats),
+            m_init_done(false), m_init_result(0)
+        {
+            for (int i=0; i < PROXY_COUNTERS_TOTAL; ++i) {
+                m_counters[i] = 0;
+                m_reported[i] = 0;
+            }
+        };
 
         ~eventd_proxy() {
             if (m_thr.joinable())
@@ -48,19 +122,69 @@ class eventd_proxy
 
         int init();
 
+        counters_t read_counter(proxy_counter_index_t index) {
+            return index != PROXY_COUNTERS_TOTAL ? m_counters[index].load() : 0;
+        }
+
     private:
         void run();
 
+        /* Forward one multi part message; Returns 0 or zmq errno */
+        int forward(void *from, void *to, bool &dropped);
+
+        void report_stats();
+
         void *m_ctx;
         void *m_frontend;
         void *m_backend;
         void *m_capture;
+        stats_collector *m_stats;
         thread m_thr;
+
+        std::atomic<counters_t> m_counters[PROXY_COUNTERS_TOTAL];
+        counters_t m_reported[PROXY_COUNTERS_TOTAL];
         std::atomic<bool> m_init_done;
         std::atomic<int> m_init_result;
 };
 
 
+/*
+ * Histogram of latency in milliseconds with power of 2 buckets.
+ * Bucket i holds values in [2^(i-1), 2^i), bucket 0 holds 0.
+ */
+class latency_histogram
+{
+    public:
+        latency_histogram() { reset(); }
+
+        void record(int64_t ms);
+
+        /* Upper bound of the bucket holding the pct percentile */
+        int64_t percentile(int pct) const;
+
+        int64_t max() const { return m_max; }
+
+        uint64_t count() const { return m_count; }
+
+        void reset();
+
+    private:
+        static const int BUCKETS = 32;
+
+        uint64_t m_buckets[BUCKETS];
+        uint64_t m_count;
+        int64_t m_max;
+};
+
+typedef struct {
+    counters_t published;
+    counters_t missed;
+    counters_t bytes;
+    bool updated;
+} source_counters_t;
+
+typedef map<string, source_counters_t> source_stats_t;
+
 class stats_collector
 {
     public:
@@ -73,6 +197,7 @@ class stats_collector
         void stop() {
 
             m_shutdown = true;
+            wake_writer();
 
             if (m_thr_collector.joinable()) {
                 m_thr_collector.join();
@@ -91,6 +216,20 @@ class stats_collector
             _update_stats(INDEX_COUNTERS_EVENTS_MISSED_CACHE, val);
         }
 
+        /* Counters of a publisher source; false, if none seen. */
+        bool read_source_counters(const string &source, source_counters_t &cntrs);
+
+        /* Percentile of publish to receive latency in milliseconds */
+        int64_t read_latency(int pct);
+
+        /* Latest counters of proxy, indexed by proxy_counter_index_t */
+        void set_proxy_stats(const counters_t *cntrs);
+
+        /* Sets least gap between writes to DB in milliseconds */
+        void set_flush_interval(int val_in_ms) {
+            m_flush_interval_ms = val_in_ms > 0 ? val_in_ms : 0;
+        }
+
         counters_t read_counter(stats_counter_index_t index) {
             if (index != COUNTERS_EVENTS_TOTAL) {
                 return m_lst_counters[index];
@@ -129,19 +268,50 @@ class stats_collector
         void _update_stats(stats_counter_index_t index, counters_t val) {
             if (index != COUNTERS_EVENTS_TOTAL) {
                 m_lst_counters[index] += val;
-                m_updated = true;
+                set_updated();
             }
             else {
                 SWSS_LOG_ERROR("Internal code error. Invalid index=%d", index);
             }
         }
 
+        /*
+         * Only the first update since last write wakes the writer.
+         * Notify under lock, so a writer about to wait can't miss it.
+         */
+        void set_updated() {
+            if (!m_updated.exchange(true)) {
+                wake_writer();
+            }
+        }
+
+        void wake_writer() {
+            lock_guard<mutex> lck(m_writer_mtx);
+            m_writer_cv.notify_one();
+        }
+
+        void update_source_stats(const event_receive_op_t &op);
+
+        void write_stats();
+
         void run_collector();
 
         void run_writer();
 
         std::atomic<bool> m_updated;
 
+        mutex m_writer_mtx;
+        condition_variable m_writer_cv;
+        std::atomic<int> m_flush_interval_ms;
+
+        /* Guards per source counters & latency shared with writer */
+        mutex m_source_mtx;
+        source_stats_t m_source_stats;
+        latency_histogram m_latency;
+        bool m_latency_updated;
+        counters_t m_proxy_counters[PROXY_COUNTERS_TOTAL];
+        bool m_proxy_updated;
+
         std::atomic<counters_t> m_lst_counters[COUNTERS_EVENTS_TOTAL];
 
         std::atomic<bool> m_shutdown;
@@ -150,6 +320,7 @@ class stats_collector
         thread m_thr_writer;
 
         shared_ptr<swss::DBConnector> m_counters_db;
+        shared_ptr<swss::RedisPipeline> m_pipeline;
         shared_ptr<swss::Table> m_stats_table;
 
         std::atomic<bool> m_pause_heartbeat;
@@ -189,17 +360,103 @@ class stats_collector
  *
  *  The string is the serialized version of internal_event_ref
  *
- *  It keeps two sets of data
- *      1) List of all events received in vector in same order as received
- *      2) Map of last event from each runtime id upon list overflow max size.
+ *  It keeps two sets of data in an event_cache
+ *      1) List of all events received in same order as received
+ *      2) Last event from each runtime id upon list overflow max size.
  *
- *  We add to the vector as much as allowed by vector and max limit,
+ *  We add to the list as much as allowed by byte budget and max limit,
  *  whichever comes first.
  *
  *  The sequence number in internal event will help assess the missed count
  *  by the consumer of the cache data.
  *
  */
+/*
+ * Byte budgeted store for captured events.
+ *
+ * The whole budget is allocated once upfront, so caching an event never
+ * allocates and capture can't fail midway on memory pressure. Untouched
+ * pages are not backed until written, hence the resident size tracks
+ * what is actually cached.
+ *
+ * Events in arrival order are packed from the start of the arena. Last
+ * events per runtime id are packed from the end of the arena, with an
+ * index from runtime id to its record. A newer event of a runtime id
+ * overwrites its record in place when it fits, else a new record is
+ * carved out and the stale ones are reclaimed by compacting the end region.
+ * A slice of the budget is held back from the ordered list, so that last
+ * events always have room once the list is full.
+ *
+ * Readers get views into the arena, which stay valid until the cache is
+ * cleared, swapped out or destroyed.
+ */
+class event_cache
+{
+    public:
+        event_cache(size_t budget = 0, size_t max_cnt = 0);
+
+        /* Append in arrival order; false, if budget or count is exhausted */
+        bool push(const event_serialized_t &evt);
+
+        /* Save as last event of rid; false, if it does not fit */
+        bool set_last(const runtime_id_t &rid, const event_serialized_t &evt);
+
+        size_t fifo_size() const { return m_fifo.size() - m_read_pos; }
+
+        size_t last_size() const { return m_last.size(); }
+
+        std::string_view fifo_at(size_t i) const {
+            return view(m_fifo[m_read_pos + i]);
+        }
+
+        /* Visit last event of each runtime id */
+        template <typename F>
+        void for_each_last(F fn) const {
+            for (const auto &e: m_last) {
+                fn(e.first, view(e.second));
+            }
+        }
+
+        /*
+         * Copy out up to cnt events, ordered list first and then
+         * last events. Events copied are released from the cache.
+         */
+        void read(int cnt, event_serialized_lst_t &lst);
+
+        size_t used_bytes() const { return m_head + (m_budget - m_tail); }
+
+        size_t budget() const { return m_budget; }
+
+        void swap(event_cache &other);
+
+    private:
+        typedef struct {
+            size_t off;
+            size_t len;
+        } record_t;
+
+        std::string_view view(const record_t &rec) const {
+            return std::string_view(m_arena.get() + rec.off, rec.len);
+        }
+
+        void compact_last();
+
+        unique_ptr<char[]> m_arena;
+        size_t m_budget;
+        size_t m_max_cnt;
+        size_t m_reserve;
+
+        /* End of ordered list region & start of last events region */
+        size_t m_head;
+        size_t m_tail;
+
+        vector<record_t> m_fifo;
+        size_t m_read_pos;
+
+        unordered_map<runtime_id_t, record_t> m_last;
+};
+
+
 typedef enum {
     NEED_INIT = 0,
     INIT_CAPTURE,
@@ -211,10 +468,11 @@ typedef enum {
 class capture_service
 {
     public:
-        capture_service(void *ctx, int cache_max, stats_collector *stats) :
+        capture_service(void *ctx, int cache_max, stats_collector *stats,
+                size_t cache_bytes = CACHE_BYTES_MAX) :
             m_ctx(ctx), m_stats_instance(stats), m_cap_run(false),
             m_ctrl(NEED_INIT), m_cache_max(cache_max),
-            m_last_events_init(false), m_total_missed_cache(0)
+            m_cache(cache_bytes, cache_max), m_total_missed_cache(0)
         {}
 
         ~capture_service();
@@ -224,6 +482,9 @@ class capture_service
         int read_cache(event_serialized_lst_t &lst_fifo,
                 last_events_t &lst_last, counters_t &overflow_cnt);
 
+        /* Hands over the cache as is; No copy of events. */
+        int read_cache(event_cache &cache, counters_t &overflow_cnt);
+
     private:
         void init_capture_cache(const event_serialized_lst_t &lst);
         void do_capture();
@@ -239,10 +500,7 @@ class capture_service
 
         int m_cache_max;
 
-        event_serialized_lst_t m_events;
-
-        last_events_t m_last_events;
-        bool m_last_events_init;
+        event_cache m_cache;
 
         typedef map<runtime_id_t, sequence_t> pre_exist_id_t;
         pre_exist_id_t m_pre_exist_id;
@@ -272,6 +272,8 @@ TEST(eventd, proxy)
     thrc.join();
     EXPECT_EQ(rd_evts.size(), wr_evts.size());
     EXPECT_EQ(rd_cevts_sz,  wr_evts.size());
+    EXPECT_EQ(wr_sz, (int)pxy->read_counter(INDEX_PROXY_FORWARDED));
+    EXPECT_EQ(0, (int)pxy->read_counter(INDEX_PROXY_DROPPED));
 
     zmq_close(mock_pub);
 
@@ -553,6 +555,122 @@ TEST(eventd, captureCacheMax)
     printf("Capture TEST with matchinhg cache-max completed\n");
 }
 
+TEST(eventd, captureCacheBudget)
+{
+    printf("Capture cache budget TEST started\n");
+
+    string evt_a(100, 'a'), evt_b(100, 'b'), evt_c(60, 'c');
+
+    /* 1600 bytes; 100 held back for last events */
+    event_cache cache(1600, 100);
+
+    int cnt = 0;
+    while (cache.push(evt_a)) {
+        ++cnt;
+    }
+    EXPECT_EQ(15, cnt);
+    EXPECT_EQ(15, (int)cache.fifo_size());
+    EXPECT_EQ(1500, (int)cache.used_bytes());
+
+    /* Reserve has room for one record; Replacing reclaims the old one */
+    EXPECT_TRUE(cache.set_last("guid-0", evt_a));
+    EXPECT_FALSE(cache.set_last("guid-1", evt_b));
+    EXPECT_TRUE(cache.set_last("guid-0", evt_c));
+    EXPECT_TRUE(cache.set_last("guid-1", evt_c.substr(0, 40)));
+    EXPECT_EQ(2, (int)cache.last_size());
+    EXPECT_LE(cache.used_bytes(), cache.budget());
+
+    map<string, string> last_exp = {{"guid-0", evt_c}, {"guid-1", evt_c.substr(0, 40)}};
+    map<string, string> last_read;
+    cache.for_each_last([&last_read](const runtime_id_t &rid, string_view evt) {
+            last_read[rid] = string(evt);
+        });
+    EXPECT_EQ(last_exp, last_read);
+    EXPECT_EQ(evt_a, string(cache.fifo_at(14)));
+
+    /* Read out in chunks; ordered list first & then last events */
+    event_serialized_lst_t lst;
+    cache.read(10, lst);
+    EXPECT_EQ(10, (int)lst.size());
+    cache.read(10, lst);
+    EXPECT_EQ(15, (int)lst.size());
+    cache.read(10, lst);
+    EXPECT_EQ(17, (int)lst.size());
+    EXPECT_EQ(0, (int)cache.fifo_size());
+    EXPECT_EQ(0, (int)cache.last_size());
+
+    /* Count limit applies before byte budget */
+    event_cache small(1600, 3);
+    EXPECT_TRUE(small.push(evt_a));
+    EXPECT_TRUE(small.push(evt_a));
+    EXPECT_TRUE(small.push(evt_a));
+    EXPECT_FALSE(small.push(evt_a));
+
+    printf("Capture cache budget TEST completed\n");
+}
+
+TEST(eventd, captureCacheRate)
+{
+    printf("Capture cache rate TEST started\n");
+
+    const int evt_cnt = 100000;
+    const int rid_cnt = 50;
+    event_serialized_lst_t evts;
+
+    for(int i=0; i < (int)ARRAY_SIZE(ldata); ++i) {
+        internal_event_t ev(create_ev(ldata[i]));
+        string evt_str;
+        serialize(ev, evt_str);
+        evts.push_back(evt_str);
+    }
+
+    /* Budget fits half the events; rest lands in last events. */
+    size_t budget = 0;
+    for(int i=0; i < evt_cnt; ++i) {
+        budget += evts[i % evts.size()].size();
+    }
+    event_cache cache(budget / 2, evt_cnt);
+
+    auto st = chrono::steady_clock::now();
+    int cached = 0;
+    int dropped = 0;
+    for(int i=0; i < evt_cnt; ++i) {
+        const string &evt = evts[i % evts.size()];
+        if (cache.push(evt)) {
+            ++cached;
+        } else if (!cache.set_last(to_string(i % rid_cnt), evt)) {
+            ++dropped;
+        }
+    }
+    auto elapsed = chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now() - st).count();
+
+    printf("Cached %d events in %ld us; %d events/sec\n", evt_cnt, (long)elapsed,
+            (int)(evt_cnt * 1000000L / max((long)elapsed, 1L)));
+
+    /* Rate is only reported; timing is not asserted on shared CI hosts */
+    EXPECT_EQ(0, dropped);
+    EXPECT_GT(cached, 0);
+    EXPECT_LT(cached, evt_cnt);
+    EXPECT_EQ(cached, (int)cache.fifo_size());
+    EXPECT_EQ(rid_cnt, (int)cache.last_size());
+    EXPECT_LE(cache.used_bytes(), cache.budget());
+
+    /* Ordered events come back in arrival order, then one per runtime id */
+    event_serialized_lst_t rd;
+    cache.read(evt_cnt, rd);
+    EXPECT_EQ(cached, (int)rd.size());
+    int misordered = 0;
+    for(int i=0; i < (int)rd.size(); ++i) {
+        misordered += (rd[i] != evts[i % evts.size()]);
+    }
+    EXPECT_EQ(0, misordered);
+    cache.read(evt_cnt, rd);
+    EXPECT_EQ(cached + rid_cnt, (int)rd.size());
+
+    printf("Capture cache rate TEST completed\n");
+}
+
 TEST(eventd, service)
 {
     /*
@@ -792,6 +910,33 @@ TEST(eventd, heartbeat)
 }
 
 
+TEST(eventd, latencyHistogram)
+{
+    latency_histogram hist;
+
+    EXPECT_EQ(0, hist.percentile(99));
+
+    /* 90 events in 1ms, 9 in 20ms & 1 outlier */
+    for (int i=0; i < 90; ++i) {
+        hist.record(1);
+    }
+    for (int i=0; i < 9; ++i) {
+        hist.record(20);
+    }
+    hist.record(700);
+
+    EXPECT_EQ(100, (int)hist.count());
+    EXPECT_EQ(1, hist.percentile(50));
+    EXPECT_EQ(1, hist.percentile(90));
+    EXPECT_EQ(31, hist.percentile(99));
+    EXPECT_EQ(700, hist.percentile(100));
+    EXPECT_EQ(700, hist.max());
+
+    hist.reset();
+    EXPECT_EQ(0, (int)hist.count());
+}
+
+
 TEST(eventd, testDB)
 {
     printf("DB TEST started\n");
@@ -874,6 +1019,20 @@ TEST(eventd, testDB)
 
     events_deinit_publisher(pub_handle);
 
+    {
+        source_counters_t cntrs;
+
+        EXPECT_TRUE(stats_instance.read_source_counters("test_db", cntrs));
+        EXPECT_EQ(pub_count, (int)cntrs.published);
+        EXPECT_EQ(0, (int)cntrs.missed);
+        EXPECT_LT(0, (int)cntrs.bytes);
+
+        string key = string("COUNTERS_EVENTS:") + EVENTS_STATS_SOURCE_PREFIX + "test_db";
+        EXPECT_TRUE(db.exists(key));
+        EXPECT_EQ(to_string(pub_count), db.hget(key, EVENTS_STATS_FIELD_PUBLISHED));
+        EXPECT_TRUE(db.exists(string("COUNTERS_EVENTS:") + EVENTS_STATS_LATENCY_KEY));
+    }
+
     for (int i=0; i < COUNTERS_EVENTS_TOTAL; ++i) {
         string key = string("COUNTERS_EVENTS:") + counter_keys[i];
         unordered_map<string, string> m;
@@ -1,5 +1,8 @@
 #include <thread>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <stdlib.h>
 #include <swss/events.h>
 #include <swss/events_common.h>
@@ -27,12 +30,25 @@ typedef enum {
     OP_INIT=0,
     OP_SEND=1,
     OP_RECV=2,
-    OP_SEND_RECV=3     //SEND|RECV
+    OP_SEND_RECV=3,    //SEND|RECV
+    OP_BENCH=4
 } op_t;
 
 
 #define PRINT_CHUNK_SZ 2
 
+/* Benchmark events are published with this source & tag */
+#define BENCH_SOURCE "sonic-events-bench"
+#define BENCH_TAG "bench"
+
+/* Params embedded in each benchmark event */
+#define BENCH_PARAM_PUB "pub"
+#define BENCH_PARAM_TS "ts_us"
+#define BENCH_PARAM_PAYLOAD "payload"
+
+/* Subscriber quits, when idle this long after publishers are done */
+#define BENCH_IDLE_MS 2000
+
 /*
  * Usage:
  */
@@ -64,7 +80,16 @@ Note:\n\
 \n\
 -c  - Use offline cache in receive mode\n\
 -o  - O/p file to write received events\n\
-      Default: STDOUT\n";
+      Default: STDOUT\n\
+\n\
+-b  - Benchmark; Publish from -t threads & receive in a dedicated thread.\n\
+      Can't be combined with -s or -r. Thread i publishes as source\n\
+      " BENCH_SOURCE "-<i>.\n\
+      Reports throughput, loss per publisher and latency percentiles.\n\
+      -n is count to send per thread. Default: 10000\n\
+-t  - Count of publisher threads in benchmark mode. Default: 1\n\
+-R  - Events per second per publisher thread. Default: 0 implying no pacing\n\
+-z  - Payload size in bytes added to each event. Default: 0\n";
 
 
 bool term_receive = false;
@@ -87,6 +112,152 @@ t_map_to_str(const Map &m)
     return _ss.str();
 }
 
+static int64_t
+now_us()
+{
+    return chrono::duration_cast<chrono::microseconds>(
+            chrono::system_clock::now().time_since_epoch()).count();
+}
+
+typedef struct {
+    int sent;
+    int received;
+    int missed;
+} bench_pub_stats_t;
+
+void
+do_bench_publish(int id, int cnt, int rate, int payload_sz, bench_pub_stats_t *stats)
+{
+    event_params_t params;
+    /*
+     * Publisher handles are cached per source and are not thread safe,
+     * hence a source per thread. It still matches the subscriber's
+     * BENCH_SOURCE prefix filter.
+     */
+    event_handle_t h = events_init_publisher(string(BENCH_SOURCE) + "-" + to_string(id));
+    ASSERT(h != NULL, "failed to init publisher %d", id);
+
+    params[BENCH_PARAM_PUB] = to_string(id);
+    if (payload_sz > 0) {
+        params[BENCH_PARAM_PAYLOAD] = string(payload_sz, 'x');
+    }
+
+    /* Send i at start + i * period, so a late send does not delay the rest */
+    auto start = chrono::steady_clock::now();
+    chrono::nanoseconds period(rate > 0 ? (1000000000LL / rate) : 0);
+
+    for (int i=0; i < cnt; ++i) {
+        if (rate > 0) {
+            this_thread::sleep_until(start + i * period);
+        }
+        params[BENCH_PARAM_TS] = to_string(now_us());
+
+        int rc = event_publish(h, BENCH_TAG, &params);
+        ASSERT(rc == 0, "Failed to publish pub=%d index=%d rc=%d", id, i, rc);
+        ++stats->sent;
+    }
+    events_deinit_publisher(h);
+}
+
+/*
+ * Publishers and subscriber run in this process, hence share the clock.
+ * Latency is from the timestamp embedded at publish to receive.
+ * Each publisher thread has its own source, hence its own handle & runtime id.
+ */
+void
+do_bench(int threads, int cnt, int rate, int payload_sz)
+{
+    vector<bench_pub_stats_t> pubs(threads, {0, 0, 0});
+    vector<int64_t> latency;
+    atomic<bool> pub_done(false);
+    int64_t first_us = 0, last_us = 0;
+    int total = 0, unknown = 0;
+
+    event_subscribe_sources_t filter = { BENCH_SOURCE };
+    event_handle_t h = events_init_subscriber(false, 100, &filter);
+    ASSERT(h != NULL, "Failed to get subscriber handle");
+
+    latency.reserve((size_t)threads * cnt);
+
+    /* Provide time for subscription to reach publishers via proxy */
+    this_thread::sleep_for(chrono::milliseconds(500));
+
+    thread rcv([&]() {
+        int64_t idle_since = now_us();
+
+        while (total < (threads * cnt)) {
+            event_receive_op_t evt;
+            int rc = event_receive(h, evt);
+            int64_t now = now_us();
+
+            if (rc != 0) {
+                ASSERT(rc == EAGAIN, "Failed to receive rc=%d", rc);
+                if (pub_done && ((now - idle_since) >= (BENCH_IDLE_MS * 1000))) {
+                    break;
+                }
+                continue;
+            }
+            idle_since = now;
+
+            event_params_t::const_iterator itp = evt.params.find(BENCH_PARAM_PUB);
+            event_params_t::const_iterator itt = evt.params.find(BENCH_PARAM_TS);
+            int id = (itp != evt.params.end()) ? stoi(itp->second) : -1;
+
+            if ((itt == evt.params.end()) || (id < 0) || (id >= threads)) {
+                ++unknown;
+                continue;
+            }
+            pubs[id].received++;
+            pubs[id].missed += evt.missed_cnt;
+
+            latency.push_back(now - stoll(itt->second));
+            if (first_us == 0) {
+                first_us = now;
+            }
+            last_us = now;
+            ++total;
+        }
+    });
+
+    vector<thread> pub_thrs;
+    int64_t pub_start = now_us();
+    for (int i=0; i < threads; ++i) {
+        pub_thrs.push_back(thread(&do_bench_publish, i, cnt, rate, payload_sz, &pubs[i]));
+    }
+    for (auto &thr: pub_thrs) {
+        thr.join();
+    }
+    int64_t pub_end = now_us();
+    pub_done = true;
+
+    rcv.join();
+    events_deinit_subscriber(h);
+
+    int sent = 0;
+    printf("publisher     sent received     lost   missed\n");
+    for (int i=0; i < threads; ++i) {
+        printf("%9d %8d %8d %8d %8d\n", i, pubs[i].sent, pubs[i].received,
+                pubs[i].sent - pubs[i].received, pubs[i].missed);
+        sent += pubs[i].sent;
+    }
+
+    double pub_secs = max(pub_end - pub_start, (int64_t)1) / 1000000.0;
+    double rcv_secs = max(last_us - first_us, (int64_t)1) / 1000000.0;
+    printf("Sent %d events in %.3f secs; %.0f events/sec\n", sent, pub_secs, sent / pub_secs);
+    printf("Received %d events in %.3f secs; %.0f events/sec; lost %d unknown %d\n",
+            total, rcv_secs, total / rcv_secs, sent - total, unknown);
+
+    if (!latency.empty()) {
+        sort(latency.begin(), latency.end());
+        auto pct = [&latency](double p) {
+            return latency[(size_t)(p * (latency.size() - 1) / 100.0)];
+        };
+        printf("Latency us: p50=%ld p99=%ld p999=%ld max=%ld\n",
+                (long)pct(50), (long)pct(99), (long)pct(99.9), (long)latency.back());
+    }
+}
+
+
 void
 do_receive(const event_subscribe_sources_t filter, const string outfile, int cnt, int pause, bool use_cache)
 {
@@ -246,12 +417,13 @@ int main(int argc, char **argv)
     bool use_cache = false;
     int op = OP_INIT;
     int cnt=0, pause=0;
+    int threads=1, rate=0, payload_sz=0;
     string json_str_msg, outfile("STDOUT"), infile;
     event_subscribe_sources_t filter;
 
     for(;;)
     {
-        switch(getopt(argc, argv, "srn:p:i:o:f:c")) // note the colon (:) to indicate that 'b' has a parameter and is not a switch
+        switch(getopt(argc, argv, "srn:p:i:o:f:cbt:R:z:")) // note the colon (:) to indicate that 'b' has a parameter and is not a switch
         {
         case 'c':
             use_cache = true;
@@ -265,6 +437,22 @@ int main(int argc, char **argv)
             op |= OP_RECV;
             continue;
 
+        case 'b':
+            op |= OP_BENCH;
+            continue;
+
+        case 't':
+            threads = stoi(optarg);
+            continue;
+
+        case 'R':
+            rate = stoi(optarg);
+            continue;
+
+        case 'z':
+            payload_sz = stoi(optarg);
+            continue;
+
         case 'n':
             cnt = stoi(optarg);
             continue;
@@ -309,7 +497,14 @@ int main(int argc, char **argv)
     printf("op=%d n=%d pause=%d i=%s o=%s\n",
             op, cnt, pause, infile.c_str(), outfile.c_str());
 
-    if (op == OP_SEND_RECV) {
+    ASSERT(((op & OP_BENCH) == 0) || (op == OP_BENCH),
+            "-b can't be combined with -s or -r");
+
+    if (op == OP_BENCH) {
+        ASSERT(threads > 0, "Expect at least one publisher thread");
+        do_bench(threads, cnt > 0 ? cnt : 10000, rate, payload_sz);
+    }
+    else if (op == OP_SEND_RECV) {
         thread thr(&do_receive, filter, outfile, 0, 0, use_cache);
         do_send(infile, cnt, pause);
     }
@@ -31,6 +31,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #include <errno.h>
 #include <string.h>
@@ -40,6 +41,8 @@
 #include "lib/json.h"
 #include "lib/libfrr.h"
 #include "lib/frratomic.h"
+#include "lib/hash.h"
+#include "lib/jhash.h"
 #include "lib/command.h"
 #include "lib/memory.h"
 #include "lib/network.h"
@@ -169,6 +172,63 @@ enum custom_rtattr_srv6_localsid_action {
 
 static const char *prov_name = "dplane_fpm_sonic";
 
+/* Replay walks that can be parked waiting for output buffer space. */
+enum fpm_nl_walk {
+	FPM_WALK_NONE,
+	FPM_WALK_LSP,
+	FPM_WALK_NHG,
+	FPM_WALK_RIB,
+	FPM_WALK_RMAC,
+};
+
+/*
+ * The output buffer is a chain of pages: contexts are encoded in place in
+ * the tail page and `fpm_write` hands every pending page to one `writev`,
+ * so buffered data is never moved. A page holds four messages of the
+ * maximum size (DPLANE_FPM_NL_BUF_SIZE), the chain is capped at 8MiB.
+ */
+#define FPM_OBUF_PAGE_SIZE (4 * 65536)
+#define FPM_OBUF_PAGES 32
+
+/*
+ * Output buffer free space: the pages not in use plus the tail page room.
+ * Written pages are recycled as soon as `fpm_write` is done with them.
+ */
+#define FPM_OBUF_FREE(fnc)                                                     \
+	((FPM_OBUF_PAGES - (fnc)->obuf->count) * FPM_OBUF_PAGE_SIZE            \
+	 + ((fnc)->obuf->tail ? STREAM_WRITEABLE((fnc)->obuf->tail) : 0))
+
+/* Output buffer space a parked walk needs to be resumed. */
+#define FPM_WALK_RESUME_SPACE(fnc) (FPM_OBUF_PAGES * FPM_OBUF_PAGE_SIZE / 2)
+
+/*
+ * Context queue latency histogram: the first bucket counts waits below
+ * FPM_QLAT_FIRST_USEC, each next one up to 4 times the previous bound and
+ * the last one everything above.
+ */
+#define FPM_QLAT_BUCKETS 8
+#define FPM_QLAT_FIRST_USEC 16
+
+static const struct {
+	const char *label;
+	const char *json;
+} fpm_qlat_names[FPM_QLAT_BUCKETS] = {
+	{ "Queue latency < 16us", "lt-16us" },
+	{ "Queue latency < 64us", "lt-64us" },
+	{ "Queue latency < 256us", "lt-256us" },
+	{ "Queue latency < 1ms", "lt-1ms" },
+	{ "Queue latency < 4ms", "lt-4ms" },
+	{ "Queue latency < 16ms", "lt-16ms" },
+	{ "Queue latency < 64ms", "lt-64ms" },
+	{ "Queue latency >= 64ms", "ge-64ms" },
+};
+
+/* Position of a hash walk, valid as long as the hash was not resized. */
+struct fpm_hash_cursor {
+	uint32_t index;
+	uint32_t size;
+};
+
 static atomic_bool fpm_cleaning_up;
 
 struct fpm_nl_ctx {
@@ -178,11 +238,14 @@ struct fpm_nl_ctx {
 	bool connecting;
 	bool use_nhg;
 	bool use_route_replace;
+	bool coalesce;
 	struct sockaddr_storage addr;
 
 	/* data plane buffers. */
 	struct stream *ibuf;
-	struct stream *obuf;
+	struct stream_fifo *obuf;
+	/* Written output pages kept for reuse. */
+	struct stream_fifo *obuf_spare;
 	pthread_mutex_t obuf_mutex;
 
 	/*
@@ -192,6 +255,25 @@ struct fpm_nl_ctx {
 	 */
 	struct dplane_ctx_list_head ctxqueue;
 	pthread_mutex_t ctxqueue_mutex;
+	/* When `ctxqueue` last went from empty to non empty. */
+	struct timeval ctxqueue_since;
+	/*
+	 * Contexts in `ctxqueue` plus `ctxpending`, used for flow control.
+	 * Not a statistic, so it lives outside `counters` and survives
+	 * "clear fpm counters".
+	 */
+	_Atomic uint32_t ctxqueue_len;
+
+	/*
+	 * Contexts taken from `ctxqueue` in bulk, only used by the FPM
+	 * pthread so they are processed without locking.
+	 */
+	struct dplane_ctx_list_head ctxpending;
+	/* Sequence numbers of contexts entering and leaving `ctxpending`. */
+	uint64_t pending_seq_in;
+	uint64_t pending_seq_out;
+	/* Pending route and next hop group updates, see `fpm_coalesce_add`. */
+	struct hash *coalesce_hash;
 
 	/* data plane events. */
 	struct zebra_dplane_provider *prov;
@@ -214,6 +296,32 @@ struct fpm_nl_ctx {
 	struct event *t_rmacreset;
 	struct event *t_rmacwalk;
 
+	/*
+	 * Replay walk parked on a full output buffer, resumed by `fpm_write`
+	 * once enough space is available. Protected by `obuf_mutex`.
+	 */
+	enum fpm_nl_walk walk_blocked;
+
+	/* Replay walk cursors, only used in the zebra pthread. */
+	struct fpm_hash_cursor lsp_cursor;
+	struct fpm_hash_cursor nhg_cursor;
+	struct {
+		bool active;
+		/* Table iterator state before the table being walked. */
+		rib_tables_iter_t iter;
+		vrf_id_t vrf_id;
+		afi_t afi;
+		safi_t safi;
+		uint32_t table_id;
+		/* Route that did not fit and must be sent first. */
+		struct prefix p;
+		struct prefix_ipv6 src_p;
+		bool has_src;
+	} rib_cursor;
+
+	/* Replay start time, used to account the replay time. */
+	struct timeval replay_start;
+
 	/* Statistic counters. */
 	struct {
 		/* Amount of bytes read into ibuf. */
@@ -239,9 +347,20 @@ struct fpm_nl_ctx {
 		_Atomic uint32_t dplane_contexts;
 		/* Peak amount of data plane contexts enqueued. */
 		_Atomic uint32_t ctxqueue_len_peak;
+		/* Amount of times a thread waited for the context queue. */
+		_Atomic uint32_t ctxqueue_contention;
+		/* Time contexts waited in queue, see `fpm_qlat_names`. */
+		_Atomic uint32_t ctxqueue_latency[FPM_QLAT_BUCKETS];
+		/* Amount of updates not sent as a later one superseded them. */
+		_Atomic uint32_t coalesced;
 
 		/* Amount of buffer full events. */
 		_Atomic uint32_t buffer_full;
+
+		/* Amount of replay walks resumed after buffer drained. */
+		_Atomic uint32_t walk_resumes;
+		/* Time taken by last complete replay in milliseconds. */
+		_Atomic uint32_t replay_time;
 	} counters;
 } *gfnc;
 
@@ -287,6 +406,8 @@ enum fpm_nl_events {
  */
 static void fpm_process_event(struct event *t);
 static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx);
+static void fpm_obuf_reset(struct fpm_nl_ctx *fnc);
+static void fpm_obuf_consume(struct fpm_nl_ctx *fnc, size_t len);
 static void fpm_lsp_send(struct event *t);
 static void fpm_lsp_reset(struct event *t);
 static void fpm_nhg_send(struct event *t);
@@ -295,6 +416,7 @@ static void fpm_rib_send(struct event *t);
 static void fpm_rib_reset(struct event *t);
 static void fpm_rmac_send(struct event *t);
 static void fpm_rmac_reset(struct event *t);
+static void fpm_walk_resume(struct fpm_nl_ctx *fnc, enum fpm_nl_walk walk);
 
 /*
  * CLI.
@@ -319,6 +441,25 @@ DEFUN(no_fpm_use_route_replace, no_fpm_use_route_replace_cmd,
 	return CMD_SUCCESS;
 }
 
+DEFUN(fpm_coalesce_updates, fpm_coalesce_updates_cmd,
+      "fpm coalesce-updates",
+      FPM_STR
+      "Only send the latest of the pending updates of a route or next hop group\n")
+{
+	gfnc->coalesce = true;
+	return CMD_SUCCESS;
+}
+
+DEFUN(no_fpm_coalesce_updates, no_fpm_coalesce_updates_cmd,
+      "no fpm coalesce-updates",
+      NO_STR
+      FPM_STR
+      "Only send the latest of the pending updates of a route or next hop group\n")
+{
+	gfnc->coalesce = false;
+	return CMD_SUCCESS;
+}
+
 DEFUN(fpm_set_address, fpm_set_address_cmd,
       "fpm address <A.B.C.D|X:X::X:X> [port (1-65535)]",
       FPM_STR
@@ -472,6 +613,7 @@ DEFUN(fpm_show_status,
 		json_object_boolean_add(j, "useNHG", gfnc->use_nhg);
 		json_object_boolean_add(j, "useRouteReplace",
 					gfnc->use_route_replace);
+		json_object_boolean_add(j, "coalesceUpdates", gfnc->coalesce);
 		json_object_boolean_add(j, "disabled", gfnc->disabled);
 		json_object_string_add(j, "address", buf);
 		json_object_int_add(j, "port", port);
@@ -489,6 +631,8 @@ DEFUN(fpm_show_status,
 			       gfnc->use_nhg ? "Yes" : "No");
 		ttable_add_row(table, "Use Route Replace Semantics|%s",
 			       gfnc->use_route_replace ? "Yes" : "No");
+		ttable_add_row(table, "Coalesce Updates|%s",
+			       gfnc->coalesce ? "Yes" : "No");
 		ttable_add_row(table, "Disabled|%s",
 			       gfnc->disabled ? "Yes" : "No");
 
@@ -508,11 +652,7 @@ DEFUN(fpm_show_counters, fpm_show_counters_cmd,
       FPM_STR
       "FPM statistic counters\n")
 {
-	uint32_t curr_queue_len;
-
-	frr_with_mutex (&gfnc->ctxqueue_mutex) {
-		curr_queue_len = dplane_ctx_queue_count(&gfnc->ctxqueue);
-	}
+	int i;
 
 	vty_out(vty, "%30s\n%30s\n", "FPM counters", "============");
 
@@ -527,10 +667,18 @@ DEFUN(fpm_show_counters, fpm_show_counters_cmd,
 	SHOW_COUNTER("Connection errors", gfnc->counters.connection_errors);
 	SHOW_COUNTER("Data plane items processed",
 		     gfnc->counters.dplane_contexts);
-	SHOW_COUNTER("Data plane items enqueued", curr_queue_len);
+	SHOW_COUNTER("Data plane items enqueued", gfnc->ctxqueue_len);
 	SHOW_COUNTER("Data plane items queue peak",
 		     gfnc->counters.ctxqueue_len_peak);
+	SHOW_COUNTER("Data plane queue contention",
+		     gfnc->counters.ctxqueue_contention);
+	for (i = 0; i < FPM_QLAT_BUCKETS; i++)
+		SHOW_COUNTER(fpm_qlat_names[i].label,
+			     gfnc->counters.ctxqueue_latency[i]);
 	SHOW_COUNTER("Buffer full hits", gfnc->counters.buffer_full);
+	SHOW_COUNTER("Superseded updates dropped", gfnc->counters.coalesced);
+	SHOW_COUNTER("Replay walk resumes", gfnc->counters.walk_resumes);
+	SHOW_COUNTER("Replay time (msecs)", gfnc->counters.replay_time);
 	SHOW_COUNTER("User FPM configurations", gfnc->counters.user_configures);
 	SHOW_COUNTER("User FPM disable requests", gfnc->counters.user_disables);
 
@@ -546,13 +694,8 @@ DEFUN(fpm_show_counters_json, fpm_show_counters_json_cmd,
       "FPM statistic counters\n"
       JSON_STR)
 {
-	uint32_t curr_queue_len;
-
-	frr_with_mutex (&gfnc->ctxqueue_mutex) {
-		curr_queue_len = dplane_ctx_queue_count(&gfnc->ctxqueue);
-	}
-
-	struct json_object *jo;
+	struct json_object *jo, *jl;
+	int i;
 
 	jo = json_object_new_object();
 	json_object_int_add(jo, "bytes-read", gfnc->counters.bytes_read);
@@ -565,10 +708,22 @@ DEFUN(fpm_show_counters_json, fpm_show_counters_json_cmd,
 			    gfnc->counters.connection_errors);
 	json_object_int_add(jo, "data-plane-contexts",
 			    gfnc->counters.dplane_contexts);
-	json_object_int_add(jo, "data-plane-contexts-queue", curr_queue_len);
+	json_object_int_add(jo, "data-plane-contexts-queue",
+			    gfnc->ctxqueue_len);
 	json_object_int_add(jo, "data-plane-contexts-queue-peak",
 			    gfnc->counters.ctxqueue_len_peak);
+	json_object_int_add(jo, "data-plane-contexts-queue-contention",
+			    gfnc->counters.ctxqueue_contention);
+	jl = json_object_new_object();
+	for (i = 0; i < FPM_QLAT_BUCKETS; i++)
+		json_object_int_add(jl, fpm_qlat_names[i].json,
+				    gfnc->counters.ctxqueue_latency[i]);
+	json_object_object_add(jo, "data-plane-contexts-queue-latency", jl);
 	json_object_int_add(jo, "buffer-full-hits", gfnc->counters.buffer_full);
+	json_object_int_add(jo, "superseded-updates", gfnc->counters.coalesced);
+	json_object_int_add(jo, "replay-walk-resumes",
+			    gfnc->counters.walk_resumes);
+	json_object_int_add(jo, "replay-time-msecs", gfnc->counters.replay_time);
 	json_object_int_add(jo, "user-configures",
 			    gfnc->counters.user_configures);
 	json_object_int_add(jo, "user-disables", gfnc->counters.user_disables);
@@ -620,6 +775,11 @@ static int fpm_write_config(struct vty *vty)
 		written = 1;
 	}
 
+	if (gfnc->coalesce) {
+		vty_out(vty, "fpm coalesce-updates\n");
+		written = 1;
+	}
+
 	return written;
 }
 
@@ -670,7 +830,8 @@ static void fpm_reconnect(struct fpm_nl_ctx *fnc)
 	}
 
 	stream_reset(fnc->ibuf);
-	stream_reset(fnc->obuf);
+	fpm_obuf_reset(fnc);
+	fnc->walk_blocked = FPM_WALK_NONE;
 	event_cancel(&fnc->t_read);
 	event_cancel(&fnc->t_write);
 
@@ -881,10 +1042,11 @@ send_batch:
 static void fpm_write(struct event *t)
 {
 	struct fpm_nl_ctx *fnc = EVENT_ARG(t);
+	struct iovec iov[FPM_OBUF_PAGES];
+	struct stream *s;
 	socklen_t statuslen;
 	ssize_t bwritten;
-	int rv, status;
-	size_t btotal;
+	int rv, status, iovcnt;
 
 	if (fnc->connecting == true) {
 		status = 0;
@@ -925,16 +1087,28 @@ static void fpm_write(struct event *t)
 	frr_mutex_lock_autounlock(&fnc->obuf_mutex);
 
 	while (true) {
-		/* Stream is empty: reset pointers and return. */
-		if (STREAM_READABLE(fnc->obuf) == 0) {
-			stream_reset(fnc->obuf);
-			break;
+		/* Resume a parked replay walk as soon as it has room again. */
+		if (fnc->walk_blocked != FPM_WALK_NONE
+		    && FPM_OBUF_FREE(fnc) >= FPM_WALK_RESUME_SPACE(fnc)) {
+			fpm_walk_resume(fnc, fnc->walk_blocked);
+			fnc->walk_blocked = FPM_WALK_NONE;
 		}
 
-		/* Try to write all at once. */
-		btotal = stream_get_endp(fnc->obuf) -
-			stream_get_getp(fnc->obuf);
-		bwritten = write(fnc->socket, stream_pnt(fnc->obuf), btotal);
+		/* Gather every page not written yet. */
+		iovcnt = 0;
+		for (s = stream_fifo_head(fnc->obuf); s; s = s->next) {
+			if (STREAM_READABLE(s) == 0)
+				continue;
+			iov[iovcnt].iov_base = stream_pnt(s);
+			iov[iovcnt].iov_len = STREAM_READABLE(s);
+			iovcnt++;
+		}
+
+		/* Buffer is empty: return. */
+		if (iovcnt == 0)
+			break;
+
+		bwritten = writev(fnc->socket, iov, iovcnt);
 		if (bwritten == 0) {
 			atomic_fetch_add_explicit(
 				&fnc->counters.connection_closes, 1,
@@ -970,12 +1144,18 @@ static void fpm_write(struct event *t)
 		atomic_fetch_sub_explicit(&fnc->counters.obuf_bytes, bwritten,
 					  memory_order_relaxed);
 
-		stream_forward_getp(fnc->obuf, (size_t)bwritten);
+		fpm_obuf_consume(fnc, (size_t)bwritten);
 	}
 
-	/* Stream is not empty yet, we must schedule more writes. */
-	if (STREAM_READABLE(fnc->obuf)) {
-		stream_pulldown(fnc->obuf);
+	/* Buffer is not empty yet, we must schedule more writes. */
+	if (iovcnt != 0) {
+		/* Writing may have made enough room for a parked walk. */
+		if (fnc->walk_blocked != FPM_WALK_NONE
+		    && FPM_OBUF_FREE(fnc) >= FPM_WALK_RESUME_SPACE(fnc)) {
+			fpm_walk_resume(fnc, fnc->walk_blocked);
+			fnc->walk_blocked = FPM_WALK_NONE;
+		}
+
 		event_add_write(fnc->fthread->master, fpm_write, fnc,
 				 fnc->socket, &fnc->t_write);
 		return;
@@ -1136,6 +1316,9 @@ static void fpm_srv6_route_reset(struct event *t)
 		}
 	}
 
+	/* Walk from the start, to pick routes before any saved cursor. */
+	fnc->rib_cursor.active = false;
+
 	/* Schedule next step: send RIB routes. */
 	event_add_event(zrouter.master, fpm_rib_send, fnc, 0, &fnc->t_ribwalk);
 }
@@ -1983,9 +2166,10 @@ static ssize_t fill_seg6ipt_encap_private(char *buffer, size_t buflen,
 
 	srhlen = SRH_BASE_HEADER_LENGTH + SRH_SEGMENT_LENGTH * segs->num_segs;
 
-	if (buflen < (sizeof(struct seg6_iptunnel_encap_pri) + srhlen))
+	if (buflen < (sizeof(struct seg6_iptunnel_encap_pri) + srhlen)) {
 		zlog_err("%s: Buffer too small", __func__);
 		return -1;
+	}
 
 	memset(buffer, 0, buflen);
 
@@ -2440,20 +2624,25 @@ static ssize_t netlink_sidlist_msg_encode(int cmd,
 }
 
 #define DPLANE_FPM_NL_BUF_SIZE 65536
+
+/* Maximum data plane contexts encoded under a single output buffer lock. */
+#define DPLANE_FPM_NL_BATCH 64
+
 /**
- * Encode data plane operation context into netlink and enqueue it in the FPM
- * output buffer.
+ * Encode data plane operation context into netlink.
  *
  * @param fnc the netlink FPM context.
  * @param ctx the data plane operation context data.
- * @return 0 on success or -1 on not enough space.
+ * @param nl_buf the buffer to encode to.
+ * @param nl_buf_size the buffer size.
+ * @return the encoded size or 0 if there is nothing to send.
  */
-static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
+static size_t fpm_nl_encode(struct fpm_nl_ctx *fnc,
+			    struct zebra_dplane_ctx *ctx, uint8_t *nl_buf,
+			    size_t nl_buf_size)
 {
-	uint8_t nl_buf[DPLANE_FPM_NL_BUF_SIZE];
 	size_t nl_buf_len;
 	ssize_t rv;
-	uint64_t obytes, obytes_peak;
 	enum dplane_op_e op = dplane_ctx_get_op(ctx);
 	struct nexthop *nexthop;
 
@@ -2498,7 +2687,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_ROUTE_DELETE:
 		if (has_srv6_nexthop(ctx)) {
 			rv = netlink_srv6_msg_encode(RTM_DELROUTE, ctx,
-								nl_buf, sizeof(nl_buf),
+								nl_buf, nl_buf_size,
 								true, fnc->use_nhg);
 			if (rv <= 0) {
 				zlog_err(
@@ -2509,7 +2698,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 			}
 		} else {
 			rv = netlink_route_multipath_msg_encode(RTM_DELROUTE, ctx,
-								nl_buf, sizeof(nl_buf),
+								nl_buf, nl_buf_size,
 								true, fnc->use_nhg, false);
 			if (rv <= 0) {
 				zlog_err(
@@ -2531,7 +2720,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 		if (has_srv6_nexthop(ctx)) {
 			rv = netlink_srv6_msg_encode(
 				RTM_NEWROUTE, ctx, &nl_buf[nl_buf_len],
-				sizeof(nl_buf) - nl_buf_len, true, fnc->use_nhg);
+				nl_buf_size - nl_buf_len, true, fnc->use_nhg);
 			if (rv <= 0) {
 				zlog_err(
 					"%s: netlink_srv6_msg_encode failed",
@@ -2542,7 +2731,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 		} else {
 			rv = netlink_route_multipath_msg_encode(
 				RTM_NEWROUTE, ctx, &nl_buf[nl_buf_len],
-				sizeof(nl_buf) - nl_buf_len, true, fnc->use_nhg,
+				nl_buf_size - nl_buf_len, true, fnc->use_nhg,
 				fnc->use_route_replace);
 			if (rv <= 0) {
 				zlog_err(
@@ -2559,7 +2748,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 
 	case DPLANE_OP_MAC_INSTALL:
 	case DPLANE_OP_MAC_DELETE:
-		rv = netlink_macfdb_update_ctx(ctx, nl_buf, sizeof(nl_buf));
+		rv = netlink_macfdb_update_ctx(ctx, nl_buf, nl_buf_size);
 		if (rv <= 0) {
 			zlog_err("%s: netlink_macfdb_update_ctx failed",
 				 __func__);
@@ -2572,7 +2761,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 
 	case DPLANE_OP_NH_DELETE:
 		rv = netlink_nexthop_msg_encode(RTM_DELNEXTHOP, ctx, nl_buf,
-						sizeof(nl_buf), true);
+						nl_buf_size, true);
 		if (rv <= 0) {
 			zlog_err("%s: netlink_nexthop_msg_encode failed",
 				 __func__);
@@ -2585,7 +2774,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_NH_INSTALL:
 	case DPLANE_OP_NH_UPDATE:
 		rv = netlink_nexthop_msg_encode(RTM_NEWNEXTHOP, ctx, nl_buf,
-						sizeof(nl_buf), true);
+						nl_buf_size, true);
 		if (rv <= 0) {
 			zlog_err("%s: netlink_nexthop_msg_encode failed",
 				 __func__);
@@ -2597,7 +2786,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 		break;
 	case DPLANE_OP_SID_LIST_DELETE:
 		rv = netlink_sidlist_msg_encode(
-				RTM_DELSIDLIST, ctx, nl_buf, sizeof(nl_buf));
+				RTM_DELSIDLIST, ctx, nl_buf, nl_buf_size);
 		if (rv <= 0) {
 			zlog_err(
 				"%s: netlink_srv6_msg_encode failed",
@@ -2610,7 +2799,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_SID_LIST_INSTALL:
 	case DPLANE_OP_SID_LIST_UPDATE:
 		rv = netlink_sidlist_msg_encode(
-				RTM_NEWSIDLIST, ctx, nl_buf, sizeof(nl_buf));
+				RTM_NEWSIDLIST, ctx, nl_buf, nl_buf_size);
 		if (rv <= 0) {
 			zlog_err(
 				"%s: netlink_srv6_msg_encode failed",
@@ -2623,7 +2812,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 
 	case DPLANE_OP_PIC_CONTEXT_DELETE:
 		rv = netlink_pic_context_msg_encode(RTM_DELNEXTHOP, ctx, nl_buf,
-						sizeof(nl_buf));
+						nl_buf_size);
 		if (rv <= 0) {
 			zlog_err("%s: netlink_nexthop_msg_encode failed",
 				 __func__);
@@ -2636,7 +2825,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_PIC_CONTEXT_INSTALL:
 	case DPLANE_OP_PIC_CONTEXT_UPDATE:
 		rv = netlink_pic_context_msg_encode(RTM_NEWNEXTHOP, ctx, nl_buf,
-						sizeof(nl_buf));
+						nl_buf_size);
 		if (rv <= 0) {
 			zlog_err("%s: netlink_pic_context_msg_encode failed",
 				 __func__);
@@ -2649,7 +2838,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_LSP_INSTALL:
 	case DPLANE_OP_LSP_UPDATE:
 	case DPLANE_OP_LSP_DELETE:
-		rv = netlink_lsp_msg_encoder(ctx, nl_buf, sizeof(nl_buf));
+		rv = netlink_lsp_msg_encoder(ctx, nl_buf, nl_buf_size);
 		if (rv <= 0) {
 			zlog_err("%s: netlink_lsp_msg_encoder failed",
 				 __func__);
@@ -2714,40 +2903,138 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 
 	}
 
-	/* Skip empty enqueues. */
-	if (nl_buf_len == 0)
-		return 0;
+	return nl_buf_len;
+}
 
-	/* We must know if someday a message goes beyond 65KiB. */
-	assert((nl_buf_len + FPM_HEADER_SIZE) <= UINT16_MAX);
+/*
+ * Output buffer tail page with `size` bytes of room, chaining a spare or new
+ * page when the tail is short.
+ *
+ * @return the page or NULL when the chain is at its cap.
+ */
+static struct stream *fpm_obuf_tail(struct fpm_nl_ctx *fnc, size_t size)
+{
+	struct stream *s = fnc->obuf->tail;
 
-	frr_mutex_lock_autounlock(&fnc->obuf_mutex);
+	if (s && STREAM_WRITEABLE(s) >= size)
+		return s;
+	if (fnc->obuf->count >= FPM_OBUF_PAGES)
+		return NULL;
 
-	/* Check if we have enough buffer space. */
-	if (STREAM_WRITEABLE(fnc->obuf) < (nl_buf_len + FPM_HEADER_SIZE)) {
-		atomic_fetch_add_explicit(&fnc->counters.buffer_full, 1,
-					  memory_order_relaxed);
+	s = stream_fifo_pop(fnc->obuf_spare);
+	if (s == NULL)
+		s = stream_new(FPM_OBUF_PAGE_SIZE);
+	stream_fifo_push(fnc->obuf, s);
 
-		if (IS_ZEBRA_DEBUG_FPM)
-			zlog_debug(
-				"%s: buffer full: wants to write %zu but has %zu",
-				__func__, nl_buf_len + FPM_HEADER_SIZE,
-				STREAM_WRITEABLE(fnc->obuf));
+	return s;
+}
 
-		return -1;
+/*
+ * Drop `len` written bytes from the output buffer head. Written pages go to
+ * the spare list, except the tail one which is rewound to be filled again.
+ */
+static void fpm_obuf_consume(struct fpm_nl_ctx *fnc, size_t len)
+{
+	struct stream *s;
+	size_t n;
+
+	while (len > 0 && (s = stream_fifo_head(fnc->obuf)) != NULL) {
+		n = STREAM_READABLE(s) < len ? STREAM_READABLE(s) : len;
+		stream_forward_getp(s, n);
+		len -= n;
+
+		if (STREAM_READABLE(s))
+			break;
+
+		stream_reset(s);
+		if (s == fnc->obuf->tail)
+			break;
+
+		stream_fifo_pop(fnc->obuf);
+		stream_fifo_push(fnc->obuf_spare, s);
 	}
+}
+
+/* Drop everything buffered, keeping the pages for reuse. */
+static void fpm_obuf_reset(struct fpm_nl_ctx *fnc)
+{
+	struct stream *s;
+
+	while ((s = stream_fifo_pop(fnc->obuf)) != NULL) {
+		stream_reset(s);
+		stream_fifo_push(fnc->obuf_spare, s);
+	}
+}
+
+/**
+ * Encode data plane operation context into netlink and enqueue it in the FPM
+ * output buffer. Must be called with `obuf_mutex` held.
+ *
+ * When the output buffer has room for any message the context is encoded
+ * in place in the tail page, otherwise it is encoded apart and copied if it
+ * fits.
+ *
+ * @param fnc the netlink FPM context.
+ * @param ctx the data plane operation context data.
+ * @return 0 on success or -1 on not enough space.
+ */
+static int fpm_nl_enqueue_locked(struct fpm_nl_ctx *fnc,
+				 struct zebra_dplane_ctx *ctx)
+{
+	uint8_t nl_buf[DPLANE_FPM_NL_BUF_SIZE];
+	size_t nl_buf_len;
+	uint64_t obytes, obytes_peak;
+	struct stream *s;
+	bool in_place;
+
+	/* Encode right after the header space in the tail page. */
+	s = fpm_obuf_tail(fnc, DPLANE_FPM_NL_BUF_SIZE);
+	in_place = s != NULL;
+	if (in_place) {
+		nl_buf_len = fpm_nl_encode(
+			fnc, ctx,
+			STREAM_DATA(s) + stream_get_endp(s) + FPM_HEADER_SIZE,
+			DPLANE_FPM_NL_BUF_SIZE - FPM_HEADER_SIZE);
+		if (nl_buf_len == 0)
+			return 0;
+	} else {
+		nl_buf_len = fpm_nl_encode(fnc, ctx, nl_buf, sizeof(nl_buf));
+		if (nl_buf_len == 0)
+			return 0;
+
+		/* Check if we have enough buffer space. */
+		s = fnc->obuf->tail;
+		if (STREAM_WRITEABLE(s) < (nl_buf_len + FPM_HEADER_SIZE)) {
+			atomic_fetch_add_explicit(&fnc->counters.buffer_full, 1,
+						  memory_order_relaxed);
+
+			if (IS_ZEBRA_DEBUG_FPM)
+				zlog_debug(
+					"%s: buffer full: wants to write %zu but has %zu",
+					__func__, nl_buf_len + FPM_HEADER_SIZE,
+					STREAM_WRITEABLE(s));
+
+			return -1;
+		}
+	}
+
+	/* We must know if someday a message goes beyond 65KiB. */
+	assert((nl_buf_len + FPM_HEADER_SIZE) <= UINT16_MAX);
 
 	/*
 	 * Fill in the FPM header information.
 	 *
 	 * See FPM_HEADER_SIZE definition for more information.
 	 */
-	stream_putc(fnc->obuf, 1);
-	stream_putc(fnc->obuf, 1);
-	stream_putw(fnc->obuf, nl_buf_len + FPM_HEADER_SIZE);
+	stream_putc(s, 1);
+	stream_putc(s, 1);
+	stream_putw(s, nl_buf_len + FPM_HEADER_SIZE);
 
-	/* Write current data. */
-	stream_write(fnc->obuf, nl_buf, (size_t)nl_buf_len);
+	/* Write current data, unless already encoded in place. */
+	if (in_place)
+		stream_forward_endp(s, nl_buf_len);
+	else
+		stream_write(s, nl_buf, nl_buf_len);
 
 	/* Account number of bytes waiting to be written. */
 	atomic_fetch_add_explicit(&fnc->counters.obuf_bytes,
@@ -2768,6 +3055,105 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	return 0;
 }
 
+/**
+ * Encode data plane operation context into netlink and enqueue it in the FPM
+ * output buffer.
+ *
+ * @param fnc the netlink FPM context.
+ * @param ctx the data plane operation context data.
+ * @return 0 on success or -1 on not enough space.
+ */
+static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
+{
+	frr_mutex_lock_autounlock(&fnc->obuf_mutex);
+
+	return fpm_nl_enqueue_locked(fnc, ctx);
+}
+
+/*
+ * Replay walk helpers.
+ *
+ * A walk that fills the output buffer parks itself and `fpm_write` resumes it
+ * once half of the buffer is free, instead of polling with timers. The walks
+ * keep a cursor, so they resume where they stopped instead of rescanning.
+ */
+
+/* Schedule a walk in the zebra pthread; called with `obuf_mutex` held. */
+static void fpm_walk_resume(struct fpm_nl_ctx *fnc, enum fpm_nl_walk walk)
+{
+	atomic_fetch_add_explicit(&fnc->counters.walk_resumes, 1,
+				  memory_order_relaxed);
+
+	switch (walk) {
+	case FPM_WALK_LSP:
+		event_add_event(zrouter.master, fpm_lsp_send, fnc, 0,
+				&fnc->t_lspwalk);
+		break;
+	case FPM_WALK_NHG:
+		event_add_event(zrouter.master, fpm_nhg_send, fnc, 0,
+				&fnc->t_nhgwalk);
+		break;
+	case FPM_WALK_RIB:
+		event_add_event(zrouter.master, fpm_rib_send, fnc, 0,
+				&fnc->t_ribwalk);
+		break;
+	case FPM_WALK_RMAC:
+		event_add_event(zrouter.master, fpm_rmac_send, fnc, 0,
+				&fnc->t_rmacwalk);
+		break;
+	case FPM_WALK_NONE:
+		break;
+	}
+}
+
+/*
+ * Park a walk that ran out of output buffer space. The check is done under
+ * `obuf_mutex` so a concurrent `fpm_write` drain can't be missed.
+ */
+static void fpm_walk_wait(struct fpm_nl_ctx *fnc, enum fpm_nl_walk walk)
+{
+	frr_with_mutex (&fnc->obuf_mutex) {
+		if (FPM_OBUF_FREE(fnc) >= FPM_WALK_RESUME_SPACE(fnc))
+			fpm_walk_resume(fnc, walk);
+		else
+			fnc->walk_blocked = walk;
+	}
+}
+
+/*
+ * Walk hash buckets starting at the cursor. On abort the cursor keeps the
+ * bucket to restart from; the callbacks skip entries already sent in it.
+ * A resized hash invalidates the cursor and the walk starts over.
+ *
+ * @return true when the walk got to the end of the hash.
+ */
+static bool fpm_hash_walk_resume(struct hash *hash,
+				 struct fpm_hash_cursor *cursor,
+				 int (*func)(struct hash_bucket *, void *),
+				 void *arg)
+{
+	struct hash_bucket *hb, *hbnext;
+	uint32_t i;
+
+	if (cursor->size != hash->size) {
+		cursor->index = 0;
+		cursor->size = hash->size;
+	}
+
+	for (i = cursor->index; i < hash->size; i++) {
+		for (hb = hash->index[i]; hb; hb = hbnext) {
+			hbnext = hb->next;
+			if ((*func)(hb, arg) == HASHWALK_ABORT) {
+				cursor->index = i;
+				return false;
+			}
+		}
+	}
+
+	cursor->index = 0;
+	return true;
+}
+
 /*
  * LSP walk/send functions
  */
@@ -2809,7 +3195,8 @@ static void fpm_lsp_send(struct event *t)
 	fla.ctx = dplane_ctx_alloc();
 	fla.complete = true;
 
-	hash_walk(zvrf->lsp_table, fpm_lsp_send_cb, &fla);
+	fpm_hash_walk_resume(zvrf->lsp_table, &fnc->lsp_cursor,
+			     fpm_lsp_send_cb, &fla);
 
 	dplane_ctx_fini(&fla.ctx);
 
@@ -2820,9 +3207,8 @@ static void fpm_lsp_send(struct event *t)
 		event_add_timer(zrouter.master, fpm_nhg_reset, fnc, 0,
 				 &fnc->t_nhgreset);
 	} else {
-		/* Didn't finish - reschedule LSP walk */
-		event_add_timer(zrouter.master, fpm_lsp_send, fnc, 0,
-				 &fnc->t_lspwalk);
+		/* Didn't finish - resume LSP walk once buffer drains */
+		fpm_walk_wait(fnc, FPM_WALK_LSP);
 	}
 }
 
@@ -2870,7 +3256,8 @@ static void fpm_nhg_send(struct event *t)
 
 	/* Send next hops. */
 	if (fnc->use_nhg)
-		hash_walk(zrouter.nhgs_id, fpm_nhg_send_cb, &fna);
+		fpm_hash_walk_resume(zrouter.nhgs_id, &fnc->nhg_cursor,
+				     fpm_nhg_send_cb, &fna);
 
 	/* `free()` allocated memory. */
 	dplane_ctx_fini(&fna.ctx);
@@ -2880,9 +3267,65 @@ static void fpm_nhg_send(struct event *t)
 		WALK_FINISH(fnc, FNE_NHG_FINISHED);
 		event_add_timer(zrouter.master, fpm_rib_reset, fnc, 0,
 				 &fnc->t_ribreset);
-	} else /* Otherwise reschedule next hop group again. */
-		event_add_timer(zrouter.master, fpm_nhg_send, fnc, 0,
-				 &fnc->t_nhgwalk);
+	} else /* Otherwise resume once buffer drains. */
+		fpm_walk_wait(fnc, FPM_WALK_NHG);
+}
+
+/*
+ * Save the RIB walk position at `rn`, which is released. Only ids and
+ * prefixes are kept, as the table or node may be gone by the time the walk
+ * resumes.
+ */
+static void fpm_rib_cursor_save(struct fpm_nl_ctx *fnc,
+				const rib_tables_iter_t *iter,
+				struct route_table *rt, struct route_node *rn)
+{
+	const struct rib_table_info *info = rib_table_info(rt);
+	const struct prefix *p, *src_p;
+
+	srcdest_rnode_prefixes(rn, &p, &src_p);
+
+	fnc->rib_cursor.active = true;
+	fnc->rib_cursor.iter = *iter;
+	fnc->rib_cursor.vrf_id = zvrf_id(info->zvrf);
+	fnc->rib_cursor.afi = info->afi;
+	fnc->rib_cursor.safi = info->safi;
+	fnc->rib_cursor.table_id = info->table_id;
+	prefix_copy(&fnc->rib_cursor.p, p);
+	fnc->rib_cursor.has_src = (src_p != NULL && src_p->prefixlen != 0);
+	if (fnc->rib_cursor.has_src)
+		prefix_copy(&fnc->rib_cursor.src_p, src_p);
+
+	route_unlock_node(rn);
+}
+
+/*
+ * Get the node to resume the RIB walk of `rt` from. When the saved table is
+ * gone, the iterator has moved onto the next table which is walked whole.
+ */
+static struct route_node *fpm_rib_cursor_node(struct fpm_nl_ctx *fnc,
+					      struct route_table *rt)
+{
+	const struct rib_table_info *info = rib_table_info(rt);
+
+	if (!fnc->rib_cursor.active)
+		return route_top(rt);
+
+	fnc->rib_cursor.active = false;
+	if (zvrf_id(info->zvrf) != fnc->rib_cursor.vrf_id
+	    || info->afi != fnc->rib_cursor.afi
+	    || info->safi != fnc->rib_cursor.safi
+	    || info->table_id != fnc->rib_cursor.table_id)
+		return route_top(rt);
+
+	/*
+	 * Returns the node locked, creating it if the route was removed in
+	 * the meantime; such a node is dropped once the walk moves past it.
+	 */
+	return srcdest_rnode_get(rt, &fnc->rib_cursor.p,
+				 fnc->rib_cursor.has_src
+					 ? &fnc->rib_cursor.src_p
+					 : NULL);
 }
 
 /**
@@ -2895,14 +3338,20 @@ static void fpm_rib_send(struct event *t)
 	struct route_node *rn;
 	struct route_table *rt;
 	struct zebra_dplane_ctx *ctx;
-	rib_tables_iter_t rt_iter;
+	rib_tables_iter_t rt_iter, rt_iter_prev;
 
 	/* Allocate temporary context for all transactions. */
 	ctx = dplane_ctx_alloc();
 
-	rt_iter.state = RIB_TABLES_ITER_S_INIT;
-	while ((rt = rib_tables_iter_next(&rt_iter))) {
-		for (rn = route_top(rt); rn; rn = srcdest_route_next(rn)) {
+	if (fnc->rib_cursor.active)
+		rt_iter = fnc->rib_cursor.iter;
+	else
+		rt_iter.state = RIB_TABLES_ITER_S_INIT;
+
+	for (rt_iter_prev = rt_iter; (rt = rib_tables_iter_next(&rt_iter));
+	     rt_iter_prev = rt_iter) {
+		for (rn = fpm_rib_cursor_node(fnc, rt); rn;
+		     rn = srcdest_route_next(rn)) {
 			dest = rib_dest_from_rnode(rn);
 			/* Skip bad route entries. */
 			if (dest == NULL || dest->selected_fib == NULL)
@@ -2920,8 +3369,9 @@ static void fpm_rib_send(struct event *t)
 				/* Free the temporary allocated context. */
 				dplane_ctx_fini(&ctx);
 
-				event_add_timer(zrouter.master, fpm_rib_send,
-						 fnc, 1, &fnc->t_ribwalk);
+				/* Resume from this route once buffer drains. */
+				fpm_rib_cursor_save(fnc, &rt_iter_prev, rt, rn);
+				fpm_walk_wait(fnc, FPM_WALK_RIB);
 				return;
 			}
 
@@ -2978,11 +3428,8 @@ static void fpm_enqueue_rmac_table(struct hash_bucket *bucket, void *arg)
 			zif->brslave_info.br_if, vid,
 			&zrmac->macaddr, vni->vni, zrmac->fwd_info.r_vtep_ip, sticky,
 			0 /*nhg*/, 0 /*update_flags*/);
-	if (fpm_nl_enqueue(fra->fnc, fra->ctx) == -1) {
-		event_add_timer(zrouter.master, fpm_rmac_send,
-				 fra->fnc, 1, &fra->fnc->t_rmacwalk);
+	if (fpm_nl_enqueue(fra->fnc, fra->ctx) == -1)
 		fra->complete = false;
-	}
 }
 
 static void fpm_enqueue_l3vni_table(struct hash_bucket *bucket, void *arg)
@@ -3004,9 +3451,11 @@ static void fpm_rmac_send(struct event *t)
 	hash_iterate(zrouter.l3vni_table, fpm_enqueue_l3vni_table, &fra);
 	dplane_ctx_fini(&fra.ctx);
 
-	/* RMAC walk completed. */
+	/* RMAC walk completed, else resume once buffer drains. */
 	if (fra.complete)
 		WALK_FINISH(fra.fnc, FNE_RMAC_FINISHED);
+	else
+		fpm_walk_wait(fra.fnc, FPM_WALK_RMAC);
 }
 
 /*
@@ -3025,6 +3474,7 @@ static void fpm_nhg_reset(struct event *t)
 	struct fpm_nl_ctx *fnc = EVENT_ARG(t);
 
 	hash_iterate(zrouter.nhgs_id, fpm_nhg_reset_cb, NULL);
+	fnc->nhg_cursor.index = 0;
 
 	/* Schedule next step: send next hop groups. */
 	event_add_event(zrouter.master, fpm_nhg_send, fnc, 0, &fnc->t_nhgwalk);
@@ -3045,7 +3495,11 @@ static void fpm_lsp_reset(struct event *t)
 	struct fpm_nl_ctx *fnc = EVENT_ARG(t);
 	struct zebra_vrf *zvrf = vrf_info_lookup(VRF_DEFAULT);
 
+	/* LSPs are the first replay step. */
+	monotime(&fnc->replay_start);
+
 	hash_iterate(zvrf->lsp_table, fpm_lsp_reset_cb, NULL);
+	fnc->lsp_cursor.index = 0;
 
 	/* Schedule next step: send LSPs */
 	event_add_event(zrouter.master, fpm_lsp_send, fnc, 0, &fnc->t_lspwalk);
@@ -3073,6 +3527,7 @@ static void fpm_rib_reset(struct event *t)
 			UNSET_FLAG(dest->flags, RIB_DEST_UPDATE_FPM);
 		}
 	}
+	fnc->rib_cursor.active = false;
 
 	/* Schedule next step: send RIB routes. */
 	event_add_event(zrouter.master, fpm_rib_send, fnc, 0, &fnc->t_ribwalk);
@@ -3118,46 +3573,321 @@ static void fpm_process_wedged(struct event *t)
 	FPM_RECONNECT(fnc);
 }
 
+/*
+ * Update coalescing.
+ *
+ * Pending contexts are numbered in `ctxpending` order. For every route and
+ * next hop group with pending updates an entry keeps the numbers of the first
+ * and last context of a run: all contexts of the run but the last one are
+ * superseded and not encoded, though they still go back to zebra as usual.
+ *
+ * A next hop group update can't be dropped once a later route or group
+ * depends on it, as it would then reach the FPM server after its user: such a
+ * reference pins the entry and the next update of the group starts a new run.
+ * Routes never need pinning, their dependencies are queued before them.
+ */
+struct fpm_coalesce_entry {
+	bool nhg;
+	uint32_t nhe_id;
+	vrf_id_t vrf_id;
+	uint32_t table_id;
+	struct prefix p;
+	struct prefix src_p;
+
+	uint64_t first;
+	uint64_t last;
+	bool pinned;
+};
+
+static unsigned int fpm_coalesce_hash_key(const void *arg)
+{
+	const struct fpm_coalesce_entry *entry = arg;
+	uint32_t key;
+
+	if (entry->nhg)
+		return jhash_1word(entry->nhe_id, 0);
+
+	key = jhash_3words(entry->vrf_id, entry->table_id,
+			   prefix_hash_key(&entry->p), 0);
+	if (entry->src_p.family)
+		key = jhash_1word(prefix_hash_key(&entry->src_p), key);
+
+	return key;
+}
+
+static bool fpm_coalesce_hash_cmp(const void *arg1, const void *arg2)
+{
+	const struct fpm_coalesce_entry *e1 = arg1, *e2 = arg2;
+
+	if (e1->nhg != e2->nhg)
+		return false;
+	if (e1->nhg)
+		return e1->nhe_id == e2->nhe_id;
+
+	if (e1->vrf_id != e2->vrf_id || e1->table_id != e2->table_id
+	    || !prefix_same(&e1->p, &e2->p))
+		return false;
+	if (e1->src_p.family == 0 || e2->src_p.family == 0)
+		return e1->src_p.family == e2->src_p.family;
+
+	return prefix_same(&e1->src_p, &e2->src_p);
+}
+
+static void *fpm_coalesce_alloc(void *arg)
+{
+	struct fpm_coalesce_entry *entry;
+
+	entry = XMALLOC(MTYPE_TMP, sizeof(*entry));
+	*entry = *(struct fpm_coalesce_entry *)arg;
+	entry->first = UINT64_MAX;
+
+	return entry;
+}
+
+static void fpm_coalesce_free(void *arg)
+{
+	XFREE(MTYPE_TMP, arg);
+}
+
+/* Fill in the coalescing key, returns false if `ctx` can't be coalesced. */
+static bool fpm_coalesce_key(struct zebra_dplane_ctx *ctx,
+			     struct fpm_coalesce_entry *key)
+{
+	const struct prefix *src_p;
+
+	memset(key, 0, sizeof(*key));
+
+	switch (dplane_ctx_get_op(ctx)) {
+	case DPLANE_OP_ROUTE_INSTALL:
+	case DPLANE_OP_ROUTE_UPDATE:
+	case DPLANE_OP_ROUTE_DELETE:
+		key->vrf_id = dplane_ctx_get_vrf(ctx);
+		key->table_id = dplane_ctx_get_table(ctx);
+		prefix_copy(&key->p, dplane_ctx_get_dest(ctx));
+		src_p = (const struct prefix *)dplane_ctx_get_src(ctx);
+		if (src_p && src_p->prefixlen)
+			prefix_copy(&key->src_p, src_p);
+		return true;
+
+	case DPLANE_OP_NH_INSTALL:
+	case DPLANE_OP_NH_UPDATE:
+	case DPLANE_OP_NH_DELETE:
+		key->nhg = true;
+		key->nhe_id = dplane_ctx_get_nhe_id(ctx);
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+/* Keep the pending updates of next hop group `nhe_id` from being dropped. */
+static void fpm_coalesce_pin(struct fpm_nl_ctx *fnc, uint32_t nhe_id)
+{
+	struct fpm_coalesce_entry key = { .nhg = true, .nhe_id = nhe_id };
+	struct fpm_coalesce_entry *entry;
+
+	if (nhe_id == 0)
+		return;
+
+	entry = hash_lookup(fnc->coalesce_hash, &key);
+	if (entry)
+		entry->pinned = true;
+}
+
+/* Account context number `seq` entering `ctxpending`. */
+static void fpm_coalesce_add(struct fpm_nl_ctx *fnc,
+			     struct zebra_dplane_ctx *ctx, uint64_t seq)
+{
+	struct fpm_coalesce_entry key, *entry;
+	const struct nh_grp *nh_grp;
+	int i;
+
+	switch (dplane_ctx_get_op(ctx)) {
+	case DPLANE_OP_ROUTE_INSTALL:
+	case DPLANE_OP_ROUTE_UPDATE:
+	case DPLANE_OP_ROUTE_DELETE:
+		fpm_coalesce_pin(fnc, dplane_ctx_get_nhe_id(ctx));
+		break;
+	case DPLANE_OP_NH_INSTALL:
+	case DPLANE_OP_NH_UPDATE:
+		nh_grp = dplane_ctx_get_nhe_nh_grp(ctx);
+		for (i = 0; i < dplane_ctx_get_nhe_nh_grp_count(ctx); i++)
+			fpm_coalesce_pin(fnc, nh_grp[i].id);
+		break;
+	default:
+		break;
+	}
+
+	if (!fpm_coalesce_key(ctx, &key))
+		return;
+
+	entry = hash_get(fnc->coalesce_hash, &key, fpm_coalesce_alloc);
+	if (entry->first == UINT64_MAX || entry->pinned) {
+		entry->first = seq;
+		entry->pinned = false;
+	}
+	entry->last = seq;
+}
+
+/*
+ * Account context number `seq` leaving `ctxpending`.
+ *
+ * @return false if a later pending context superseded it.
+ */
+static bool fpm_coalesce_take(struct fpm_nl_ctx *fnc,
+			      struct zebra_dplane_ctx *ctx, uint64_t seq)
+{
+	struct fpm_coalesce_entry key, *entry;
+
+	if (hashcount(fnc->coalesce_hash) == 0)
+		return true;
+
+	if (!fpm_coalesce_key(ctx, &key))
+		return true;
+
+	entry = hash_lookup(fnc->coalesce_hash, &key);
+	if (entry == NULL || seq < entry->first)
+		return true;
+
+	if (seq < entry->last) {
+		atomic_fetch_add_explicit(&fnc->counters.coalesced, 1,
+					  memory_order_relaxed);
+		return false;
+	}
+
+	hash_release(fnc->coalesce_hash, entry);
+	fpm_coalesce_free(entry);
+
+	return true;
+}
+
+/*
+ * Lock the context queue, accounting the times the other pthread was
+ * holding it.
+ */
+static void fpm_ctxqueue_lock(struct fpm_nl_ctx *fnc)
+{
+	if (pthread_mutex_trylock(&fnc->ctxqueue_mutex) == 0)
+		return;
+
+	atomic_fetch_add_explicit(&fnc->counters.ctxqueue_contention, 1,
+				  memory_order_relaxed);
+	pthread_mutex_lock(&fnc->ctxqueue_mutex);
+}
+
+static void fpm_qlat_record(struct fpm_nl_ctx *fnc, int64_t usecs)
+{
+	int64_t bound = FPM_QLAT_FIRST_USEC;
+	int i;
+
+	for (i = 0; i < FPM_QLAT_BUCKETS - 1 && usecs >= bound; i++)
+		bound *= 4;
+
+	atomic_fetch_add_explicit(&fnc->counters.ctxqueue_latency[i], 1,
+				  memory_order_relaxed);
+}
+
+/*
+ * Take every context handed over by the data plane pthread at once,
+ * accounting how long the oldest of them waited.
+ */
+static void fpm_ctxqueue_splice(struct fpm_nl_ctx *fnc)
+{
+	struct dplane_ctx_list_head batch_list;
+	struct zebra_dplane_ctx *ctx;
+	int64_t waited = -1;
+
+	dplane_ctx_q_init(&batch_list);
+
+	fpm_ctxqueue_lock(fnc);
+	if (dplane_ctx_queue_count(&fnc->ctxqueue) > 0) {
+		waited = monotime_since(&fnc->ctxqueue_since, NULL);
+		dplane_ctx_list_append(&batch_list, &fnc->ctxqueue);
+	}
+	pthread_mutex_unlock(&fnc->ctxqueue_mutex);
+
+	if (waited >= 0)
+		fpm_qlat_record(fnc, waited);
+
+	if (!fnc->coalesce) {
+		fnc->pending_seq_in += dplane_ctx_queue_count(&batch_list);
+		dplane_ctx_list_append(&fnc->ctxpending, &batch_list);
+		return;
+	}
+
+	while ((ctx = dplane_ctx_dequeue(&batch_list)) != NULL) {
+		fpm_coalesce_add(fnc, ctx, fnc->pending_seq_in++);
+		dplane_ctx_enqueue_tail(&fnc->ctxpending, ctx);
+	}
+}
+
 static void fpm_process_queue(struct event *t)
 {
 	struct fpm_nl_ctx *fnc = EVENT_ARG(t);
 	struct zebra_dplane_ctx *ctx;
+	struct zebra_dplane_ctx *batch[DPLANE_FPM_NL_BATCH];
+	size_t batch_len, batch_max, i;
+	uint64_t batch_seq;
 	bool no_bufs = false;
 	uint64_t processed_contexts = 0;
 
 	while (true) {
-		size_t writeable_amount;
+		batch_len = 0;
+
+		if (dplane_ctx_queue_count(&fnc->ctxpending) == 0)
+			fpm_ctxqueue_splice(fnc);
 
 		frr_with_mutex (&fnc->obuf_mutex) {
-			writeable_amount = STREAM_WRITEABLE(fnc->obuf);
+			/* Take only as many contexts as surely fit. */
+			batch_max = FPM_OBUF_FREE(fnc) / DPLANE_FPM_NL_BUF_SIZE;
+			if (batch_max > DPLANE_FPM_NL_BATCH)
+				batch_max = DPLANE_FPM_NL_BATCH;
+
+			batch_seq = fnc->pending_seq_out;
+			while (batch_len < batch_max) {
+				ctx = dplane_ctx_dequeue(&fnc->ctxpending);
+				if (ctx == NULL)
+					break;
+				batch[batch_len++] = ctx;
+			}
+			fnc->pending_seq_out += batch_len;
+
+			for (i = 0; i < batch_len; i++) {
+				/* Skip superseded updates. */
+				if (!fpm_coalesce_take(fnc, batch[i],
+						       batch_seq + i))
+					continue;
+
+				/*
+				 * Intentionally ignoring the return value
+				 * as that we are ensuring that we can write to
+				 * the output data in the FPM_OBUF_FREE
+				 * check above, so we can ignore the return
+				 */
+				if (fnc->socket != -1)
+					(void)fpm_nl_enqueue_locked(fnc,
+								    batch[i]);
+			}
 		}
 
+		for (i = 0; i < batch_len; i++)
+			dplane_provider_enqueue_out_ctx(fnc->prov, batch[i]);
+
+		/* Account the processed entries. */
+		processed_contexts += batch_len;
+		atomic_fetch_sub_explicit(&fnc->ctxqueue_len,
+					  batch_len, memory_order_relaxed);
+
 		/* No space available yet. */
-		if (writeable_amount < DPLANE_FPM_NL_BUF_SIZE) {
+		if (batch_max == 0) {
 			no_bufs = true;
 			break;
 		}
 
-		/* Dequeue next item or quit processing. */
-		frr_with_mutex (&fnc->ctxqueue_mutex) {
-			ctx = dplane_ctx_dequeue(&fnc->ctxqueue);
-		}
-		if (ctx == NULL)
+		/* Queue is empty: quit processing. */
+		if (batch_len < batch_max)
 			break;
-
-		/*
-		 * Intentionally ignoring the return value
-		 * as that we are ensuring that we can write to
-		 * the output data in the STREAM_WRITEABLE
-		 * check above, so we can ignore the return
-		 */
-		if (fnc->socket != -1)
-			(void)fpm_nl_enqueue(fnc, ctx);
-
-		/* Account the processed entries. */
-		processed_contexts++;
-
-		dplane_provider_enqueue_out_ctx(fnc->prov, ctx);
 	}
 
 	/* Update count of processed contexts */
@@ -3239,6 +3969,11 @@ static void fpm_process_event(struct event *t)
 			zlog_debug("%s: RIB walk finished", __func__);
 		break;
 	case FNE_RMAC_FINISHED:
+		/* RMAC is the last replay step. */
+		atomic_store_explicit(&fnc->counters.replay_time,
+				      monotime_since(&fnc->replay_start, NULL)
+					      / 1000,
+				      memory_order_relaxed);
 		if (IS_ZEBRA_DEBUG_FPM)
 			zlog_debug("%s: RMAC walk finished", __func__);
 		break;
@@ -3260,13 +3995,18 @@ static int fpm_nl_start(struct zebra_dplane_provider *prov)
 	fnc->fthread = frr_pthread_new(NULL, prov_name, prov_name);
 	assert(frr_pthread_run(fnc->fthread, NULL) == 0);
 	fnc->ibuf = stream_new(DPLANE_FPM_NL_BUF_SIZE);
-	fnc->obuf = stream_new(DPLANE_FPM_NL_BUF_SIZE * 128);
+	fnc->obuf = stream_fifo_new();
+	fnc->obuf_spare = stream_fifo_new();
 	pthread_mutex_init(&fnc->obuf_mutex, NULL);
 	fnc->socket = -1;
 	fnc->disabled = true;
 	fnc->prov = prov;
 	dplane_ctx_q_init(&fnc->ctxqueue);
 	pthread_mutex_init(&fnc->ctxqueue_mutex, NULL);
+	dplane_ctx_q_init(&fnc->ctxpending);
+	fnc->coalesce_hash = hash_create(fpm_coalesce_hash_key,
+					 fpm_coalesce_hash_cmp,
+					 "FPM update coalescing");
 
 	/* Set default values. */
 	fnc->use_nhg = true;
@@ -3324,8 +4064,10 @@ static int fpm_nl_finish_late(struct fpm_nl_ctx *fnc)
 	/* Free all allocated resources. */
 	pthread_mutex_destroy(&fnc->obuf_mutex);
 	pthread_mutex_destroy(&fnc->ctxqueue_mutex);
+	hash_clean_and_free(&fnc->coalesce_hash, fpm_coalesce_free);
 	stream_free(fnc->ibuf);
-	stream_free(fnc->obuf);
+	stream_fifo_free(fnc->obuf);
+	stream_fifo_free(fnc->obuf_spare);
 	free(gfnc);
 	gfnc = NULL;
 
@@ -3347,15 +4089,19 @@ static int fpm_nl_process(struct zebra_dplane_provider *prov)
 {
 	struct zebra_dplane_ctx *ctx;
 	struct fpm_nl_ctx *fnc;
+	struct dplane_ctx_list_head batch_list;
 	int counter, limit;
-	uint64_t cur_queue = 0, peak_queue = 0, stored_peak_queue;
+	uint64_t cur_queue = 0, stored_peak_queue;
+	uint32_t batch_len = 0;
 
 	fnc = dplane_provider_get_data(prov);
 	limit = dplane_provider_get_work_limit(prov);
 
-	frr_with_mutex (&fnc->ctxqueue_mutex) {
-		cur_queue = dplane_ctx_queue_count(&fnc->ctxqueue);
-	}
+	/* Initialize the batch list */
+	dplane_ctx_q_init(&batch_list);
+
+	cur_queue = atomic_load_explicit(&fnc->ctxqueue_len,
+					 memory_order_relaxed);
 
 	if (cur_queue >= (uint64_t)limit) {
 		if (IS_ZEBRA_DEBUG_FPM)
@@ -3395,14 +4141,8 @@ static int fpm_nl_process(struct zebra_dplane_provider *prov)
 			    dplane_ctx_get_safi(ctx) == SAFI_MULTICAST)
 				goto skip;
 
-			frr_with_mutex (&fnc->ctxqueue_mutex) {
-				dplane_ctx_enqueue_tail(&fnc->ctxqueue, ctx);
-				cur_queue =
-					dplane_ctx_queue_count(&fnc->ctxqueue);
-			}
-
-			if (peak_queue < cur_queue)
-				peak_queue = cur_queue;
+			dplane_ctx_enqueue_tail(&batch_list, ctx);
+			batch_len++;
 			continue;
 		}
 skip:
@@ -3410,16 +4150,30 @@ skip:
 		dplane_provider_enqueue_out_ctx(prov, ctx);
 	}
 
-	/* Update peak queue length, if we just observed a new peak */
-	stored_peak_queue = atomic_load_explicit(
-		&fnc->counters.ctxqueue_len_peak, memory_order_relaxed);
-	if (stored_peak_queue < peak_queue)
-		atomic_store_explicit(&fnc->counters.ctxqueue_len_peak,
-				      peak_queue, memory_order_relaxed);
-
-	if (cur_queue > 0)
+	/* Hand the whole batch over to the FPM pthread at once. */
+	if (batch_len > 0) {
+		fpm_ctxqueue_lock(fnc);
+		if (dplane_ctx_queue_count(&fnc->ctxqueue) == 0)
+			monotime(&fnc->ctxqueue_since);
+		dplane_ctx_list_append(&fnc->ctxqueue, &batch_list);
+		pthread_mutex_unlock(&fnc->ctxqueue_mutex);
+
+		cur_queue = atomic_fetch_add_explicit(
+				    &fnc->ctxqueue_len, batch_len,
+				    memory_order_relaxed)
+			    + batch_len;
+
+		/* Update peak queue length, if we just observed a new peak */
+		stored_peak_queue = atomic_load_explicit(
+			&fnc->counters.ctxqueue_len_peak, memory_order_relaxed);
+		if (stored_peak_queue < cur_queue)
+			atomic_store_explicit(&fnc->counters.ctxqueue_len_peak,
+					      cur_queue, memory_order_relaxed);
+
+		/* Single wake up of the FPM pthread per batch. */
 		event_add_event(fnc->fthread->master, fpm_process_queue, fnc, 0,
 				&fnc->t_dequeue);
+	}
 
 	/* Ensure dataplane thread is rescheduled if we hit the work limit */
 	if (counter >= limit)
@@ -3453,6 +4207,8 @@ static int fpm_nl_new(struct event_loop *tm)
 	install_element(CONFIG_NODE, &no_fpm_use_nhg_cmd);
 	install_element(CONFIG_NODE, &fpm_use_route_replace_cmd);
 	install_element(CONFIG_NODE, &no_fpm_use_route_replace_cmd);
+	install_element(CONFIG_NODE, &fpm_coalesce_updates_cmd);
+	install_element(CONFIG_NODE, &no_fpm_coalesce_updates_cmd);
 
 	return 0;
 }
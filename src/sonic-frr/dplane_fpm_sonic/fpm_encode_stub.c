@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Link stubs for fpm_encode_test.
+ *
+ * Parts of zebra that dplane_fpm_sonic.c refers to but fpm_encode_test
+ * does not exercise: the provider plumbing, the replay walks and the
+ * encoders that live in rt_netlink.c. Reaching any of them is a harness
+ * bug, so they abort. No zebra header is included, the stubs only satisfy
+ * the linker.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FPM_ENCODE_STUB(name)                                                  \
+	void name(void);                                                       \
+	void name(void)                                                        \
+	{                                                                      \
+		fprintf(stderr, "fpm_encode_test: %s called\n", #name);        \
+		abort();                                                       \
+	}
+
+/* Data plane contexts and provider API (zebra_dplane.c). */
+FPM_ENCODE_STUB(dplane_ctx_alloc)
+FPM_ENCODE_STUB(dplane_ctx_dequeue)
+FPM_ENCODE_STUB(dplane_ctx_enqueue_tail)
+FPM_ENCODE_STUB(dplane_ctx_fini)
+FPM_ENCODE_STUB(dplane_ctx_get_ifname)
+FPM_ENCODE_STUB(dplane_ctx_get_safi)
+FPM_ENCODE_STUB(dplane_ctx_get_src)
+FPM_ENCODE_STUB(dplane_ctx_list_append)
+FPM_ENCODE_STUB(dplane_ctx_lsp_init)
+FPM_ENCODE_STUB(dplane_ctx_nexthop_init)
+FPM_ENCODE_STUB(dplane_ctx_q_init)
+FPM_ENCODE_STUB(dplane_ctx_queue_count)
+FPM_ENCODE_STUB(dplane_ctx_reset)
+FPM_ENCODE_STUB(dplane_ctx_route_init)
+FPM_ENCODE_STUB(dplane_ctx_set_op)
+FPM_ENCODE_STUB(dplane_ctx_set_table)
+FPM_ENCODE_STUB(dplane_ctx_set_vrf)
+FPM_ENCODE_STUB(dplane_mac_init)
+FPM_ENCODE_STUB(dplane_provider_dequeue_in_ctx)
+FPM_ENCODE_STUB(dplane_provider_enqueue_ctx_list_to_zebra)
+FPM_ENCODE_STUB(dplane_provider_enqueue_out_ctx)
+FPM_ENCODE_STUB(dplane_provider_get_data)
+FPM_ENCODE_STUB(dplane_provider_get_work_limit)
+FPM_ENCODE_STUB(dplane_provider_register)
+FPM_ENCODE_STUB(dplane_provider_work_ready)
+
+/* Route, next hop, MAC and LSP encoders (rt_netlink.c). */
+FPM_ENCODE_STUB(netlink_route_multipath_msg_encode)
+FPM_ENCODE_STUB(netlink_nexthop_msg_encode)
+FPM_ENCODE_STUB(netlink_macfdb_update_ctx)
+FPM_ENCODE_STUB(netlink_lsp_msg_encoder)
+FPM_ENCODE_STUB(netlink_route_notify_read_ctx)
+FPM_ENCODE_STUB(nl_msg_type_to_str)
+
+/* Replay walks (zebra_rib.c, zebra_vxlan.c). */
+FPM_ENCODE_STUB(rib_tables_iter_next)
+FPM_ENCODE_STUB(zebra_vxlan_if_vni_find)
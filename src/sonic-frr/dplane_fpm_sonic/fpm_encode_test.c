@@ -0,0 +1,750 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * dplane_fpm_sonic encoder check and benchmark.
+ *
+ * Builds the module itself (dplane_fpm_sonic.c is included below, so its
+ * static encoders are reachable) against stubbed data plane context
+ * accessors, then pushes synthetic contexts through the real send path:
+ * fpm_nl_enqueue() -> fpm_nl_encode() -> the SRv6 VPN route, SRv6 local
+ * SID, PIC context and SID list encoders -> FPM framing in the output
+ * buffer pages -> fpm_write() on a socket pair. The other end of the socket
+ * pair decodes every FPM frame and checks each netlink message.
+ *
+ * Plain route, next hop group, MAC and LSP messages are encoded by zebra's
+ * rt_netlink.c, which is not linked here: those encoders and the rest of
+ * zebra the module calls are link stubs (fpm_encode_stub.c) that abort if
+ * reached. nl_attr_*() below follow zebra's kernel_netlink.c.
+ *
+ * Built against a configured and built FRR tree with fpm_encode_test.mk:
+ *
+ *   make -f fpm_encode_test.mk FRR_SRC=<frr tree> check
+ *   ./fpm_encode_test vpn 1000000 8
+ *
+ * Without arguments every case is checked with a small count; with a case
+ * name, that case is run with `count` contexts of `width` next hops, group
+ * members or SIDs and the encode rate is reported.
+ */
+
+#include "dplane_fpm_sonic.c"
+
+#include <sys/socket.h>
+
+#define TEST_CHECK_COUNT 2000
+#define TEST_MAX_WIDTH 8
+#define TEST_RBUF_SIZE (1024 * 1024)
+#define TEST_PIC_ID_BASE 1000000
+
+#ifndef NLMSG_TAIL
+#define NLMSG_TAIL(nmsg)                                                       \
+	((struct rtattr *)(((uint8_t *)(nmsg)) + NLMSG_ALIGN((nmsg)->nlmsg_len)))
+#endif
+
+/*
+ * Data plane context stand-in: only what the encoders under test read.
+ */
+struct zebra_dplane_ctx {
+	enum dplane_op_e op;
+	enum zebra_dplane_result status;
+	int type;
+	uint32_t table;
+	vrf_id_t vrf_id;
+	struct prefix dest;
+	struct nexthop_group ng;
+
+	uint32_t nhe_id;
+	uint32_t pic_nhe_id;
+	afi_t nhe_afi;
+	int nhe_type;
+	struct nh_grp nh_grp[TEST_MAX_WIDTH];
+	uint16_t nh_grp_count;
+
+	struct zebra_srv6_sidlist sidlist;
+};
+
+enum test_case {
+	TEST_VPN,
+	TEST_VPN_NHG,
+	TEST_VPN_UPDATE,
+	TEST_LOCALSID,
+	TEST_PIC,
+	TEST_PIC_GROUP,
+	TEST_SIDLIST,
+	TEST_CASES,
+};
+
+static const struct {
+	const char *name;
+	const char *desc;
+} test_cases[TEST_CASES] = {
+	[TEST_VPN] = { "vpn", "SRv6 VPN route, ECMP over width SIDs" },
+	[TEST_VPN_NHG] = { "vpn-nhg", "SRv6 VPN route using PIC/NHG ids" },
+	[TEST_VPN_UPDATE] = { "vpn-update", "SRv6 VPN route update (del + add)" },
+	[TEST_LOCALSID] = { "localsid", "SRv6 local SID, End/End.X/End.DX6" },
+	[TEST_PIC] = { "pic", "PIC context, one next hop with width SIDs" },
+	[TEST_PIC_GROUP] = { "pic-group", "PIC context group of width ids" },
+	[TEST_SIDLIST] = { "sidlist", "SID list of width segments" },
+};
+
+struct test_state {
+	enum test_case tcase;
+	uint32_t width;
+	struct fpm_nl_ctx *fnc;
+	int peer;
+
+	/* Received bytes not decoded yet. */
+	uint8_t *rbuf;
+	size_t rlen;
+
+	/* Contexts sent and netlink messages expected from them. */
+	uint32_t sent;
+	uint32_t decoded;
+	uint64_t bytes;
+	uint64_t errors;
+};
+
+/*
+ * zebra globals and accessors used on the encode path.
+ */
+struct zebra_router zrouter;
+unsigned long zebra_debug_kernel;
+unsigned long zebra_debug_fpm;
+unsigned long zebra_debug_nexthop;
+unsigned long zebra_debug_dplane;
+
+static struct nlsock test_nlsock;
+static struct zebra_srv6 test_srv6;
+
+enum dplane_op_e dplane_ctx_get_op(const struct zebra_dplane_ctx *ctx)
+{
+	return ctx->op;
+}
+
+void dplane_ctx_set_status(struct zebra_dplane_ctx *ctx,
+			   enum zebra_dplane_result status)
+{
+	ctx->status = status;
+}
+
+uint32_t dplane_ctx_get_table(const struct zebra_dplane_ctx *ctx)
+{
+	return ctx->table;
+}
+
+vrf_id_t dplane_ctx_get_vrf(const struct zebra_dplane_ctx *ctx)
+{
+	return ctx->vrf_id;
+}
+
+int dplane_ctx_get_type(const struct zebra_dplane_ctx *ctx)
+{
+	return ctx->type;
+}
+
+int dplane_ctx_get_old_type(const struct zebra_dplane_ctx *ctx)
+{
+	return ctx->type;
+}
+
+const struct prefix *dplane_ctx_get_dest(const struct zebra_dplane_ctx *ctx)
+{
+	return &ctx->dest;
+}
+
+const struct nexthop_group *dplane_ctx_get_ng(const struct zebra_dplane_ctx *ctx)
+{
+	return &ctx->ng;
+}
+
+int dplane_ctx_get_ns_sock(const struct zebra_dplane_ctx *ctx)
+{
+	return 0;
+}
+
+uint32_t dplane_ctx_get_nhe_id(const struct zebra_dplane_ctx *ctx)
+{
+	return ctx->nhe_id;
+}
+
+uint32_t dplane_ctx_get_pic_nhe_id(const struct zebra_dplane_ctx *ctx)
+{
+	return ctx->pic_nhe_id;
+}
+
+afi_t dplane_ctx_get_nhe_afi(const struct zebra_dplane_ctx *ctx)
+{
+	return ctx->nhe_afi;
+}
+
+int dplane_ctx_get_nhe_type(const struct zebra_dplane_ctx *ctx)
+{
+	return ctx->nhe_type;
+}
+
+const struct nexthop_group *
+dplane_ctx_get_nhe_ng(const struct zebra_dplane_ctx *ctx)
+{
+	return &ctx->ng;
+}
+
+const struct nh_grp *dplane_ctx_get_nhe_nh_grp(const struct zebra_dplane_ctx *ctx)
+{
+	return ctx->nh_grp;
+}
+
+uint16_t dplane_ctx_get_nhe_nh_grp_count(const struct zebra_dplane_ctx *ctx)
+{
+	return ctx->nh_grp_count;
+}
+
+const struct zebra_srv6_sidlist *
+dplane_ctx_get_sidlist(const struct zebra_dplane_ctx *ctx)
+{
+	return &ctx->sidlist;
+}
+
+int zebra2proto(int proto)
+{
+	return proto == ZEBRA_ROUTE_BGP ? RTPROT_BGP : RTPROT_ZEBRA;
+}
+
+struct nlsock *kernel_netlink_nlsock_lookup(int sock)
+{
+	return &test_nlsock;
+}
+
+bool zebra_nhg_kernel_nexthops_enabled(void)
+{
+	return true;
+}
+
+bool zebra_nhg_proto_nexthops_only(void)
+{
+	return false;
+}
+
+struct zebra_srv6 *zebra_srv6_get_default(void)
+{
+	return &test_srv6;
+}
+
+bool nl_attr_put(struct nlmsghdr *n, unsigned int maxlen, int type,
+		 const void *data, unsigned int alen)
+{
+	struct rtattr *rta;
+	int len = RTA_LENGTH(alen);
+
+	if (NLMSG_ALIGN(n->nlmsg_len) + RTA_ALIGN(len) > maxlen)
+		return false;
+
+	rta = NLMSG_TAIL(n);
+	rta->rta_type = type;
+	rta->rta_len = len;
+	if (data)
+		memcpy(RTA_DATA(rta), data, alen);
+	else
+		assert(alen == 0);
+
+	n->nlmsg_len = NLMSG_ALIGN(n->nlmsg_len) + RTA_ALIGN(len);
+
+	return true;
+}
+
+bool nl_attr_put8(struct nlmsghdr *n, unsigned int maxlen, int type,
+		  uint8_t data)
+{
+	return nl_attr_put(n, maxlen, type, &data, sizeof(data));
+}
+
+bool nl_attr_put16(struct nlmsghdr *n, unsigned int maxlen, int type,
+		   uint16_t data)
+{
+	return nl_attr_put(n, maxlen, type, &data, sizeof(data));
+}
+
+bool nl_attr_put32(struct nlmsghdr *n, unsigned int maxlen, int type,
+		   uint32_t data)
+{
+	return nl_attr_put(n, maxlen, type, &data, sizeof(data));
+}
+
+struct rtattr *nl_attr_nest(struct nlmsghdr *n, unsigned int maxlen, int type)
+{
+	struct rtattr *nest = NLMSG_TAIL(n);
+
+	if (!nl_attr_put(n, maxlen, type, NULL, 0))
+		return NULL;
+
+	nest->rta_type |= NLA_F_NESTED;
+	return nest;
+}
+
+int nl_attr_nest_end(struct nlmsghdr *n, struct rtattr *nest)
+{
+	nest->rta_len = (uint8_t *)NLMSG_TAIL(n) - (uint8_t *)nest;
+	return n->nlmsg_len;
+}
+
+struct rtnexthop *nl_attr_rtnh(struct nlmsghdr *n, unsigned int maxlen)
+{
+	struct rtnexthop *rtnh = (struct rtnexthop *)NLMSG_TAIL(n);
+
+	if (NLMSG_ALIGN(n->nlmsg_len) + RTNH_ALIGN(sizeof(struct rtnexthop))
+	    > maxlen)
+		return NULL;
+
+	memset(rtnh, 0, sizeof(struct rtnexthop));
+	n->nlmsg_len =
+		NLMSG_ALIGN(n->nlmsg_len) + RTA_ALIGN(sizeof(struct rtnexthop));
+
+	return rtnh;
+}
+
+void nl_attr_rtnh_end(struct nlmsghdr *n, struct rtnexthop *rtnh)
+{
+	rtnh->rtnh_len = (uint8_t *)NLMSG_TAIL(n) - (uint8_t *)rtnh;
+}
+
+/*
+ * Synthetic contexts.
+ */
+static uint64_t test_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void test_sid(struct in6_addr *sid, uint32_t node, uint32_t func)
+{
+	memset(sid, 0, sizeof(*sid));
+	sid->s6_addr[0] = 0xfc;
+	sid->s6_addr32[1] = htonl(node);
+	sid->s6_addr32[2] = htonl(func);
+}
+
+static struct nexthop *test_nexthop(uint32_t i, uint32_t nsegs)
+{
+	struct nexthop *nh = calloc(1, sizeof(*nh));
+	struct seg6_seg_stack *segs;
+	uint32_t s;
+
+	nh->type = NEXTHOP_TYPE_IPV6_IFINDEX;
+	nh->vrf_id = VRF_DEFAULT;
+	nh->ifindex = 2 + i;
+	nh->gate.ipv6.s6_addr[0] = 0xfe;
+	nh->gate.ipv6.s6_addr[1] = 0x80;
+	nh->gate.ipv6.s6_addr[15] = 1 + i;
+	SET_FLAG(nh->flags, NEXTHOP_FLAG_ACTIVE);
+
+	/* Like zebra, a next hop without SIDs has one :: in its stack. */
+	nh->nh_srv6 = calloc(1, sizeof(*nh->nh_srv6));
+	segs = calloc(1, sizeof(*segs)
+				 + (nsegs ? nsegs : 1) * sizeof(struct in6_addr));
+	segs->num_segs = nsegs;
+	for (s = 0; s < nsegs; s++)
+		test_sid(&segs->seg[s], 1 + i, 0x100 + s);
+	nh->nh_srv6->seg6_segs = segs;
+
+	return nh;
+}
+
+static void test_ctx_init(struct zebra_dplane_ctx *ctx, enum test_case tcase,
+			  uint32_t width)
+{
+	struct nexthop *nh, **tail = &ctx->ng.nexthop;
+	uint32_t i, n;
+
+	memset(ctx, 0, sizeof(*ctx));
+	ctx->type = ZEBRA_ROUTE_BGP;
+	ctx->table = RT_TABLE_MAIN;
+	ctx->vrf_id = VRF_DEFAULT;
+	ctx->nhe_type = ZEBRA_ROUTE_BGP;
+	ctx->nhe_afi = AFI_IP6;
+
+	switch (tcase) {
+	case TEST_VPN:
+	case TEST_VPN_NHG:
+	case TEST_VPN_UPDATE:
+		ctx->op = tcase == TEST_VPN_UPDATE ? DPLANE_OP_ROUTE_UPDATE
+						   : DPLANE_OP_ROUTE_INSTALL;
+		ctx->dest.family = AF_INET;
+		ctx->dest.prefixlen = 32;
+		n = tcase == TEST_VPN_NHG ? 1 : width;
+		for (i = 0; i < n; i++) {
+			nh = test_nexthop(i, 1);
+			*tail = nh;
+			tail = &nh->next;
+		}
+		break;
+	case TEST_LOCALSID:
+		ctx->op = DPLANE_OP_ROUTE_INSTALL;
+		ctx->dest.family = AF_INET6;
+		ctx->dest.prefixlen = 64;
+		ctx->ng.nexthop = test_nexthop(0, 0);
+		break;
+	case TEST_PIC:
+		ctx->op = DPLANE_OP_PIC_CONTEXT_INSTALL;
+		ctx->ng.nexthop = test_nexthop(0, width);
+		break;
+	case TEST_PIC_GROUP:
+		ctx->op = DPLANE_OP_PIC_CONTEXT_INSTALL;
+		ctx->nh_grp_count = width;
+		for (i = 0; i < width; i++) {
+			ctx->nh_grp[i].id = 1 + i;
+			ctx->nh_grp[i].weight = 1;
+		}
+		break;
+	case TEST_SIDLIST:
+		ctx->op = DPLANE_OP_SID_LIST_INSTALL;
+		ctx->sidlist.segment_count_ = width;
+		for (i = 0; i < width; i++) {
+			ctx->sidlist.segments_[i].index_ = i;
+			SET_IPADDR_V6(&ctx->sidlist.segments_[i].srv6_sid_value_);
+			test_sid(&ctx->sidlist.segments_[i].srv6_sid_value_.ipaddr_v6,
+				 1 + i, 0x100);
+		}
+		break;
+	case TEST_CASES:
+		break;
+	}
+}
+
+static void test_ctx_fini(struct zebra_dplane_ctx *ctx)
+{
+	struct nexthop *nh, *next;
+
+	for (nh = ctx->ng.nexthop; nh; nh = next) {
+		next = nh->next;
+		free(nh->nh_srv6->seg6_segs);
+		free(nh->nh_srv6);
+		free(nh);
+	}
+}
+
+/* Address each context is sent for, checked on the receiving side. */
+static void test_ctx_dest(struct prefix *p, enum test_case tcase, uint32_t i)
+{
+	if (tcase == TEST_LOCALSID) {
+		test_sid(&p->u.prefix6, 0xff00, i);
+		return;
+	}
+
+	p->u.prefix4.s_addr = htonl(0x0a000000 + i);
+}
+
+/* Make context `i` of the run. */
+static void test_ctx_set(struct zebra_dplane_ctx *ctx, enum test_case tcase,
+			 uint32_t i)
+{
+	struct nexthop *nh = ctx->ng.nexthop;
+	uint32_t action;
+
+	ctx->status = ZEBRA_DPLANE_REQUEST_SUCCESS;
+	test_ctx_dest(&ctx->dest, tcase, i);
+	ctx->nhe_id = 1 + i;
+	ctx->pic_nhe_id = TEST_PIC_ID_BASE + i;
+
+	switch (tcase) {
+	case TEST_LOCALSID:
+		action = i % 3;
+		nh->nh_srv6->seg6local_action =
+			action == 0 ? ZEBRA_SEG6_LOCAL_ACTION_END
+			: action == 1 ? ZEBRA_SEG6_LOCAL_ACTION_END_X
+				      : ZEBRA_SEG6_LOCAL_ACTION_END_DX6;
+		nh->nh_srv6->seg6local_ctx.nh6 = nh->gate.ipv6;
+		break;
+	case TEST_SIDLIST:
+		snprintf(ctx->sidlist.sidlist_name_,
+			 sizeof(ctx->sidlist.sidlist_name_), "sl%u", i);
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Receiving side.
+ */
+#define TEST_ERROR(ts, fmt, ...)                                               \
+	do {                                                                   \
+		if ((ts)->errors++ < 10)                                       \
+			fprintf(stderr, "%s: context %u: " fmt "\n",           \
+				test_cases[(ts)->tcase].name, (ts)->decoded,   \
+				##__VA_ARGS__);                                \
+	} while (0)
+
+/* Netlink messages each context turns into. */
+static uint32_t test_msgs_per_ctx(enum test_case tcase)
+{
+	return tcase == TEST_VPN_UPDATE ? 2 : 1;
+}
+
+/* Check one netlink message of context `ts->decoded`. */
+static void test_check_msg(struct test_state *ts, struct nlmsghdr *nlh,
+			   uint32_t msg)
+{
+	struct prefix p = {};
+	struct rtattr *rta;
+	size_t hdrlen, bytelen;
+	int len, expect, key;
+	bool found = false;
+
+	switch (ts->tcase) {
+	case TEST_VPN:
+	case TEST_VPN_UPDATE:
+		expect = (ts->tcase == TEST_VPN_UPDATE && msg == 0)
+				 ? RTM_DELROUTE
+				 : RTM_NEWROUTE;
+		break;
+	case TEST_VPN_NHG:
+		expect = RTM_NEWSRV6VPNROUTE;
+		break;
+	case TEST_LOCALSID:
+		expect = RTM_NEWSRV6LOCALSID;
+		break;
+	case TEST_PIC:
+	case TEST_PIC_GROUP:
+		expect = RTM_NEWPICCONTEXT;
+		break;
+	case TEST_SIDLIST:
+	default:
+		expect = RTM_NEWSIDLIST;
+		break;
+	}
+	if (nlh->nlmsg_type != expect) {
+		TEST_ERROR(ts, "message type %u, expected %d", nlh->nlmsg_type,
+			   expect);
+		return;
+	}
+
+	hdrlen = (expect == RTM_NEWPICCONTEXT) ? sizeof(struct nhmsg)
+					       : sizeof(struct rtmsg);
+	if (nlh->nlmsg_len < NLMSG_LENGTH(hdrlen)) {
+		TEST_ERROR(ts, "message length %u too short", nlh->nlmsg_len);
+		return;
+	}
+
+	/*
+	 * Attributes must tile the message, and the key attribute must be
+	 * this context's: RTA_DST or the local SID value for routes, NHA_ID
+	 * for PIC contexts and RTA_TABLE, the segment count, for SID lists.
+	 */
+	test_ctx_dest(&p, ts->tcase, ts->decoded);
+	bytelen = ts->tcase == TEST_LOCALSID ? IPV6_MAX_BYTELEN
+					     : IPV4_MAX_BYTELEN;
+	key = expect == RTM_NEWSIDLIST ? RTA_TABLE : 1;
+	len = nlh->nlmsg_len - NLMSG_LENGTH(hdrlen);
+	for (rta = (struct rtattr *)((uint8_t *)NLMSG_DATA(nlh)
+				     + NLMSG_ALIGN(hdrlen));
+	     RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+		if ((rta->rta_type & NLA_TYPE_MASK) != key)
+			continue;
+		found = true;
+		if (expect == RTM_NEWPICCONTEXT) {
+			if (RTA_PAYLOAD(rta) != sizeof(uint32_t)
+			    || *(uint32_t *)RTA_DATA(rta) != 1 + ts->decoded)
+				TEST_ERROR(ts, "wrong NHA_ID");
+		} else if (expect == RTM_NEWSIDLIST) {
+			if (RTA_PAYLOAD(rta) != sizeof(uint32_t)
+			    || *(uint32_t *)RTA_DATA(rta) != ts->width)
+				TEST_ERROR(ts, "wrong segment count");
+		} else if (RTA_PAYLOAD(rta) != bytelen
+			   || memcmp(RTA_DATA(rta), &p.u.prefix, bytelen)) {
+			TEST_ERROR(ts, "wrong destination");
+		}
+	}
+	if (len != 0)
+		TEST_ERROR(ts, "%d bytes of attributes left over", len);
+	if (!found)
+		TEST_ERROR(ts, "attribute %d missing", key);
+}
+
+/* Check one FPM frame, holding all messages of one context. */
+static void test_check_frame(struct test_state *ts, uint8_t *frame,
+			     size_t flen)
+{
+	struct nlmsghdr *nlh;
+	int len = flen - FPM_HEADER_SIZE;
+	uint32_t msgs = 0;
+
+	if (frame[0] != 1 || frame[1] != 1)
+		TEST_ERROR(ts, "bad FPM header %u/%u", frame[0], frame[1]);
+
+	for (nlh = (struct nlmsghdr *)(frame + FPM_HEADER_SIZE);
+	     NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len))
+		test_check_msg(ts, nlh, msgs++);
+
+	if (len != 0)
+		TEST_ERROR(ts, "%d bytes left over in frame", len);
+	if (msgs != test_msgs_per_ctx(ts->tcase))
+		TEST_ERROR(ts, "%u messages in frame, expected %u", msgs,
+			   test_msgs_per_ctx(ts->tcase));
+
+	ts->decoded++;
+}
+
+/* Read what fpm_write sent so far and check every complete frame. */
+static void test_read(struct test_state *ts)
+{
+	size_t off, flen;
+	ssize_t n;
+
+	while ((n = read(ts->peer, ts->rbuf + ts->rlen,
+			 TEST_RBUF_SIZE - ts->rlen)) > 0) {
+		ts->rlen += n;
+		ts->bytes += n;
+
+		off = 0;
+		while (ts->rlen - off >= FPM_HEADER_SIZE) {
+			flen = (ts->rbuf[off + 2] << 8) | ts->rbuf[off + 3];
+			if (flen < FPM_HEADER_SIZE + NLMSG_HDRLEN) {
+				TEST_ERROR(ts, "FPM frame length %zu", flen);
+				ts->rlen = 0;
+				return;
+			}
+			if (ts->rlen - off < flen)
+				break;
+			test_check_frame(ts, ts->rbuf + off, flen);
+			off += flen;
+		}
+		memmove(ts->rbuf, ts->rbuf + off, ts->rlen - off);
+		ts->rlen -= off;
+	}
+}
+
+/* Write out the whole output buffer the way the FPM pthread does. */
+static void test_drain(struct test_state *ts)
+{
+	struct event ev = { .arg = ts->fnc };
+
+	do {
+		fpm_write(&ev);
+		test_read(ts);
+	} while (atomic_load_explicit(&ts->fnc->counters.obuf_bytes,
+				      memory_order_relaxed));
+	test_read(ts);
+}
+
+static int test_run(enum test_case tcase, uint32_t count, uint32_t width,
+		    bool report)
+{
+	struct test_state ts = { .tcase = tcase, .width = width };
+	struct zebra_dplane_ctx ctx;
+	struct fpm_nl_ctx fnc = {};
+	uint64_t start, nsecs;
+	int sv[2];
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1) {
+		perror("socketpair");
+		return 1;
+	}
+	set_nonblocking(sv[0]);
+	set_nonblocking(sv[1]);
+
+	fnc.socket = sv[0];
+	fnc.obuf = stream_fifo_new();
+	fnc.obuf_spare = stream_fifo_new();
+	pthread_mutex_init(&fnc.obuf_mutex, NULL);
+	fnc.fthread = frr_pthread_new(NULL, "fpm_encode_test",
+				      "fpm_encode_test");
+	fnc.use_nhg = tcase == TEST_VPN_NHG || tcase == TEST_PIC
+		      || tcase == TEST_PIC_GROUP;
+	fnc.use_route_replace = true;
+
+	ts.fnc = &fnc;
+	ts.peer = sv[1];
+	ts.rbuf = malloc(TEST_RBUF_SIZE);
+
+	test_ctx_init(&ctx, tcase, width);
+
+	start = test_now_ns();
+	for (ts.sent = 0; ts.sent < count; ts.sent++) {
+		test_ctx_set(&ctx, tcase, ts.sent);
+		while (fpm_nl_enqueue(&fnc, &ctx) == -1)
+			test_drain(&ts);
+		if (ctx.status != ZEBRA_DPLANE_REQUEST_SUCCESS) {
+			ts.decoded = ts.sent;
+			TEST_ERROR(&ts, "encoder failed");
+			break;
+		}
+	}
+	test_drain(&ts);
+	nsecs = test_now_ns() - start;
+
+	if (ts.decoded != ts.sent || ts.rlen != 0) {
+		ts.errors++;
+		fprintf(stderr, "%s: %u contexts sent, %u frames received, %zu bytes left\n",
+			test_cases[tcase].name, ts.sent, ts.decoded, ts.rlen);
+	}
+
+	if (report)
+		printf("%-10s %8u ctx in %9.2f ms %8.0f ns/ctx %7.1f bytes/ctx %s\n",
+		       test_cases[tcase].name, ts.sent, nsecs / 1e6,
+		       ts.sent ? (double)nsecs / ts.sent : 0.0,
+		       ts.sent ? (double)ts.bytes / ts.sent : 0.0,
+		       ts.errors ? "FAIL" : "ok");
+
+	test_ctx_fini(&ctx);
+	event_cancel(&fnc.t_write);
+	frr_pthread_destroy(fnc.fthread);
+	pthread_mutex_destroy(&fnc.obuf_mutex);
+	stream_fifo_free(fnc.obuf);
+	stream_fifo_free(fnc.obuf_spare);
+	free(ts.rbuf);
+	close(sv[0]);
+	close(sv[1]);
+
+	return ts.errors ? 1 : 0;
+}
+
+static void usage(const char *prog)
+{
+	int i;
+
+	fprintf(stderr, "usage: %s [case [count [width]]]\n\n", prog);
+	fprintf(stderr, "Without a case every case is checked. Cases:\n");
+	for (i = 0; i < TEST_CASES; i++)
+		fprintf(stderr, "  %-10s %s\n", test_cases[i].name,
+			test_cases[i].desc);
+	fprintf(stderr, "\nwidth is 1 to %d, default 4\n", TEST_MAX_WIDTH);
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t count = TEST_CHECK_COUNT, width = 4;
+	int i, tcase = -1, rc = 0;
+
+	if (argc > 1) {
+		for (i = 0; i < TEST_CASES; i++)
+			if (strcmp(argv[1], test_cases[i].name) == 0)
+				tcase = i;
+		if (tcase < 0) {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if (argc > 2)
+		count = strtoul(argv[2], NULL, 0);
+	if (argc > 3)
+		width = strtoul(argv[3], NULL, 0);
+	if (count == 0 || width == 0 || width > TEST_MAX_WIDTH) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	frr_pthread_init();
+	/* The SRv6 VPN encoders look up the default VRF's loopback. */
+	vrf_get(VRF_DEFAULT, VRF_DEFAULT_NAME);
+
+	if (tcase >= 0) {
+		rc = test_run(tcase, count, width, true);
+	} else {
+		for (i = 0; i < TEST_CASES; i++)
+			rc |= test_run(i, count, width, true);
+		printf("%s\n", rc ? "FAIL" : "PASS");
+	}
+
+	frr_pthread_finish();
+	return rc;
+}
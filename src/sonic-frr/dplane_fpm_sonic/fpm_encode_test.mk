@@ -0,0 +1,28 @@
+#
+# Build and run fpm_encode_test, the dplane_fpm_sonic encoder check, against
+# a configured and built FRR tree:
+#
+#   make -f fpm_encode_test.mk FRR_SRC=<frr tree> [FRR_BUILD=<build dir>] check
+#
+
+HERE := $(dir $(lastword $(MAKEFILE_LIST)))
+FRR_SRC ?= ../frr
+FRR_BUILD ?= $(FRR_SRC)/build
+
+CC ?= cc
+CFLAGS ?= -O2 -g
+CPPFLAGS += -I$(HERE) -I$(FRR_BUILD) -I$(FRR_BUILD)/lib -I$(FRR_SRC) -I$(FRR_SRC)/lib
+FPM_ENCODE_CFLAGS = -std=gnu11 -pthread -Wall -Wno-unused-function
+FPM_ENCODE_LIBS = -L$(FRR_BUILD)/lib/.libs -Wl,-rpath,$(abspath $(FRR_BUILD)/lib/.libs) -lfrr -pthread
+
+fpm_encode_test: $(HERE)fpm_encode_test.c $(HERE)fpm_encode_stub.c $(HERE)dplane_fpm_sonic.c
+	$(CC) $(CPPFLAGS) $(CFLAGS) $(FPM_ENCODE_CFLAGS) -o $@ \
+		$(HERE)fpm_encode_test.c $(HERE)fpm_encode_stub.c $(LDFLAGS) $(FPM_ENCODE_LIBS)
+
+check: fpm_encode_test
+	./fpm_encode_test
+
+clean:
+	rm -f fpm_encode_test
+
+.PHONY: check clean
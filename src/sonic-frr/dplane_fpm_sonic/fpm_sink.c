@@ -0,0 +1,641 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Mock fpmsyncd sink for dplane_fpm_sonic benchmarking.
+ *
+ * Listens like fpmsyncd does, decodes the FPM framing, verifies every
+ * netlink message in it and reports routes/s and bytes/route. Point zebra to
+ * it with `fpm address 127.0.0.1 port <port>` to measure the module encoders
+ * and transmit path without fpmsyncd and redis.
+ *
+ * With `-g` the sink also runs a generator sending synthetic IPv4/IPv6 ECMP
+ * routes, next hop groups and SRv6 SID list routes framed like the module
+ * does, which measures the transport and decode path (including per route
+ * latency) on a plain Linux box. The generator builds its netlink messages
+ * itself: -g does NOT run or measure the dplane_fpm_sonic.c encoders. For
+ * those, use fpm_encode_test or a zebra loading the module.
+ *
+ *   cc -O2 -pthread -o fpm_sink fpm_sink.c
+ *   ./fpm_sink -g 1000000 -e 4 -N
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <linux/netlink.h>
+#include <linux/nexthop.h>
+#include <linux/rtnetlink.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/* FPM framing, see FPM_HEADER_SIZE in dplane_fpm_sonic.c. */
+#define FPM_HEADER_SIZE 4
+#define FPM_PROTO_VERSION 1
+#define FPM_MSG_TYPE_NETLINK 1
+#define FPM_DEFAULT_PORT 2620
+
+/* Custom SRv6 messages and attributes, see dplane_fpm_sonic.c. */
+#define RTM_NEWSIDLIST 1000
+#define RTM_DELSIDLIST 1001
+#define FPM_ROUTE_ENCAP_SRV6 101
+#define FPM_ROUTE_ENCAP_SRV6_ENCAP_SIDLIST 2
+
+#define SINK_BUF_SIZE (1024 * 1024)
+#define GEN_BUF_SIZE (256 * 1024)
+#define GEN_MSG_SIZE 16384
+
+struct sink_stats {
+	uint64_t frames;
+	uint64_t bytes;
+	uint64_t routes;
+	uint64_t route_deletes;
+	uint64_t nhgs;
+	uint64_t sidlists;
+	uint64_t others;
+	uint64_t errors;
+};
+
+struct gen_opts {
+	uint16_t port;
+	uint32_t routes;
+	uint32_t ecmp;
+	bool ipv6;
+	bool nhg;
+	bool srv6;
+};
+
+/* Send time of every generated route, indexed by netlink sequence. */
+static uint64_t *gen_sent_ns;
+static uint32_t gen_routes;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"Usage: %s [-p port] [-c routes] [-q] [-g routes [-e ecmp] [-6] [-N] [-S]]\n"
+		"  -p port    listening port (default %d)\n"
+		"  -c routes  exit after receiving this many routes\n"
+		"  -q         no per second progress report\n"
+		"  -g routes  generate and send this many synthetic routes; these are\n"
+		"             built here, not by dplane_fpm_sonic.c, so its encoders\n"
+		"             are not measured\n"
+		"  -e ecmp    next hops per generated route (default 1)\n"
+		"  -6         generate IPv6 routes\n"
+		"  -N         generate next hop groups and routes using them\n"
+		"  -S         generate SRv6 SID list routes\n",
+		prog, FPM_DEFAULT_PORT);
+}
+
+/*
+ * Verifier.
+ */
+static bool attrs_valid(const struct rtattr *rta, int len)
+{
+	for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len))
+		;
+
+	/* Attributes must cover the message exactly, up to alignment. */
+	return len >= 0 && len < (int)RTA_ALIGNTO;
+}
+
+static bool route_valid(const struct nlmsghdr *nlh)
+{
+	const struct rtmsg *rtm = NLMSG_DATA(nlh);
+	const struct rtattr *rta;
+	int len = RTM_PAYLOAD(nlh);
+	int alen;
+
+	if (nlh->nlmsg_len < NLMSG_LENGTH(sizeof(*rtm)))
+		return false;
+	if (rtm->rtm_family != AF_INET && rtm->rtm_family != AF_INET6)
+		return false;
+	if (!attrs_valid(RTM_RTA(rtm), len))
+		return false;
+
+	/* Destination, when present, must match the family. */
+	alen = rtm->rtm_family == AF_INET ? 4 : 16;
+	if (rtm->rtm_dst_len > alen * 8)
+		return false;
+	for (rta = RTM_RTA(rtm); RTA_OK(rta, len); rta = RTA_NEXT(rta, len))
+		if (rta->rta_type == RTA_DST && (int)RTA_PAYLOAD(rta) != alen)
+			return false;
+
+	return true;
+}
+
+static bool nhg_valid(const struct nlmsghdr *nlh)
+{
+	const struct nhmsg *nhm = NLMSG_DATA(nlh);
+	int len = nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*nhm));
+
+	if (len < 0)
+		return false;
+
+	return attrs_valid((const struct rtattr *)((const char *)nhm
+						  + NLMSG_ALIGN(sizeof(*nhm))),
+			   len);
+}
+
+/*
+ * Verify and account the netlink messages of one FPM frame.
+ *
+ * @return false on malformed frame.
+ */
+static bool frame_process(const uint8_t *data, size_t len,
+			  struct sink_stats *st, uint64_t *lat_ns,
+			  uint32_t *lat_count)
+{
+	const struct nlmsghdr *nlh;
+	int rem = len;
+	bool valid;
+	uint64_t now = 0;
+
+	for (nlh = (const struct nlmsghdr *)data; rem > 0;
+	     nlh = NLMSG_NEXT(nlh, rem)) {
+		if (!NLMSG_OK(nlh, rem))
+			return false;
+
+		switch (nlh->nlmsg_type) {
+		case RTM_NEWROUTE:
+		case RTM_DELROUTE:
+			valid = route_valid(nlh);
+			if (nlh->nlmsg_type == RTM_NEWROUTE)
+				st->routes++;
+			else
+				st->route_deletes++;
+			break;
+		case RTM_NEWNEXTHOP:
+		case RTM_DELNEXTHOP:
+			valid = nhg_valid(nlh);
+			st->nhgs++;
+			break;
+		case RTM_NEWSIDLIST:
+		case RTM_DELSIDLIST:
+			valid = true;
+			st->sidlists++;
+			break;
+		default:
+			valid = true;
+			st->others++;
+			break;
+		}
+		if (!valid)
+			return false;
+
+		/* Generated routes carry their index in the sequence. */
+		if (gen_sent_ns && nlh->nlmsg_type == RTM_NEWROUTE
+		    && nlh->nlmsg_seq < gen_routes) {
+			if (now == 0)
+				now = now_ns();
+			lat_ns[(*lat_count)++] =
+				now - gen_sent_ns[nlh->nlmsg_seq];
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Generator.
+ */
+static void nl_put_attr(struct nlmsghdr *nlh, uint16_t type, const void *data,
+			size_t len)
+{
+	struct rtattr *rta;
+
+	rta = (struct rtattr *)((char *)nlh + NLMSG_ALIGN(nlh->nlmsg_len));
+	rta->rta_type = type;
+	rta->rta_len = RTA_LENGTH(len);
+	if (len)
+		memcpy(RTA_DATA(rta), data, len);
+	nlh->nlmsg_len = NLMSG_ALIGN(nlh->nlmsg_len) + RTA_ALIGN(rta->rta_len);
+}
+
+static struct rtattr *nl_nest_begin(struct nlmsghdr *nlh, uint16_t type)
+{
+	struct rtattr *nest;
+
+	nest = (struct rtattr *)((char *)nlh + NLMSG_ALIGN(nlh->nlmsg_len));
+	nl_put_attr(nlh, type, NULL, 0);
+
+	return nest;
+}
+
+static void nl_nest_end(struct nlmsghdr *nlh, struct rtattr *nest)
+{
+	nest->rta_len = (char *)nlh + nlh->nlmsg_len - (char *)nest;
+}
+
+static void gen_gateway(const struct gen_opts *go, uint32_t idx, void *gw)
+{
+	uint32_t v4 = htonl(0x0a000001 + idx);
+	struct in6_addr v6 = { .s6_addr = { 0xfc, 0x00 } };
+
+	if (go->ipv6) {
+		v6.s6_addr32[3] = htonl(idx + 1);
+		memcpy(gw, &v6, sizeof(v6));
+	} else
+		memcpy(gw, &v4, sizeof(v4));
+}
+
+/*
+ * Next hop `id`: ids 1 to `go->ecmp` are singletons and `go->ecmp + 1` the
+ * group of all of them.
+ */
+static size_t gen_nhg(const struct gen_opts *go, uint8_t *buf, uint32_t id)
+{
+	struct nlmsghdr *nlh = (struct nlmsghdr *)buf;
+	struct nhmsg *nhm = NLMSG_DATA(nlh);
+	struct nexthop_grp grp[256];
+	uint8_t gw[16];
+	uint32_t oif = 2, i;
+
+	memset(buf, 0, NLMSG_LENGTH(sizeof(*nhm)));
+	nlh->nlmsg_len = NLMSG_LENGTH(sizeof(*nhm));
+	nlh->nlmsg_type = RTM_NEWNEXTHOP;
+	nlh->nlmsg_flags = NLM_F_CREATE | NLM_F_REPLACE | NLM_F_REQUEST;
+	nlh->nlmsg_seq = UINT32_MAX;
+	nhm->nh_family = go->ipv6 ? AF_INET6 : AF_INET;
+	nl_put_attr(nlh, NHA_ID, &id, sizeof(id));
+
+	if (id <= go->ecmp) {
+		gen_gateway(go, id - 1, gw);
+		nl_put_attr(nlh, NHA_GATEWAY, gw, go->ipv6 ? 16 : 4);
+		nl_put_attr(nlh, NHA_OIF, &oif, sizeof(oif));
+	} else {
+		nhm->nh_family = AF_UNSPEC;
+		memset(grp, 0, sizeof(grp));
+		for (i = 0; i < go->ecmp; i++)
+			grp[i].id = i + 1;
+		nl_put_attr(nlh, NHA_GROUP, grp, go->ecmp * sizeof(grp[0]));
+	}
+
+	return nlh->nlmsg_len;
+}
+
+static size_t gen_route(const struct gen_opts *go, uint8_t *buf, uint32_t idx)
+{
+	struct nlmsghdr *nlh = (struct nlmsghdr *)buf;
+	struct rtmsg *rtm = NLMSG_DATA(nlh);
+	struct rtattr *nest, *srv6;
+	struct rtnexthop *rtnh;
+	uint8_t dst[16] = { 0x20, 0x01, 0x0d, 0xb8 }, gw[16];
+	uint32_t v4, oif = 2, nh_id = go->ecmp + 1, i;
+	uint16_t encap = FPM_ROUTE_ENCAP_SRV6;
+	size_t alen = go->ipv6 ? 16 : 4;
+
+	memset(buf, 0, NLMSG_LENGTH(sizeof(*rtm)));
+	nlh->nlmsg_len = NLMSG_LENGTH(sizeof(*rtm));
+	nlh->nlmsg_type = RTM_NEWROUTE;
+	nlh->nlmsg_flags = NLM_F_CREATE | NLM_F_REPLACE | NLM_F_REQUEST;
+	nlh->nlmsg_seq = idx;
+	rtm->rtm_family = go->ipv6 ? AF_INET6 : AF_INET;
+	rtm->rtm_table = RT_TABLE_MAIN;
+	rtm->rtm_protocol = RTPROT_BGP;
+	rtm->rtm_scope = RT_SCOPE_UNIVERSE;
+	rtm->rtm_type = RTN_UNICAST;
+
+	/* Distinct /24 or /64 per route. */
+	if (go->ipv6) {
+		rtm->rtm_dst_len = 64;
+		dst[4] = idx >> 24;
+		dst[5] = idx >> 16;
+		dst[6] = idx >> 8;
+		dst[7] = idx;
+	} else {
+		rtm->rtm_dst_len = 24;
+		v4 = htonl(0x64000000 + (idx << 8));
+		memcpy(dst, &v4, sizeof(v4));
+	}
+	nl_put_attr(nlh, RTA_DST, dst, alen);
+
+	if (go->srv6) {
+		/* Encapsulation with a SID list, as SRv6 VPN routes. */
+		nl_put_attr(nlh, RTA_OIF, &oif, sizeof(oif));
+		srv6 = nl_nest_begin(nlh, RTA_ENCAP);
+		memset(dst, 0, sizeof(dst));
+		dst[0] = 0xfd;
+		dst[15] = idx % 64;
+		nl_put_attr(nlh, FPM_ROUTE_ENCAP_SRV6_ENCAP_SIDLIST, dst,
+			    sizeof(dst));
+		nl_nest_end(nlh, srv6);
+		nl_put_attr(nlh, RTA_ENCAP_TYPE, &encap, sizeof(encap));
+	} else if (go->nhg)
+		nl_put_attr(nlh, RTA_NH_ID, &nh_id, sizeof(nh_id));
+	else if (go->ecmp == 1) {
+		gen_gateway(go, 0, gw);
+		nl_put_attr(nlh, RTA_GATEWAY, gw, alen);
+		nl_put_attr(nlh, RTA_OIF, &oif, sizeof(oif));
+	} else {
+		nest = nl_nest_begin(nlh, RTA_MULTIPATH);
+		for (i = 0; i < go->ecmp; i++) {
+			rtnh = (struct rtnexthop *)((char *)nlh
+						    + nlh->nlmsg_len);
+			memset(rtnh, 0, sizeof(*rtnh));
+			rtnh->rtnh_ifindex = oif;
+			nlh->nlmsg_len += RTNH_ALIGN(sizeof(*rtnh));
+
+			gen_gateway(go, i, gw);
+			nl_put_attr(nlh, RTA_GATEWAY, gw, alen);
+			rtnh->rtnh_len = (char *)nlh + nlh->nlmsg_len
+					 - (char *)rtnh;
+		}
+		nl_nest_end(nlh, nest);
+	}
+
+	return nlh->nlmsg_len;
+}
+
+/* Frame `nl_len` bytes of netlink already written after the header. */
+static size_t gen_frame(uint8_t *frame, size_t nl_len)
+{
+	uint16_t len = htons(nl_len + FPM_HEADER_SIZE);
+
+	frame[0] = FPM_PROTO_VERSION;
+	frame[1] = FPM_MSG_TYPE_NETLINK;
+	memcpy(&frame[2], &len, sizeof(len));
+
+	return nl_len + FPM_HEADER_SIZE;
+}
+
+static bool gen_flush(int sock, uint8_t *buf, size_t *len)
+{
+	size_t off = 0;
+	ssize_t rv;
+
+	while (off < *len) {
+		rv = write(sock, buf + off, *len - off);
+		if (rv == -1 && errno == EINTR)
+			continue;
+		if (rv <= 0) {
+			perror("generator: write");
+			return false;
+		}
+		off += rv;
+	}
+	*len = 0;
+
+	return true;
+}
+
+static void *gen_thread(void *arg)
+{
+	const struct gen_opts *go = arg;
+	struct sockaddr_in sin = {};
+	uint8_t *buf;
+	size_t len = 0;
+	uint32_t i;
+	int sock;
+
+	buf = malloc(GEN_BUF_SIZE);
+	sock = socket(AF_INET, SOCK_STREAM, 0);
+	sin.sin_family = AF_INET;
+	sin.sin_port = htons(go->port);
+	sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (buf == NULL || sock == -1
+	    || connect(sock, (struct sockaddr *)&sin, sizeof(sin)) == -1) {
+		perror("generator: connect");
+		exit(1);
+	}
+
+	/* Next hop groups go first, as zebra does. */
+	if (go->nhg)
+		for (i = 1; i <= go->ecmp + 1; i++)
+			len += gen_frame(buf + len,
+					 gen_nhg(go, buf + len + FPM_HEADER_SIZE,
+						 i));
+
+	for (i = 0; i < go->routes; i++) {
+		if (GEN_BUF_SIZE - len < GEN_MSG_SIZE
+		    && !gen_flush(sock, buf, &len))
+			exit(1);
+
+		gen_sent_ns[i] = now_ns();
+		len += gen_frame(buf + len,
+				 gen_route(go, buf + len + FPM_HEADER_SIZE, i));
+	}
+	if (!gen_flush(sock, buf, &len))
+		exit(1);
+
+	close(sock);
+	free(buf);
+
+	return NULL;
+}
+
+/*
+ * Sink.
+ */
+static int cmp_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static void report(const struct sink_stats *st, uint64_t elapsed_ns,
+		   uint64_t *lat_ns, uint32_t lat_count)
+{
+	double secs = elapsed_ns / 1e9;
+	uint64_t routes = st->routes + st->route_deletes;
+
+	printf("frames %" PRIu64 " bytes %" PRIu64 " routes %" PRIu64
+	       " deletes %" PRIu64 " nhgs %" PRIu64 " sidlists %" PRIu64
+	       " others %" PRIu64 " errors %" PRIu64 "\n",
+	       st->frames, st->bytes, st->routes, st->route_deletes, st->nhgs,
+	       st->sidlists, st->others, st->errors);
+	printf("elapsed %.3fs, %.0f routes/s, %.1f bytes/route\n", secs,
+	       secs > 0 ? routes / secs : 0.0,
+	       routes ? (double)st->bytes / routes : 0.0);
+
+	if (lat_count == 0)
+		return;
+
+	qsort(lat_ns, lat_count, sizeof(*lat_ns), cmp_u64);
+	printf("latency p50 %.1fus p99 %.1fus p999 %.1fus max %.1fus\n",
+	       lat_ns[lat_count / 2] / 1e3,
+	       lat_ns[(uint64_t)lat_count * 99 / 100] / 1e3,
+	       lat_ns[(uint64_t)lat_count * 999 / 1000] / 1e3,
+	       lat_ns[lat_count - 1] / 1e3);
+}
+
+/*
+ * Receive and verify frames until the peer closes the connection or
+ * `expect` routes were received.
+ */
+static int sink_run(int sock, uint64_t expect, bool quiet,
+		    uint64_t *lat_ns, uint32_t *lat_count)
+{
+	struct sink_stats st = {}, last = {};
+	uint8_t *buf = malloc(SINK_BUF_SIZE);
+	uint64_t start = 0, tick = 0, now;
+	size_t len = 0, off;
+	uint16_t flen;
+	ssize_t rv;
+
+	if (buf == NULL)
+		return 1;
+
+	while (expect == 0 || st.routes + st.route_deletes < expect) {
+		rv = read(sock, buf + len, SINK_BUF_SIZE - len);
+		if (rv == -1 && errno == EINTR)
+			continue;
+		if (rv <= 0)
+			break;
+
+		now = now_ns();
+		if (start == 0)
+			start = tick = now;
+		len += rv;
+		st.bytes += rv;
+
+		for (off = 0; len - off >= FPM_HEADER_SIZE; off += flen) {
+			memcpy(&flen, &buf[off + 2], sizeof(flen));
+			flen = ntohs(flen);
+			if (buf[off] != FPM_PROTO_VERSION
+			    || buf[off + 1] != FPM_MSG_TYPE_NETLINK
+			    || flen < FPM_HEADER_SIZE) {
+				fprintf(stderr, "bad FPM header at frame %" PRIu64 "\n",
+					st.frames);
+				st.errors++;
+				goto out;
+			}
+			if (len - off < flen)
+				break;
+
+			st.frames++;
+			if (!frame_process(&buf[off + FPM_HEADER_SIZE],
+					   flen - FPM_HEADER_SIZE, &st, lat_ns,
+					   lat_count)) {
+				fprintf(stderr, "bad netlink message in frame %" PRIu64 "\n",
+					st.frames);
+				st.errors++;
+			}
+		}
+		memmove(buf, buf + off, len - off);
+		len -= off;
+
+		if (!quiet && now - tick >= 1000000000ULL) {
+			printf("%" PRIu64 " routes/s\n",
+			       st.routes + st.route_deletes - last.routes
+				       - last.route_deletes);
+			last = st;
+			tick = now;
+		}
+	}
+
+out:
+	report(&st, start ? now_ns() - start : 0, lat_ns, *lat_count);
+	free(buf);
+
+	return st.errors ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+	struct gen_opts go = { .port = FPM_DEFAULT_PORT, .ecmp = 1 };
+	struct sockaddr_in sin = {};
+	pthread_t gen;
+	uint64_t expect = 0, *lat_ns = NULL;
+	uint32_t lat_count = 0;
+	bool quiet = false;
+	int opt, lsock, sock, one = 1, rv;
+
+	while ((opt = getopt(argc, argv, "p:c:qg:e:6NSh")) != -1) {
+		switch (opt) {
+		case 'p':
+			go.port = strtoul(optarg, NULL, 10);
+			break;
+		case 'c':
+			expect = strtoull(optarg, NULL, 10);
+			break;
+		case 'q':
+			quiet = true;
+			break;
+		case 'g':
+			go.routes = strtoul(optarg, NULL, 10);
+			break;
+		case 'e':
+			go.ecmp = strtoul(optarg, NULL, 10);
+			break;
+		case '6':
+			go.ipv6 = true;
+			break;
+		case 'N':
+			go.nhg = true;
+			break;
+		case 'S':
+			go.srv6 = true;
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+	if (go.ecmp < 1 || go.ecmp > 255) {
+		fprintf(stderr, "ecmp must be in 1-255\n");
+		return 1;
+	}
+
+	lsock = socket(AF_INET, SOCK_STREAM, 0);
+	setsockopt(lsock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	sin.sin_family = AF_INET;
+	sin.sin_port = htons(go.port);
+	sin.sin_addr.s_addr = htonl(go.routes ? INADDR_LOOPBACK : INADDR_ANY);
+	if (bind(lsock, (struct sockaddr *)&sin, sizeof(sin)) == -1
+	    || listen(lsock, 1) == -1) {
+		perror("listen");
+		return 1;
+	}
+
+	if (go.routes) {
+		gen_routes = go.routes;
+		gen_sent_ns = calloc(go.routes, sizeof(*gen_sent_ns));
+		lat_ns = calloc(go.routes, sizeof(*lat_ns));
+		if (gen_sent_ns == NULL || lat_ns == NULL) {
+			perror("calloc");
+			return 1;
+		}
+		if (expect == 0)
+			expect = go.routes;
+		pthread_create(&gen, NULL, gen_thread, &go);
+	} else
+		printf("waiting for FPM connection on port %u\n", go.port);
+
+	sock = accept(lsock, NULL, NULL);
+	if (sock == -1) {
+		perror("accept");
+		return 1;
+	}
+	close(lsock);
+
+	rv = sink_run(sock, expect, quiet, lat_ns, &lat_count);
+	if (go.routes) {
+		pthread_join(gen, NULL);
+		if (lat_count != go.routes) {
+			fprintf(stderr, "received %u of %u generated routes\n",
+				lat_count, go.routes);
+			rv = 1;
+		}
+	}
+	close(sock);
+	free(gen_sent_ns);
+	free(lat_ns);
+
+	return rv;
+}
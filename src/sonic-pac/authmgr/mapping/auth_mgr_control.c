@@ -18,6 +18,7 @@
 
 #include "auth_mgr_include.h"
 #include "osapi_sem.h"
+#include "osapi_msgq.h"
 #include "auth_mgr_exports.h"
 #include "auth_mgr_client.h"
 #include "auth_mgr_timer.h"
@@ -183,7 +184,8 @@ RC_t authmgrStartTasks ()
 *********************************************************************/
 void authmgrTask ()
 {
-  authmgrMsg_t msg;
+  static authmgrMsg_t msg[AUTHMGR_MSG_BATCH];
+  uint32 numMsgs, i;
   authmgrBulkMsg_t bulkMsg;
   authmgrVlanMsg_t vlanMsg;
 
@@ -223,11 +225,25 @@ void authmgrTask ()
     {
       (void) authmgrVlanDispatchCmd (&vlanMsg);
     }
-    else if (osapiMessageReceive
-        (authmgrCB->authmgrQueue, (void *) &msg,
-         (uint32) sizeof (authmgrMsg_t),  NO_WAIT) ==  SUCCESS)
+    else if (osapiMessageReceiveBatch
+        (authmgrCB->authmgrQueue, (void *) msg, (uint32) sizeof (authmgrMsg_t),
+         AUTHMGR_MSG_BATCH, &numMsgs,  NO_WAIT) ==  SUCCESS)
     {
-      (void) authmgrDispatchCmd (&msg);
+      /* One semaphore token was given per message, take the ones for the
+       * rest of the batch. A token not given yet only causes an empty pass. */
+      for (i = 1; i < numMsgs; i++)
+      {
+        (void) osapiSemaTake(authmgrCB->authmgrTaskSyncSema,  NO_WAIT);
+      }
+      for (i = 0; i < numMsgs; i++)
+      {
+        if (i > 0)
+        {
+          memset(&authmgrCB->processInfo, 0, sizeof(authmgrClientInfo_t));
+          memset(&authmgrCB->oldInfo, 0, sizeof(authmgrClientInfo_t));
+        }
+        (void) authmgrDispatchCmd (&msg[i]);
+      }
     }
     else if (osapiMessageReceive
         (authmgrCB->authmgrBulkQueue, (void *) &bulkMsg,
@@ -425,6 +441,7 @@ RC_t authmgrIssueCmd (uint32 event, uint32 intIfNum, void *data)
   authmgrMsg_t msg;
   authmgrBulkMsg_t bulkMsg;
   authmgrVlanMsg_t vlanMsg;
+  uint32 priority =  MSG_PRIORITY_NORM;
 
   RC_t rc;
 
@@ -479,10 +496,19 @@ RC_t authmgrIssueCmd (uint32 event, uint32 intIfNum, void *data)
       (void) authmgrFillMsg (data, &msg);
     }
 
+    /* Link changes and authentication results must not wait behind
+       a backlog of other events during port storms */
+    if ((event == authmgrIntfChange) ||
+        (event == authmgrAaaInfoReceived) ||
+        (event == authmgrAuthMethodCallbackEvent))
+    {
+      priority =  MSG_PRIORITY_URG;
+    }
+
     rc =
       osapiMessageSend (authmgrCB->authmgrQueue, &msg,
           (uint32) sizeof (authmgrMsg_t),  NO_WAIT,
-           MSG_PRIORITY_NORM);
+          priority);
   }
 
   rc = osapiSemaGive(authmgrCB->authmgrTaskSyncSema);
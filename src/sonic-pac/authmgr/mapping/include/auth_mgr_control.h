@@ -185,6 +185,7 @@ typedef struct authmgrVlanMsg_s
 
 #define AUTHMGR_MSG_COUNT       FD_AUTHMGR_MSG_COUNT
 #define AUTHMGR_VLAN_MSG_COUNT  (16 * 1024)
+#define AUTHMGR_MSG_BATCH       16   /* authmgrQueue messages served per wakeup */
 #define AUTHMGR_TIMER_TICK      1000 /*in milliseconds*/
 
 typedef RC_t(*authmgrStatusMapFn_t) (uint32 lIntIfNum, authmgrAuthRespParams_t *params);
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2024 Broadcom Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _OSAPI_MSGQ_H_
+#define _OSAPI_MSGQ_H_
+
+#include "datatypes.h"
+
+/**************************************************************************
+* @purpose  Receive up to a number of messages from a message queue.
+*
+* @param    Queue_ptr @b{(input)}   Pointer to message queue.
+* @param    Messages @b{(output)}   Array of maxMsgs buffers of Size bytes.
+* @param    Size @b{(input)}        Size of each buffer in Messages.
+* @param    maxMsgs @b{(input)}     Maximum number of messages to receive.
+* @param    numMsgs @b{(output)}    Number of messages received.
+* @param    Wait @b{(input)}        NO_WAIT or  WAIT_FOREVER.
+*
+* @returns   SUCCESS if at least one message was received,  FAILURE if the
+*           queue is empty and NO_WAIT was given or  ERROR on bad arguments.
+*
+* @comments    Only the first message is waited for.
+*
+* @end
+*************************************************************************/
+RC_t osapiMessageReceiveBatch(void *queue_ptr, void *Messages, uint32 Size,
+                              uint32 maxMsgs, uint32 *numMsgs, uint32 Wait);
+
+/**************************************************************************
+* @purpose  Returns the highest number of messages ever on a message queue.
+*
+* @param    queue_ptr  @b{(input)}  Pointer to message queue.
+* @param    hwm        @b{(output)} Pointer to area to return number
+* @param    reset      @b{(input)}  TRUE to restart tracking from the
+*                                   current number of messages.
+*
+* @returns   SUCCESS
+*
+* @end
+*************************************************************************/
+RC_t osapiMsgQueueHighWaterMarkGet(void *queue_ptr, uint32 *hwm, BOOL reset);
+
+#endif /* _OSAPI_MSGQ_H_ */
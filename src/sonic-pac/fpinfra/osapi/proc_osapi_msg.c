@@ -16,32 +16,242 @@
 
 #include <stdlib.h>
 #include <pthread.h>
-#include <semaphore.h>
 #include <errno.h>
 #include <string.h>
 //#include "proc_osapi.h"
 #include "datatypes.h"
 #include "commdefs.h"
+#include "osapi_msgq.h"
+
+/* Receive order of the priority lanes: urgent messages go first. */
+#define PROC_OSAPI_MSGQ_LANE_URG   0
+#define PROC_OSAPI_MSGQ_LANE_NORM  1
+#define PROC_OSAPI_MSGQ_LANES      2
+
+/*
+ * Each lane is a bounded multi-producer ring (D. Vyukov's sequence ring):
+ * a sender claims a slot with one compare-and-swap on enq_pos, copies the
+ * message in and publishes it by advancing the slot sequence; the receiver
+ * does the same on deq_pos. Neither side takes the mutex unless the lane is
+ * empty or full and the caller asked to wait, the mutex and the condition
+ * variables only serve blocking callers.
+ *
+ * Positions are 64 bit and only grow, the slot is position modulo max_size,
+ * so the ring holds exactly queue_size messages.
+ */
+typedef struct
+{
+  unsigned long long seq;  /* Position the slot is ready for */
+  unsigned char data[];
+} proc_osapi_msgq_slot_t;
+
+typedef struct
+{
+  unsigned long long enq_pos;  /* Next position to send to */
+  unsigned char pad[64 - sizeof(unsigned long long)];  /* Keep senders and receiver apart */
+  unsigned long long deq_pos;  /* Next position to receive from */
+  unsigned char *slots;        /* max_size slots of slot_size bytes */
+} proc_osapi_msgq_lane_t;
 
 typedef struct 
 {
-  unsigned int max_size;  /* Maximum messages in the queue */
+  unsigned int max_size;  /* Maximum messages in each lane */
   unsigned int msg_size;  /* Size of each message in the queue */
+  unsigned int slot_size; /* Bytes per slot, sequence and message */
   unsigned int num_msgs;  /* Current number of messages in the queue */
+  unsigned int high_wm;   /* Highest number of messages ever in the queue */
 
-  unsigned int head; /* First message in the queue (Next to be dequeued) */
-  unsigned int tail; /* Last message in the queue */
+  proc_osapi_msgq_lane_t *lane[PROC_OSAPI_MSGQ_LANES];  /* Urgent lane allocated on first use */
 
-  unsigned char *buf;  /* Buffer for storing the messages */
-  unsigned int  buf_size; /* Number of bytes in the queue buffer */
+  unsigned int tx_waiters; /* Callers blocked as their lane is full */
+  unsigned int rx_waiters; /* Callers blocked as the queue is empty */
+  pthread_cond_t tx_cond;
+  pthread_cond_t rx_cond;
 
-  sem_t tx_sema; /* Block callers when queue is full */
-  sem_t rx_sema; /* Block callers when queue is empty */
-
-  pthread_mutex_t mutex; /* Protect access to the queue structure */
+  pthread_mutex_t mutex; /* Only taken to block and to wake blocked callers */
    
 } proc_osapi_msgq_t; 
 
+#define PROC_OSAPI_MSGQ_SLOT(_msgq, _lane, _pos) \
+  ((proc_osapi_msgq_slot_t *)&(_lane)->slots[((_pos) % (_msgq)->max_size) * (_msgq)->slot_size])
+
+static proc_osapi_msgq_lane_t *proc_osapi_msgq_lane_alloc(proc_osapi_msgq_t *msgq)
+{
+  proc_osapi_msgq_lane_t *lane;
+  unsigned int i;
+
+  lane = calloc(1, sizeof(proc_osapi_msgq_lane_t));
+  if (lane == NULLPTR)
+  {
+    return NULLPTR;
+  }
+  lane->slots = calloc(msgq->max_size, msgq->slot_size);
+  if (lane->slots == NULLPTR)
+  {
+    free(lane);
+    return NULLPTR;
+  }
+  for (i = 0; i < msgq->max_size; i++)
+  {
+    PROC_OSAPI_MSGQ_SLOT(msgq, lane, i)->seq = i;
+  }
+
+  return lane;
+}
+
+static void proc_osapi_msgq_lane_free(proc_osapi_msgq_lane_t *lane)
+{
+  if (lane != NULLPTR)
+  {
+    free(lane->slots);
+    free(lane);
+  }
+}
+
+/* Copy a message into the lane, FAILURE if it is full. */
+static RC_t proc_osapi_msgq_put(proc_osapi_msgq_t *msgq, proc_osapi_msgq_lane_t *lane,
+                                void *Message, uint32 Size)
+{
+  proc_osapi_msgq_slot_t *slot;
+  unsigned long long pos, seq;
+  unsigned int num, hwm;
+
+  pos = __atomic_load_n(&lane->enq_pos, __ATOMIC_RELAXED);
+  for (;;)
+  {
+    slot = PROC_OSAPI_MSGQ_SLOT(msgq, lane, pos);
+    seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq == pos)
+    {
+      if (__atomic_compare_exchange_n(&lane->enq_pos, &pos, pos + 1, 0,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      {
+        break;
+      }
+    }
+    else if (seq < pos)
+    {
+      /* Slot still holds the message from one lap ago */
+      return  FAILURE;
+    }
+    else
+    {
+      pos = __atomic_load_n(&lane->enq_pos, __ATOMIC_RELAXED);
+    }
+  }
+
+  /* Counted before it can be received, so the count never drops below zero */
+  num = __atomic_add_fetch(&msgq->num_msgs, 1, __ATOMIC_RELAXED);
+  memcpy(slot->data, Message, ((Size < msgq->msg_size) ? Size : msgq->msg_size));
+  __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+  hwm = __atomic_load_n(&msgq->high_wm, __ATOMIC_RELAXED);
+  while ((num > hwm) &&
+         !__atomic_compare_exchange_n(&msgq->high_wm, &hwm, num, 0,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+  {
+  }
+
+  return  SUCCESS;
+}
+
+/* Copy the first message out of the lane, FAILURE if it is empty. */
+static RC_t proc_osapi_msgq_lane_get(proc_osapi_msgq_t *msgq, proc_osapi_msgq_lane_t *lane,
+                                     void *Message, uint32 Size)
+{
+  proc_osapi_msgq_slot_t *slot;
+  unsigned long long pos, seq;
+
+  if (lane == NULLPTR)
+  {
+    return  FAILURE;
+  }
+
+  pos = __atomic_load_n(&lane->deq_pos, __ATOMIC_RELAXED);
+  for (;;)
+  {
+    slot = PROC_OSAPI_MSGQ_SLOT(msgq, lane, pos);
+    seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq == pos + 1)
+    {
+      if (__atomic_compare_exchange_n(&lane->deq_pos, &pos, pos + 1, 0,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      {
+        break;
+      }
+    }
+    else if (seq < pos + 1)
+    {
+      /* Nothing sent to this position yet */
+      return  FAILURE;
+    }
+    else
+    {
+      pos = __atomic_load_n(&lane->deq_pos, __ATOMIC_RELAXED);
+    }
+  }
+
+  memcpy(Message, slot->data, ((Size < msgq->msg_size) ? Size : msgq->msg_size));
+  __atomic_store_n(&slot->seq, pos + msgq->max_size, __ATOMIC_RELEASE);
+  __atomic_sub_fetch(&msgq->num_msgs, 1, __ATOMIC_RELAXED);
+
+  return  SUCCESS;
+}
+
+/* Receive the first message in receive order, FAILURE if the queue is empty. */
+static RC_t proc_osapi_msgq_get(proc_osapi_msgq_t *msgq, void *Message, uint32 Size)
+{
+  unsigned int i;
+
+  for (i = 0; i < PROC_OSAPI_MSGQ_LANES; i++)
+  {
+    if (proc_osapi_msgq_lane_get(msgq, __atomic_load_n(&msgq->lane[i], __ATOMIC_ACQUIRE),
+                                 Message, Size) ==  SUCCESS)
+    {
+      return  SUCCESS;
+    }
+  }
+
+  return  FAILURE;
+}
+
+/*
+ * Wake callers blocked on the other side. The waiter count is raised before
+ * the waiter checks the queue again under the mutex, and read here after the
+ * ring was updated, so one side always sees the other.
+ */
+static void proc_osapi_msgq_wake(proc_osapi_msgq_t *msgq, unsigned int *waiters,
+                                 pthread_cond_t *cond)
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(waiters, __ATOMIC_RELAXED) != 0)
+  {
+    pthread_mutex_lock(&msgq->mutex);
+    pthread_cond_broadcast(cond);
+    pthread_mutex_unlock(&msgq->mutex);
+  }
+}
+
+/* Receive a message, waiting for one if asked to. */
+static RC_t proc_osapi_msgq_rx(proc_osapi_msgq_t *msgq, void *Message, uint32 Size,
+                               uint32 Wait)
+{
+  RC_t rc = proc_osapi_msgq_get(msgq, Message, Size);
+
+  if ((rc !=  SUCCESS) && (Wait ==  WAIT_FOREVER))
+  {
+    pthread_mutex_lock(&msgq->mutex);
+    __atomic_add_fetch(&msgq->rx_waiters, 1, __ATOMIC_SEQ_CST);
+    while ((rc = proc_osapi_msgq_get(msgq, Message, Size)) !=  SUCCESS)
+    {
+      pthread_cond_wait(&msgq->rx_cond, &msgq->mutex);
+    }
+    __atomic_sub_fetch(&msgq->rx_waiters, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&msgq->mutex);
+  }
+
+  return rc;
+}
 
 /**************************************************************************
 * @purpose  Create a message queue.
@@ -57,6 +267,8 @@ typedef struct
 * @comments    routine returns a void ptr used to identify the created message queue
 * @comments    in all subsequent calls to routines in this library. The queue will be
 * @comments    created as a FIFO queue.
+* @comments    Urgent messages get a separate lane of queue_size messages, which
+* @comments    is only allocated when the first urgent message is sent.
 *
 * @end
 *************************************************************************/
@@ -66,23 +278,33 @@ void * osapiMsgQueueCreate( char8 *queue_name, uint32 queue_size,
   proc_osapi_msgq_t *msgq;
   pthread_mutexattr_t attr;
 
-  msgq = malloc(sizeof(proc_osapi_msgq_t));
+  if (queue_size == 0)
+  {
+    return NULLPTR;
+  }
+
+  msgq = calloc(1, sizeof(proc_osapi_msgq_t));
+  if (msgq == NULLPTR)
+  {
+    return NULLPTR;
+  }
 
   msgq->max_size = queue_size;
   msgq->msg_size = message_size;
-  msgq->num_msgs = 0;
-  msgq->head = 0;
-  msgq->tail = 0;
+  msgq->slot_size = (sizeof(proc_osapi_msgq_slot_t) + message_size + 7) & ~7u;
 
-  msgq->buf_size = queue_size * message_size;
-  msgq->buf = malloc (msgq->buf_size);
-  memset (msgq->buf, 0, msgq->buf_size);
+  msgq->lane[PROC_OSAPI_MSGQ_LANE_NORM] = proc_osapi_msgq_lane_alloc(msgq);
+  if (msgq->lane[PROC_OSAPI_MSGQ_LANE_NORM] == NULLPTR)
+  {
+    free(msgq);
+    return NULLPTR;
+  }
 
   pthread_mutexattr_init(&attr);
   pthread_mutex_init(&msgq->mutex, &attr);
 
-  sem_init (&msgq->tx_sema, 0, queue_size);
-  sem_init (&msgq->rx_sema, 0, 0);
+  pthread_cond_init(&msgq->tx_cond, NULL);
+  pthread_cond_init(&msgq->rx_cond, NULL);
 
   return msgq;
 }
@@ -95,7 +317,8 @@ void * osapiMsgQueueCreate( char8 *queue_name, uint32 queue_size,
 *
 * @returns   SUCCESS or  ERROR.
 *
-* @comments    none.
+* @comments    Messages of all priorities are counted, from the time they are
+* @comments    sent until they are received.
 *
 * @end
 *************************************************************************/
@@ -103,9 +326,40 @@ RC_t osapiMsgQueueGetNumMsgs(void *queue_ptr,  int32 *bptr)
 {
   proc_osapi_msgq_t *msgq = queue_ptr;
 
-  pthread_mutex_lock(&msgq->mutex);
-  *bptr = msgq->num_msgs;
-  pthread_mutex_unlock(&msgq->mutex);
+  *bptr = (int32)__atomic_load_n(&msgq->num_msgs, __ATOMIC_RELAXED);
+
+  return  SUCCESS;
+}
+
+/**************************************************************************
+* @purpose  Returns the highest number of messages ever on the specified
+*           message queue.
+*
+* @param    queue_ptr  @b{(input)}  Pointer to message queue.
+* @param    hwm        @b{(output)} Pointer to area to return number
+* @param    reset      @b{(input)}   TRUE to restart tracking from the
+*                                    current number of messages.
+*
+* @returns   SUCCESS
+*
+* @comments    Messages of all priorities are counted.
+*
+* @end
+*************************************************************************/
+RC_t osapiMsgQueueHighWaterMarkGet(void *queue_ptr, uint32 *hwm, BOOL reset)
+{
+  proc_osapi_msgq_t *msgq = queue_ptr;
+
+  if (reset ==  TRUE)
+  {
+    *hwm = __atomic_exchange_n(&msgq->high_wm,
+                               __atomic_load_n(&msgq->num_msgs, __ATOMIC_RELAXED),
+                               __ATOMIC_RELAXED);
+  }
+  else
+  {
+    *hwm = __atomic_load_n(&msgq->high_wm, __ATOMIC_RELAXED);
+  }
 
   return  SUCCESS;
 }
@@ -123,7 +377,7 @@ RC_t osapiMsgQueueGetNumMsgs(void *queue_ptr,  int32 *bptr)
 *
 * @returns   SUCCESS or  FAILURE.
 *
-* @comments    none.
+* @comments    Messages are counted in receive order, urgent ones first.
 *
 * @end
 *************************************************************************/
@@ -131,22 +385,47 @@ RC_t osapiMessagePeek(void *queue_ptr, void *Message,
                             uint32 Size, uint32 msgOffset)
 {
   proc_osapi_msgq_t *msgq = queue_ptr;
-  unsigned int msg_to_read;
+  proc_osapi_msgq_lane_t *lane;
+  proc_osapi_msgq_slot_t *slot;
+  unsigned long long pos, seq, count;
+  unsigned int i;
 
-  pthread_mutex_lock(&msgq->mutex);
-  if ((msgq->num_msgs == 0) || ((msgq->num_msgs - 1) < msgOffset))
+  for (i = 0; i < PROC_OSAPI_MSGQ_LANES; i++)
   {
-    pthread_mutex_unlock(&msgq->mutex);
-    return  FAILURE;
-  }
+    lane = __atomic_load_n(&msgq->lane[i], __ATOMIC_ACQUIRE);
+    if (lane == NULLPTR)
+    {
+      continue;
+    }
 
-  msg_to_read = (msgq->head + (msgOffset * msgq->msg_size)) % msgq->buf_size;
-  memcpy(Message, &msgq->buf[msg_to_read],
-         ((Size < msgq->msg_size) ? Size : msgq->msg_size));
+    pos = __atomic_load_n(&lane->deq_pos, __ATOMIC_ACQUIRE);
+    count = __atomic_load_n(&lane->enq_pos, __ATOMIC_ACQUIRE) - pos;
+    if (msgOffset >= count)
+    {
+      /* Skip this lane's messages and look in the next one */
+      msgOffset -= (uint32)count;
+      continue;
+    }
+
+    pos += msgOffset;
+    slot = PROC_OSAPI_MSGQ_SLOT(msgq, lane, pos);
+    seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq != pos + 1)
+    {
+      /* Still being copied in, or already received */
+      return  FAILURE;
+    }
 
+    memcpy(Message, slot->data, ((Size < msgq->msg_size) ? Size : msgq->msg_size));
+    /* The message was received and the slot reused while copying */
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq)
+    {
+      return  FAILURE;
+    }
+    return  SUCCESS;
+  }
 
-  pthread_mutex_unlock(&msgq->mutex);
-  return  SUCCESS;
+  return  FAILURE;
 }
 
 /**************************************************************************
@@ -165,6 +444,7 @@ RC_t osapiMessagePeek(void *queue_ptr, void *Message,
 * @comments    copied into the specified buffer, Message, which is Size bytes in length.
 * @comments    If the message is longer than Size, the remainder of the message is discarded (no
 * @comments    error indication is returned).
+* @comments    Urgent messages are received before normal ones.
 *
 * @end
 *************************************************************************/
@@ -172,43 +452,70 @@ RC_t osapiMessageReceive(void *queue_ptr, void *Message,
                             uint32 Size, uint32 Wait)
 {
   proc_osapi_msgq_t *msgq = queue_ptr;
-  int err;
 
   if((Wait !=  WAIT_FOREVER) && (Wait !=  NO_WAIT))
   {
     return  ERROR;
   }
 
-  if(Wait ==  WAIT_FOREVER)
+  if (proc_osapi_msgq_rx(msgq, Message, Size, Wait) !=  SUCCESS)
   {
-    do {
-        err = sem_wait(&msgq->rx_sema);
-    } while (err != 0 && errno == EINTR);
-  } else
+    return  FAILURE;
+  }
+  proc_osapi_msgq_wake(msgq, &msgq->tx_waiters, &msgq->tx_cond);
+
+  return  SUCCESS;
+}
+
+
+/**************************************************************************
+* @purpose  Receive up to a number of messages from a message queue.
+*
+* @param    Queue_ptr @b{(input)}   Pointer to message queue.
+* @param    Messages @b{(output)}   Array of maxMsgs buffers of Size bytes
+*                                   to put the messages in.
+* @param    Size @b{(input)}        Size of each buffer in Messages.
+* @param    maxMsgs @b{(input)}     Maximum number of messages to receive.
+* @param    numMsgs @b{(output)}    Number of messages received.
+* @param    Wait @b{(input)}        a flag to wait or not.  NO_WAIT or  WAIT_FOREVER.
+*
+* @returns   SUCCESS if at least one message was received,  FAILURE if the
+*           queue is empty and NO_WAIT was given or  ERROR on bad arguments.
+*
+* @comments    Waits for the first message only, the rest are taken while
+* @comments    available. Messages are truncated as in osapiMessageReceive.
+*
+* @end
+*************************************************************************/
+RC_t osapiMessageReceiveBatch(void *queue_ptr, void *Messages, uint32 Size,
+                              uint32 maxMsgs, uint32 *numMsgs, uint32 Wait)
+{
+  proc_osapi_msgq_t *msgq = queue_ptr;
+  unsigned char *msg = Messages;
+  uint32 count = 0;
+
+  *numMsgs = 0;
+  if (((Wait !=  WAIT_FOREVER) && (Wait !=  NO_WAIT)) || (maxMsgs == 0))
   {
-    do
-    {
-      err = sem_trywait(&msgq->rx_sema);
-    } while ((err < 0) && (errno == EINTR));
+    return  ERROR;
   }
-  if(err)
+
+  if (proc_osapi_msgq_rx(msgq, msg, Size, Wait) !=  SUCCESS)
   {
     return  FAILURE;
   }
+  do
+  {
+    msg += Size;
+    count++;
+  } while ((count < maxMsgs) && (proc_osapi_msgq_get(msgq, msg, Size) ==  SUCCESS));
+  proc_osapi_msgq_wake(msgq, &msgq->tx_waiters, &msgq->tx_cond);
 
-  pthread_mutex_lock(&msgq->mutex);
-  memcpy(Message, &msgq->buf[msgq->head],
-         ((Size < msgq->msg_size) ? Size : msgq->msg_size));
-  msgq->head += msgq->msg_size;
-  msgq->head %= msgq->buf_size;
-  msgq->num_msgs--;
-  pthread_mutex_unlock(&msgq->mutex);
-
-  sem_post (&msgq->tx_sema);
-
+  *numMsgs = count;
   return  SUCCESS;
 }
 
+
 /**************************************************************************
 *
 * @purpose  Send a message to a message queue.
@@ -219,7 +526,7 @@ RC_t osapiMessageReceive(void *queue_ptr, void *Message,
 * @param    Wait         @b{(input)}  a flag to wait or not.  NO_WAIT or  WAIT_FOREVER.
 *                                     This function does not accept a timeout value, so
 *                                     only "No Wait" or "Wait Forever" options are allowed.
-* @param    Priority     @b{(input)}  Ignored.
+* @param    Priority     @b{(input)}  MSG_PRIORITY_URG or  MSG_PRIORITY_NORM.
 *
 * @returns   SUCCESS
 * @returns   ERROR
@@ -229,6 +536,9 @@ RC_t osapiMessageReceive(void *queue_ptr, void *Message,
 *           receive messages on the queue, the message will immediately
 *           be delivered to the first waiting task. If no task is waiting to receive
 *           messages, the message is saved in the message queue.
+*           Urgent messages are received before all normal ones, in the order
+*           they were sent. Each priority has its own queue_size messages, so
+*           urgent messages can still be sent when normal ones fill the queue.
 *
 * @end
 *
@@ -237,43 +547,57 @@ RC_t osapiMessageSend(void *queue_ptr, void *Message, uint32 Size,
                          uint32 Wait, uint32 Priority)
 {
   proc_osapi_msgq_t *msgq = queue_ptr;
-  int err;
+  proc_osapi_msgq_lane_t *lane, *none = NULLPTR;
+  unsigned int idx;
+  RC_t rc;
 
   if((Wait !=  WAIT_FOREVER) && (Wait !=  NO_WAIT))
   {
     return  ERROR;
   }
 
-  if(Wait ==  WAIT_FOREVER)
+  idx = (Priority ==  MSG_PRIORITY_URG) ? PROC_OSAPI_MSGQ_LANE_URG : PROC_OSAPI_MSGQ_LANE_NORM;
+  lane = __atomic_load_n(&msgq->lane[idx], __ATOMIC_ACQUIRE);
+  if (lane == NULLPTR)
   {
-    do {
-        err = sem_wait(&msgq->tx_sema);
-    } while (err != 0 && errno == EINTR);
-  } else
+    lane = proc_osapi_msgq_lane_alloc(msgq);
+    if (lane == NULLPTR)
+    {
+      return  FAILURE;
+    }
+    /* Another sender may have allocated it first */
+    if (!__atomic_compare_exchange_n(&msgq->lane[idx], &none, lane, 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+      proc_osapi_msgq_lane_free(lane);
+      lane = none;
+    }
+  }
+
+  rc = proc_osapi_msgq_put(msgq, lane, Message, Size);
+  if ((rc !=  SUCCESS) && (Wait ==  WAIT_FOREVER))
   {
-    do
+    pthread_mutex_lock(&msgq->mutex);
+    __atomic_add_fetch(&msgq->tx_waiters, 1, __ATOMIC_SEQ_CST);
+    while ((rc = proc_osapi_msgq_put(msgq, lane, Message, Size)) !=  SUCCESS)
     {
-      err = sem_trywait(&msgq->tx_sema);
-    } while ((err < 0) && (errno == EINTR));
+      pthread_cond_wait(&msgq->tx_cond, &msgq->mutex);
+    }
+    __atomic_sub_fetch(&msgq->tx_waiters, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&msgq->mutex);
   }
-  if(err)
+  if (rc !=  SUCCESS)
   {
     return  FAILURE;
   }
 
-  pthread_mutex_lock(&msgq->mutex);
-  memcpy(&msgq->buf[msgq->tail], Message,
-         ((Size < msgq->msg_size) ? Size : msgq->msg_size));
-  msgq->tail += msgq->msg_size;
-  msgq->tail %= msgq->buf_size;
-  msgq->num_msgs++;
-  pthread_mutex_unlock(&msgq->mutex);
-
-  sem_post (&msgq->rx_sema);
+  /* Only wake the receiver up when it is blocked. */
+  proc_osapi_msgq_wake(msgq, &msgq->rx_waiters, &msgq->rx_cond);
 
   return  SUCCESS;
 }
 
+
 /**************************************************************************
 * @purpose  Delete a message queue.
 *
@@ -288,18 +612,23 @@ RC_t osapiMessageSend(void *queue_ptr, void *Message, uint32 Size,
 RC_t osapiMsgQueueDelete(void *queue_ptr)
 {
   proc_osapi_msgq_t *msgq = queue_ptr;
+  unsigned int i;
 
   pthread_mutex_destroy(&msgq->mutex);
 
-  sem_destroy (&msgq->tx_sema);
-  sem_destroy (&msgq->rx_sema);
+  pthread_cond_destroy (&msgq->tx_cond);
+  pthread_cond_destroy (&msgq->rx_cond);
 
-  free (msgq->buf);
+  for (i = 0; i < PROC_OSAPI_MSGQ_LANES; i++)
+  {
+    proc_osapi_msgq_lane_free(msgq->lane[i]);
+  }
   free (msgq);
 
   return  SUCCESS;
 }
 
+
 /**************************************************************************
 * @purpose  Returns the maximum number of elements that may be in a message queue.
 *
@@ -309,7 +638,7 @@ RC_t osapiMsgQueueDelete(void *queue_ptr)
 * @returns   SUCCESS
 * @returns   ERROR
 *
-* @comments None.
+* @comments The limit applies to each message priority.
 *
 * @end
 *************************************************************************/
@@ -317,10 +646,9 @@ RC_t osapiMsgQueueLimitGet(void *queue_ptr, uint32 *qLimit)
 {
   proc_osapi_msgq_t *msgq = queue_ptr;
 
-  pthread_mutex_lock(&msgq->mutex);
   *qLimit = msgq->max_size;
-  pthread_mutex_unlock(&msgq->mutex);
 
   return  SUCCESS;
 }
 
+
@@ -29,17 +29,28 @@
 **                        Structure Definitions                               **
 *******************************************************************************/
 
+/* Number of slots in the timer wheel; must be a power of 2. A timer lands in
+   slot (expiry tick % APP_TMR_WHEEL_SIZE), timers further out than one
+   revolution simply stay in their slot until the wheel comes round to them */
+#define APP_TMR_WHEEL_SIZE   4096
+#define APP_TMR_WHEEL_MASK   (APP_TMR_WHEEL_SIZE - 1)
+
+/* Serial number comparison of wheel ticks, so that the 32-bit tick counter
+   may wrap */
+#define APP_TMR_TICK_DIFF(a, b)   ((int32)((uint32)(a) - (uint32)(b)))
+
 typedef struct appTmrCtrlBlk
 {
   COMPONENT_IDS_t       compId;
   uint32                bufferPoolId;
   APP_TMR_GRAN_TYPE_t   type;
   void                     *semId;
-  sll_t                 tmrList;
-  sll_t                 wrapTmrList; /* SLL during expiry timer wrap */
+  timerNode_t         **wheel;      /* APP_TMR_WHEEL_SIZE unsorted slot lists */
+  uint32                numTimers;  /* Timers currently on the wheel */
 
-  /* To store previous timetick when 
-	 tick has come to process timers*/
+  /* Wheel tick being processed and the system time (in msec) at which
+     that tick started. Timer expiry is kept in wheel ticks, not msec */
+  uint32                curTick;
   uint32                prevTime; 
   osapiTimerDescr_t        *pSysTimer;
   app_tmr_dispatcher_fn dispatchFn;
@@ -54,55 +65,160 @@ typedef struct appTmrCtrlBlk
 
 /*********************************************************************
 *
-* @purpose  To compare the two keys given based on the timer expiry value.
+* @purpose  Compute the wheel tick at which a timer started now expires
 *
-* @param    data1  @b{(input)}The pointer to the first key.
-* @param    data2  @b{(input)}The pointer to the second key.
-* @param    keyLen @b{(input)}The length of the key to be compared.
+* @param    pCtrlBlk @b{(input)}The timer instance control block.
+* @param    currTime @b{(input)}Current system uptime in msec.
+* @param    timeOut  @b{(input)}Timeout, in Application Timer base ticks.
 *
-* @returns  Less than 0, if node1 < node 2.
-* @returns  Zero, if node1 == node2
-* @returns  More than 0, if node1 > node2.
+* @returns  Expiry wheel tick.
 *
-* @notes    Key Length is ignored for this comparison.
+* @notes    A partially elapsed tick is rounded up so that a timer never
+*           pops before its timeout. The result is never behind curTick,
+*           so the timer cannot land in a slot the wheel has already passed.
 *
 * @end
 *
 *********************************************************************/
 static
- int32 appTimerCompare(void *data1,
-                         void *data2,
-                         uint32 keyLen)
+uint32 appTimerExpiryTickGet(appTmrCtrlBlk_t *pCtrlBlk,
+                             uint32           currTime,
+                             uint32           timeOut)
 {
-  timerNode_t *pEntry1, *pEntry2;
+  uint32 elapsed = currTime - pCtrlBlk->prevTime;
+  uint32 ticks;
 
-  if(data1 ==  NULLPTR || data2 ==  NULLPTR)
-    return 1;
+  /* currTime may have been sampled before the caller took the semaphore,
+     while appTimerProcess() moved prevTime past it */
+  if ((int32)elapsed < 0)
+    elapsed = 0;
 
-  pEntry1 = (timerNode_t *)data1;
-  pEntry2 = (timerNode_t *)data2;
+  ticks = elapsed / pCtrlBlk->type;
+  if ((elapsed % pCtrlBlk->type) != 0)
+    ticks++;
 
-  return (pEntry1->expiryTime - pEntry2->expiryTime);
+  return (pCtrlBlk->curTick + ticks + timeOut);
 }
 
 /*********************************************************************
 *
-* @purpose  To destroy the node associated with the given node
+* @purpose  Put a timer node on the wheel slot of its expiry tick
 *
-* @param    node @b{(input)}The pointer to the node that is to be deleted.
+* @param    pCtrlBlk   @b{(input)}The timer instance control block.
+* @param    pTimerNode @b{(input)}The timer node, with expiryTime set.
 *
-* @returns   SUCCESS, if success
-* @returns   FAILURE, if failure
+* @returns  None.
 *
-* @notes    There is currently no need for this.
+* @notes    Caller must hold the instance semaphore.
 *
 * @end
 *
 *********************************************************************/
 static
-RC_t appTimerDestroy( sll_member_t *node)
+void appTimerWheelLink(appTmrCtrlBlk_t *pCtrlBlk,
+                       timerNode_t     *pTimerNode)
 {
-  return  SUCCESS;
+  timerNode_t **pSlot = &pCtrlBlk->wheel[pTimerNode->expiryTime & APP_TMR_WHEEL_MASK];
+
+  (( sll_member_t *)pTimerNode)->next = ( sll_member_t *)*pSlot;
+  *pSlot = pTimerNode;
+  pCtrlBlk->numTimers++;
+}
+
+/*********************************************************************
+*
+* @purpose  Find the link that points at a timer node on the wheel
+*
+* @param    pCtrlBlk   @b{(input)}The timer instance control block.
+* @param    pTimerNode @b{(input)}The timer node to look for.
+*
+* @returns  Pointer to the slot head or node link referencing pTimerNode,
+*            NULLPTR if the node is not on the wheel (eg. it already popped)
+*
+* @notes    Caller must hold the instance semaphore. Only the slot for the
+*           node's expiry tick is searched.
+*
+* @end
+*
+*********************************************************************/
+static
+ sll_member_t **appTimerWheelLinkFind(appTmrCtrlBlk_t *pCtrlBlk,
+                                       timerNode_t     *pTimerNode)
+{
+   sll_member_t **pPrev;
+
+  pPrev = ( sll_member_t **)&pCtrlBlk->wheel[pTimerNode->expiryTime & APP_TMR_WHEEL_MASK];
+  for (; *pPrev !=  NULLPTR; pPrev = &(*pPrev)->next)
+  {
+    if (*pPrev == ( sll_member_t *)pTimerNode)
+      return pPrev;
+  }
+  return  NULLPTR;
+}
+
+/*********************************************************************
+*
+* @purpose  Take a timer node off the wheel
+*
+* @param    pCtrlBlk   @b{(input)}The timer instance control block.
+* @param    pTimerNode @b{(input)}The timer node to remove.
+*
+* @returns   TRUE, if the node was on the wheel and has been removed
+* @returns   FALSE, if the node was not found (eg. it already popped)
+*
+* @notes    Caller must hold the instance semaphore.
+*
+* @end
+*
+*********************************************************************/
+static
+ BOOL appTimerWheelUnlink(appTmrCtrlBlk_t *pCtrlBlk,
+                           timerNode_t     *pTimerNode)
+{
+   sll_member_t **pPrev;
+
+  pPrev = appTimerWheelLinkFind(pCtrlBlk, pTimerNode);
+  if (pPrev ==  NULLPTR)
+    return  FALSE;
+
+  *pPrev = (( sll_member_t *)pTimerNode)->next;
+  (( sll_member_t *)pTimerNode)->next =  NULLPTR;
+  pCtrlBlk->numTimers--;
+  return  TRUE;
+}
+
+/*********************************************************************
+*
+* @purpose  Remove the first expired timer from the current wheel slot
+*
+* @param    pCtrlBlk @b{(input)}The timer instance control block.
+*
+* @returns  Pointer to the expired timer node, or  NULLPTR if none.
+*
+* @notes    Caller must hold the instance semaphore. Nodes in the slot
+*           that belong to a later revolution of the wheel are skipped.
+*
+* @end
+*
+*********************************************************************/
+static
+timerNode_t *appTimerWheelExpiredPop(appTmrCtrlBlk_t *pCtrlBlk)
+{
+   sll_member_t **pPrev;
+  timerNode_t     *pTimerNode;
+
+  pPrev = ( sll_member_t **)&pCtrlBlk->wheel[pCtrlBlk->curTick & APP_TMR_WHEEL_MASK];
+  for (; *pPrev !=  NULLPTR; pPrev = &(*pPrev)->next)
+  {
+    pTimerNode = (timerNode_t *)*pPrev;
+    if (APP_TMR_TICK_DIFF(pTimerNode->expiryTime, pCtrlBlk->curTick) <= 0)
+    {
+      *pPrev = (( sll_member_t *)pTimerNode)->next;
+      pCtrlBlk->numTimers--;
+      return pTimerNode;
+    }
+  }
+  return  NULLPTR;
 }
 
 /*********************************************************************
@@ -218,33 +334,22 @@ void appTimerTick( uint64 param1,  uint64 param2)
     osapiFree(compId, pCtrlBlk);
     return ( APP_TMR_CTRL_BLK_t) NULLPTR;
   }
-  if(SLLCreate(compId,  SLL_ASCEND_ORDER, sizeof(uint32), appTimerCompare,
-               appTimerDestroy, &(pCtrlBlk->tmrList)) !=  SUCCESS)
+  pCtrlBlk->wheel = (timerNode_t **)osapiMalloc(compId,
+                                                APP_TMR_WHEEL_SIZE * sizeof(timerNode_t *));
+  if(pCtrlBlk->wheel ==  NULLPTR)
   {
     osapiSemaDelete(pCtrlBlk->semId);
     osapiFree(compId, pCtrlBlk);
     return ( APP_TMR_CTRL_BLK_t) NULLPTR;
   }
-  if(SLLCreate(compId,  SLL_ASCEND_ORDER, sizeof(uint32), appTimerCompare,
-               appTimerDestroy, &(pCtrlBlk->wrapTmrList)) !=  SUCCESS)
-  {
-    SLLDestroy(compId, &(pCtrlBlk->tmrList));
-    osapiSemaDelete(pCtrlBlk->semId);
-    osapiFree(compId, pCtrlBlk);
-    return ( APP_TMR_CTRL_BLK_t) NULLPTR;
-  }
-  /* SLLCreate() creates an instance of the Singly Linked List that does not
-     allow duplicates. Since for our application, we need support for multiple
-     entries with the same expiry time, we need to explicitly enable nodes with
-     duplicate key values in the list */
-  SLLFlagsSet(&(pCtrlBlk->tmrList),  SLL_FLAG_ALLOW_DUPLICATES,  TRUE);
-  SLLFlagsSet(&(pCtrlBlk->wrapTmrList),  SLL_FLAG_ALLOW_DUPLICATES,  TRUE);
+  memset(pCtrlBlk->wheel, 0, APP_TMR_WHEEL_SIZE * sizeof(timerNode_t *));
 
   pCtrlBlk->compId     = compId;
   pCtrlBlk->type       = timerType;
   pCtrlBlk->dispatchFn = dispatchFn;
   pCtrlBlk->pParam     = pParam;
   pCtrlBlk->pSelf      = pCtrlBlk;
+  pCtrlBlk->curTick    = 0;
   pCtrlBlk->prevTime   = osapiTimeMillisecondsGet(); 
 
   /* Start the base system tick timer */
@@ -299,8 +404,9 @@ RC_t appTimerDeInit( APP_TMR_CTRL_BLK_t timerCtrlBlk)
 
   /* Release the resources */
   compId = pCtrlBlk->compId;
-  SLLDestroy(compId, &(pCtrlBlk->tmrList));
-  SLLDestroy(compId, &(pCtrlBlk->wrapTmrList));
+  osapiFree(compId, pCtrlBlk->wheel);
+  pCtrlBlk->wheel      =  NULLPTR;
+  pCtrlBlk->numTimers  = 0;
   pCtrlBlk->type       = 0;
   pCtrlBlk->dispatchFn =  NULLPTR;
   pCtrlBlk->pSelf      =  NULLPTR;
@@ -376,27 +482,9 @@ appTimerAddNode ( APP_TMR_CTRL_BLK_t timerCtrlBlk,
 #ifdef APPTIMER_DEBUG    
   osapiStrncpy(pTimerNode->name, timerName, APPTIMER_STR_LEN);
 #endif  
-  pTimerNode->expiryTime = currTime + (timeOut * pCtrlBlk->type);
+  pTimerNode->expiryTime = appTimerExpiryTickGet(pCtrlBlk, currTime, timeOut);
   pTimerNode->pParam     = pParam;
-  if ((pTimerNode->expiryTime < currTime) || (currTime < pCtrlBlk->prevTime))
-  {
-    /*  Add to wrap SLL */
-    if(SLLAdd(&(pCtrlBlk->wrapTmrList), ( sll_member_t *)pTimerNode) !=  SUCCESS)
-    {
-      memset(pTimerNode, 0, sizeof(timerNode_t));
-      bufferPoolFree(pCtrlBlk->bufferPoolId, ( uchar8 *)pTimerNode);
-      return ( APP_TMR_HNDL_t) NULLPTR;
-    }
-  }
-  else
-  {
-    if(SLLAdd(&(pCtrlBlk->tmrList), ( sll_member_t *)pTimerNode) !=  SUCCESS)
-    {
-      memset(pTimerNode, 0, sizeof(timerNode_t));
-      bufferPoolFree(pCtrlBlk->bufferPoolId, ( uchar8 *)pTimerNode);
-      return ( APP_TMR_HNDL_t) NULLPTR;
-    }
-  }
+  appTimerWheelLink(pCtrlBlk, pTimerNode);
   return ( APP_TMR_HNDL_t)pTimerNode;
 }
 
@@ -436,15 +524,11 @@ RC_t appTimerDelete( APP_TMR_CTRL_BLK_t timerCtrlBlk,
   if(osapiSemaTake(pCtrlBlk->semId,  WAIT_FOREVER) !=  SUCCESS)
     return  FAILURE;
 
-  /* Remove the entry from the timer list */
-  if(SLLNodeRemove(&(pCtrlBlk->tmrList), ( sll_member_t *)pTimerNode) ==  NULL)
+  /* Remove the entry from the timer wheel */
+  if(appTimerWheelUnlink(pCtrlBlk, pTimerNode) !=  TRUE)
   {
-    /*  Need to check for the same in wrap timer list as well*/
-    if(SLLNodeRemove(&(pCtrlBlk->wrapTmrList), ( sll_member_t *)pTimerNode) ==  NULL)
-    {
-     osapiSemaGive(pCtrlBlk->semId);
-     return  SUCCESS;
-    }
+    osapiSemaGive(pCtrlBlk->semId);
+    return  SUCCESS;
   }
 
   /* Free-up the resources */
@@ -592,51 +676,27 @@ RC_t appTimerUpdate_track( APP_TMR_CTRL_BLK_t timerCtrlBlk,
   }
 
   pTimerNode = (timerNode_t *)*timerHandle;
-  /* Remove the entry from the timer list */
-  if(SLLNodeRemove(&(pCtrlBlk->tmrList), ( sll_member_t *)pTimerNode) ==  NULL) 
+  /* Remove the entry from the timer wheel */
+  if(appTimerWheelUnlink(pCtrlBlk, pTimerNode) !=  TRUE)
   {
-    if(SLLNodeRemove(&(pCtrlBlk->wrapTmrList), ( sll_member_t *)pTimerNode) ==  NULL)
+    if ((*timerHandle = appTimerAddNode (timerCtrlBlk, pFunc, pParam, timeOut,timerName,
+                fileName, lineNum))
+                      ==  NULLPTR)
     {
-      if ((*timerHandle = appTimerAddNode (timerCtrlBlk, pFunc, pParam, timeOut,timerName,
-                  fileName, lineNum))
-                        ==  NULLPTR)
-      {
-        osapiSemaGive(pCtrlBlk->semId);
-        return  FAILURE;
-      }
       osapiSemaGive(pCtrlBlk->semId);
-      return  SUCCESS;
+      return  FAILURE;
     }
+    osapiSemaGive(pCtrlBlk->semId);
+    return  SUCCESS;
   }
 
-  /* Update the timer entry */
+  /* Update the timer entry and put it back on the slot of its new expiry */
   if(pFunc !=  NULLPTR)
     pTimerNode->expiryFn = pFunc;
   if(pParam !=  NULLPTR)
     pTimerNode->pParam = pParam;
-  pTimerNode->expiryTime = currTime + (pCtrlBlk->type * timeOut);
-  if ((pTimerNode->expiryTime < currTime)  || (currTime < pCtrlBlk->prevTime))
-  {
-    /*  Add to wrap SLL node*/
-    if(SLLAdd(&(pCtrlBlk->wrapTmrList), ( sll_member_t *)pTimerNode) !=  SUCCESS)
-    {
-      memset(pTimerNode, 0, sizeof(timerNode_t));
-      bufferPoolFree(pCtrlBlk->bufferPoolId, ( uchar8 *)pTimerNode);
-      osapiSemaGive(pCtrlBlk->semId);
-      return  FAILURE;
-    }
-  }
-  else
-  {
-    /* Add the entry back to the timer list */
-    if(SLLAdd(&(pCtrlBlk->tmrList), ( sll_member_t *)pTimerNode) !=  SUCCESS)
-    {
-      memset(pTimerNode, 0, sizeof(timerNode_t));
-      bufferPoolFree(pCtrlBlk->bufferPoolId, ( uchar8 *)pTimerNode);
-      osapiSemaGive(pCtrlBlk->semId);
-      return  FAILURE;
-    }
-  }
+  pTimerNode->expiryTime = appTimerExpiryTickGet(pCtrlBlk, currTime, timeOut);
+  appTimerWheelLink(pCtrlBlk, pTimerNode);
   osapiSemaGive(pCtrlBlk->semId);
   return  SUCCESS;
 }
@@ -665,9 +725,8 @@ RC_t appTimerTimeLeftGet( APP_TMR_CTRL_BLK_t timerCtrlBlk,
 {
   appTmrCtrlBlk_t *pCtrlBlk;
   timerNode_t     *pTimerNode;
-  timerNode_t     *pTmpNode =  NULLPTR;
   uint32       currTime;
-   BOOL         isWrapTmrEntry =  FALSE;
+  int32        ticksLeft;
   /* 
    * if timer does not exist or this api fails for whatever reason
    * just return 0 in timeleft
@@ -689,50 +748,21 @@ RC_t appTimerTimeLeftGet( APP_TMR_CTRL_BLK_t timerCtrlBlk,
   if(osapiSemaTake(pCtrlBlk->semId,  WAIT_FOREVER) !=  SUCCESS)
     return  FAILURE;
 
-  /* Retrieve the entry from the timer list */
-  pTmpNode = (timerNode_t *)SLLNodeFind(&(pCtrlBlk->tmrList), ( sll_member_t *)pTimerNode);
-  if(pTmpNode ==  NULLPTR)
+  /* Make sure the entry is still on the timer wheel */
+  if(appTimerWheelLinkFind(pCtrlBlk, pTimerNode) ==  NULLPTR)
   {
-    /*  find the same in wrap timer list as well*/  
-    pTmpNode = (timerNode_t *)SLLNodeFind(&(pCtrlBlk->wrapTmrList), ( sll_member_t *)pTimerNode);
-    if(pTmpNode ==  NULLPTR)
-    {
-      osapiSemaGive(pCtrlBlk->semId);
-      return  FAILURE;
-    }
-    else
-    {
-      isWrapTmrEntry =  TRUE;
-    }
+    osapiSemaGive(pCtrlBlk->semId);
+    return  FAILURE;
   }
 
-
-  /* Some times, if the timer tick events are still in the queue and not 
-     processed yet means and during this instance if appTimerTimeLeftGet 
-     is called from mgmt layer, there is a chance of pTmpNode->expiryTime being
-     lesser than the current time and so may result in the negative value if 
-     directly subtracted and so explicitly initialize it to 0 when expirytime is less than
-     current time 
-   */
-
-  if(((pTmpNode->expiryTime < currTime) &&
-      ( FALSE == isWrapTmrEntry)) ||
-     ((pTmpNode->expiryTime > currTime) && ( TRUE == isWrapTmrEntry)))
+  /* If the timer tick events are still in the queue and not processed yet,
+     the expiry may already be behind the current time; report 0 then
+     rather than a negative value */
+  ticksLeft = APP_TMR_TICK_DIFF(pTimerNode->expiryTime,
+                                appTimerExpiryTickGet(pCtrlBlk, currTime, 0));
+  if(ticksLeft > 0)
   {
-    *pTimeLeft =0; 
-  }
-  else
-  {
-    if (( TRUE == isWrapTmrEntry) &&
-        (pTmpNode->expiryTime < currTime))
-    {
-      *pTimeLeft = (((0xFFFFFFFF) - currTime) + pTmpNode->expiryTime + 1) / pCtrlBlk->type;
-    }
-    else
-    {
-      /* Compute the time left based on the expiry time */
-      *pTimeLeft = (pTmpNode->expiryTime - currTime) / pCtrlBlk->type;
-    }
+    *pTimeLeft = (uint32)ticksLeft;
   }
 
   osapiSemaGive(pCtrlBlk->semId);
@@ -762,7 +792,7 @@ void appTimerProcess( APP_TMR_CTRL_BLK_t timerCtrlBlk)
   appTmrCtrlBlk_t *pCtrlBlk;
   timerNode_t     *pTimerNode =  NULLPTR;
   uint32       currTime;
-   sll_t        tempSll;
+  uint32       elapsed;
 
   /* Basic sanity Checks */
   pCtrlBlk = (appTmrCtrlBlk_t *)timerCtrlBlk;
@@ -781,93 +811,46 @@ void appTimerProcess( APP_TMR_CTRL_BLK_t timerCtrlBlk)
     if(osapiSemaTake(pCtrlBlk->semId,  WAIT_FOREVER) !=  SUCCESS)
       break;
 
-    /* Get the top of list entry */
-    if(currTime >= pCtrlBlk->prevTime)
+    /* Turn the wheel one tick at a time until an expired timer turns up
+       in the current slot or the wheel has caught up with the system time.
+       Unsigned arithmetic keeps this correct across the msec counter wrap */
+    while((pTimerNode = appTimerWheelExpiredPop(pCtrlBlk)) ==  NULLPTR)
     {
-      pTimerNode = (timerNode_t *)SLLAtStartPop(&(pCtrlBlk->tmrList));
-      if(pTimerNode !=  NULLPTR)
-      {
-        if(pTimerNode->expiryTime > currTime)
-        {
-          SLLAtStartPush(&(pCtrlBlk->tmrList), ( sll_member_t *)pTimerNode);
-          pCtrlBlk->prevTime = currTime;
-          osapiSemaGive(pCtrlBlk->semId);
-          break;
-        }
-        else
-        {
-           app_tmr_fn pFunc = pTimerNode->expiryFn;
-          void          *pParam = pTimerNode->pParam;
-
-          /* Free-up the timer entry as we are popping it */
-          memset(pTimerNode, 0, sizeof(timerNode_t));
-          bufferPoolFree(pCtrlBlk->bufferPoolId, ( uchar8 *)pTimerNode);
-          osapiSemaGive(pCtrlBlk->semId);
-
-          /* Invoke the expiry function */
-          if(pFunc !=  NULLPTR)
-          {
-            pFunc(pParam);
-          }
-        }
-      }
-      else
+      elapsed = currTime - pCtrlBlk->prevTime;
+      if(((int32)elapsed < 0) || (elapsed < pCtrlBlk->type))
+        break;
+
+      if(pCtrlBlk->numTimers == 0)
       {
-        /* No enties to process*/
-        pCtrlBlk->prevTime = currTime;
-        osapiSemaGive(pCtrlBlk->semId);
+        /* Nothing to pop on the way; jump straight to the current tick */
+        pCtrlBlk->curTick  += elapsed / pCtrlBlk->type;
+        pCtrlBlk->prevTime += (elapsed / pCtrlBlk->type) * pCtrlBlk->type;
         break;
       }
+      pCtrlBlk->curTick++;
+      pCtrlBlk->prevTime += pCtrlBlk->type;
     }
-    else /* if(currTime < pCtrlBlk->prevTime) */
+
+    if(pTimerNode ==  NULLPTR)
     {
-      /* Time has wrapped; pop all the timers in the regular timer list */
-      while ( TRUE)
-      {
-         app_tmr_fn      pFunc;
-        void              *pParam;
-
-        pTimerNode = (timerNode_t *)SLLAtStartPop(&(pCtrlBlk->tmrList));
-        if(pTimerNode ==  NULLPTR)
-        {
-          break;
-        }
-        pFunc = pTimerNode->expiryFn;
-        pParam = pTimerNode->pParam;
-
-        /* Free-up the timer entry as we are popping it */
-        memset(pTimerNode, 0, sizeof(timerNode_t));
-        bufferPoolFree(pCtrlBlk->bufferPoolId, ( uchar8 *)pTimerNode);
-        osapiSemaGive(pCtrlBlk->semId);
-
-        /* Invoke the expiry function */
-        if(pFunc !=  NULLPTR)
-        {
-          pFunc(pParam);
-        }
-        if(osapiSemaTake(pCtrlBlk->semId,  WAIT_FOREVER) !=  SUCCESS)
-        {
-          osapiTimer64Add(appTimerTick,
-                        ( uint64) ((unsigned long) pCtrlBlk),
-                        ( uint64) ((unsigned long) pCtrlBlk->pParam),
-                        pCtrlBlk->type,
-                        &(pCtrlBlk->pSysTimer));
-          return;
-        } 
-      }
+      osapiSemaGive(pCtrlBlk->semId);
+      break;
+    }
+    else
+    {
+       app_tmr_fn pFunc = pTimerNode->expiryFn;
+      void          *pParam = pTimerNode->pParam;
 
-      /* Copy the wrap timer list to the regular timer list and reset the wrap timer list */
-      memcpy(&tempSll, &(pCtrlBlk->tmrList), sizeof( sll_t));
-      memcpy(&pCtrlBlk->tmrList, &pCtrlBlk->wrapTmrList, sizeof( sll_t));
-      memcpy((&pCtrlBlk->wrapTmrList), &tempSll, sizeof( sll_t));
-       LOGF( LOG_SEVERITY_DEBUG, "Regular timer list is cleared." 
-              "Wrap timer list is copied to regular list. No. of elements copied %d", 
-              SLLNumMembersGet(&pCtrlBlk->tmrList));
-      /* Set the prevTime to the start of wrap around value */
-      pCtrlBlk->prevTime = 0;
-
-      /* Continue to process the regular timer list */
+      /* Free-up the timer entry as we are popping it */
+      memset(pTimerNode, 0, sizeof(timerNode_t));
+      bufferPoolFree(pCtrlBlk->bufferPoolId, ( uchar8 *)pTimerNode);
       osapiSemaGive(pCtrlBlk->semId);
+
+      /* Invoke the expiry function */
+      if(pFunc !=  NULLPTR)
+      {
+        pFunc(pParam);
+      }
     }
   };
 
@@ -900,6 +883,8 @@ void appTimerDebugShow( APP_TMR_CTRL_BLK_t timerCtrlBlk)
   appTmrCtrlBlk_t *pCtrlBlk;
   timerNode_t     *pTimerNode =  NULLPTR;
   uint32       currTime;
+  uint32       nowTick;
+  uint32       slot;
   
   /* Basic sanity Checks */
   pCtrlBlk = (appTmrCtrlBlk_t *)timerCtrlBlk;
@@ -916,24 +901,17 @@ void appTimerDebugShow( APP_TMR_CTRL_BLK_t timerCtrlBlk)
     return;
   /* Retrieve the current timer tick */
   currTime = osapiTimeMillisecondsGet();
-  for (pTimerNode = (timerNode_t *)SLLFirstGet(&(pCtrlBlk->tmrList));
-       pTimerNode !=  NULLPTR;
-       pTimerNode = (timerNode_t *)SLLNextGet(&(pCtrlBlk->tmrList), 
-            ( sll_member_t *)pTimerNode))
+  nowTick = appTimerExpiryTickGet(pCtrlBlk, currTime, 0);
+  for (slot = 0; slot < APP_TMR_WHEEL_SIZE; slot++)
   {
-    sysapiPrintf("%-8s       %-4d      0x%x      \n",pTimerNode->name,
-                ((pTimerNode->expiryTime - currTime)/pCtrlBlk->type), 
-                pTimerNode->expiryFn);
-  }
-  /*  Check if etries in wrap timer list*/
-  for (pTimerNode = (timerNode_t *)SLLFirstGet(&(pCtrlBlk->wrapTmrList));
-       pTimerNode !=  NULLPTR;
-       pTimerNode = (timerNode_t *)SLLNextGet(&(pCtrlBlk->wrapTmrList),
-            ( sll_member_t *)pTimerNode))
-  {
-    sysapiPrintf("%-8s       %-4d      0x%x      \n",pTimerNode->name,
-                ((pTimerNode->expiryTime - currTime)/pCtrlBlk->type),
-                pTimerNode->expiryFn);
+    for (pTimerNode = pCtrlBlk->wheel[slot];
+         pTimerNode !=  NULLPTR;
+         pTimerNode = (timerNode_t *)(( sll_member_t *)pTimerNode)->next)
+    {
+      sysapiPrintf("%-8s       %-4d      0x%x      \n",pTimerNode->name,
+                  APP_TMR_TICK_DIFF(pTimerNode->expiryTime, nowTick),
+                  pTimerNode->expiryFn);
+    }
   }
   osapiSemaGive(pCtrlBlk->semId);
 #endif
@@ -955,7 +933,8 @@ uint32 appTimerCbMemSizeGet(uint32   maxAppTimers)
 {
  uint32 size;
 
-  size = sizeof(appTmrCtrlBlk_t) + maxAppTimers * sizeof(timerNode_t);
+  size = sizeof(appTmrCtrlBlk_t) + (APP_TMR_WHEEL_SIZE * sizeof(timerNode_t *)) +
+         maxAppTimers * sizeof(timerNode_t);
   return size;
 }
 /*********************************************************************
@@ -0,0 +1,289 @@
+/*
+ * Copyright 2024 Broadcom Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Standalone check and benchmark for the apptimer timing wheel.
+ *
+ * apptimer.c is built against the minimal osapi, buffer pool and sll
+ * stand-ins in stub/, with osapiTimeMillisecondsGet() returning a clock the
+ * driver advances itself, so expiry is checked tick by tick with no
+ * sleeping:
+ *
+ *   cc -O2 -Istub -o apptimer_bench apptimer_bench.c ../apptimer.c
+ *   ./apptimer_bench check           early, late, lost, duplicate expiries
+ *   ./apptimer_bench [count]         add/update/delete/expire of count
+ *                                    timers (default 100000)
+ *
+ * The check runs random add, update, delete and time left calls, including
+ * restarts from the expiry callback, at several granularities and across
+ * the 32-bit millisecond wrap. It exits non-zero on any error.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "datatypes.h"
+#include "apptimer_api.h"
+
+#define BENCH_TIMERS_MAX    100000
+#define BENCH_TIMEOUT_MAX   3600
+
+/* Millisecond clock seen by apptimer.c, through stub/osapi.h */
+uint32 fakeNow;
+
+typedef struct benchTimer_s
+{
+  APP_TMR_HNDL_t hndl;
+  uint32         due;
+  int            fired;
+  int            live;
+} benchTimer_t;
+
+static benchTimer_t       timers[BENCH_TIMERS_MAX];
+static APP_TMR_HNDL_t     hndls[BENCH_TIMERS_MAX];
+static APP_TMR_CTRL_BLK_t ctrlBlk;
+static uint32             gran;
+static uint32             lastProcess;
+static int                errors;
+static int                fires;
+
+static void benchDispatch(APP_TMR_CTRL_BLK_t timerCtrlBlk, void *ptrData)
+{
+  (void)timerCtrlBlk;
+  (void)ptrData;
+}
+
+static void checkExpiry(void *pParam)
+{
+  benchTimer_t *t = pParam;
+  long          idx = (long)(t - timers);
+
+  fires++;
+  if (!t->live)
+  {
+    errors++;
+    printf("timer %ld fired after delete\n", idx);
+  }
+  if ((int32)(fakeNow - t->due) < 0)
+  {
+    errors++;
+    printf("timer %ld early, now %u due %u\n", idx, fakeNow, t->due);
+  }
+  if ((int32)(lastProcess - t->due) >= (int32)gran)
+  {
+    errors++;
+    printf("timer %ld late, now %u due %u\n", idx, fakeNow, t->due);
+  }
+  t->live = 0;
+  t->hndl = NULLPTR;
+  t->fired++;
+
+  /* Restart some from the callback, as protocol timers do */
+  if ((idx % 7) == 0 && t->fired < 3)
+  {
+    t->hndl = appTimerAdd_track(ctrlBlk, checkExpiry, t, 3, "bench", "checkExpiry", 0);
+    t->due = fakeNow + 3 * gran;
+    t->live = 1;
+  }
+}
+
+static void checkTimeLeft(benchTimer_t *t)
+{
+  uint32 left;
+  int32  due = (int32)(t->due - fakeNow);
+
+  if (appTimerTimeLeftGet(ctrlBlk, t->hndl, &left) != SUCCESS)
+  {
+    errors++;
+    printf("time left get failed\n");
+  }
+  else if (due <= 0 ? left != 0 :
+           (left * gran > (uint32)due + gran || left * gran + gran < (uint32)due))
+  {
+    errors++;
+    printf("time left %u ms, expected %d ms\n", left * gran, due);
+  }
+}
+
+static int benchCheck(uint32 start, uint32 granularity, int count)
+{
+  benchTimer_t *t;
+  uint32        timeOut;
+  int           step, op, i;
+
+  gran = granularity;
+  fakeNow = start;
+  lastProcess = start;
+  errors = fires = 0;
+  memset(timers, 0, sizeof(timers));
+  ctrlBlk = appTimerInit(1, benchDispatch, NULLPTR, granularity, 1);
+  srand(42);
+
+  for (step = 0; step < 20000; step++)
+  {
+    t = &timers[rand() % count];
+    op = rand() % 10;
+    timeOut = rand() % 50;
+
+    if (op < 5)
+    {
+      if (!t->live)
+      {
+        t->hndl = appTimerAdd_track(ctrlBlk, checkExpiry, t, timeOut, "bench", "checkExpiry", 0);
+        t->live = 1;
+        t->due = fakeNow + timeOut * granularity;
+      }
+    }
+    else if (op < 8)
+    {
+      if (appTimerUpdate_track(ctrlBlk, &t->hndl, checkExpiry, t, timeOut,
+                               (uchar8 *)"bench", (uchar8 *)"checkExpiry", 0) != SUCCESS)
+      {
+        errors++;
+        printf("update failed\n");
+      }
+      t->live = 1;
+      t->due = fakeNow + timeOut * granularity;
+    }
+    else if (op < 9)
+    {
+      if (t->live)
+      {
+        appTimerDelete(ctrlBlk, t->hndl);
+        t->live = 0;
+        t->hndl = NULLPTR;
+      }
+    }
+    else if (t->live)
+    {
+      checkTimeLeft(t);
+    }
+
+    /* Process at uneven intervals, up to one and a half ticks apart */
+    if (rand() % 3 == 0)
+    {
+      fakeNow += rand() % (granularity + granularity / 2 + 1);
+      appTimerProcess(ctrlBlk);
+      lastProcess = fakeNow;
+    }
+  }
+
+  for (i = 0; i < 200; i++)
+  {
+    fakeNow += granularity;
+    appTimerProcess(ctrlBlk);
+    lastProcess = fakeNow;
+  }
+  for (i = 0; i < count; i++)
+  {
+    if (timers[i].live)
+    {
+      errors++;
+      printf("timer %d never fired, due %u now %u\n", i, timers[i].due, fakeNow);
+    }
+  }
+  appTimerDeInit(ctrlBlk);
+
+  printf("check start %u gran %u: fires %d errors %d\n", start, granularity, fires, errors);
+  return errors;
+}
+
+static void benchExpiry(void *pParam)
+{
+  (void)pParam;
+  fires++;
+}
+
+static double benchSeconds(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void benchRun(int count)
+{
+  double t0, t1, t2, t3, t4;
+  int    i;
+
+  fakeNow = 1000;
+  fires = 0;
+  ctrlBlk = appTimerInit(1, benchDispatch, NULLPTR, APP_TMR_1SEC, 1);
+  srand(1);
+
+  t0 = benchSeconds();
+  for (i = 0; i < count; i++)
+  {
+    hndls[i] = appTimerAdd_track(ctrlBlk, benchExpiry, NULLPTR, 1 + rand() % BENCH_TIMEOUT_MAX,
+                                 "bench", "benchExpiry", 0);
+  }
+  t1 = benchSeconds();
+  for (i = 0; i < count; i++)
+  {
+    appTimerUpdate_track(ctrlBlk, &hndls[i], NULLPTR, NULLPTR, 1 + rand() % BENCH_TIMEOUT_MAX,
+                         (uchar8 *)"bench", (uchar8 *)"benchExpiry", 0);
+  }
+  t2 = benchSeconds();
+  for (i = 0; i < count; i += 2)
+  {
+    appTimerDelete(ctrlBlk, hndls[i]);
+  }
+  t3 = benchSeconds();
+  for (i = 0; i <= BENCH_TIMEOUT_MAX + 100; i++)
+  {
+    fakeNow += 1000;
+    appTimerProcess(ctrlBlk);
+  }
+  t4 = benchSeconds();
+  appTimerDeInit(ctrlBlk);
+
+  printf("timers %d\n", count);
+  printf("add    %8.3f s %6.0f ns/op\n", t1 - t0, (t1 - t0) / count * 1e9);
+  printf("update %8.3f s %6.0f ns/op\n", t2 - t1, (t2 - t1) / count * 1e9);
+  printf("delete %8.3f s %6.0f ns/op\n", t3 - t2, (t3 - t2) / ((count + 1) / 2) * 1e9);
+  printf("expire %8.3f s, %d fired\n", t4 - t3, fires);
+}
+
+int main(int argc, char **argv)
+{
+  int count = BENCH_TIMERS_MAX;
+
+  if (argc > 1 && strcmp(argv[1], "check") == 0)
+  {
+    int failed = 0;
+
+    failed += benchCheck(1000, APP_TMR_1SEC, 2000);
+    failed += benchCheck(0xFFFFFFFFu - 200000, APP_TMR_1SEC, 2000);
+    failed += benchCheck(0xFFFFFFFFu - 2000, APP_TMR_10MSEC, 500);
+    failed += benchCheck(5, APP_TMR_1MSEC, 300);
+    return failed ? 1 : 0;
+  }
+
+  if (argc > 1)
+  {
+    count = atoi(argv[1]);
+  }
+  if (count <= 0 || count > BENCH_TIMERS_MAX)
+  {
+    fprintf(stderr, "usage: %s check | [count]    (count 1-%d)\n", argv[0], BENCH_TIMERS_MAX);
+    return 1;
+  }
+  benchRun(count);
+
+  return 0;
+}
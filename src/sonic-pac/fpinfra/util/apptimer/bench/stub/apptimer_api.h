@@ -0,0 +1,14 @@
+/* Minimal stand-in for the fpinfra apptimer_api.h, only what apptimer_bench needs */
+#include "sll_api.h"
+typedef void *APP_TMR_CTRL_BLK_t; typedef void *APP_TMR_HNDL_t;
+typedef void (*app_tmr_fn)(void *);
+typedef void (*app_tmr_dispatcher_fn)(APP_TMR_CTRL_BLK_t, void *);
+typedef enum { APP_TMR_1MSEC = 1, APP_TMR_10MSEC = 10, APP_TMR_100MSEC = 100, APP_TMR_1SEC = 1000 } APP_TMR_GRAN_TYPE_t;
+typedef struct timerNode_s { struct timerNode_s *next; uint32 expiryTime; app_tmr_fn expiryFn; void *pParam; } timerNode_t;
+APP_TMR_CTRL_BLK_t appTimerInit(COMPONENT_IDS_t, app_tmr_dispatcher_fn, void *, APP_TMR_GRAN_TYPE_t, uint32);
+RC_t appTimerDeInit(APP_TMR_CTRL_BLK_t);
+APP_TMR_HNDL_t appTimerAdd_track(APP_TMR_CTRL_BLK_t, app_tmr_fn, void *, uint32, char8 *, char8 *, uint32);
+RC_t appTimerUpdate_track(APP_TMR_CTRL_BLK_t, APP_TMR_HNDL_t *, void *, void *, uint32, uchar8 *, uchar8 *, uint32);
+RC_t appTimerDelete(APP_TMR_CTRL_BLK_t, APP_TMR_HNDL_t);
+RC_t appTimerTimeLeftGet(APP_TMR_CTRL_BLK_t, APP_TMR_HNDL_t, uint32 *);
+void appTimerProcess(APP_TMR_CTRL_BLK_t);
@@ -0,0 +1,3 @@
+/* Minimal stand-in for the fpinfra buff_api.h, only what apptimer_bench needs */
+static inline RC_t bufferPoolAllocate(uint32 id, uchar8 **p) { (void)id; *p = malloc(64); return *p ? SUCCESS : FAILURE; }
+static inline RC_t bufferPoolFree(uint32 id, uchar8 *p) { (void)id; free(p); return SUCCESS; }
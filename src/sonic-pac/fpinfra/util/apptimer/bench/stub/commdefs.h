@@ -0,0 +1,2 @@
+/* Minimal stand-in for the fpinfra commdefs.h, only what apptimer_bench needs */
+#define WAIT_FOREVER ((uint32)-1)
@@ -0,0 +1,13 @@
+/* Minimal stand-in for the fpinfra datatypes.h, only what apptimer_bench needs */
+#ifndef DT_H
+#define DT_H
+#include <stdint.h>
+#include <stddef.h>
+typedef char char8; typedef unsigned char uchar8; typedef unsigned int uint32; typedef int int32;
+typedef unsigned long long uint64; typedef int BOOL;
+#define TRUE 1
+#define FALSE 0
+#define NULLPTR ((void*)0)
+typedef enum { SUCCESS = 0, FAILURE, ERROR } RC_t;
+typedef int COMPONENT_IDS_t;
+#endif
@@ -0,0 +1,3 @@
+/* Minimal stand-in for the fpinfra log.h, only what apptimer_bench needs */
+#define LOG_SEVERITY_DEBUG 0
+#define LOGF(s, ...) do { } while (0)
@@ -0,0 +1,14 @@
+/* Minimal stand-in for the fpinfra osapi.h, only what apptimer_bench needs */
+#ifndef OSAPI_H
+#define OSAPI_H
+#include <stdlib.h>
+#include <string.h>
+typedef struct { int x; } osapiTimerDescr_t;
+extern uint32 fakeNow;
+static inline uint32 osapiTimeMillisecondsGet(void) { return fakeNow; }
+static inline void *osapiMalloc(COMPONENT_IDS_t c, size_t n) { (void)c; return malloc(n); }
+static inline void osapiFree(COMPONENT_IDS_t c, void *p) { (void)c; free(p); }
+static inline void osapiTimer64Add(void (*f)(uint64, uint64), uint64 a, uint64 b, uint32 t, osapiTimerDescr_t **d) { (void)f;(void)a;(void)b;(void)t; *d = NULL; }
+static inline void osapiTimerFree(osapiTimerDescr_t *d) { (void)d; }
+#define osapiStrncpy(a,b,n) strncpy((char*)(a),(char*)(b),(n))
+#endif
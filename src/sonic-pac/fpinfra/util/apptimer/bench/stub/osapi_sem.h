@@ -0,0 +1,7 @@
+/* Minimal stand-in for the fpinfra osapi_sem.h, only what apptimer_bench needs */
+#define OSAPI_SEM_Q_PRIORITY 0
+#define OSAPI_SEM_FULL 1
+static inline void *osapiSemaBCreate(int a, int b) { (void)a;(void)b; return (void*)1; }
+static inline RC_t osapiSemaTake(void *s, uint32 w) { (void)s;(void)w; return SUCCESS; }
+static inline RC_t osapiSemaGive(void *s) { (void)s; return SUCCESS; }
+static inline RC_t osapiSemaDelete(void *s) { (void)s; return SUCCESS; }
@@ -0,0 +1,24 @@
+/* Minimal stand-in for the fpinfra sll_api.h, only what apptimer_bench needs */
+#ifndef SLL_API_H
+#define SLL_API_H
+typedef struct sll_member_s { struct sll_member_s *next; char8 data[]; } sll_member_t;
+typedef enum { SLL_NO_ORDER, SLL_ASCEND_ORDER, SLL_DESCEND_ORDER } SLL_SORT_TYPE;
+typedef enum { SLL_FLAG_ALLOW_DUPLICATES } SLL_FLAG_t;
+typedef int32 (*sllCompareFunc)(void *, void *, uint32);
+typedef RC_t (*sllDestroyFunc)(sll_member_t *);
+typedef struct { sll_member_t *sllStart, *sllEnd; uint32 sllNumElements; SLL_SORT_TYPE sllSortType;
+  uint32 sllKeySize; BOOL sllDupEnable; COMPONENT_IDS_t sllCompId; sllCompareFunc sllCompareFunc;
+  sllDestroyFunc sllDestroyFunc; void *semId; BOOL inUse; } sll_t;
+RC_t SLLCreate(COMPONENT_IDS_t, SLL_SORT_TYPE, uint32, sllCompareFunc, sllDestroyFunc, sll_t *);
+RC_t SLLFlagsSet(sll_t *, SLL_FLAG_t, uint32);
+RC_t SLLPurge(COMPONENT_IDS_t, sll_t *);
+RC_t SLLDestroy(COMPONENT_IDS_t, sll_t *);
+RC_t SLLAdd(sll_t *, sll_member_t *);
+sll_member_t *SLLNodeRemove(sll_t *, sll_member_t *);
+sll_member_t *SLLNodeFind(sll_t *, sll_member_t *);
+sll_member_t *SLLAtStartPop(sll_t *);
+RC_t SLLAtStartPush(sll_t *, sll_member_t *);
+uint32 SLLNumMembersGet(sll_t *);
+sll_member_t *SLLFirstGet(sll_t *);
+sll_member_t *SLLNextGet(sll_t *, sll_member_t *);
+#endif
@@ -0,0 +1,2 @@
+/* Minimal stand-in for the fpinfra utils_api.h, only what apptimer_bench needs */
+static inline void utilsFilenameStrip(char8 **f) { (void)f; }
@@ -144,6 +144,7 @@ typedef struct mabMsg_s
 
 
 #define MAB_MSG_COUNT   FD_MAB_MSG_COUNT
+#define MAB_MSG_BATCH   16   /* mabQueue messages served per wakeup */
 #define MAB_TIMER_TICK  1000 /*in milliseconds*/
 
 extern RC_t mabStartTasks();
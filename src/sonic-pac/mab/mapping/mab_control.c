@@ -26,6 +26,7 @@
 #include "radius_attr_parse.h"
 #include "utils_api.h"
 #include "osapi_sem.h"
+#include "osapi_msgq.h"
 #include "sysapi.h"
 
 #include "mab_include.h"
@@ -175,7 +176,8 @@ RC_t mabStartTasks()
  *********************************************************************/
 void mabTask()
 {
-  mabMsg_t msg;
+  static mabMsg_t msg[MAB_MSG_BATCH];
+  uint32 numMsgs, i;
 
   (void)osapiTaskInitDone( MAB_TASK_SYNC);
 
@@ -198,10 +200,18 @@ void mabTask()
       continue;
     }
 
-    if (osapiMessageReceive(mabBlock->mabQueue, (void*)&msg, (uint32)sizeof(mabMsg_t),
-           WAIT_FOREVER) ==  SUCCESS)
+    if (osapiMessageReceiveBatch(mabBlock->mabQueue, (void*)msg, (uint32)sizeof(mabMsg_t),
+                                 MAB_MSG_BATCH, &numMsgs,  WAIT_FOREVER) ==  SUCCESS)
     {
-      (void)mabDispatchCmd(&msg);
+      /* Take the semaphore tokens given for the rest of the batch */
+      for (i = 1; i < numMsgs; i++)
+      {
+        (void)osapiSemaTake(mabBlock->mabTaskSyncSema,  NO_WAIT);
+      }
+      for (i = 0; i < numMsgs; i++)
+      {
+        (void)mabDispatchCmd(&msg[i]);
+      }
     }
     else
     {
@@ -349,6 +359,7 @@ RC_t mabIssueCmd(uint32 event, uint32 intIfNum, void *data)
 {
   mabMsg_t msg;
   RC_t rc;
+  uint32 priority =  MSG_PRIORITY_NORM;
    uchar8 ifName[ NIM_IF_ALIAS_SIZE + 1];
   nimGetIntfName(intIfNum,  ALIASNAME, ifName);
 
@@ -359,8 +370,13 @@ RC_t mabIssueCmd(uint32 event, uint32 intIfNum, void *data)
   if (data !=  NULLPTR)
     (void)mabFillMsg(data, &msg);
 
+  /* Link changes and RADIUS responses must not wait behind a backlog of
+     other events during port storms */
+  if ((event == mabIntfChange) || (event == mabAaaInfoReceived))
+    priority =  MSG_PRIORITY_URG;
+
   /* send message */
-  rc = osapiMessageSend(mabBlock->mabQueue, &msg, (uint32)sizeof(mabMsg_t),  NO_WAIT,  MSG_PRIORITY_NORM);
+  rc = osapiMessageSend(mabBlock->mabQueue, &msg, (uint32)sizeof(mabMsg_t),  NO_WAIT, priority);
   if (rc !=  SUCCESS)
   {
     MAB_ERROR_SEVERE("Failed to send to mabQueue! Event: %u, interface: %s\n", event, ifName);
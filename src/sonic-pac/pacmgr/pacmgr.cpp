@@ -50,11 +50,13 @@
 #include <net/if.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <linux/filter.h>
 #include "fpSonicUtils.h"
 
 extern PacMgr pacmgr;
 extern swss::Select s;
-extern pacSocket_map_t g_pacSocketMap;
+extern pacSocket *g_pacSocket;
 
 const string INTFS_PREFIX = "E";
 
@@ -1188,86 +1190,24 @@ bool PacMgr::processPacHostapdConfGlobalTblEvent(Selectable *tbl)
   return true;
 }
 
-void PacMgr::processPacket(int m_pac_socket)
+void PacMgr::processPacket(const pacIntfInfo_t &intf, uint16_t vlan_id, const uchar8 *pkt, uint32 len)
 {
-    struct sockaddr_ll from;
-    struct sockaddr_ll to;
-    struct iovec iov;
-    struct msghdr msg;
-    uint16_t vlan_id = 0;
-    ssize_t  packetLen = 0;
-    static char pkt[MAX_PACKET_SIZE];
-    struct cmsghdr *cmsg;
-    struct tpacket_auxdata *aux;
-    union {
-      char buf[CMSG_SPACE(MAX_PACKET_SIZE)];
-      struct cmsghdr align;
-    } cmsg_buf;
-    char ifname[IF_NAMESIZE] = {0};
-
-    uint32 intIfNum;
      enetMacAddr_t macAddr;
      uchar8           eap_ethtype[] = {0x88, 0x8e};
-     uchar8 intfMac[ETHER_ADDR_LEN];
 
-    memset(pkt, 0, sizeof(pkt));
-    memset(&from, 0, sizeof(struct sockaddr_ll));
-    memset(&to, 0, sizeof(struct sockaddr_ll));
-    memset(&iov, 0, sizeof(struct iovec));
-    memset(&msg, 0, sizeof(struct msghdr));
-
-    msg.msg_name        = &from;
-    msg.msg_namelen     = sizeof(from);
-    msg.msg_iov         = &iov;
-    msg.msg_iovlen      = 1;
-    msg.msg_controllen   = sizeof(cmsg_buf);
-    msg.msg_control      = &cmsg_buf;
-    msg.msg_flags       = 0;
-
-    iov.iov_len         = MAX_PACKET_SIZE;
-    iov.iov_base        = pkt;
-
-    packetLen = recvmsg(m_pac_socket, &msg, MSG_TRUNC);
-
-    if (0 > packetLen)
-    {
-        if (errno == ENETDOWN)
-            SWSS_LOG_NOTICE("%s : errno : Network is down %d \n", __FUNCTION__, from.sll_ifindex);
-        else
-            SWSS_LOG_NOTICE("%d : errno : %s \n", from.sll_ifindex, strerror(errno));
-
-        return;
-    }
-    
-
-
-    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
-    {
-        if (cmsg->cmsg_level == SOL_PACKET || cmsg->cmsg_type == PACKET_AUXDATA)
-        {
-            aux = (struct tpacket_auxdata *)CMSG_DATA(cmsg);
-            if (aux->tp_status & TP_STATUS_VLAN_VALID)
-            {
-                vlan_id = (aux->tp_vlan_tci & 0x0fff);
-                break;
-            }
-        }
-    }
-
-    if_indextoname(from.sll_ifindex, ifname);
-
-    string name(ifname);
-    if(name.find(INTFS_PREFIX) == string::npos)
+    if (len < ETHER_HDR_LEN)
     {
-        // SWSS_LOG_NOTICE("Unsupported interface format. No 'E' prefix: %s", ifname);
         return;
     }
 
-    memcpy (macAddr.addr, (unsigned char*)&pkt[ETHER_ADDR_LEN], sizeof(macAddr));
+    memcpy (macAddr.addr, &pkt[ETHER_ADDR_LEN], sizeof(macAddr));
 
+    // EAPOL and own MAC frames are dropped by the ring filter already, these
+    // only catch frames that were queued before the filter was last updated
     if (memcmp(&pkt[12], eap_ethtype, sizeof(eap_ethtype)) == 0)
     {
-        SWSS_LOG_NOTICE("Received packet is EAPOL. Ignoring unlearnt packet trigger due to EAPOL pkt type %02X from %s", pkt[15], ifname);
+        SWSS_LOG_NOTICE("Received packet is EAPOL. Ignoring unlearnt packet trigger due to EAPOL pkt type %02X from %s",
+                        (len > 15) ? pkt[15] : 0, intf.ifname.c_str());
         SWSS_LOG_NOTICE("Src MAC %02X:%02X:%02X:%02X:%02X:%02X ", 
                        (unsigned char)macAddr.addr[0], (unsigned char)macAddr.addr[1],
                        (unsigned char)macAddr.addr[2], (unsigned char)macAddr.addr[3],
@@ -1276,25 +1216,12 @@ void PacMgr::processPacket(int m_pac_socket)
         return;
     }
 
-    if(fpGetIntIfNumFromHostIfName(ifname, &intIfNum) !=  SUCCESS)
-    {
-        SWSS_LOG_NOTICE("Unable to get the internal interface number for %s.", ifname);
-        return;
-    }
-
-    if (nimGetIntfAddress(intIfNum,  0, intfMac) !=  SUCCESS)
-    {
-        SWSS_LOG_NOTICE("Unable to fetch interface MAC for %s", ifname);
-        return;
-    }
-
-    if (0 == memcmp(macAddr.addr, intfMac, ETHER_ADDR_LEN))
+    if (0 == memcmp(macAddr.addr, intf.mac.addr, ETHER_ADDR_LEN))
     {
-//        SWSS_LOG_NOTICE("own mac.. returning");
         return;
     }
 
-    authmgrUnauthAddrCallBack(intIfNum, macAddr, ( ushort16)vlan_id);
+    authmgrUnauthAddrCallBack(intf.intIfNum, macAddr, ( ushort16)vlan_id);
     return;
 }
 
@@ -1304,52 +1231,24 @@ void PacMgr::createPacSocket(char *if_name, bool isCreate)
 
     if (isCreate == true)
     {
-        auto it = g_pacSocketMap.begin();
-        while(it != g_pacSocketMap.end())
+        // the socket only exists while at least one interface needs it
+        if (g_pacSocket == NULL)
         {
-            auto interface_name = it->second;
-
-            if (ifname == interface_name)
-            {
-                SWSS_LOG_DEBUG("Already exists. Found the entry in socket map for interface %s", PAC_GET_STD_IF_FORMAT(if_name));
-                return;
-            }
-            it++;
+            g_pacSocket = new pacSocket();
+            s.addSelectable(g_pacSocket);
         }
-
-        pacSocket *p = NULL;
-        p = new pacSocket(ifname);
-        if (p == NULL)
-        {
-            SWSS_LOG_ERROR("createPacSocket failed for %s", PAC_GET_STD_IF_FORMAT(if_name));
-            return;
-        }
-        g_pacSocketMap[p] = ifname;
-        s.addSelectable(p);
+        g_pacSocket->addInterface(ifname);
     }
-    else
+    else if (g_pacSocket != NULL)
     {
-        pacSocket *p = NULL;
-        auto it = g_pacSocketMap.begin();
-        while(it != g_pacSocketMap.end())
-        {
-            auto interface_name = it->second;
-
-            if (ifname == interface_name)
-            {
-                SWSS_LOG_NOTICE("Found the entry in socket map for interface %s", PAC_GET_STD_IF_FORMAT(if_name));
-                p = (pacSocket *)it->first;
-                break;
-            }
-            it++;
-        }
+        g_pacSocket->removeInterface(ifname);
+    }
 
-        if(p)
-        {
-            s.removeSelectable(p);
-            g_pacSocketMap.erase(p);
-            delete (p);
-        }
+    if ((g_pacSocket != NULL) && g_pacSocket->empty())
+    {
+        s.removeSelectable(g_pacSocket);
+        delete g_pacSocket;
+        g_pacSocket = NULL;
     }
     SWSS_LOG_NOTICE("Create/Delete (%d) pacSocket for ifname %s", isCreate, PAC_GET_STD_IF_FORMAT(if_name));
     return;
@@ -1375,45 +1274,75 @@ extern "C" {
     }
 }
 
-pacSocket::pacSocket(string ifname, int priority) :
-    Selectable(priority), m_pac_socket(0)
+pacSocket::pacSocket(int priority) :
+    Selectable(priority), m_pac_socket(0), m_ring(NULL), m_block(0)
 {
-    int val = 0;
-    int ret = 0;
+    int val = TPACKET_V3;
+    int err;
+    struct tpacket_req3 req;
     struct sockaddr_ll ll_my;
 
-    // open a raw socket
-    m_pac_socket = socket(PF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
-    if (m_pac_socket	 < 0)
+    // open a raw socket; it is bound to ETH_P_ALL only once the ring
+    // and the filter are in place
+    m_pac_socket = socket(PF_PACKET, SOCK_RAW, 0);
+    if (m_pac_socket < 0)
     {
         SWSS_LOG_ERROR("socket() API returned error %d", m_pac_socket);
         throw system_error(errno, system_category());
     }
-    else
+
+    if (-1 == setsockopt(m_pac_socket, SOL_PACKET, PACKET_VERSION, &val, sizeof(val)))
     {
-        SWSS_LOG_DEBUG("Created socket %d", m_pac_socket);
+        err = errno;
+        SWSS_LOG_ERROR("Unable to set TPACKET_V3 on socket %d", m_pac_socket);
+        close(m_pac_socket);
+        throw system_error(err, system_category());
     }
 
-    //get vlan info from socket
-    val = 1;
-    if (-1 == setsockopt (m_pac_socket, SOL_PACKET, PACKET_AUXDATA, &val,
-                sizeof (val)))
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = PACMGR_RING_BLOCK_SIZE;
+    req.tp_block_nr = PACMGR_RING_BLOCK_NR;
+    req.tp_frame_size = PACMGR_RING_FRAME_SIZE;
+    req.tp_frame_nr = (PACMGR_RING_BLOCK_SIZE / PACMGR_RING_FRAME_SIZE) * PACMGR_RING_BLOCK_NR;
+    req.tp_retire_blk_tov = PACMGR_RING_BLOCK_TMO;
+    if (-1 == setsockopt(m_pac_socket, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)))
     {
-        SWSS_LOG_NOTICE("error socket %d", m_pac_socket);
+        err = errno;
+        SWSS_LOG_ERROR("Unable to set up the receive ring on socket %d", m_pac_socket);
+        close(m_pac_socket);
+        throw system_error(err, system_category());
+    }
 
+    m_ring = (uint8_t *)mmap(NULL, (size_t)PACMGR_RING_BLOCK_SIZE * PACMGR_RING_BLOCK_NR,
+                             PROT_READ | PROT_WRITE, MAP_SHARED, m_pac_socket, 0);
+    if (m_ring == MAP_FAILED)
+    {
+        err = errno;
+        SWSS_LOG_ERROR("Unable to map the receive ring of socket %d", m_pac_socket);
+        m_ring = NULL;
+        close(m_pac_socket);
+        throw system_error(err, system_category());
     }
 
+    // no interfaces yet, so this drops everything
+    updateFilter();
+
     memset(&ll_my, 0, sizeof(ll_my));
     ll_my.sll_family = PF_PACKET;
-    ll_my.sll_ifindex = if_nametoindex(ifname.c_str());
-    ret = bind(m_pac_socket, (struct sockaddr *) &ll_my, sizeof(ll_my));
-    if (ret < 0)
+    ll_my.sll_protocol = htons(ETH_P_ALL);
+    ll_my.sll_ifindex = 0;
+    if (bind(m_pac_socket, (struct sockaddr *) &ll_my, sizeof(ll_my)) < 0)
     {
-        SWSS_LOG_NOTICE("Binding the socket to the interface %s failed", PAC_GET_STD_IF_FORMAT(ifname));
+        err = errno;
+        SWSS_LOG_ERROR("Binding socket %d failed", m_pac_socket);
+        munmap(m_ring, (size_t)PACMGR_RING_BLOCK_SIZE * PACMGR_RING_BLOCK_NR);
+        m_ring = NULL;
+        close(m_pac_socket);
+        throw system_error(err, system_category());
     }
 
-    SWSS_LOG_NOTICE("Created a socket for the interface %s(%d)",
-                    PAC_GET_STD_IF_FORMAT(ifname), ll_my.sll_ifindex);
+    SWSS_LOG_NOTICE("Created socket %d with a %u KB receive ring", m_pac_socket,
+                    (PACMGR_RING_BLOCK_SIZE * PACMGR_RING_BLOCK_NR) / 1024);
 }
 
 
@@ -1421,6 +1350,10 @@ pacSocket::~pacSocket()
 {
     SWSS_LOG_DEBUG("Delete socket %d", m_pac_socket);
 
+    if (m_ring)
+    {
+        munmap(m_ring, (size_t)PACMGR_RING_BLOCK_SIZE * PACMGR_RING_BLOCK_NR);
+    }
 
     if (m_pac_socket)
     {
@@ -1436,11 +1369,206 @@ int pacSocket::getFd()
 
 uint64_t pacSocket::readData()
 {
+    struct tpacket_block_desc *pbd;
+    struct tpacket3_hdr *ppd;
+    struct sockaddr_ll *from;
+    uint16_t vlan_id;
+    bool refresh = false;
+
     SWSS_LOG_DEBUG("%s %d: Read data for the PAC packet", __FUNCTION__, __LINE__);
-    pacmgr.processPacket(m_pac_socket);
+
+    // hand back at most one ring's worth of blocks per call, so that a MAC
+    // flood cannot keep the select loop away from the DB events
+    for (int n = 0; n < PACMGR_RING_BLOCK_NR; n++)
+    {
+        pbd = (struct tpacket_block_desc *)(m_ring + (size_t)m_block * PACMGR_RING_BLOCK_SIZE);
+        if ((__atomic_load_n(&pbd->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0)
+        {
+            break;
+        }
+
+        ppd = (struct tpacket3_hdr *)((uint8_t *)pbd + pbd->hdr.bh1.offset_to_first_pkt);
+        for (uint32_t i = 0; i < pbd->hdr.bh1.num_pkts; i++)
+        {
+            from = (struct sockaddr_ll *)((uint8_t *)ppd + TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+
+            auto it = m_intfMap.find(from->sll_ifindex);
+            if (it != m_intfMap.end())
+            {
+                pacIntfInfo_t &intf = it->second;
+
+                if (!intf.resolved && resolveInterface(intf))
+                {
+                    refresh = true;
+                }
+                if (intf.resolved)
+                {
+                    vlan_id = (ppd->tp_status & TP_STATUS_VLAN_VALID) ? (ppd->hv1.tp_vlan_tci & 0x0fff) : 0;
+                    pacmgr.processPacket(intf, vlan_id, (uchar8 *)ppd + ppd->tp_mac, ppd->tp_snaplen);
+                }
+            }
+            ppd = (struct tpacket3_hdr *)((uint8_t *)ppd + ppd->tp_next_offset);
+        }
+
+        __atomic_store_n(&pbd->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        m_block = (m_block + 1) % PACMGR_RING_BLOCK_NR;
+    }
+
+    // an interface MAC became known, let the kernel drop its frames too
+    if (refresh)
+    {
+        updateFilter();
+    }
     return 0;
 }
 
+void pacSocket::addInterface(const string &ifname)
+{
+    pacIntfInfo_t intf;
+    int ifindex;
+
+    if (ifname.find(INTFS_PREFIX) == string::npos)
+    {
+        SWSS_LOG_NOTICE("Unsupported interface format. No 'E' prefix: %s", ifname.c_str());
+        return;
+    }
+
+    for (auto &it : m_intfMap)
+    {
+        if (it.second.ifname == ifname)
+        {
+            SWSS_LOG_DEBUG("Already exists. Found the entry in socket map for interface %s", PAC_GET_STD_IF_FORMAT(ifname));
+            return;
+        }
+    }
+
+    ifindex = if_nametoindex(ifname.c_str());
+    if (ifindex == 0)
+    {
+        SWSS_LOG_NOTICE("Unable to get the ifindex of %s", PAC_GET_STD_IF_FORMAT(ifname));
+        return;
+    }
+
+    intf.ifname = ifname;
+    intf.intIfNum = 0;
+    memset(&intf.mac, 0, sizeof(intf.mac));
+    intf.resolved = false;
+    if (!resolveInterface(intf))
+    {
+        SWSS_LOG_NOTICE("Unable to get the internal interface number or MAC for %s, will retry on receive",
+                        PAC_GET_STD_IF_FORMAT(ifname));
+    }
+
+    m_intfMap[ifindex] = intf;
+    updateFilter();
+
+    SWSS_LOG_NOTICE("Receiving unauth packets for the interface %s(%d)",
+                    PAC_GET_STD_IF_FORMAT(ifname), ifindex);
+}
+
+void pacSocket::removeInterface(const string &ifname)
+{
+    for (auto it = m_intfMap.begin(); it != m_intfMap.end(); it++)
+    {
+        if (it->second.ifname == ifname)
+        {
+            SWSS_LOG_NOTICE("Found the entry in socket map for interface %s", PAC_GET_STD_IF_FORMAT(ifname));
+            m_intfMap.erase(it);
+            updateFilter();
+            return;
+        }
+    }
+}
+
+bool pacSocket::empty() const
+{
+    return m_intfMap.empty();
+}
+
+bool pacSocket::resolveInterface(pacIntfInfo_t &intf)
+{
+    if (fpGetIntIfNumFromHostIfName(intf.ifname.c_str(), &intf.intIfNum) !=  SUCCESS)
+    {
+        return false;
+    }
+
+    if (nimGetIntfAddress(intf.intIfNum,  0, intf.mac.addr) !=  SUCCESS)
+    {
+        return false;
+    }
+
+    intf.resolved = true;
+    return true;
+}
+
+/* Build and attach the classic BPF program for the ring:
+ *   - drop what we transmit ourselves
+ *   - accept only frames received on PAC enabled ifindexes
+ *   - drop EAPOL, which is handled by the dot1x path
+ *   - drop frames sourced from any of our interface MACs
+ *   - copy only the Ethernet header of what is left into the ring
+ * Attaching a new program replaces the old one atomically.
+ */
+void pacSocket::updateFilter()
+{
+    std::vector<struct sock_filter> prog;
+    std::vector<const enetMacAddr_t *> macs;
+    uint32_t left = m_intfMap.size();
+
+    prog.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, (uint32_t)(SKF_AD_OFF + SKF_AD_PKTTYPE)));
+    prog.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, PACKET_OUTGOING, 0, 1));
+    prog.push_back(BPF_STMT(BPF_RET | BPF_K, 0));
+
+    // jump past the remaining ifindex checks and the final drop
+    prog.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, (uint32_t)(SKF_AD_OFF + SKF_AD_IFINDEX)));
+    for (auto &it : m_intfMap)
+    {
+        left--;
+        prog.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)it.first, 0, 1));
+        prog.push_back(BPF_STMT(BPF_JMP | BPF_JA, (left * 2) + 1));
+
+        if (it.second.resolved &&
+            std::none_of(macs.begin(), macs.end(), [&](const enetMacAddr_t *m)
+                         { return memcmp(m->addr, it.second.mac.addr, ETHER_ADDR_LEN) == 0; }))
+        {
+            macs.push_back(&it.second.mac);
+        }
+    }
+    prog.push_back(BPF_STMT(BPF_RET | BPF_K, 0));
+
+    prog.push_back(BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 12));
+    prog.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ETH_P_PAE, 0, 1));
+    prog.push_back(BPF_STMT(BPF_RET | BPF_K, 0));
+
+    // five instructions per MAC; leave the rest to processPacket if the
+    // program would grow too big
+    if (prog.size() + (macs.size() * 5) + 1 > BPF_MAXINSNS)
+    {
+        SWSS_LOG_NOTICE("Too many interface MACs (%zu) for the packet filter", macs.size());
+        macs.clear();
+    }
+    for (auto m : macs)
+    {
+        const uchar8 *a = m->addr;
+
+        prog.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, ETHER_ADDR_LEN));
+        prog.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,
+                                ((uint32_t)a[0] << 24) | ((uint32_t)a[1] << 16) | ((uint32_t)a[2] << 8) | a[3], 0, 3));
+        prog.push_back(BPF_STMT(BPF_LD | BPF_H | BPF_ABS, ETHER_ADDR_LEN + 4));
+        prog.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ((uint32_t)a[4] << 8) | a[5], 0, 1));
+        prog.push_back(BPF_STMT(BPF_RET | BPF_K, 0));
+    }
+    prog.push_back(BPF_STMT(BPF_RET | BPF_K, PACMGR_RING_SNAP_LEN));
+
+    struct sock_fprog fprog;
+    fprog.len = (unsigned short)prog.size();
+    fprog.filter = prog.data();
+    if (-1 == setsockopt(m_pac_socket, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog)))
+    {
+        SWSS_LOG_ERROR("Unable to attach the packet filter to socket %d: %s", m_pac_socket, strerror(errno));
+    }
+}
+
 pacQueue::pacQueue(int priority) :
     Selectable(priority)
 {
@@ -28,12 +28,19 @@
 #include <swss/table.h>
 #include <swss/select.h>
 #include <swss/timestamp.h>
+#include <unordered_map>
 
 #include "redisapi.h"
 #include "auth_mgr_exports.h"
 
 #define STATEDB_KEY_SEPARATOR "|"
-#define MAX_PACKET_SIZE       8192
+
+/* Unauthenticated address punt ring (TPACKET_V3), shared by all PAC ports */
+#define PACMGR_RING_BLOCK_SIZE (1 << 18)
+#define PACMGR_RING_BLOCK_NR   8
+#define PACMGR_RING_FRAME_SIZE 2048
+#define PACMGR_RING_BLOCK_TMO  10  // msec before a partly filled block is handed up
+#define PACMGR_RING_SNAP_LEN   64  // only the Ethernet header is looked at
 
 #define INDEX_0 0
 #define INDEX_1 1
@@ -61,7 +68,13 @@ typedef struct pac_hostapd_glbl_info_s {
   unsigned int enable_auth;
 }pac_hostapd_glbl_info_t;
 
-typedef std::map<Selectable *, std::string> pacSocket_map_t;
+/* PAC enabled interface as seen by the unauth address receiver */
+typedef struct pacIntfInfo_s {
+    std::string ifname;
+    uint32 intIfNum;
+     enetMacAddr_t mac;
+    bool resolved;  // intIfNum and mac are valid
+} pacIntfInfo_t;
 
 /* PAC GLOBAL config table Info */
 typedef struct pacGlobalConfigCacheParams_t {
@@ -122,7 +135,7 @@ public:
     std::vector<Selectable *> getSelectables();
     bool processDbEvent(Selectable *source);
     void createPacSocket(char *if_name, bool isCreate);
-    void processPacket(int m_pac_socket);
+    void processPacket(const pacIntfInfo_t &intf, uint16_t vlan_id, const uchar8 *pkt, uint32 len);
     int  pacQueuePost(char *if_name, bool isCreate);
 
     /* Placeholder for PAC Global table config params */
@@ -171,18 +184,34 @@ private:
 
 namespace swss {
 
+/* Single AF_PACKET socket with a TPACKET_V3 receive ring for the
+ * unauth address punts of all PAC enabled interfaces. A classic BPF
+ * filter keeps everything but frames from unknown source MACs on those
+ * interfaces out of the ring.
+ */
 class pacSocket : public Selectable {
 public:
 
-    pacSocket(string ifname, int priority = 0);
+    pacSocket(int priority = 0);
     virtual ~pacSocket ();
 
     int getFd() override;
     uint64_t readData() override;
+    void addInterface(const string &ifname);
+    void removeInterface(const string &ifname);
+    bool empty() const;
 
 private:
 
+    bool resolveInterface(pacIntfInfo_t &intf);
+    void updateFilter();
+
     int m_pac_socket;
+    uint8_t *m_ring;
+    unsigned int m_block;  // next ring block to hand back to the kernel
+
+    // ifindex -> interface
+    std::unordered_map<int, pacIntfInfo_t> m_intfMap;
 };
 
 }
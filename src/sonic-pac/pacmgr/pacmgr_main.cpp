@@ -36,7 +36,7 @@ swss::DBConnector appDb("APPL_DB", 0);
 
 PacMgr pacmgr(&configDb, &stateDb, &appDb);
 swss::Select s;
-pacSocket_map_t g_pacSocketMap;
+pacSocket *g_pacSocket = NULL;
 
 
 int main(int argc, char *argv[])
@@ -70,7 +70,8 @@ int main(int argc, char *argv[])
             swss::Selectable *sel = NULL;
             s.select(&sel);
 
-            if (g_pacSocketMap.find(sel) != g_pacSocketMap.end())
+            // unauth packets are handled in pacSocket::readData()
+            if ((g_pacSocket != NULL) && (sel == g_pacSocket))
             {
                 continue;
             }